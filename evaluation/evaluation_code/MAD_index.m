@@ -62,6 +62,15 @@ end
 ref = double( ref_img );
 dst = double( dst_img );
 
+% The native engine (mad_native, built by compile_metrix_native in
+% metrix_mux) gives the scores of the code below for floating-point
+% images; it keeps the filters and the last reference's analysis.
+% (The LUT of hi_index maps integer 255 as 254, so those stay here.)
+if( nargout < 2 && isfloat( ref_img ) && isfloat( dst_img ) && exist( 'mad_native', 'file' ) == 3 )
+  [index.MAD index.HI index.LO index.sig] = mad_native( ref, dst );
+  return;
+end
+
 % Calculate high quality index
 % Calculate low quality index
 
@@ -0,0 +1,84 @@
+function convert_gt_store(imgNo, kernNo, withMeans, withSpectra)
+% CONVERT_GT_STORE writes the ground truth images of
+% groundTruthMatFiles/GroundTruth<img>_<kernel>.mat to the ground truth
+% store groundTruthMatFiles/GroundTruth<img>_<kernel>.gts, which
+% eval_image.m maps into memory (gtstore_native) instead of loading
+% the .mat file.  IMGNO (default 1:4) and KERNNO (default 1:12) select
+% the files.  With WITHMEANS (default false) the store also holds
+% mean(x,3) of every image, with WITHSPECTRA (default true) fft2 of
+% that mean, so that registering against an image costs no transform.
+%
+% The layout is the one of gtstore.h
+% (image_quality_algorithms/metrix_mux/native): an 80-byte header, then
+% the images as the GroundTruth array holds them, the means and the
+% spectra (real and imaginary parts interleaved), each section starting
+% at a multiple of 4096 bytes.
+
+if ~exist('imgNo', 'var')||isempty(imgNo), imgNo = 1:4; end
+if ~exist('kernNo', 'var')||isempty(kernNo), kernNo = 1:12; end
+if ~exist('withMeans', 'var')||isempty(withMeans), withMeans = false; end
+if ~exist('withSpectra', 'var')||isempty(withSpectra), withSpectra = true; end
+
+for img = imgNo
+  for kernel = kernNo
+    matFile = sprintf('groundTruthMatFiles/GroundTruth%d_%d.mat', img, kernel);
+    storeFile = sprintf('groundTruthMatFiles/GroundTruth%d_%d.gts', img, kernel);
+    fprintf('Converting %s to %s\n', matFile, storeFile);
+    load(matFile);
+    write_store(GroundTruth, storeFile, withMeans, withSpectra);
+    clear GroundTruth
+  end
+end
+
+return
+
+% -----------------------------------------------------------------
+% Helper functions
+% -----------------------------------------------------------------
+
+function write_store(GroundTruth, storeFile, withMeans, withSpectra)
+
+if ~isa(GroundTruth, 'uint8')
+  error('GroundTruth has to be of type uint8!');
+end
+[rows, cols, channels, frames] = size(GroundTruth);
+frameSize = rows*cols*channels;
+planeSize = rows*cols;
+
+align = @(offset) ceil(offset/4096)*4096;
+offsets = [align(80), 0, 0];
+next = offsets(1) + frameSize*frames;
+if withMeans
+  offsets(2) = align(next);
+  next = offsets(2) + 8*planeSize*frames;
+end
+if withSpectra
+  offsets(3) = align(next);
+end
+
+fid = fopen(storeFile, 'w', 'ieee-le');
+if fid < 0
+  error('Cannot create %s!', storeFile);
+end
+fwrite(fid, 'MTRXGTS1', 'uchar');
+fwrite(fid, [1 1 withMeans+2*withSpectra 0], 'uint32');
+fwrite(fid, [rows cols channels frames offsets], 'uint64');
+
+fwrite(fid, zeros(1, offsets(1) - ftell(fid)), 'uint8');
+fwrite(fid, GroundTruth, 'uint8');
+if withMeans
+  fwrite(fid, zeros(1, offsets(2) - ftell(fid)), 'uint8');
+  for j = 1:frames
+    fwrite(fid, mean(double(GroundTruth(:,:,:,j)), 3), 'double');
+  end
+end
+if withSpectra
+  fwrite(fid, zeros(1, offsets(3) - ftell(fid)), 'uint8');
+  for j = 1:frames
+    F = fft2(mean(double(GroundTruth(:,:,:,j)), 3));
+    fwrite(fid, [real(F(:)).'; imag(F(:)).'], 'double');
+  end
+end
+fclose(fid);
+
+return
@@ -1,8 +1,30 @@
-function scores = eval_image(deblurred,img,kernel,metric)
+function scores = eval_image(deblurred,img,kernel,metric,topK,verify)
 % BENCHMARK_EVAL_IMAGE computes various quality measures given
 % a deblurred image and the corresponding ID, i.e. you have to
 % provide the image and kernel number
 %
+% Candidate pruning: with TOPK, the expensive metrics ('MSSIM', 'VIF',
+% 'IFC', 'MAD') are computed against the TOPK ground truth images
+% closest to the deblurred image only.  Every ground truth image is
+% registered and ranked first by a cheap proxy, the MSE of the
+% registered images averaged over PROXY_BLOCK x PROXY_BLOCK blocks
+% (scores.proxy); the others score NaN, which get_best_metric_value2
+% ignores.  scores.candidates lists the images scored.  With VERIFY,
+% all images are scored as well (scores.exhaustive), and
+% scores.pruned_differs tells whether the best value of the pruned
+% scores differs from the exhaustive one.
+%
+% The ground truth images are read from the memory-mapped store
+% groundTruthMatFiles/GroundTruth<img>_<kernel>.gts (convert_gt_store.m)
+% when it and gtstore_native exist, else loaded from the .mat file.
+%
+% METRIC can be a cell array of metrics, e.g. {'PSNR','MSSIM','VIF'}:
+% every ground truth image is then scaled, registered and shifted once
+% for all of them, and scores has a field per metric.  With
+% fused_native, the metrix_mux metrics of an image pair are computed in
+% one call that preprocesses the pair once and shares the intermediates
+% (the SSIM moments of MSSIM's first scale, the pyramids of VIF and IFC).
+%
 % Michael Hirsch and Rolf Koehler (c) 2012
 
 addpath(genpath('image_quality_algorithms'))
@@ -16,9 +38,18 @@ if ( ~isa(deblurred, 'uint8') || size(deblurred,3)~=3 )
   error('Input image has to be a color image of type uint8!');
 end
 
-% load in .mat containing Ground Truth images
-load(sprintf('groundTruthMatFiles/GroundTruth%d_%d.mat', ...
+% map the Ground Truth store, or load in .mat containing Ground Truth
+% images
+storeFile = sprintf('groundTruthMatFiles/GroundTruth%d_%d.gts', img, kernel);
+if exist('gtstore_native', 'file') == 3 && exist(storeFile, 'file') == 2
+  GroundTruth = [];
+  info = gtstore_native(storeFile);
+  N = info(4);
+else
+  load(sprintf('groundTruthMatFiles/GroundTruth%d_%d.mat', ...
                      img,kernel));
+  N = size(GroundTruth,4);
+end
 
 % z will denote the estimated, i.e. deblurred image
 z = double(deblurred);
@@ -26,15 +57,16 @@ z = double(deblurred);
 % Create constant image which will act as a mask
 c = ones(size(deblurred));
 
-% Initialize containers for quality measures
- mse   = []; 
- mssim = []; 
- vif   = []; 
- ifc   = []; 
- psnr  = []; 
- mad   = []; 
+if ~exist('topK', 'var'), topK = []; end
+if ~exist('verify', 'var')||isempty(verify), verify = false; end
+metrics = reshape(cellstr(metric), 1, []);
+for k = 1:length(metrics)
+  if ~any(strcmp(metrics{k}, {'MSE','MSSIM','VIF','IFC','PSNR','MAD'}))
+    error('Unknown metric %s!', metrics{k});
+  end
+end
+PROXY_BLOCK = 4;
       
-N = size(GroundTruth,4);
 idGt = 1:N;
 
 % For whatever reason ground truth image of (1,3) is missing
@@ -42,65 +74,156 @@ idGt = 1:N;
     idGt = [1:29,31:198];
   end
 
+% MSE and PSNR cost no more than the proxy
+prune = ~isempty(topK) && topK < length(idGt) && ...
+        all(ismember(metrics, {'MSSIM','VIF','IFC','MAD'}));
+
+% =================================================================
+% rank the ground truth images by the proxy
+% -----------------------------------------------------------------
+shifts = zeros(N, 2);
+candidates = idGt;
+if prune
+  fprintf(['Ranking motive %d of 4, kernel %d of 12 against %d ground ' ...
+           'truth images, keeping %d\n'], img, kernel, length(idGt), topK);
+  proxy = nan(1, N);
+  for j = idGt
+    [x, shift] = gt_image(GroundTruth, storeFile, j, z);
+    [xr, zr, shifts(j,:)] = align_to_gt(x, z, c, shift);
+    proxy(j) = proxy_mse(xr, zr, PROXY_BLOCK);
+  end
+  [dummy, order] = sort(proxy(idGt));
+  candidates = sort(idGt(order(1:topK)));
+end
+
 % =================================================================  
 % compute the image quality measure score
 % -----------------------------------------------------------------
-for j = idGt
+scored = candidates;
+if prune && verify
+  scored = idGt;
+end
+values = nan(length(metrics), N);
+for j = scored
   fprintf(['Processing motive %d of 4, kernel %d of 12,  image %d ' ...
-           'of %d for metric %s \n'], img, kernel,j, N,metric);
+           'of %d for metric %s \n'], img, kernel,j, N, ...
+          sprintf('%s ', metrics{:}));
+
+  % Load ground truth image, denoted by x, and scale, register and
+  % shift (the registration of the ranking is reused)
+  if prune
+    x = gt_image(GroundTruth, storeFile, j);
+    [xr, zr] = align_to_gt(x, z, c, shifts(j,:));
+  else
+    [x, shift] = gt_image(GroundTruth, storeFile, j, z);
+    [xr, zr] = align_to_gt(x, z, c, shift);
+  end
 
-  % Load ground truth image, denoted by x
-  x  = double(GroundTruth(:,:,:,j));
-  xf = fft2(mean(x,3));
+  % Compute various quality measures
+  values(:,j) = metric_values(xr, zr, metrics);
+end
 
-  % Scale image intensity
-  zs = (sum(vec(x.*z)) / sum(vec(z.*z))) .* z;
-  zf = fft2(mean(zs,3));
+% =================================================================
+% Save results
+% -----------------------------------------------------------------
+pruned = nan(size(values));
+pruned(:,candidates) = values(:,candidates);
+for k = 1:length(metrics)
+  scores.(metrics{k}) = pruned(k,idGt);
+end
+if prune
+  scores.proxy = proxy(idGt);
+  scores.candidates = candidates;
+  if verify
+    % one row per metric when there are several
+    scores.exhaustive = values(:,idGt);
+    scores.pruned_differs = false;
+    for k = 1:length(metrics)
+      scores.pruned_differs = scores.pruned_differs || ...
+          get_best_metric_value2(pruned(k,idGt), metrics{k}, img, kernel) ~= ...
+          get_best_metric_value2(values(k,idGt), metrics{k}, img, kernel);
+    end
+  end
+end
 
-  % Estimate shift by registering deblurred to ground truth image
-  [output Greg] = dftregistration(xf, zf, 1);
-  shift = output(3:4);
+return
 
-  % Apply shift 
-  cr = imshift(double(c), shift, 'same');
-  zr = imshift(double(zs), shift, 'same');  
-  xr = x.*cr; 
+% -----------------------------------------------------------------
+% Helper functions
+% -----------------------------------------------------------------
 
-  % Compute various quality measures
-  switch metric
-    case 'MSE'
-        mse   = [mse   metrix_mux(xr, zr, 'MSE')];
-    case 'MSSIM'
-        mssim = [mssim metrix_mux(xr, zr, 'MSSIM')];
-    case 'VIF'
-        vif   = [vif   metrix_mux(xr, zr, 'VIF')];
-    case 'IFC'
-        ifc   = [ifc   metrix_mux(xr, zr, 'IFC')];
-    case 'PSNR'
-        psnr  = [psnr  metrix_mux(xr, zr, 'PSNR')];
-    case 'MAD'
-        MAD_temp = MAD_index(xr, zr);
-        mad   = [mad   MAD_temp.MAD];
+function [x, shift] = gt_image(GroundTruth, storeFile, j, z)
+% Ground truth image J, from the store STOREFILE if GROUNDTRUTH is
+% empty; with Z, also the registration shift of Z to it, from the
+% stored spectrum ([] without a store: align_to_gt registers)
+shift = [];
+if isempty(GroundTruth)
+  x = double(gtstore_native(storeFile, j));
+  if nargin > 3
+    output = gtstore_native(storeFile, j, mean(z,3), 1);
+    shift = output(3:4);
   end
+else
+  x = double(GroundTruth(:,:,:,j));
 end
 
-% =================================================================
-% Save results
-% -----------------------------------------------------------------
-switch metric
-  case 'MSE'
-     scores.MSE   = mse;
-  case 'MSSIM'
-     scores.MSSIM = mssim;
-  case 'VIF'
-     scores.VIF   = vif;
-  case 'IFC'
-     scores.IFC   = ifc;
-  case 'PSNR'
-     scores.PSNR  = psnr;
-  case 'MAD'
-     scores.MAD   = mad;
+return
+
+function [xr, zr, shift] = align_to_gt(x, z, c, shift)
+% Scales the intensity of Z to X, registers it to X (unless SHIFT is
+% given) and shifts it; XR is X masked to the part the shifted Z covers
+
+% Scale image intensity
+zs = (sum(vec(x.*z)) / sum(vec(z.*z))) .* z;
+
+% Estimate shift by registering deblurred to ground truth image.
+% The native engine keeps the spectrum of the deblurred image across
+% the frames; scaling it does not move the correlation peak.
+if nargin < 4 || isempty(shift)
+  if exist('dftreg_native', 'file') == 3
+    output = dftreg_native(mean(x,3), mean(z,3), 1);
+  else
+    xf = fft2(mean(x,3));
+    zf = fft2(mean(zs,3));
+    [output Greg] = dftregistration(xf, zf, 1);
+  end
+  shift = output(3:4);
+end
+
+% Apply shift 
+cr = imshift(double(c), shift, 'same');
+zr = imshift(double(zs), shift, 'same');  
+xr = x.*cr; 
+
+return
+
+function v = metric_values(x, z, metrics)
+% The METRICS of the aligned pair X, Z, one column: the metrix_mux
+% metrics in one fused_native call if it exists, MAD by MAD_index
+v = nan(length(metrics), 1);
+mux = ~strcmp(metrics, 'MAD');
+if any(mux) && exist('fused_native', 'file') == 3
+  v(mux) = fused_native(x, z, metrics(mux));
+else
+  for k = find(mux)
+    v(k) = metrix_mux(x, z, metrics{k});
+  end
+end
+for k = find(~mux)
+  MAD_temp = MAD_index(x, z);
+  v(k) = MAD_temp.MAD;
 end
 
 return
 
+function e = proxy_mse(x, z, f)
+% MSE of the channel means of X and Z averaged over FxF blocks (the
+% last rows and columns that do not fill a block are left out)
+d = mean(x,3) - mean(z,3);
+h = f*floor(size(d,1)/f);
+w = f*floor(size(d,2)/f);
+d = reshape(sum(reshape(d(1:h,1:w), f, []), 1), h/f, w);
+d = reshape(sum(reshape(d.', f, []), 1), w/f, h/f);
+e = mean((d(:)/(f*f)).^2);
+
+return
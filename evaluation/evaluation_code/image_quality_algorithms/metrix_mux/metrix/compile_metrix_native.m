@@ -0,0 +1,56 @@
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%%%
+%%%  FUNCTION:  compile_metrix_native
+%%%
+%%%  INPUTS:    NONE
+%%%  
+%%%  OUTPUTS:   NONE
+%%%
+%%%  CHANGES:   Builds the MEX interfaces to the native (C++) metric engines
+%%%             in ../native, which link the matlabPyrTools C kernels
+%%%             directly; if the build does not succeed, the package
+%%%             defaults to the Matlab-based metric code.
+%%%
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+function compile_metrix_native
+
+fprintf('    Building native metric engine MEX interfaces...');
+
+this_file_name = 'compile_metrix_native.m';
+this_file = which( this_file_name );
+metrix_path = this_file( 1:end-length( this_file_name ) );
+native_path = fullfile( metrix_path, '..', 'native' );
+pyr_path = fullfile( metrix_path, '..', 'utilities', 'matlabPyrTools', 'MEX' );
+dwt_path = fullfile( metrix_path, 'vsnr', 'imdwt_cpp' );
+
+pyr_sources = {'convolve.c', 'edges.c', 'wrap.c', 'fftconv.c', 'pyramid.c'};
+native_sources = {'image.cpp', 'pyrtools.cpp', 'gsm.cpp', 'vif.cpp', 'ifc.cpp', 'vsnr.cpp', 'mssim.cpp', ...
+                  'fft.cpp', 'nqm.cpp', 'mad.cpp', 'dftreg.cpp', 'imshift.cpp', 'frameeval.cpp', 'gtstore.cpp', ...
+                  'fused.cpp'};
+sources = [ fullfile( pyr_path, pyr_sources ), fullfile( native_path, native_sources ) ];
+
+%%%
+%%% one MEX function per engine, with the Matlab code it stands in for
+%%%
+gateways = { 'vifvec_native', 'VIF and IFC'; ...
+             'vsnr_native',   'VSNR'; ...
+             'mssim_native',  'MS-SSIM'; ...
+             'nqm_native',    'NQM and WSNR'; ...
+             'mad_native',    'MAD'; ...
+             'dftreg_native', 'dftregistration'; ...
+             'imshift_native', 'imshift'; ...
+             'gtstore_native', 'GroundTruth .mat loading'; ...
+             'fused_native',  'metrix_mux (several metrics)' };
+fprintf('\n');
+for k = 1:size(gateways, 1)
+    fprintf('        %s...', gateways{k,1});
+    try
+        mex( '-O', ['-I' pyr_path], ['-I' native_path], ['-I' dwt_path], '-outdir', native_path, ...
+             fullfile( native_path, [gateways{k,1} '.cpp'] ), sources{:} );
+        fprintf('[Success!]\n');
+    catch
+        fprintf('    [Failed!]\n');
+        fprintf('        Defaulting to Matlab-based %s...[Done!]\n', gateways{k,2});
+    end
+end
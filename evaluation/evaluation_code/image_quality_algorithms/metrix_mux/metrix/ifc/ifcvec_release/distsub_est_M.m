@@ -27,14 +27,9 @@ for i=1:length(subbands)
     winstart=[1 1].*floor(M/2)+1;
     winstop=size(y)-ceil(M/2)+1;
     
-    % mean
-    mean_x = corrDn(y,win/sum(win(:)),'reflect1',winstep, winstart,winstop);
-    mean_y = corrDn(yn,win/sum(win(:)),'reflect1',winstep, winstart,winstop);
-    % cov
-    cov_xy = corrDn(y.*yn, win, 'reflect1',winstep, winstart,winstop) - sum(win(:)).*mean_x.*mean_y;
-    % var
-    ss_x = corrDn(y.^2,win, 'reflect1',winstep, winstart,winstop) - sum(win(:)).*mean_x.^2;
-    ss_y = corrDn(yn.^2,win, 'reflect1',winstep, winstart,winstop) - sum(win(:)).*mean_y.^2;
+    % mean, cov and var in one pass over y and yn (same as corrDn of y,
+    % yn, y.*yn, y.^2 and yn.^2; see winMoments in matlabPyrTools)
+    [mean_x, mean_y, cov_xy, ss_x, ss_y] = winMoments(y, yn, win, 'reflect1', winstep, winstart, winstop);
 
     
     % get rid of numerical problems, very small negative numbers, or very
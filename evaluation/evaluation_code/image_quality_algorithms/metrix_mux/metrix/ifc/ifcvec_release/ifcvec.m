@@ -72,8 +72,10 @@ subbands=[4 7 10 13 16 19 22 25];
 % corresponding subbands from the reference and the distorted images
 % respectively.
 [pyr,pind] = buildSpyr(imorg, 4, 'sp5Filters', 'reflect1'); % compute transform
+pyr = double(pyr); % single images: float pyramid kernels, double statistics
 org=ind2wtree(pyr,pind); % convert to cell array
 [pyr,pind] = buildSpyr(imdist, 4, 'sp5Filters', 'reflect1');
+pyr = double(pyr);
 dist=ind2wtree(pyr,pind);
 
 % calculate the parameters of the distortion channel
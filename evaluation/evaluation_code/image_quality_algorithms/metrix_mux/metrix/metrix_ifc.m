@@ -9,7 +9,8 @@
 %%%
 %%%  OUTPUTS:   metrix_value        - IFC value
 %%%
-%%%  CHANGES:   NONE
+%%%  CHANGES:   Uses the native engine (vifvec_native, built by
+%%%             compile_metrix_native) when it is available
 %%%             
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
@@ -39,4 +40,8 @@
 
 function [metrix_value] = metrix_ifc(reference_image,query_image)
 
-metrix_value = ifcvec(reference_image, query_image);
+if exist('vifvec_native', 'file') == 3
+    [vif_value, metrix_value] = vifvec_native(reference_image, query_image);
+else
+    metrix_value = ifcvec(reference_image, query_image);
+end
@@ -9,7 +9,8 @@
 %%%
 %%%  OUTPUTS:   metrix_value        - MSSIM value
 %%%
-%%%  CHANGES:   NONE
+%%%  CHANGES:   Uses the native engine (mssim_native, built by
+%%%             compile_metrix_native) when it is available
 %%%             
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
@@ -39,4 +40,8 @@
 
 function [metrix_value] = metrix_mssim(reference_image, query_image)
 
-metrix_value = mssim_index( reference_image, query_image );
+if exist('mssim_native', 'file') == 3
+    metrix_value = mssim_native( reference_image, query_image );
+else
+    metrix_value = mssim_index( reference_image, query_image );
+end
@@ -9,7 +9,9 @@
 %%%
 %%%  OUTPUTS:   metrix_value        - NQM value
 %%%
-%%%  CHANGES:   NONE
+%%%  CHANGES:   Uses the native engine (nqm_native, built by
+%%%             compile_metrix_native) when it is available; it keeps
+%%%             the filter bank and FFT plan of the last image size
 %%%             
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
@@ -52,4 +54,8 @@ viewing_angle = 1/3.5 * 180 / pi;
 %%%
 dim = sqrt( prod( size(reference_image) ));
 
-metrix_value = nqm_modified(reference_image, query_image, viewing_angle, dim);
+if exist('nqm_native', 'file') == 3
+    metrix_value = nqm_native(reference_image, query_image);
+else
+    metrix_value = nqm_modified(reference_image, query_image, viewing_angle, dim);
+end
@@ -9,7 +9,9 @@
 %%%
 %%%  OUTPUTS:   metrix_value        - VSNR value
 %%%
-%%%  CHANGES:   NONE
+%%%  CHANGES:   Uses the native engine (vsnr_native, built by
+%%%             compile_metrix_native) when it is available; it keeps
+%%%             the analyses of recent reference images between calls
 %%%             
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
@@ -39,4 +41,8 @@
 
 function [metrix_value] = metrix_vsnr(reference_image, query_image)
 
-metrix_value = vsnr_modified( reference_image, query_image );
+if exist('vsnr_native', 'file') == 3
+    metrix_value = vsnr_native( reference_image, query_image );
+else
+    metrix_value = vsnr_modified( reference_image, query_image );
+end
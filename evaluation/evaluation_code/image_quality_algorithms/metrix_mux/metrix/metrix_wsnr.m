@@ -9,7 +9,8 @@
 %%%
 %%%  OUTPUTS:   metrix_value        - WSNR value
 %%%
-%%%  CHANGES:   NONE
+%%%  CHANGES:   Uses the native engine (nqm_native, built by
+%%%             compile_metrix_native) when it is available
 %%%             
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
@@ -39,4 +40,8 @@
 
 function [metrix_value] = metrix_wsnr(reference_image,query_image)
 
-metrix_value = wsnr_new_modified(reference_image, query_image);
+if exist('nqm_native', 'file') == 3
+    metrix_value = nqm_native(reference_image, query_image, 'wsnr');
+else
+    metrix_value = wsnr_new_modified(reference_image, query_image);
+end
@@ -74,8 +74,10 @@ sigma_nsq=0.4;
 % corresponding subbands from the reference and the distorted images
 % respectively.
 [pyr,pind] = buildSpyr(imorg, 4, 'sp5Filters', 'reflect1'); % compute transform
+pyr = double(pyr); % single images: float pyramid kernels, double statistics
 org=ind2wtree(pyr,pind); % convert to cell array
 [pyr,pind] = buildSpyr(imdist, 4, 'sp5Filters', 'reflect1');
+pyr = double(pyr);
 dist=ind2wtree(pyr,pind);
 
 % calculate the parameters of the distortion channel
@@ -47,6 +47,9 @@
 
 #include "gtypes.h"
 #include "gfile.h"
+#ifdef METRIX_TRACE
+  #include "trace.h"   // metrix_mux native/, hot-path instrumentation
+#endif
 
 #if defined(_MSC_VER)
   #pragma warning(disable:4786)
@@ -642,6 +645,9 @@ private:
       if (!sleeping_ && size > 0)
       {
         pData_ = new Type[size];
+      #ifdef METRIX_TRACE
+        METRIX_TRACE_ALLOC("pyramid/GBuffer", (long long) (size * sizeof(Type)));
+      #endif
         if (zero_init)
         {
         #if defined(_MSC_VER)
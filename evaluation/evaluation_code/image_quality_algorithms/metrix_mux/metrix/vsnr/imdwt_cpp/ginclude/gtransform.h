@@ -27,6 +27,9 @@
 //=========================================================================
 
 #include "gwavelist.h"
+#ifdef METRIX_TRACE
+  #include "trace.h"   // metrix_mux native/, hot-path instrumentation
+#endif
 //=========================================================================
 
 namespace wavlet {
@@ -110,6 +113,9 @@ void GTransform<ListType>::Decompose(
    index_type num_scales
   )
 {
+#ifdef METRIX_TRACE
+  METRIX_TRACE_SCOPE("pyramid/GTransform::Decompose");
+#endif
   // assure that the source image is appropriately sized
   WaveList.AddPadding(num_scales);
   // assure that there's room for the subbands
@@ -141,6 +147,9 @@ void GTransform<ListType>::Reconstruct(
    list_type& WaveList
   )
 {
+#ifdef METRIX_TRACE
+  METRIX_TRACE_SCOPE("pyramid/GTransform::Reconstruct");
+#endif
   // perform the inverse DWT
   const index_type num_scales = WaveList.NumScales();
   for (index_type scale_index = num_scales; scale_index >= 1;
@@ -160,6 +169,9 @@ void GTransform<ListType>::ReconstructOne(
    index_type non_zero_orient
   )
 {
+#ifdef METRIX_TRACE
+  METRIX_TRACE_SCOPE("pyramid/GTransform::Reconstruct");
+#endif
   // perform the inverse DWT
   const index_type num_scales = WaveList.NumScales();
   for (index_type scale_index = num_scales; scale_index >= 1;
@@ -114,12 +114,12 @@ void GWavelift<ListType>::DoTransformRows(
   buf_data_type* pd = DBuffer.Data();
   buf_data_type* ps = SBuffer.Data();
 
-  register const buf_data_type* px_row;
-  register buf_data_type* pd_row;
-  register buf_data_type* ps_row;
+  const buf_data_type* px_row;
+  buf_data_type* pd_row;
+  buf_data_type* ps_row;
 
-  register size_type x;
-  register buf_data_type d_res0, old_d_res, d_res, X2n;
+  size_type x;
+  buf_data_type d_res0, old_d_res, d_res, X2n;
   for (size_type y = 0; y < sh; ++y)
   {
     px_row = px + (xw * y);
@@ -212,9 +212,9 @@ void GWavelift<ListType>::DoTransformCols(
   buf_data_type* pd_col;
   buf_data_type* ps_col;
 
-  register size_type y;
-  register size_type ysave0, ysave1;
-  register buf_data_type d_res0, old_d_res, d_res, X2n;
+  size_type y;
+  size_type ysave0, ysave1;
+  buf_data_type d_res0, old_d_res, d_res, X2n;
   for (size_type x = 0; x < sw; ++x)
   {
     px_col = px + x;
@@ -326,9 +326,9 @@ void GWavelift<ListType>::DoUntransformCols(
   DBufferMut *= -KINV;
 #endif
 
-  register size_type y;
-  register size_type ysave0;
-  register buf_data_type s_res, d_res, d_res0, d_res_last;
+  size_type y;
+  size_type ysave0;
+  buf_data_type s_res, d_res, d_res0, d_res_last;
   for (size_type x = 0; x < sw; ++x)
   {
     px_col = px + x;
@@ -431,8 +431,8 @@ void GWavelift<ListType>::DoUntransformRows(
   DBufferMut *= -KINV;
 #endif
 
-  register size_type x;
-  register buf_data_type s_res, d_res, old_d_res, d_res0;
+  size_type x;
+  buf_data_type s_res, d_res, old_d_res, d_res0;
   for (size_type y = 0; y < sh; ++y)
   {
     px_row = px + (xw * y);
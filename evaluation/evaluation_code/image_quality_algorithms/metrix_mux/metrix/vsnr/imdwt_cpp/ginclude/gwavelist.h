@@ -73,6 +73,7 @@ public:
       GBufferList<buf_type>::operator=(rhs);
       padX_ = rhs.PadX();
       padY_ = rhs.PadY();
+      return *this;
     }
   // parenthesis operator (band access)
   buf_type const& operator ()(index_type scale_index,
@@ -180,7 +181,7 @@ public:
 
   index_type NumScales() const
     {
-      return static_cast<index_type>(0.5 + (Count() - 1) / 6.0);
+      return static_cast<index_type>(0.5 + (this->Count() - 1) / 6.0);
     }
   index_type NumBands() const
     {
@@ -192,40 +193,40 @@ public:
     }
   void Image(buf_type const& NewImage)
     {
-      if (Count() <= 0)
+      if (this->Count() <= 0)
       {
-        Add(NewImage);
+        this->Add(NewImage);
       }
-      else Items(0) = NewImage;
+      else this->Items(0) = NewImage;
     }
   void Image(size_type cx, size_type cy)
     {
-      Add(buf_type(cx, cy));
+      this->Add(buf_type(cx, cy));
     }
 
   buf_type const& LL(index_type scale_index) const
     {
-      return Items(scale_index * 6);
+      return this->Items(scale_index * 6);
     }
   buf_type const& LH(index_type scale_index) const
     {
-      return Items((scale_index * 6) - 1);
+      return this->Items((scale_index * 6) - 1);
     }
   buf_type const& HL(index_type scale_index) const
     {
-      return Items((scale_index * 6) - 2);
+      return this->Items((scale_index * 6) - 2);
     }
   buf_type const& HH(index_type scale_index) const
     {
-      return Items((scale_index * 6) - 3);
+      return this->Items((scale_index * 6) - 3);
     }
   buf_type const& H(index_type scale_index) const
     {
-      return Items((scale_index * 6) - 4);
+      return this->Items((scale_index * 6) - 4);
     }
   buf_type const& L(index_type scale_index) const
     {
-      return Items((scale_index * 6) - 5);
+      return this->Items((scale_index * 6) - 5);
     }
   buf_type const& Band(index_type scale_index,
     index_type orient_index) const
@@ -236,6 +237,7 @@ public:
         case 1: return HL(scale_index);
         case 2: return HH(scale_index);
       }
+      throw except_type("Invalid subband index");
     }
 
   buf_type& Image()
@@ -244,27 +246,27 @@ public:
     }
   buf_type& LL(index_type scale_index)
     {
-      return Items(scale_index * 6);
+      return this->Items(scale_index * 6);
     }
   buf_type& LH(index_type scale_index)
     {
-      return Items((scale_index * 6) - 1);
+      return this->Items((scale_index * 6) - 1);
     }
   buf_type& HL(index_type scale_index)
     {
-      return Items((scale_index * 6) - 2);
+      return this->Items((scale_index * 6) - 2);
     }
   buf_type& HH(index_type scale_index)
     {
-      return Items((scale_index * 6) - 3);
+      return this->Items((scale_index * 6) - 3);
     }
   buf_type& H(index_type scale_index)
     {
-      return Items((scale_index * 6) - 4);
+      return this->Items((scale_index * 6) - 4);
     }
   buf_type& L(index_type scale_index)
     {
-      return Items((scale_index * 6) - 5);
+      return this->Items((scale_index * 6) - 5);
     }
   buf_type& Band(index_type scale_index,
     index_type orient_index)
@@ -316,10 +318,10 @@ public:
       }
 
       // clear all bands except LL(0)
-      size_type count = Count();
+      size_type count = this->Count();
       for (size_type index = count - 1; index > 0; --index)
       {
-        Delete(index);
+        this->Delete(index);
       }
 
       buf_type const& SrcImage = Image();
@@ -329,20 +331,20 @@ public:
       size_type half_cy = cy >> 1;
 
       // add the required subbands to the list
-      Reserve(static_cast<size_type>(1.5 + 3.0 * num_scales));
+      this->Reserve(static_cast<size_type>(1.5 + 3.0 * num_scales));
       for (index_type iLevel = 1; iLevel <= num_scales; ++iLevel)
       {
         // make room for the L and H subbands
-        Add(half_cx, cy);
-        Add(half_cx, cy);
+        this->Add(half_cx, cy);
+        this->Add(half_cx, cy);
 
         if (cy > 1)
         {
           // make room for the HH, HL, HL, and LL subbands
-          Add(half_cx, half_cy);
-          Add(half_cx, half_cy);
-          Add(half_cx, half_cy);
-          Add(half_cx, half_cy);
+          this->Add(half_cx, half_cy);
+          this->Add(half_cx, half_cy);
+          this->Add(half_cx, half_cy);
+          this->Add(half_cx, half_cy);
 
           // divide the dimensions by 2 for the next scale
           cy >>= 1; half_cx >>= 1; half_cy >>= 1;
@@ -350,10 +352,10 @@ public:
         else
         {
           // make placeholders for the HH, HL, HL, and LL subbands
-          Add(0, 0);
-          Add(0, 0);
-          Add(0, 0);
-          Add(0, 0);
+          this->Add(0, 0);
+          this->Add(0, 0);
+          this->Add(0, 0);
+          this->Add(0, 0);
 
           // divide the horz. dimension by 2 for the next scale
           half_cx >>= 1;
@@ -0,0 +1,19 @@
+## Compares "name metric score" lines (stdin) with expected.txt
+## ("name metric score [tolerance]", relative tolerance 1e-8 by
+## default).  Names are matched without their directory; a score
+## that is missing fails too.  Scores equal as text (inf) match.
+FNR == NR {
+  if ($1 !~ /^#/ && NF >= 3) { want[$1 " " $2] = $3; tol[$1 " " $2] = (NF > 3) ? $4 : 1e-8 }
+  next
+}
+{
+  n = split($1, p, "/"); k = p[n] " " $2
+  d = $3 - want[k]; if (d < 0) d = -d
+  ok = (k in want) && ($3 == want[k] || d <= tol[k] * (want[k] < 0 ? -want[k] : want[k]))
+  bad += !ok; seen[k] = 1
+  printf "%-20s %16s %s\n", k, $3, ok ? "ok" : "FAILED"
+}
+END {
+  for (k in want) if (!(k in seen)) { printf "%-20s %16s FAILED\n", k, "missing"; ++bad }
+  exit bad > 0
+}
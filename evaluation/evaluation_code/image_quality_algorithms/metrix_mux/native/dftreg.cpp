@@ -0,0 +1,326 @@
+//=========================================================================
+// dftreg.cpp
+//=========================================================================
+#include "dftreg.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Matlab's max of complex values: the larger modulus, and of equal
+// moduli the larger phase angle
+inline bool Greater(const Complex& a, double abs_a, const Complex& b, double abs_b)
+{
+  return abs_a > abs_b || (abs_a == abs_b && std::arg(a) > std::arg(b));
+}
+
+// [max1, loc1] = max(CC); [max2, loc2] = max(max1): the first maximum
+// in column-major order of the ROWS x COLS array CC
+void Peak(const Complex* cc, int rows, int cols, int& rloc, int& cloc)
+{
+  std::vector<int> best(cols);
+  std::vector<double> best_abs(cols);
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    const Complex* col = cc + (std::size_t) c * rows;
+    int b = 0;
+    double ba = std::abs(col[0]);
+    for (int r = 1; r < rows; ++r)
+    {
+      double const a = std::abs(col[r]);
+      if (Greater(col[r], a, col[b], ba))
+      {
+        b = r;
+        ba = a;
+      }
+    }
+    best[c] = b;
+    best_abs[c] = ba;
+  }
+  cloc = 0;
+  for (int c = 1; c < cols; ++c)
+    if (Greater(cc[best[c] + (std::size_t) c * rows], best_abs[c],
+                cc[best[cloc] + (std::size_t) cloc * rows], best_abs[cloc]))
+      cloc = c;
+  rloc = best[cloc];
+}
+
+// sum(sum(A .* conj(B))) over ROWS x COLS spectra, by columns
+Complex CrossSum(const Complex* a, const Complex* b, int rows, int cols)
+{
+  std::vector<Complex> col_sum(cols);
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    std::size_t const o = (std::size_t) c * rows;
+    Complex s;
+    for (int r = 0; r < rows; ++r) s += a[o + r] * std::conj(b[o + r]);
+    col_sum[c] = s;
+  }
+  Complex s;
+  for (int c = 0; c < cols; ++c) s += col_sum[c];
+  return s;
+}
+
+// Matlab's round: halves away from zero
+inline double Round(double x)
+{
+  return (x < 0.0) ? -std::floor(-x + 0.5) : std::floor(x + 0.5);
+}
+
+// error and diffphase from the correlation peak and the energies
+void Finish(const Complex& cc_max, double e1, double e2, DftRegOutput& out)
+{
+  out.error = std::sqrt(std::fabs(1.0 - std::norm(cc_max) / (e2 * e1)));
+  out.diffphase = std::atan2(cc_max.imag(), cc_max.real());
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+DftRegistration::DftRegistration(int rows, int cols, int usfac)
+  : fft_(rows, cols), up_(0), usfac_(usfac)
+{
+  if (usfac < 0) throw std::runtime_error("DftRegistration: USFAC must not be negative");
+  work_.resize((std::size_t) (usfac > 1 ? 4 : 1) * rows * cols);
+  if (usfac > 1) up_ = new Fft2d(2 * rows, 2 * cols);
+}
+//-------------------------------------------------------------------------
+
+DftRegistration::~DftRegistration()
+{
+  delete up_;
+}
+//-------------------------------------------------------------------------
+
+void DftRegistration::Spectrum(const Image& im, std::vector<Complex>& ft)
+{
+  METRIX_TRACE_SCOPE("register/DftRegistration::Spectrum");
+  if (im.Rows() != Rows() || im.Cols() != Cols())
+    throw std::runtime_error("DftRegistration: image size differs from the plan's");
+  std::size_t const n = im.Size();
+  const double* x = im.Data();
+  ft.resize(n);
+  for (std::size_t i = 0; i < n; ++i) ft[i] = x[i];
+  fft_.Forward(&ft[0]);
+}
+//-------------------------------------------------------------------------
+
+DftRegOutput DftRegistration::Register(const Complex* buf1ft, const Complex* buf2ft)
+{
+  METRIX_TRACE_SCOPE("register/DftRegistration::Register");
+  int const m = Rows(), n = Cols();
+  DftRegOutput out = DftRegOutput();
+
+  if (usfac_ == 0)
+  {
+    Complex const cc_max = CrossSum(buf1ft, buf2ft, m, n);
+    Finish(cc_max, CrossSum(buf1ft, buf1ft, m, n).real(), CrossSum(buf2ft, buf2ft, m, n).real(), out);
+    return out;
+  }
+
+  if (usfac_ == 1)
+  {
+    // whole-pixel shift: the peak of ifft2(buf1ft .* conj(buf2ft))
+    OMP(omp parallel for schedule(static))
+    for (int c = 0; c < n; ++c)
+    {
+      std::size_t const o = (std::size_t) c * m;
+      for (int r = 0; r < m; ++r) work_[o + r] = buf1ft[o + r] * std::conj(buf2ft[o + r]);
+    }
+    fft_.Inverse(&work_[0]);
+    int rloc, cloc;
+    Peak(&work_[0], m, n, rloc, cloc);
+    double const mn = (double) m * n;
+    Finish(work_[rloc + (std::size_t) cloc * m],
+           CrossSum(buf1ft, buf1ft, m, n).real() / mn, CrossSum(buf2ft, buf2ft, m, n).real() / mn, out);
+    out.row_shift = (rloc + 1 > m / 2) ? rloc - m : rloc;
+    out.col_shift = (cloc + 1 > n / 2) ? cloc - n : cloc;
+    return out;
+  }
+
+  // the cross-power spectrum embedded in a 2x larger one (frequencies
+  // -floor(N/2)..ceil(N/2)-1); only its rows within M/2 of DC are set,
+  // the others are skipped by the inverse
+  int const m2 = 2 * m, n2 = 2 * n;
+  OMP(omp parallel for schedule(static))
+  for (int C = 0; C < n2; ++C)
+  {
+    int const fc = BinFrequency(C, n2);
+    bool const col_in = (fc >= -(n / 2) && fc < (n + 1) / 2);
+    int const c = (fc + n) % n;
+    Complex* dst = &work_[(std::size_t) C * m2];
+    for (int R = 0; R < m2; ++R)
+    {
+      int const fr = BinFrequency(R, m2);
+      if (fr > m / 2 || -fr > m / 2) continue;
+      if (col_in && fr >= -(m / 2) && fr < (m + 1) / 2)
+      {
+        std::size_t const k = (fr + m) % m + (std::size_t) c * m;
+        dst[R] = buf1ft[k] * std::conj(buf2ft[k]);
+      }
+      else
+        dst[R] = Complex();
+    }
+  }
+  up_->Inverse(&work_[0], m / 2);
+  int rloc, cloc;
+  Peak(&work_[0], m2, n2, rloc, cloc);
+  Complex const cc_max = work_[rloc + (std::size_t) cloc * m2];
+  out.row_shift = ((rloc + 1 > m) ? rloc - m2 : rloc) / 2.0;
+  out.col_shift = ((cloc + 1 > n) ? cloc - n2 : cloc) / 2.0;
+
+  if (usfac_ > 2)
+    Refine(buf1ft, buf2ft, out);
+  else
+  {
+    double const mn = (double) m2 * n2;
+    Finish(cc_max, CrossSum(buf1ft, buf1ft, m, n).real() / mn, CrossSum(buf2ft, buf2ft, m, n).real() / mn, out);
+  }
+  if (m == 1) out.row_shift = 0.0;
+  if (n == 1) out.col_shift = 0.0;
+  return out;
+}
+//-------------------------------------------------------------------------
+
+// dftups(buf2ft .* conj(buf1ft), NO, NO, USFAC, ROFF, COFF): the
+// cross-correlation upsampled by USFAC on an NO x NO grid around the
+// estimate, as kernr * in * kernc (the product with kernr first)
+void DftRegistration::Refine(const Complex* buf1ft, const Complex* buf2ft, DftRegOutput& out)
+{
+  int const m = Rows(), n = Cols();
+  double const us = usfac_;
+  out.row_shift = Round(out.row_shift * us) / us;
+  out.col_shift = Round(out.col_shift * us) / us;
+  int const no = (int) std::ceil(us * 1.5);
+  double const dftshift = std::floor(std::ceil(us * 1.5) / 2.0);
+  double const roff = dftshift - out.row_shift * us;
+  double const coff = dftshift - out.col_shift * us;
+
+  double const ar = (-2.0 * PI) / (m * us), ac = (-2.0 * PI) / (n * us);
+  std::vector<Complex> kernr((std::size_t) no * m), kernc((std::size_t) n * no);
+  for (int r = 0; r < m; ++r)
+    for (int p = 0; p < no; ++p)
+    {
+      double const t = (ar * (p - roff)) * BinFrequency(r, m);
+      kernr[p + (std::size_t) r * no] = Complex(std::cos(t), std::sin(t));
+    }
+  for (int q = 0; q < no; ++q)
+    for (int c = 0; c < n; ++c)
+    {
+      double const t = (ac * BinFrequency(c, n)) * (q - coff);
+      kernc[c + (std::size_t) q * n] = Complex(std::cos(t), std::sin(t));
+    }
+
+  // T = kernr * (buf2ft .* conj(buf1ft)), NO x N
+  std::vector<Complex> tmp((std::size_t) no * n);
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < n; ++c)
+  {
+    std::size_t const o = (std::size_t) c * m;
+    Complex* t = &tmp[(std::size_t) c * no];
+    for (int r = 0; r < m; ++r)
+    {
+      Complex const v = buf2ft[o + r] * std::conj(buf1ft[o + r]);
+      const Complex* k = &kernr[(std::size_t) r * no];
+      for (int p = 0; p < no; ++p) t[p] += k[p] * v;
+    }
+  }
+  double const scale = (double) m * n * us * us;
+  std::vector<Complex> cc((std::size_t) no * no);
+  for (int q = 0; q < no; ++q)
+    for (int p = 0; p < no; ++p)
+    {
+      Complex s;
+      for (int c = 0; c < n; ++c) s += tmp[p + (std::size_t) c * no] * kernc[c + (std::size_t) q * n];
+      cc[p + (std::size_t) q * no] = std::conj(s) / scale;
+    }
+
+  int rloc, cloc;
+  Peak(&cc[0], no, no, rloc, cloc);
+  Finish(cc[rloc + (std::size_t) cloc * no],
+         CrossSum(buf1ft, buf1ft, m, n).real() / scale, CrossSum(buf2ft, buf2ft, m, n).real() / scale, out);
+  out.row_shift += (rloc - dftshift) / us;
+  out.col_shift += (cloc - dftshift) / us;
+}
+//-------------------------------------------------------------------------
+
+DftSpectrumCache::DftSpectrumCache(std::size_t capacity)
+  : capacity_(capacity > 1 ? capacity : 2), hits_(0), misses_(0)
+{
+}
+//-------------------------------------------------------------------------
+
+const std::vector<Complex>& DftSpectrumCache::Spectrum(DftRegistration& reg, const Image& im)
+{
+  unsigned long long const h = HashImage(im);
+  std::pair<Index::iterator, Index::iterator> const range = index_.equal_range(h);
+  for (Index::iterator i = range.first; i != range.second; ++i)
+    if (SameImage(i->second->image, im))
+    {
+      ++hits_;
+      METRIX_TRACE_COUNT("register/spectrum cache hits", 1);
+      entries_.splice(entries_.begin(), entries_, i->second);
+      return entries_.front().ft;
+    }
+
+  ++misses_;
+  METRIX_TRACE_COUNT("register/spectrum cache misses", 1);
+  entries_.push_front(Entry());
+  Entry& e = entries_.front();
+  e.hash = h;
+  e.image = im;
+  try
+  {
+    reg.Spectrum(im, e.ft);
+  }
+  catch (...)
+  {
+    entries_.pop_front();
+    throw;
+  }
+  index_.insert(std::make_pair(h, entries_.begin()));
+  if (entries_.size() > capacity_)
+  {
+    Entries::iterator const last = --entries_.end();
+    std::pair<Index::iterator, Index::iterator> const old = index_.equal_range(last->hash);
+    for (Index::iterator i = old.first; i != old.second; ++i)
+      if (i->second == last)
+      {
+        index_.erase(i);
+        break;
+      }
+    entries_.erase(last);
+  }
+  return entries_.front().ft;
+}
+//-------------------------------------------------------------------------
+
+void DftSpectrumCache::Clear()
+{
+  index_.clear();
+  entries_.clear();
+}
+//-------------------------------------------------------------------------
+
+DftRegOutput DftRegister(const Image& ref, const Image& mov, int usfac)
+{
+  if (ref.Rows() != mov.Rows() || ref.Cols() != mov.Cols())
+    throw std::runtime_error("DftRegister: images differ in size");
+  DftRegistration reg(ref.Rows(), ref.Cols(), usfac);
+  std::vector<Complex> f1, f2;
+  reg.Spectrum(ref, f1);
+  reg.Spectrum(mov, f2);
+  return reg.Register(&f1[0], &f2[0]);
+}
+
+} // namespace metrix
+//=========================================================================
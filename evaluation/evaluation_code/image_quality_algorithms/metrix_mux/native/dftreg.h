@@ -0,0 +1,116 @@
+//=========================================================================
+// dftreg.h
+//
+// Sub-pixel image registration by cross-correlation, as
+// dftregistration.m (evaluation_code; Guizar-Sicairos, Thurman and
+// Fienup, Opt. Lett. 33, 2008): the peak of the inverse FFT of the
+// cross-power spectrum, at 2x upsampling for USFAC > 1, refined by a
+// matrix-multiply DFT (dftups) in a 1.5 pixel neighbourhood for
+// USFAC > 2.  USFAC 0 gives only the error and phase at zero shift.
+//
+// A DftRegistration is a plan for one image size and USFAC: the FFT
+// plans (the 2x upsampled inverse skips the rows that are zero) and
+// buffers.  Registration takes spectra, as dftregistration does, so
+// the spectrum of an image shared by many pairs (the deblurred image
+// against each ground-truth frame) is computed once; DftSpectrumCache
+// keeps recent ones keyed by image hash.
+//=========================================================================
+#ifndef metrix_dftregH
+#define metrix_dftregH
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "fft.h"
+#include "image.h"
+
+namespace metrix {
+
+// dftregistration's OUTPUT: [error, diffphase, row_shift, col_shift]
+// (the shifts are 0 for USFAC 0)
+struct DftRegOutput
+{
+  double error;       // translation-invariant normalized RMS error
+  double diffphase;   // global phase difference
+  double row_shift;   // shift of the registered image, in pixels
+  double col_shift;
+};
+
+class DftRegistration
+{
+public:
+  // Throws std::runtime_error if USFAC is negative or the FFT plans
+  // cannot be made.
+  DftRegistration(int rows, int cols, int usfac = 1);
+  ~DftRegistration();
+
+  int Rows() const { return fft_.Rows(); }
+  int Cols() const { return fft_.Cols(); }
+  int Upsampling() const { return usfac_; }
+
+  // fft2(IM) into FT (ROWS*COLS, column-major); throws
+  // std::runtime_error unless IM is ROWS x COLS.
+  void Spectrum(const Image& im, std::vector<Complex>& ft);
+
+  // dftregistration(BUF1FT, BUF2FT, USFAC): registers the image of
+  // BUF2FT to the reference of BUF1FT (both ROWS*COLS spectra, DC
+  // first).  Not thread-safe: the plan holds the FFT scratch.
+  DftRegOutput Register(const Complex* buf1ft, const Complex* buf2ft);
+
+private:
+  DftRegistration(const DftRegistration&);
+  DftRegistration& operator=(const DftRegistration&);
+
+  // refinement by the matrix-multiply DFT around the 2x estimate
+  void Refine(const Complex* buf1ft, const Complex* buf2ft, DftRegOutput& out);
+
+  Fft2d fft_;
+  Fft2d* up_;                    // 2*ROWS x 2*COLS, for USFAC > 1
+  int usfac_;
+  std::vector<Complex> work_;    // cross-power spectrum / correlation
+};
+//-------------------------------------------------------------------------
+
+// The spectra of up to CAPACITY images, least recently used dropped
+// first.  A hit is checked against the stored image, so a hash
+// collision costs time, never a wrong spectrum.  Not thread-safe.
+class DftSpectrumCache
+{
+public:
+  // CAPACITY is at least 2, so that the spectra of a pair can be
+  // looked up one after the other
+  explicit DftSpectrumCache(std::size_t capacity = 4);
+
+  // fft2(IM), computed with REG unless cached; valid until CAPACITY-1
+  // other images have been looked up, or Clear()
+  const std::vector<Complex>& Spectrum(DftRegistration& reg, const Image& im);
+  void Clear();
+
+  std::size_t Hits() const { return hits_; }
+  std::size_t Misses() const { return misses_; }
+
+private:
+  struct Entry
+  {
+    unsigned long long hash;
+    Image image;
+    std::vector<Complex> ft;
+  };
+  typedef std::list<Entry> Entries;   // most recently used first
+  typedef std::multimap<unsigned long long, Entries::iterator> Index;
+
+  std::size_t capacity_;
+  Entries entries_;
+  Index index_;
+  std::size_t hits_, misses_;
+};
+//-------------------------------------------------------------------------
+
+// dftregistration(fft2(REF), fft2(MOV), USFAC)
+DftRegOutput DftRegister(const Image& ref, const Image& mov, int usfac = 1);
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,114 @@
+//=========================================================================
+// dftreg_native.cpp
+//
+// OUTPUT = dftreg_native(REF, IMG, USFAC)
+// dftreg_native('clear')
+//
+// Matlab interface to the native registration engine (dftreg.h):
+// dftregistration(fft2(REF), fft2(IMG), USFAC), i.e. [error,
+// diffphase, row_shift, col_shift] ([error, diffphase] for USFAC 0).
+// REF and IMG are real 2D matrices of the same size (double, single or
+// uint8); REF may be a cell array of N such images, all registered
+// against IMG, for an N-row OUTPUT.  USFAC defaults to 1.
+//
+// The plan for the last size and USFAC and the spectra of the last few
+// images are kept between calls, so registering one image against many
+// references (eval_image.m's deblurred image against each ground-truth
+// frame) transforms it once.  dftreg_native('clear') frees them.  Built
+// by metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+#include <vector>
+
+#include "dftreg.h"
+#include "mexutil.h"
+
+namespace {
+
+const std::size_t CACHE_CAPACITY = 4;
+
+metrix::DftRegistration* plan = 0;
+metrix::DftSpectrumCache* cache = 0;
+
+void FreePlan()
+{
+  delete cache;
+  cache = 0;
+  delete plan;
+  plan = 0;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs == 1 && mxIsChar(prhs[0]))
+  {
+    FreePlan();
+    return;
+  }
+  if (nrhs < 2 || nrhs > 3) mexErrMsgIdAndTxt("metrix:dftreg_native", "requires 2 or 3 arguments.");
+  if (nlhs > 1) mexErrMsgIdAndTxt("metrix:dftreg_native", "returns 1 value.");
+  int usfac = 1;
+  if (nrhs == 3)
+  {
+    if (!mxIsNumeric(prhs[2]) || mxGetNumberOfElements(prhs[2]) != 1 ||
+        mxGetScalar(prhs[2]) < 0 || mxGetScalar(prhs[2]) != (int) mxGetScalar(prhs[2]))
+      mexErrMsgIdAndTxt("metrix:dftreg_native", "USFAC must be a nonnegative integer.");
+    usfac = (int) mxGetScalar(prhs[2]);
+  }
+  bool const batch = mxIsCell(prhs[0]);
+  std::size_t const n = batch ? mxGetNumberOfElements(prhs[0]) : 1;
+
+  std::vector<metrix::DftRegOutput> out(n);
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      metrix::Image const img = metrix::ImageArg(prhs[1], "IMG");
+      if (!plan || plan->Rows() != img.Rows() || plan->Cols() != img.Cols() || plan->Upsampling() != usfac)
+      {
+        if (!plan) mexAtExit(FreePlan);
+        FreePlan();
+        plan = new metrix::DftRegistration(img.Rows(), img.Cols(), usfac);
+        cache = new metrix::DftSpectrumCache(CACHE_CAPACITY);
+      }
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        const mxArray* a = batch ? mxGetCell(prhs[0], i) : prhs[0];
+        if (!a) throw std::runtime_error("empty cell in REF.");
+        metrix::Image const ref = metrix::ImageArg(a, "REF");
+        if (ref.Rows() != img.Rows() || ref.Cols() != img.Cols())
+          throw std::runtime_error("REF and IMG differ in size.");
+        // the reference's spectrum first: IMG's is then the most
+        // recently used, and stays cached across the batch
+        const std::vector<metrix::Complex>& buf1ft = cache->Spectrum(*plan, ref);
+        const std::vector<metrix::Complex>& buf2ft = cache->Spectrum(*plan, img);
+        out[i] = plan->Register(&buf1ft[0], &buf2ft[0]);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:dftreg_native", "%s", msg);
+
+  std::size_t const cols = (usfac == 0) ? 2 : 4;
+  plhs[0] = mxCreateDoubleMatrix(n, cols, mxREAL);
+  double* o = mxGetPr(plhs[0]);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    o[i] = out[i].error;
+    o[i + n] = out[i].diffphase;
+    if (cols == 4)
+    {
+      o[i + 2 * n] = out[i].row_shift;
+      o[i + 3 * n] = out[i].col_shift;
+    }
+  }
+}
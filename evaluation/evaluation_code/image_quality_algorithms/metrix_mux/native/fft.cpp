@@ -0,0 +1,130 @@
+//=========================================================================
+// fft.cpp
+//=========================================================================
+#include "fft.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+const int ROW_BLOCK = 8;   // rows gathered per pass across the columns
+
+inline double* Interleaved(Complex* p) { return reinterpret_cast<double*>(p); }
+
+} // namespace
+//-------------------------------------------------------------------------
+
+Fft2d::Fft2d(int rows, int cols)
+  : rows_(rows), cols_(cols), threads_(MaxThreads())
+{
+  if (rows < 1 || cols < 1) throw std::runtime_error("Fft2d: empty array");
+  bool ok = true;
+  for (int t = 0; t < threads_; ++t)
+  {
+    row_plans_.push_back(fft_plan_create(cols));
+    col_plans_.push_back(fft_plan_create(rows));
+    ok = ok && row_plans_.back() && col_plans_.back();
+  }
+  if (!ok)
+  {
+    Release();
+    throw std::runtime_error("Fft2d: out of memory");
+  }
+}
+//-------------------------------------------------------------------------
+
+Fft2d::~Fft2d()
+{
+  Release();
+}
+//-------------------------------------------------------------------------
+
+void Fft2d::Release()
+{
+  for (std::size_t t = 0; t < row_plans_.size(); ++t) fft_plan_destroy(row_plans_[t]);
+  for (std::size_t t = 0; t < col_plans_.size(); ++t) fft_plan_destroy(col_plans_[t]);
+  row_plans_.clear();
+  col_plans_.clear();
+}
+//-------------------------------------------------------------------------
+
+void Fft2d::Forward(Complex* data)
+{
+  Transform(data, false, rows_);
+}
+//-------------------------------------------------------------------------
+
+void Fft2d::Inverse(Complex* data)
+{
+  Transform(data, true, rows_);
+}
+//-------------------------------------------------------------------------
+
+void Fft2d::Inverse(Complex* data, int max_row_freq)
+{
+  Transform(data, true, max_row_freq);
+}
+//-------------------------------------------------------------------------
+
+// The inverse is conj(fft2(conj(DATA))) / (ROWS*COLS).  Rows are
+// transformed first (gathered ROW_BLOCK at a time, so each cache line
+// of a column is read once per block), so that zero rows can be
+// skipped (and are cleared); then the columns, in place.
+void Fft2d::Transform(Complex* data, bool inverse, int max_row_freq)
+{
+  int const rows = rows_, cols = cols_;
+  std::vector<int> active;
+  for (int r = 0; r < rows; ++r)
+  {
+    int const f = BinFrequency(r, rows);
+    if (f <= max_row_freq && -f <= max_row_freq) active.push_back(r);
+  }
+  int const nactive = (int) active.size();
+  double const scale = 1.0 / ((double) rows * cols);
+
+  OMP(omp parallel num_threads(threads_))
+  {
+    int const t = ThreadNum();
+    std::vector<Complex> block((std::size_t) ROW_BLOCK * cols);
+
+    OMP(omp for schedule(static))
+    for (int i0 = 0; i0 < nactive; i0 += ROW_BLOCK)
+    {
+      int const n = std::min(ROW_BLOCK, nactive - i0);
+      for (int c = 0; c < cols; ++c)
+      {
+        const Complex* col = data + (std::size_t) c * rows;
+        for (int b = 0; b < n; ++b)
+        {
+          Complex const v = col[active[i0 + b]];
+          block[(std::size_t) b * cols + c] = inverse ? std::conj(v) : v;
+        }
+      }
+      for (int b = 0; b < n; ++b)
+        fft_1d(row_plans_[t], Interleaved(&block[(std::size_t) b * cols]));
+      for (int c = 0; c < cols; ++c)
+      {
+        Complex* col = data + (std::size_t) c * rows;
+        for (int b = 0; b < n; ++b) col[active[i0 + b]] = block[(std::size_t) b * cols + c];
+      }
+    }
+
+    OMP(omp for schedule(static))
+    for (int c = 0; c < cols; ++c)
+    {
+      Complex* col = data + (std::size_t) c * rows;
+      if (nactive < rows)
+        std::fill(col + (nactive + 1) / 2, col + rows - nactive / 2, Complex());
+      fft_1d(col_plans_[t], Interleaved(col));
+      if (inverse)
+        for (int r = 0; r < rows; ++r) col[r] = std::conj(col[r]) * scale;
+    }
+  }
+}
+
+} // namespace metrix
+//=========================================================================
@@ -0,0 +1,67 @@
+//=========================================================================
+// fft.h
+//
+// 2D discrete Fourier transforms of column-major complex arrays (as
+// Matlab's fft2/ifft2), on the mixed-radix FFT of the matlabPyrTools
+// kernels (fftconv.c).  An Fft2d is a plan for one size: the 1D plans
+// (twiddles and scratch) of each thread are made once and reused by
+// every transform.
+//=========================================================================
+#ifndef metrix_fftH
+#define metrix_fftH
+
+#include <complex>
+#include <vector>
+
+extern "C" {
+#include "convolve.h"
+}
+
+namespace metrix {
+
+typedef std::complex<double> Complex;
+
+// Frequency of DFT bin K of N: K for K < N/2, K - N above.
+inline int BinFrequency(int k, int n) { return (2 * k < n) ? k : k - n; }
+
+class Fft2d
+{
+public:
+  // Throws std::runtime_error if the plans cannot be allocated.
+  Fft2d(int rows, int cols);
+  ~Fft2d();
+
+  int Rows() const { return rows_; }
+  int Cols() const { return cols_; }
+
+  // fft2(DATA), in place (ROWS x COLS, column-major)
+  void Forward(Complex* data);
+
+  // ifft2(DATA), in place (scaled by 1/(ROWS*COLS))
+  void Inverse(Complex* data);
+
+  // ifft2(DATA) with every row whose frequency exceeds MAX_ROW_FREQ in
+  // magnitude taken as zero (those rows need not be set): only the
+  // other rows are transformed across the columns.  Band-limited
+  // inverses (filter banks) cost little more than the transforms down
+  // the columns.
+  void Inverse(Complex* data, int max_row_freq);
+
+  // Not thread-safe: the scratch of each thread is in the plan.
+
+private:
+  Fft2d(const Fft2d&);
+  Fft2d& operator=(const Fft2d&);
+
+  void Transform(Complex* data, bool inverse, int max_row_freq);
+  void Release();
+
+  int rows_, cols_;
+  int threads_;
+  std::vector<FFT_PLAN*> row_plans_;   // length COLS, one per thread
+  std::vector<FFT_PLAN*> col_plans_;   // length ROWS
+};
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,193 @@
+//=========================================================================
+// frame.cpp
+//=========================================================================
+#include "frame.h"
+#include "trace.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+extern "C" {
+#include <jpeglib.h>
+}
+#include <png.h>
+
+namespace metrix {
+
+namespace {
+
+const std::size_t MESSAGE_LENGTH = 200;
+
+// Closes the file however the decoder returns
+class FileCloser
+{
+public:
+  explicit FileCloser(std::FILE* fp) : fp_(fp) {}
+  ~FileCloser() { if (fp_) std::fclose(fp_); }
+
+private:
+  FileCloser(const FileCloser&);
+  FileCloser& operator=(const FileCloser&);
+
+  std::FILE* fp_;
+};
+
+// Interleaved scanline R (NC samples per pixel) into the planes of F
+void Scatter(const unsigned char* line, int r, int nc, Frame& f)
+{
+  int const rows = f.Rows(), cols = f.Cols();
+  for (int k = 0; k < f.Channels(); ++k)
+  {
+    unsigned char* p = f.Plane(k) + r;
+    const unsigned char* s = line + k;
+    for (int c = 0; c < cols; ++c) p[(std::size_t) c * rows] = s[(std::size_t) c * nc];
+  }
+}
+//-------------------------------------------------------------------------
+
+// libjpeg and libpng report errors by longjmp: each decoder sets its
+// jump point itself and returns false with the message.  Whatever
+// owns memory (the frame, PNG buffers) is the caller's, so a jump
+// skips no destructor.
+
+struct JpegError
+{
+  jpeg_error_mgr mgr;
+  std::jmp_buf jump;
+  char message[JMSG_LENGTH_MAX];
+};
+
+void JpegErrorExit(j_common_ptr cinfo)
+{
+  JpegError* e = (JpegError*) cinfo->err;
+  (*cinfo->err->format_message)(cinfo, e->message);
+  std::longjmp(e->jump, 1);
+}
+
+bool DecodeJpeg(std::FILE* fp, Frame& f, JpegError& err)
+{
+  jpeg_decompress_struct cinfo;
+  cinfo.err = jpeg_std_error(&err.mgr);
+  err.mgr.error_exit = JpegErrorExit;
+  if (setjmp(err.jump))
+  {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  jpeg_create_decompress(&cinfo);
+  jpeg_stdio_src(&cinfo, fp);
+  jpeg_read_header(&cinfo, TRUE);
+  if (cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK)
+  {
+    std::strcpy(err.message, "CMYK JPEGs are not supported");
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  jpeg_start_decompress(&cinfo);
+  int const nc = cinfo.output_components;
+  f = Frame(cinfo.output_height, cinfo.output_width, nc);
+  JSAMPARRAY line = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE,
+                                               cinfo.output_width * nc, 1);
+  while (cinfo.output_scanline < cinfo.output_height)
+  {
+    int const r = cinfo.output_scanline;
+    jpeg_read_scanlines(&cinfo, line, 1);
+    Scatter(line[0], r, nc, f);
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  return true;
+}
+//-------------------------------------------------------------------------
+
+void PngError(png_structp png, png_const_charp what)
+{
+  std::snprintf((char*) png_get_error_ptr(png), MESSAGE_LENGTH, "%s", what);
+  png_longjmp(png, 1);
+}
+
+void PngWarning(png_structp, png_const_charp)
+{
+}
+
+bool DecodePng(std::FILE* fp, Frame& f, std::vector<unsigned char>& pixels,
+               std::vector<png_bytep>& row_pointers, char* message)
+{
+  png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, message, PngError, PngWarning);
+  png_infop info = png ? png_create_info_struct(png) : 0;
+  if (!info)
+  {
+    std::strcpy(message, "out of memory");
+    png_destroy_read_struct(&png, 0, 0);
+    return false;
+  }
+  if (setjmp(png_jmpbuf(png)))
+  {
+    png_destroy_read_struct(&png, &info, 0);
+    return false;
+  }
+  png_init_io(png, fp);
+  png_read_info(png, info);
+  int const color_type = png_get_color_type(png, info);
+  int const bit_depth = png_get_bit_depth(png, info);
+  if ((color_type & PNG_COLOR_MASK_PALETTE) || bit_depth == 16)
+  {
+    std::strcpy(message, "palette and 16-bit PNGs are not supported");
+    png_destroy_read_struct(&png, &info, 0);
+    return false;
+  }
+  if (bit_depth < 8) png_set_expand_gray_1_2_4_to_8(png);
+  if (color_type & PNG_COLOR_MASK_ALPHA) png_set_strip_alpha(png);
+  png_set_interlace_handling(png);
+  png_read_update_info(png, info);
+
+  int const rows = png_get_image_height(png, info);
+  int const cols = png_get_image_width(png, info);
+  int const nc = png_get_channels(png, info);
+  std::size_t const stride = png_get_rowbytes(png, info);
+  f = Frame(rows, cols, nc);
+  pixels.resize(stride * rows);
+  row_pointers.resize(rows);
+  for (int r = 0; r < rows; ++r) row_pointers[r] = &pixels[stride * r];
+  png_read_image(png, &row_pointers[0]);
+  png_read_end(png, 0);
+  png_destroy_read_struct(&png, &info, 0);
+  for (int r = 0; r < rows; ++r) Scatter(row_pointers[r], r, nc, f);
+  return true;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+Frame ReadFrame(const std::string& path)
+{
+  METRIX_TRACE_SCOPE("decode/ReadFrame");
+  std::FILE* fp = std::fopen(path.c_str(), "rb");
+  if (!fp) throw std::runtime_error(path + ": cannot open file");
+  FileCloser closer(fp);
+  unsigned char magic[8] = {0};
+  std::size_t const n = std::fread(magic, 1, sizeof(magic), fp);
+  std::rewind(fp);
+
+  Frame f;
+  if (n >= 3 && magic[0] == 0xFF && magic[1] == 0xD8 && magic[2] == 0xFF)
+  {
+    JpegError err;
+    if (!DecodeJpeg(fp, f, err)) throw std::runtime_error(path + ": " + err.message);
+  }
+  else if (n == 8 && png_sig_cmp(magic, 0, 8) == 0)
+  {
+    std::vector<unsigned char> pixels;
+    std::vector<png_bytep> row_pointers;
+    char message[MESSAGE_LENGTH];
+    if (!DecodePng(fp, f, pixels, row_pointers, message)) throw std::runtime_error(path + ": " + message);
+  }
+  else
+    throw std::runtime_error(path + ": unrecognized image format (JPEG and PNG are supported)");
+  return f;
+}
+
+} // namespace metrix
+//=========================================================================
@@ -0,0 +1,50 @@
+//=========================================================================
+// frame.h
+//
+// 8-bit video frames as Matlab's imread returns them: ROWS x COLS x
+// CHANNELS uint8, column-major, one plane per channel (1 for gray, 3
+// for RGB).  ReadFrame decodes the JPEG and PNG files of the DVD and
+// nah test sets with libjpeg and libpng, and is compiled into the
+// tools that need it only (metrix_eval), so that the metric engines
+// and their MEX interfaces do not depend on those libraries.
+//=========================================================================
+#ifndef metrix_frameH
+#define metrix_frameH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace metrix {
+
+class Frame
+{
+public:
+  Frame() : rows_(0), cols_(0), channels_(0) {}
+  Frame(int rows, int cols, int channels)
+    : rows_(rows), cols_(cols), channels_(channels),
+      data_((std::size_t) rows * cols * channels) {}
+
+  int Rows() const { return rows_; }
+  int Cols() const { return cols_; }
+  int Channels() const { return channels_; }
+  std::size_t Size() const { return data_.size(); }
+
+  unsigned char* Plane(int k) { return &data_[(std::size_t) k * rows_ * cols_]; }
+  const unsigned char* Plane(int k) const { return &data_[(std::size_t) k * rows_ * cols_]; }
+
+private:
+  int rows_, cols_, channels_;
+  std::vector<unsigned char> data_;
+};
+//-------------------------------------------------------------------------
+
+// Reads a gray or colour JPEG, or an 8-bit gray or RGB PNG (alpha is
+// dropped, as imread drops it when it is not asked for).  Throws
+// std::runtime_error if the file cannot be read or decoded, or is a
+// CMYK JPEG or a palette or 16-bit PNG.
+Frame ReadFrame(const std::string& path);
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,140 @@
+//=========================================================================
+// frameeval.cpp
+//=========================================================================
+#include "frameeval.h"
+#include "fused.h"
+#include "imshift.h"
+#include "trace.h"
+
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+// luminance weights of preprocess_metrix_mux.m
+const double LUMA_R = 0.29900;
+const double LUMA_G = 0.58700;
+const double LUMA_B = 0.11400;
+
+// mean(X, 3) of the CHANNELS planes of X
+Image ChannelMean(const double* x, int rows, int cols, int channels)
+{
+  Image m(rows, cols);
+  std::size_t const n = m.Size();
+  double* o = m.Data();
+  if (channels == 1)
+    for (std::size_t i = 0; i < n; ++i) o[i] = x[i];
+  else
+    for (std::size_t i = 0; i < n; ++i) o[i] = (x[i] + x[n + i] + x[2 * n + i]) / 3;
+  return m;
+}
+
+// preprocess_metrix_mux's luminance of the CHANNELS planes of X, each
+// sample multiplied by MASK
+Image MaskedLuminance(const double* x, const double* mask, int rows, int cols, int channels)
+{
+  Image y(rows, cols);
+  std::size_t const n = y.Size();
+  double* o = y.Data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    double const m = mask[i];
+    o[i] = (channels == 1) ? x[i] * m
+      : LUMA_R * (x[i] * m) + LUMA_G * (x[n + i] * m) + LUMA_B * (x[2 * n + i] * m);
+  }
+  return y;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+FrameEvaluator::FrameEvaluator(const FrameEvalOptions& opt)
+  : opt_(opt), reg_(0)
+{
+  if (opt.crop < 0) throw std::runtime_error("FrameEvaluator: negative crop");
+}
+//-------------------------------------------------------------------------
+
+FrameEvaluator::~FrameEvaluator()
+{
+  delete reg_;
+}
+//-------------------------------------------------------------------------
+
+void FrameEvaluator::Prepare(const Frame& f, std::vector<double>& planes, int& rows, int& cols) const
+{
+  bool const turn = (f.Cols() != opt_.landscape_width);
+  int const crop = opt_.crop;
+  rows = (turn ? f.Cols() : f.Rows()) - 2 * crop;
+  cols = (turn ? f.Rows() : f.Cols()) - 2 * crop;
+  if (rows < 1 || cols < 1) throw std::runtime_error("FrameEvaluator: frame smaller than the crop");
+  int const in_rows = f.Rows();
+  planes.resize((std::size_t) rows * cols * f.Channels());
+  double* o = &planes[0];
+  for (int k = 0; k < f.Channels(); ++k)
+  {
+    const unsigned char* p = f.Plane(k);
+    for (int c = 0; c < cols; ++c, o += rows)
+      if (turn)
+        for (int r = 0; r < rows; ++r) o[r] = p[(c + crop) + (std::size_t) (r + crop) * in_rows];
+      else
+      {
+        const unsigned char* s = p + (std::size_t) (c + crop) * in_rows + crop;
+        for (int r = 0; r < rows; ++r) o[r] = s[r];
+      }
+  }
+}
+//-------------------------------------------------------------------------
+
+FrameScores FrameEvaluator::Evaluate(const Frame& gt, const Frame& result)
+{
+  METRIX_TRACE_SCOPE("eval/FrameEvaluator::Evaluate");
+  int rows, cols, zrows, zcols;
+  Prepare(gt, x_, rows, cols);
+  Prepare(result, z_, zrows, zcols);
+  int const channels = gt.Channels();
+  if (zrows != rows || zcols != cols || result.Channels() != channels)
+    throw std::runtime_error("FrameEvaluator: frames differ in size");
+  if (channels != 1 && channels != 3)
+    throw std::runtime_error("FrameEvaluator: frames must be gray or RGB");
+  FrameScores s;
+
+  // scale the result's intensity to the ground truth's
+  std::size_t const n = x_.size();
+  double xz = 0.0, zz = 0.0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    xz += x_[i] * z_[i];
+    zz += z_[i] * z_[i];
+  }
+  s.scale = xz / zz;
+  for (std::size_t i = 0; i < n; ++i) z_[i] *= s.scale;
+
+  // register the channel means
+  if (!reg_ || reg_->Rows() != rows || reg_->Cols() != cols)
+  {
+    delete reg_;
+    reg_ = 0;
+    reg_ = new DftRegistration(rows, cols, 1);
+  }
+  reg_->Spectrum(ChannelMean(&x_[0], rows, cols, channels), xf_);
+  reg_->Spectrum(ChannelMean(&z_[0], rows, cols, channels), zf_);
+  DftRegOutput const reg = reg_->Register(&xf_[0], &zf_[0]);
+  s.row_shift = reg.row_shift;
+  s.col_shift = reg.col_shift;
+
+  // shift the result, and keep the ground truth where it is covered
+  shifted_.resize(n);
+  ImShift(&z_[0], rows, cols, channels, s.row_shift, s.col_shift, SHIFT_SAME, &shifted_[0]);
+  Image const mask = ImShift(Image(rows, cols, 1.0), s.row_shift, s.col_shift, SHIFT_SAME);
+
+  Image const yx = MaskedLuminance(&x_[0], mask.Data(), rows, cols, channels);
+  Image const yz = Luminance(&shifted_[0], rows, cols, channels);
+  FusedScores const f = FusedMetrics(yx, yz, METRIC_PSNR | METRIC_SSIM);
+  s.psnr = f.psnr;
+  s.ssim = f.ssim;
+  return s;
+}
+
+} // namespace metrix
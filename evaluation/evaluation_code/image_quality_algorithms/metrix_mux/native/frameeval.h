@@ -0,0 +1,71 @@
+//=========================================================================
+// frameeval.h
+//
+// The per-frame measure of evaluation.m (after Koehler et al.): both
+// frames are turned to landscape (transposed unless LANDSCAPE_WIDTH
+// wide) and cropped by CROP pixels on every side; the result Z is
+// scaled by sum(X.*Z)/sum(Z.*Z) to the intensity of the ground truth
+// X; the channel means are registered (dftregistration, USFAC 1);
+// the scaled result is shifted ('same') by the registration and X is
+// masked to the samples the shifted result covers; and PSNR and SSIM
+// (metrix_mux's, on the luminance of preprocess_metrix_mux) compare
+// the two.
+//
+// A FrameEvaluator keeps the registration plan of the last frame
+// size and its buffers, so a video costs one plan.  Evaluators are
+// independent: a worker pool uses one per thread.
+//=========================================================================
+#ifndef metrix_frameevalH
+#define metrix_frameevalH
+
+#include <vector>
+
+#include "dftreg.h"
+#include "frame.h"
+#include "image.h"
+
+namespace metrix {
+
+struct FrameEvalOptions
+{
+  int crop;              // evaluation.m's cropsize
+  int landscape_width;   // frames of any other width are transposed
+  FrameEvalOptions() : crop(16), landscape_width(1280) {}
+};
+
+struct FrameScores
+{
+  double psnr;         // dB
+  double ssim;
+  double scale;        // intensity scale of the result
+  double row_shift;    // registration shift of the result
+  double col_shift;
+};
+
+class FrameEvaluator
+{
+public:
+  explicit FrameEvaluator(const FrameEvalOptions& opt = FrameEvalOptions());
+  ~FrameEvaluator();
+
+  // Throws std::runtime_error if the frames differ in size or channels
+  // (after the landscape turn), have neither 1 nor 3 channels, or are
+  // too small once cropped.
+  FrameScores Evaluate(const Frame& gt, const Frame& result);
+
+private:
+  FrameEvaluator(const FrameEvaluator&);
+  FrameEvaluator& operator=(const FrameEvaluator&);
+
+  // double(F), turned to landscape and cropped, into planes
+  void Prepare(const Frame& f, std::vector<double>& planes, int& rows, int& cols) const;
+
+  FrameEvalOptions opt_;
+  DftRegistration* reg_;
+  std::vector<double> x_, z_, shifted_;
+  std::vector<Complex> xf_, zf_;
+};
+
+} // namespace metrix
+//=========================================================================
+#endif
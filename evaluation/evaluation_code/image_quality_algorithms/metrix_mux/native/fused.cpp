@@ -0,0 +1,156 @@
+//=========================================================================
+// fused.cpp
+//=========================================================================
+#include "fused.h"
+#include "ifc.h"
+#include "mssim.h"
+#include "trace.h"
+#include "vif.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+// luminance weights of preprocess_metrix_mux.m
+const double LUMA_R = 0.29900;
+const double LUMA_G = 0.58700;
+const double LUMA_B = 0.11400;
+
+// preprocess_metrix_mux's decomposition sizes
+const int PAD_MULTIPLE = 32;
+const int PAD_MINIMUM = 128;
+
+int PaddedSize(int n)
+{
+  return std::max(PAD_MINIMUM, PAD_MULTIPLE * ((n + PAD_MULTIPLE - 1) / PAD_MULTIPLE));
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+unsigned MetricFlag(const std::string& name)
+{
+  std::string n(name);
+  for (std::size_t i = 0; i < n.size(); ++i) n[i] = (char) std::toupper((unsigned char) n[i]);
+  if (n == "MSE") return METRIC_MSE;
+  if (n == "PSNR") return METRIC_PSNR;
+  if (n == "SSIM") return METRIC_SSIM;
+  if (n == "MSSIM") return METRIC_MSSIM;
+  if (n == "VIF") return METRIC_VIF;
+  if (n == "IFC") return METRIC_IFC;
+  throw std::runtime_error("unknown metric '" + name + "' (MSE, PSNR, SSIM, MSSIM, VIF or IFC)");
+}
+//-------------------------------------------------------------------------
+
+Image Luminance(const double* x, int rows, int cols, int channels)
+{
+  if (channels != 1 && channels != 3)
+    throw std::runtime_error("Luminance: images must be gray or RGB");
+  Image y(rows, cols);
+  std::size_t const n = y.Size();
+  double* o = y.Data();
+  if (channels == 1)
+    for (std::size_t i = 0; i < n; ++i) o[i] = x[i];
+  else
+    for (std::size_t i = 0; i < n; ++i)
+      o[i] = LUMA_R * x[i] + LUMA_G * x[n + i] + LUMA_B * x[2 * n + i];
+  return y;
+}
+//-------------------------------------------------------------------------
+
+// The Matlab code, 0-based: edge columns mirrored without the edge,
+// then edge rows, then each corner filled with the sample next to the
+// image's corner.
+Image PadForDecomposition(const Image& im)
+{
+  int const H = im.Rows(), W = im.Cols();
+  int const HP = PaddedSize(H), WP = PaddedSize(W);
+  if (HP == H && WP == W) return im;
+  // round((HP - H) / 2), halves rounded up
+  int const top = (HP - H + 1) / 2, left = (WP - W + 1) / 2;
+  Image p(HP, WP);
+  const double* in = im.Data();
+  double* out = p.Data();
+  for (int c = 0; c < WP; ++c)
+  {
+    double* o = out + (std::size_t) c * HP;
+    int src_col;
+    if (c < left) src_col = std::min(W - 1, left - c);
+    else if (c < left + W) src_col = c - left;
+    else src_col = W - 1 - std::min(W - 1, c - left - W + 1);
+    bool const edge_col = (c < left || c >= left + W);
+    int const corner_col = (c < left) ? std::min(W, 2) - 1 : std::max(W - 1, 1) - 1;
+    for (int r = 0; r < HP; ++r)
+    {
+      int src_row;
+      if (r < top) src_row = std::min(H - 1, top - r);
+      else if (r < top + H) src_row = r - top;
+      else src_row = H - 1 - std::min(H - 1, r - top - H + 1);
+      bool const edge_row = (r < top || r >= top + H);
+      if (edge_row && edge_col)
+      {
+        int const corner_row = (r < top) ? std::min(H, 2) - 1 : std::max(H - 1, 1) - 1;
+        o[r] = in[corner_row + (std::size_t) corner_col * H];
+      }
+      else
+        o[r] = in[src_row + (std::size_t) src_col * H];
+    }
+  }
+  return p;
+}
+//-------------------------------------------------------------------------
+
+FusedScores FusedMetrics(const Image& ref, const Image& dist, unsigned metrics)
+{
+  METRIX_TRACE_SCOPE("eval/FusedMetrics");
+  if (ref.Rows() != dist.Rows() || ref.Cols() != dist.Cols())
+    throw std::runtime_error("FusedMetrics: images differ in size");
+  double const nan = std::numeric_limits<double>::quiet_NaN();
+  FusedScores s = {nan, nan, nan, nan, nan, nan};
+
+  if (metrics & (METRIC_MSE | METRIC_PSNR))
+  {
+    double se = 0.0;
+    for (std::size_t i = 0; i < ref.Size(); ++i)
+    {
+      double const d = ref.Data()[i] - dist.Data()[i];
+      se += d * d;
+    }
+    double const mse = se / ref.Size();
+    if (metrics & METRIC_MSE) s.mse = mse;
+    if (metrics & METRIC_PSNR) s.psnr = 10 * std::log10(255.0 * 255.0 / mse);
+  }
+
+  if (metrics & METRIC_MSSIM)
+  {
+    MssimScores const m = Mssim(ref, dist, MssimOptions(), (metrics & METRIC_SSIM) ? &s.ssim : 0);
+    s.mssim = m.mssim;
+  }
+  else if (metrics & METRIC_SSIM)
+    s.ssim = Ssim(ref, dist);
+
+  if (metrics & (METRIC_VIF | METRIC_IFC))
+  {
+    Image const pref = PadForDecomposition(ref);
+    Image const pdist = PadForDecomposition(dist);
+    if ((metrics & METRIC_VIF) && (metrics & METRIC_IFC))
+    {
+      InformationScores const i = VifIfc(pref, pdist);
+      s.vif = i.vif;
+      s.ifc = i.ifc;
+    }
+    else if (metrics & METRIC_VIF)
+      s.vif = Vif(pref, pdist);
+    else
+      s.ifc = Ifc(pref, pdist);
+  }
+  return s;
+}
+
+} // namespace metrix
@@ -0,0 +1,60 @@
+//=========================================================================
+// fused.h
+//
+// Several metrix_mux scores of one image pair at the cost of the
+// costliest: the pair is preprocessed once (preprocess_metrix_mux's
+// luminance, and its symmetric extension for the pyramid metrics only)
+// and the metrics share their intermediates.  MSE and PSNR come from one
+// pass; SSIM from the windowed moments of MS-SSIM's first scale when
+// both are asked for (mssim.h); VIF and IFC from one pair of steerable
+// pyramids and one set of GSM statistics (ifc.h).
+//=========================================================================
+#ifndef metrix_fusedH
+#define metrix_fusedH
+
+#include <string>
+
+#include "image.h"
+
+namespace metrix {
+
+// metrix_mux indicators, as flags
+enum
+{
+  METRIC_MSE = 1,
+  METRIC_PSNR = 2,
+  METRIC_SSIM = 4,
+  METRIC_MSSIM = 8,
+  METRIC_VIF = 16,
+  METRIC_IFC = 32
+};
+
+// The flag of metrix_mux's indicator NAME ('MSE', 'PSNR', 'SSIM',
+// 'MSSIM', 'VIF' or 'IFC', in any case).  Throws std::runtime_error
+// for any other.
+unsigned MetricFlag(const std::string& name);
+
+// Scores of the metrics asked for; the others are NaN.
+struct FusedScores
+{
+  double mse, psnr, ssim, mssim, vif, ifc;
+};
+
+// preprocess_metrix_mux's luminance of the CHANNELS (1 or 3) planes
+// of X, column-major.  Throws std::runtime_error for other channels.
+Image Luminance(const double* x, int rows, int cols, int channels);
+
+// preprocess_metrix_mux's symmetric extension for the decompositions
+// of VIF, IFC and VSNR: IM centred in rows and columns rounded up to
+// multiples of 32, and at least 128 (IM itself if it fits already).
+Image PadForDecomposition(const Image& im);
+
+// The METRICS (METRIC_ flags) of the luminance images REF and DIST,
+// as metrix_mux(REF, DIST, indicator) gives each of them.  Throws
+// std::runtime_error if the images differ in size or are too small
+// for a metric asked for.
+FusedScores FusedMetrics(const Image& ref, const Image& dist, unsigned metrics);
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,109 @@
+//=========================================================================
+// fused_native.cpp
+//
+// V = fused_native(REF, QUERY, METRICS)
+//
+// Matlab interface to the fused metric engine (fused.h): V(k) is
+// metrix_mux(REF, QUERY, METRICS{k}) for each of METRICS ('MSE',
+// 'PSNR', 'SSIM', 'MSSIM', 'VIF' or 'IFC'; a string for one), with
+// preprocess_metrix_mux's luminance and padding done once and the
+// intermediates shared across the metrics.  REF and QUERY are real 2D
+// or ROWS x COLS x 3 arrays of the same size (double, single or
+// uint8).  Used by eval_image.m; built by metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "fused.h"
+#include "mexutil.h"
+
+namespace {
+
+// preprocess_metrix_mux's luminance of a 2D or ROWS x COLS x 3 array
+metrix::Image LuminanceArg(const mxArray* arg, const char* name)
+{
+  if (mxIsComplex(arg) || mxIsSparse(arg) || mxGetNumberOfDimensions(arg) > 3 ||
+      !(mxIsDouble(arg) || mxIsSingle(arg) || mxIsUint8(arg)))
+    throw std::runtime_error(std::string(name) +
+                             " must be a real 2D or 3D double, single or uint8 array.");
+  const mwSize* dims = mxGetDimensions(arg);
+  int const rows = (int) dims[0], cols = (int) dims[1];
+  int const channels = (mxGetNumberOfDimensions(arg) == 3) ? (int) dims[2] : 1;
+  if (mxIsDouble(arg)) return metrix::Luminance(mxGetPr(arg), rows, cols, channels);
+  std::size_t const n = mxGetNumberOfElements(arg);
+  std::vector<double> x(n);
+  if (mxIsSingle(arg))
+  {
+    const float* src = (const float*) mxGetData(arg);
+    for (std::size_t i = 0; i < n; ++i) x[i] = src[i];
+  }
+  else
+  {
+    const unsigned char* src = (const unsigned char*) mxGetData(arg);
+    for (std::size_t i = 0; i < n; ++i) x[i] = src[i];
+  }
+  return metrix::Luminance(n ? &x[0] : 0, rows, cols, channels);
+}
+
+std::string StringArg(const mxArray* arg)
+{
+  char buf[16];
+  if (!arg || !mxIsChar(arg) || mxGetString(arg, buf, sizeof(buf)) != 0)
+    throw std::runtime_error("METRICS must be a metric name or a cell array of them.");
+  return buf;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs != 3) mexErrMsgIdAndTxt("metrix:fused_native", "requires 3 arguments.");
+  if (nlhs > 1) mexErrMsgIdAndTxt("metrix:fused_native", "returns 1 value.");
+
+  std::vector<double> v;
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      std::vector<unsigned> flags;
+      if (mxIsCell(prhs[2]))
+        for (std::size_t k = 0; k < mxGetNumberOfElements(prhs[2]); ++k)
+          flags.push_back(metrix::MetricFlag(StringArg(mxGetCell(prhs[2], k))));
+      else
+        flags.push_back(metrix::MetricFlag(StringArg(prhs[2])));
+      unsigned metrics = 0;
+      for (std::size_t k = 0; k < flags.size(); ++k) metrics |= flags[k];
+
+      metrix::Image const ref = LuminanceArg(prhs[0], "REF");
+      metrix::Image const query = LuminanceArg(prhs[1], "QUERY");
+      if (mxGetNumberOfDimensions(prhs[0]) != mxGetNumberOfDimensions(prhs[1]) ||
+          ref.Rows() != query.Rows() || ref.Cols() != query.Cols())
+        throw std::runtime_error("REF and QUERY differ in size.");
+      metrix::FusedScores const s = metrix::FusedMetrics(ref, query, metrics);
+      for (std::size_t k = 0; k < flags.size(); ++k)
+        switch (flags[k])
+        {
+        case metrix::METRIC_MSE: v.push_back(s.mse); break;
+        case metrix::METRIC_PSNR: v.push_back(s.psnr); break;
+        case metrix::METRIC_SSIM: v.push_back(s.ssim); break;
+        case metrix::METRIC_MSSIM: v.push_back(s.mssim); break;
+        case metrix::METRIC_VIF: v.push_back(s.vif); break;
+        default: v.push_back(s.ifc); break;
+        }
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:fused_native", "%s", msg);
+
+  plhs[0] = mxCreateDoubleMatrix(1, v.size(), mxREAL);
+  double* o = mxGetPr(plhs[0]);
+  for (std::size_t k = 0; k < v.size(); ++k) o[k] = v[k];
+}
@@ -0,0 +1,301 @@
+//=========================================================================
+// gsm.cpp
+//=========================================================================
+#include "gsm.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+const int LANES = 4;          // independent partial sums, so the dot products vectorize
+const double TOL = 1e-15;     // vifsub_est_M.m's tolerance for zero variance
+
+// sum over i < N of (A[i]-MA)*(B[i]-MB)
+double CenteredDot(const double* a, const double* b, int n, double ma, double mb)
+{
+  double s[LANES] = {0.0, 0.0, 0.0, 0.0};
+  int i = 0;
+  for (; i + LANES <= n; i += LANES)
+    for (int l = 0; l < LANES; ++l)
+      s[l] += (a[i + l] - ma) * (b[i + l] - mb);
+  for (; i < n; ++i) s[0] += (a[i] - ma) * (b[i] - mb);
+  return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+// Mean and covariance of all (overlapping) MxM blocks of the
+// H x W top-left part of Y (row stride STRIDE), each block read as a
+// column-major vector: the MCU and CU of refparams_vecgsm.m.
+void BlockCovariance(const double* y, int stride, int h, int w, int M,
+                     std::vector<double>& mean, std::vector<double>& cov)
+{
+  int const n = M * M;
+  int const nr = h - M + 1;
+  int const nc = w - M + 1;
+  double const count = (double) nr * nc;
+
+  mean.assign(n, 0.0);
+  cov.assign(n * n, 0.0);
+  for (int p = 0; p < n; ++p)
+  {
+    const double* yp = y + (std::size_t) (p / M) * stride + p % M;
+    double s = 0.0;
+    for (int c = 0; c < nc; ++c)
+      for (int r = 0; r < nr; ++r) s += yp[(std::size_t) c * stride + r];
+    mean[p] = s / count;
+  }
+  for (int p = 0; p < n; ++p)
+    for (int q = p; q < n; ++q)
+    {
+      const double* yp = y + (std::size_t) (p / M) * stride + p % M;
+      const double* yq = y + (std::size_t) (q / M) * stride + q % M;
+      double s = 0.0;
+      for (int c = 0; c < nc; ++c)
+        s += CenteredDot(yp + (std::size_t) c * stride, yq + (std::size_t) c * stride,
+                         nr, mean[p], mean[q]);
+      cov[p * n + q] = cov[q * n + p] = s / count;
+    }
+}
+
+// reflect1 edge handling: mirror about the edge samples of [0, N)
+inline int Reflect1(int i, int n) { return (i < 0) ? -i : (i >= n) ? 2 * (n - 1) - i : i; }
+
+// internal_moments of the H x W top-left parts of X and Y (row stride
+// STRIDE) with WIN = ones(WINSIZE) and
+// 'reflect1' edges, at rows and columns START, START+STEP, ... below
+// RSTOP and CSTOP.  The box is separable: each output column first
+// sums WINSIZE image columns into five column vectors (x, y, x*y, x^2,
+// y^2, a unit-stride loop that vectorizes), from which every output
+// row of that column takes a WINSIZE-sample sum.  Reflecting the
+// image about its edges gives the same sums as internal_reduce's
+// reflected filters; WINSIZE must not exceed H or W.
+void BoxMoments(const double* x, const double* y, int stride, int h, int w, int winsize,
+                int start, int step, int rstop, int cstop,
+                double* mean_x, double* mean_y, double* cov_xy, double* ss_x, double* ss_y)
+{
+  int const rad = winsize / 2;
+  int const nr = (rstop - start + step - 1) / step;
+  int const nc = (cstop - start + step - 1) / step;
+  double const wsum = (double) winsize * winsize;
+  std::vector<double> col(5 * (std::size_t) h);
+  double* const sx = &col[0];
+  double* const sy = sx + h;
+  double* const sxy = sy + h;
+  double* const sxx = sxy + h;
+  double* const syy = sxx + h;
+
+  for (int j = 0; j < nc; ++j)
+  {
+    std::fill(col.begin(), col.end(), 0.0);
+    for (int d = -rad; d <= rad; ++d)
+    {
+      std::size_t const c = (std::size_t) Reflect1(start + step * j + d, w) * stride;
+      const double* xc = x + c;
+      const double* yc = y + c;
+      for (int r = 0; r < h; ++r)
+      {
+        double const a = xc[r], b = yc[r];
+        sx[r] += a;  sy[r] += b;
+        sxy[r] += a * b;  sxx[r] += a * a;  syy[r] += b * b;
+      }
+    }
+    for (int i = 0; i < nr; ++i)
+    {
+      double tx = 0.0, ty = 0.0, txy = 0.0, txx = 0.0, tyy = 0.0;
+      for (int d = -rad; d <= rad; ++d)
+      {
+        int const r = Reflect1(start + step * i + d, h);
+        tx += sx[r];  ty += sy[r];
+        txy += sxy[r];  txx += sxx[r];  tyy += syy[r];
+      }
+      std::size_t const o = i + (std::size_t) j * nr;
+      double const mx = tx / wsum, my = ty / wsum;
+      mean_x[o] = mx;
+      mean_y[o] = my;
+      cov_xy[o] = txy - wsum * mx * my;
+      ss_x[o] = txx - wsum * mx * mx;
+      ss_y[o] = tyy - wsum * my * my;
+    }
+  }
+}
+
+// Inverse of the N x N matrix A by Gauss-Jordan elimination with
+// partial pivoting.  A singular A gives an all-Inf inverse, as inv()
+// does in Matlab.
+std::vector<double> Inverse(std::vector<double> a, int n)
+{
+  std::vector<double> inv(n * n, 0.0);
+  for (int i = 0; i < n; ++i) inv[i * n + i] = 1.0;
+  for (int c = 0; c < n; ++c)
+  {
+    int piv = c;
+    for (int r = c + 1; r < n; ++r)
+      if (std::fabs(a[r * n + c]) > std::fabs(a[piv * n + c])) piv = r;
+    if (a[piv * n + c] == 0.0)
+      return std::vector<double>(n * n, std::numeric_limits<double>::infinity());
+    if (piv != c)
+      for (int k = 0; k < n; ++k)
+      {
+        std::swap(a[c * n + k], a[piv * n + k]);
+        std::swap(inv[c * n + k], inv[piv * n + k]);
+      }
+    double const d = 1.0 / a[c * n + c];
+    for (int k = 0; k < n; ++k) { a[c * n + k] *= d;  inv[c * n + k] *= d; }
+    for (int r = 0; r < n; ++r)
+      if (r != c && a[r * n + c] != 0.0)
+      {
+        double const f = a[r * n + c];
+        for (int k = 0; k < n; ++k)
+        {
+          a[r * n + k] -= f * a[c * n + k];
+          inv[r * n + k] -= f * inv[c * n + k];
+        }
+      }
+  }
+  return inv;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+void SymmetricEigenvalues(double* a, int n, double* lambda)
+{
+  for (int sweep = 0; sweep < 100; ++sweep)
+  {
+    double off = 0.0, diag = 0.0;
+    for (int p = 0; p < n; ++p)
+    {
+      diag += a[p * n + p] * a[p * n + p];
+      for (int q = p + 1; q < n; ++q) off += a[p * n + q] * a[p * n + q];
+    }
+    if (off <= 1e-30 * diag || off == 0.0) break;
+
+    for (int p = 0; p < n - 1; ++p)
+      for (int q = p + 1; q < n; ++q)
+      {
+        double const apq = a[p * n + q];
+        if (apq == 0.0) continue;
+        double const theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+        double const t = (theta >= 0 ? 1.0 : -1.0) /
+                         (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+        double const c = 1.0 / std::sqrt(t * t + 1.0);
+        double const s = t * c;
+        for (int k = 0; k < n; ++k)   // columns p, q
+        {
+          double const akp = a[k * n + p], akq = a[k * n + q];
+          a[k * n + p] = c * akp - s * akq;
+          a[k * n + q] = s * akp + c * akq;
+        }
+        for (int k = 0; k < n; ++k)   // rows p, q
+        {
+          double const apk = a[p * n + k], aqk = a[q * n + k];
+          a[p * n + k] = c * apk - s * aqk;
+          a[q * n + k] = s * apk + c * aqk;
+        }
+      }
+  }
+  for (int i = 0; i < n; ++i) lambda[i] = a[i * n + i];
+  std::sort(lambda, lambda + n);
+}
+//-------------------------------------------------------------------------
+
+void EstimateGsmBand(const double* ref, const double* dist, int rows, int cols,
+                     int M, int winsize, GsmBand* band)
+{
+  METRIX_TRACE_SCOPE("stats/EstimateGsmBand");
+  int const h = (rows / M) * M;   // crop to exact multiple size
+  int const w = (cols / M) * M;
+  int const n = M * M;
+  if (h < winsize || w < winsize)
+    throw std::runtime_error("EstimateGsmBand: subband smaller than the window");
+
+  band->rows = h / M;
+  band->cols = w / M;
+  std::size_t const nfield = (std::size_t) band->rows * band->cols;
+
+  // reference: block covariance, its eigenvalues, and the S field
+  // from the non-overlapping blocks
+  std::vector<double> mean, cov;
+  BlockCovariance(ref, rows, h, w, M, mean, cov);
+  std::vector<double> const icov = Inverse(cov, n);
+  band->lambda.resize(n);
+  SymmetricEigenvalues(&cov[0], n, &band->lambda[0]);
+
+  band->ss.resize(nfield);
+  std::vector<double> x(n);
+  for (int b = 0; b < band->cols; ++b)
+    for (int a = 0; a < band->rows; ++a)
+    {
+      for (int p = 0; p < n; ++p)
+        x[p] = ref[(std::size_t) (M * b + p / M) * rows + M * a + p % M];
+      double s = 0.0;
+      for (int p = 0; p < n; ++p)
+      {
+        double ix = 0.0;
+        for (int q = 0; q < n; ++q) ix += icov[p * n + q] * x[q];
+        s += ix * x[p];
+      }
+      band->ss[a + (std::size_t) b * band->rows] = s / n;
+    }
+
+  // distortion channel: windowed moments of the cropped subbands,
+  // every M-th sample starting at floor(M/2)
+  std::vector<double> mean_x(nfield), mean_y(nfield), cov_xy(nfield), ss_x(nfield), ss_y(nfield);
+  int const start = M / 2;
+  BoxMoments(ref, dist, rows, h, w, winsize, start, M, h - (M + 1) / 2 + 1, w - (M + 1) / 2 + 1,
+             &mean_x[0], &mean_y[0], &cov_xy[0], &ss_x[0], &ss_y[0]);
+
+  // regression of the distorted on the reference subband, with the
+  // clamps of vifsub_est_M.m (in its order)
+  double const wsum = (double) winsize * winsize;
+  band->g.resize(nfield);
+  band->vv.resize(nfield);
+  for (std::size_t i = 0; i < nfield; ++i)
+  {
+    double const sx = std::max(ss_x[i], 0.0);
+    double const sy = std::max(ss_y[i], 0.0);
+    double g = cov_xy[i] / (sx + TOL);
+    double vv = (sy - g * cov_xy[i]) / wsum;
+    if (sx < TOL) { g = 0.0;  vv = sy; }
+    if (sy < TOL) { g = 0.0;  vv = 0.0; }
+    if (g < 0) { vv = sy;  g = 0.0; }
+    if (vv <= TOL) vv = TOL;
+    band->g[i] = g;
+    band->vv[i] = vv;
+  }
+
+  // border fields, which see the window's edge handling, are left out
+  band->offset = ((winsize - 1) / 2 + M - 1) / M;
+}
+//-------------------------------------------------------------------------
+
+double GsmInformation(const GsmBand& band, double sigma_nsq, bool distorted)
+{
+  int const n = (int) band.lambda.size();
+  double total = 0.0;
+  for (int c = band.offset; c < band.cols - band.offset; ++c)
+    for (int r = band.offset; r < band.rows - band.offset; ++r)
+    {
+      std::size_t const i = r + (std::size_t) c * band.rows;
+      double const a = distorted
+        ? band.g[i] * band.g[i] * band.ss[i] / (band.vv[i] + sigma_nsq)
+        : band.ss[i] / sigma_nsq;
+      // log2 of a product of (at most) three factors: a third of the logs
+      for (int j = 0; j < n; j += 3)
+      {
+        double prod = 1.0 + a * band.lambda[j];
+        if (j + 1 < n) prod *= 1.0 + a * band.lambda[j + 1];
+        if (j + 2 < n) prod *= 1.0 + a * band.lambda[j + 2];
+        total += std::log2(prod);
+      }
+    }
+  return total;
+}
+
+} // namespace metrix
+//=========================================================================
@@ -0,0 +1,47 @@
+//=========================================================================
+// gsm.h
+//
+// Gaussian scale mixture (GSM) statistics of a steerable pyramid
+// subband, as estimated by the LIVE VIF/IFC code (vifvec_release,
+// ifcvec_release): refparams_vecgsm.m for the reference image and
+// vifsub_est_M.m (= distsub_est_M.m) for the distortion channel.
+//=========================================================================
+#ifndef metrix_gsmH
+#define metrix_gsmH
+
+#include <vector>
+
+namespace metrix {
+
+// The fields are (rows/M) x (cols/M), column-major, one value per
+// non-overlapping MxM block of the subband (cropped to a multiple of
+// M).  Only the part OFFSET or more fields from the border enters the
+// VIF/IFC sums.
+struct GsmBand
+{
+  int rows, cols, offset;
+  std::vector<double> g;       // gain of the distortion channel
+  std::vector<double> vv;      // variance of its additive noise
+  std::vector<double> ss;      // S field of the reference (refparams_vecgsm)
+  std::vector<double> lambda;  // eigenvalues of the reference's MxM block covariance
+};
+
+// GSM statistics of one pair of subbands, REF and DIST (ROWS x COLS,
+// column-major), with MxM blocks and a WINSIZE x WINSIZE window for
+// the distortion channel.  The windowed moments are internal_moments'
+// (winMoments in Matlab) for a box window, computed separably.
+void EstimateGsmBand(const double* ref, const double* dist, int rows, int cols,
+                     int M, int winsize, GsmBand* band);
+
+// Eigenvalues (ascending) of the symmetric N x N matrix A, by cyclic
+// Jacobi rotations (A is overwritten).
+void SymmetricEigenvalues(double* a, int n, double* lambda);
+
+// Sum over the valid part of BAND of sum_j log2(1 + g^2 s lambda_j / (vv + SIGMA_NSQ)),
+// the distorted-image information; with DISTORTED false, of
+// sum_j log2(1 + s lambda_j / SIGMA_NSQ), the reference information.
+double GsmInformation(const GsmBand& band, double sigma_nsq, bool distorted);
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,307 @@
+//=========================================================================
+// gtstore.cpp
+//=========================================================================
+#include "gtstore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace metrix {
+
+namespace {
+
+const char MAGIC[8] = {'M', 'T', 'R', 'X', 'G', 'T', 'S', '1'};
+const unsigned VERSION = 1;
+const unsigned DTYPE_UINT8 = 1;
+const unsigned HAS_MEANS = 1;
+const unsigned HAS_SPECTRA = 2;
+const std::size_t HEADER_SIZE = 80;
+const unsigned long long ALIGNMENT = 4096;
+
+unsigned long long Align(unsigned long long offset)
+{
+  return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// little-endian fields of the header, whatever the host
+unsigned ReadU32(const unsigned char* p)
+{
+  return (unsigned) p[0] | (unsigned) p[1] << 8 | (unsigned) p[2] << 16 | (unsigned) p[3] << 24;
+}
+
+unsigned long long ReadU64(const unsigned char* p)
+{
+  return (unsigned long long) ReadU32(p) | (unsigned long long) ReadU32(p + 4) << 32;
+}
+
+void WriteU32(unsigned char* p, unsigned v)
+{
+  for (int i = 0; i < 4; ++i) p[i] = (unsigned char) (v >> (8 * i));
+}
+
+void WriteU64(unsigned char* p, unsigned long long v)
+{
+  WriteU32(p, (unsigned) v);
+  WriteU32(p + 4, (unsigned) (v >> 32));
+}
+
+// mean(X, 3) of the CHANNELS planes of the uint8 frame X, as Matlab
+// sums them
+void ChannelMean(const unsigned char* x, std::size_t n, int channels, double* out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    double s = 0.0;
+    for (int k = 0; k < channels; ++k) s += x[k * n + i];
+    out[i] = s / channels;
+  }
+}
+
+class Writer
+{
+public:
+  explicit Writer(const std::string& path) : path_(path), fp_(std::fopen(path.c_str(), "wb")), pos_(0)
+  {
+    if (!fp_) throw std::runtime_error(path + ": cannot create file");
+  }
+  ~Writer() { if (fp_) std::fclose(fp_); }
+
+  void Write(const void* p, std::size_t n)
+  {
+    if (n > 0 && std::fwrite(p, 1, n, fp_) != n) throw std::runtime_error(path_ + ": write error");
+    pos_ += n;
+  }
+
+  void PadTo(unsigned long long offset)
+  {
+    static const unsigned char zeros[4096] = {0};
+    while (pos_ < offset)
+      Write(zeros, (std::size_t) std::min<unsigned long long>(offset - pos_, sizeof(zeros)));
+  }
+
+  void Close()
+  {
+    int const status = std::fclose(fp_);
+    fp_ = 0;
+    if (status != 0) throw std::runtime_error(path_ + ": write error");
+  }
+
+private:
+  std::string path_;
+  std::FILE* fp_;
+  unsigned long long pos_;
+};
+
+} // namespace
+//-------------------------------------------------------------------------
+
+GroundTruthStore::GroundTruthStore(const std::string& path)
+  : path_(path), rows_(0), cols_(0), channels_(0), frames_(0), map_(0), map_size_(0),
+#ifdef _WIN32
+    file_(INVALID_HANDLE_VALUE), mapping_(0),
+#endif
+    data_(0), means_(0), spectra_(0)
+{
+#ifdef _WIN32
+  file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                      FILE_ATTRIBUTE_NORMAL, 0);
+  LARGE_INTEGER size;
+  if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size))
+  {
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+    throw std::runtime_error(path + ": cannot open file");
+  }
+  map_size_ = (std::size_t) size.QuadPart;
+  if (map_size_ >= HEADER_SIZE)
+  {
+    mapping_ = CreateFileMappingA(file_, 0, PAGE_READONLY, 0, 0, 0);
+    if (mapping_) map_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+  }
+  if (!map_)
+  {
+    if (mapping_) CloseHandle(mapping_);
+    CloseHandle(file_);
+    throw std::runtime_error(path + (map_size_ < HEADER_SIZE ? ": not a ground-truth store"
+                                                             : ": cannot map file"));
+  }
+#else
+  int const fd = open(path.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    if (fd >= 0) close(fd);
+    throw std::runtime_error(path + ": cannot open file");
+  }
+  map_size_ = (std::size_t) st.st_size;
+  void* const map = (map_size_ >= HEADER_SIZE) ? mmap(0, map_size_, PROT_READ, MAP_SHARED, fd, 0)
+                                               : MAP_FAILED;
+  close(fd);
+  if (map == MAP_FAILED)
+    throw std::runtime_error(path + (map_size_ < HEADER_SIZE ? ": not a ground-truth store"
+                                                             : ": cannot map file"));
+  map_ = map;
+#endif
+
+  const unsigned char* const base = (const unsigned char*) map_;
+  const char* error = 0;
+  unsigned long long const rows = ReadU64(base + 24), cols = ReadU64(base + 32);
+  unsigned long long const channels = ReadU64(base + 40), frames = ReadU64(base + 48);
+  unsigned long long const offsets[3] = {ReadU64(base + 56), ReadU64(base + 64), ReadU64(base + 72)};
+  unsigned long long const plane = rows * cols;
+  if (std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0 || ReadU32(base + 8) != VERSION)
+    error = ": not a ground-truth store of this version";
+  else if (ReadU32(base + 12) != DTYPE_UINT8)
+    error = ": frames are not uint8";
+  else if (rows < 1 || cols < 1 || channels < 1 || rows > 0x7fffffff || cols > 0x7fffffff ||
+           channels > 0x7fffffff || frames > 0x7fffffff || offsets[0] == 0 ||
+           plane > map_size_ / channels)
+    error = ": bad dimensions";
+  // the size of a frame in each section (no product can overflow)
+  unsigned long long const per_frame[3] = {plane * channels, 8 * plane, 16 * plane};
+  for (int k = 0; !error && k < 3; ++k)
+    if (offsets[k] != 0 && (offsets[k] % ALIGNMENT != 0 || offsets[k] > map_size_ ||
+                            (frames > 0 && per_frame[k] > (map_size_ - offsets[k]) / frames)))
+      error = ": file shorter than its header says";
+  if (error)
+  {
+    Unmap();
+    throw std::runtime_error(path + error);
+  }
+  rows_ = (int) rows;
+  cols_ = (int) cols;
+  channels_ = (int) channels;
+  frames_ = (int) frames;
+  data_ = base + offsets[0];
+  if (offsets[1]) means_ = (const double*) (base + offsets[1]);
+  if (offsets[2]) spectra_ = (const Complex*) (base + offsets[2]);
+}
+//-------------------------------------------------------------------------
+
+GroundTruthStore::~GroundTruthStore()
+{
+  Unmap();
+}
+//-------------------------------------------------------------------------
+
+void GroundTruthStore::Unmap()
+{
+  if (!map_) return;
+#ifdef _WIN32
+  UnmapViewOfFile(map_);
+  CloseHandle(mapping_);
+  CloseHandle(file_);
+#else
+  munmap(map_, map_size_);
+#endif
+  map_ = 0;
+}
+//-------------------------------------------------------------------------
+
+void GroundTruthStore::CheckFrame(int j) const
+{
+  if (j < 0 || j >= frames_) throw std::runtime_error(path_ + ": no such frame");
+}
+//-------------------------------------------------------------------------
+
+const unsigned char* GroundTruthStore::Frame(int j) const
+{
+  CheckFrame(j);
+  return data_ + (std::size_t) j * rows_ * cols_ * channels_;
+}
+//-------------------------------------------------------------------------
+
+const double* GroundTruthStore::Mean(int j) const
+{
+  CheckFrame(j);
+  return means_ ? means_ + (std::size_t) j * rows_ * cols_ : 0;
+}
+//-------------------------------------------------------------------------
+
+const Complex* GroundTruthStore::Spectrum(int j) const
+{
+  CheckFrame(j);
+  return spectra_ ? spectra_ + (std::size_t) j * rows_ * cols_ : 0;
+}
+//-------------------------------------------------------------------------
+
+Image GroundTruthStore::MeanImage(int j) const
+{
+  Image m(rows_, cols_);
+  if (const double* p = Mean(j))
+    std::memcpy(m.Data(), p, m.Size() * sizeof(double));
+  else
+    ChannelMean(Frame(j), m.Size(), channels_, m.Data());
+  return m;
+}
+//-------------------------------------------------------------------------
+
+void WriteGroundTruthStore(const std::string& path, int rows, int cols, int channels, int frames,
+                           const unsigned char* data, bool means, bool spectra)
+{
+  if (rows < 1 || cols < 1 || channels < 1 || frames < 0)
+    throw std::runtime_error(path + ": bad dimensions");
+  unsigned long long const plane = (unsigned long long) rows * cols;
+  unsigned long long const frame_size = plane * channels;
+  unsigned long long offsets[3];
+  offsets[0] = Align(HEADER_SIZE);
+  offsets[1] = means ? Align(offsets[0] + frame_size * frames) : 0;
+  offsets[2] = spectra ? Align((means ? offsets[1] + 8 * plane * frames
+                                      : offsets[0] + frame_size * frames)) : 0;
+
+  unsigned char header[HEADER_SIZE] = {0};
+  std::memcpy(header, MAGIC, sizeof(MAGIC));
+  WriteU32(header + 8, VERSION);
+  WriteU32(header + 12, DTYPE_UINT8);
+  WriteU32(header + 16, (means ? HAS_MEANS : 0) | (spectra ? HAS_SPECTRA : 0));
+  WriteU64(header + 24, rows);
+  WriteU64(header + 32, cols);
+  WriteU64(header + 40, channels);
+  WriteU64(header + 48, frames);
+  for (int k = 0; k < 3; ++k) WriteU64(header + 56 + 8 * k, offsets[k]);
+
+  Writer w(path);
+  w.Write(header, sizeof(header));
+  w.PadTo(offsets[0]);
+  w.Write(data, (std::size_t) (frame_size * frames));
+  if (means || spectra)
+  {
+    std::vector<double> mean((std::size_t) plane);
+    if (means)
+    {
+      w.PadTo(offsets[1]);
+      for (int j = 0; j < frames; ++j)
+      {
+        ChannelMean(data + j * frame_size, mean.size(), channels, &mean[0]);
+        w.Write(&mean[0], mean.size() * sizeof(double));
+      }
+    }
+    if (spectra)
+    {
+      w.PadTo(offsets[2]);
+      Fft2d fft(rows, cols);
+      std::vector<Complex> ft(mean.size());
+      for (int j = 0; j < frames; ++j)
+      {
+        ChannelMean(data + j * frame_size, mean.size(), channels, &mean[0]);
+        for (std::size_t i = 0; i < ft.size(); ++i) ft[i] = mean[i];
+        fft.Forward(&ft[0]);
+        w.Write(&ft[0], ft.size() * sizeof(Complex));
+      }
+    }
+  }
+  w.Close();
+}
+
+} // namespace metrix
@@ -0,0 +1,99 @@
+//=========================================================================
+// gtstore.h
+//
+// A ground-truth store: the frames of a GroundTruth%d_%d.mat array
+// uncompressed in one file that is memory-mapped rather than loaded,
+// so opening it costs no decompression, a frame is read when touched,
+// and the pages are shared by every process evaluating against it.
+// Optionally it also holds each frame's channel mean (mean(X,3)) and
+// the spectrum of that mean (fft2), the registration's reference.
+//
+// Layout (little-endian): an 80-byte header,
+//
+//    0  char[8]  "MTRXGTS1"
+//    8  uint32   version (1)
+//   12  uint32   dtype (1: uint8)
+//   16  uint32   flags (1: means, 2: spectra)
+//   20  uint32   0
+//   24  uint64   rows, cols, channels, frames
+//   56  uint64   offsets of the frames, means and spectra (0: none)
+//
+// then each section at a multiple of 4096: FRAMES x CHANNELS x COLS x
+// ROWS uint8 (a frame as GroundTruth(:,:,:,j) is in memory), FRAMES x
+// COLS x ROWS double means, and FRAMES x COLS x ROWS complex double
+// spectra (real and imaginary parts interleaved).  WriteGroundTruthStore
+// and convert_gt_store.m (evaluation_code) write it.
+//=========================================================================
+#ifndef metrix_gtstoreH
+#define metrix_gtstoreH
+
+#include <cstddef>
+#include <string>
+
+#include "fft.h"
+#include "image.h"
+
+namespace metrix {
+
+class GroundTruthStore
+{
+public:
+  // Maps the store PATH read-only.  Throws std::runtime_error if it
+  // cannot be opened or mapped, or is not a store of this version or
+  // shorter than its header says.
+  explicit GroundTruthStore(const std::string& path);
+  ~GroundTruthStore();
+
+  const std::string& Path() const { return path_; }
+  int Rows() const { return rows_; }
+  int Cols() const { return cols_; }
+  int Channels() const { return channels_; }
+  int Frames() const { return frames_; }
+  bool HasMeans() const { return means_ != 0; }
+  bool HasSpectra() const { return spectra_ != 0; }
+
+  // Frame J (0-based): CHANNELS planes of ROWS x COLS, column-major.
+  // The pointers are valid while the store is.  Throws
+  // std::runtime_error for J out of range.
+  const unsigned char* Frame(int j) const;
+
+  // mean(double(frame J), 3), or null without means
+  const double* Mean(int j) const;
+
+  // fft2 of Mean(J), or null without spectra
+  const Complex* Spectrum(int j) const;
+
+  // Mean(J) as an Image, computed from the frame without means
+  Image MeanImage(int j) const;
+
+private:
+  GroundTruthStore(const GroundTruthStore&);
+  GroundTruthStore& operator=(const GroundTruthStore&);
+
+  void CheckFrame(int j) const;
+  void Unmap();
+
+  std::string path_;
+  int rows_, cols_, channels_, frames_;
+  void* map_;
+  std::size_t map_size_;
+#ifdef _WIN32
+  void* file_;
+  void* mapping_;
+#endif
+  const unsigned char* data_;
+  const double* means_;
+  const Complex* spectra_;
+};
+//-------------------------------------------------------------------------
+
+// Writes FRAMES frames of ROWS x COLS x CHANNELS uint8 (DATA, laid out
+// as a GroundTruth array) to the store PATH, with their channel means
+// and their spectra if asked for.  Throws std::runtime_error if PATH
+// cannot be written.
+void WriteGroundTruthStore(const std::string& path, int rows, int cols, int channels, int frames,
+                           const unsigned char* data, bool means, bool spectra);
+
+} // namespace metrix
+//=========================================================================
+#endif
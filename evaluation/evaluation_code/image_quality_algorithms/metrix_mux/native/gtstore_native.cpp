@@ -0,0 +1,160 @@
+//=========================================================================
+// gtstore_native.cpp
+//
+// INFO = gtstore_native(STORE)
+// X = gtstore_native(STORE, J)
+// OUTPUT = gtstore_native(STORE, J, IMG, USFAC)
+// gtstore_native('clear')
+//
+// Matlab interface to ground-truth stores (gtstore.h), as written by
+// convert_gt_store.m.  INFO is [rows cols channels frames]; X is image
+// J (from 1) as uint8 ROWS x COLS x CHANNELS, i.e. GroundTruth(:,:,:,J)
+// of the .mat file; OUTPUT is dftregistration(fft2(mean(double(X),3)),
+// fft2(IMG), USFAC) (dftreg_native's), from the stored spectrum when
+// the store has one.  USFAC defaults to 1.
+//
+// The last store stays mapped between calls, so eval_image.m reads
+// only the images it uses, and the pages are shared with every other
+// process mapping the store.  The registration plan for the last size
+// and USFAC and the spectrum of the last IMG are kept as well.
+// gtstore_native('clear') unmaps and frees them.  Built by
+// metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dftreg.h"
+#include "gtstore.h"
+#include "mexutil.h"
+
+namespace {
+
+const std::size_t CACHE_CAPACITY = 2;
+
+metrix::GroundTruthStore* store = 0;
+metrix::DftRegistration* plan = 0;
+metrix::DftSpectrumCache* cache = 0;
+
+void FreePlan()
+{
+  delete cache;
+  cache = 0;
+  delete plan;
+  plan = 0;
+}
+
+void FreeAll()
+{
+  FreePlan();
+  delete store;
+  store = 0;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  char path[4096];
+  if (nrhs == 1 && mxIsChar(prhs[0]) && mxGetString(prhs[0], path, sizeof(path)) == 0 &&
+      std::strcmp(path, "clear") == 0)
+  {
+    FreeAll();
+    return;
+  }
+  if (nrhs != 1 && nrhs != 2 && nrhs != 4)
+    mexErrMsgIdAndTxt("metrix:gtstore_native", "requires 1, 2 or 4 arguments.");
+  if (nlhs > 1) mexErrMsgIdAndTxt("metrix:gtstore_native", "returns 1 value.");
+  if (!mxIsChar(prhs[0]) || mxGetString(prhs[0], path, sizeof(path)) != 0)
+    mexErrMsgIdAndTxt("metrix:gtstore_native", "STORE must be a file name.");
+  double j = 0;
+  if (nrhs >= 2)
+  {
+    if (!mxIsNumeric(prhs[1]) || mxGetNumberOfElements(prhs[1]) != 1 ||
+        mxGetScalar(prhs[1]) < 1 || mxGetScalar(prhs[1]) != (int) mxGetScalar(prhs[1]))
+      mexErrMsgIdAndTxt("metrix:gtstore_native", "J must be a positive integer.");
+    j = mxGetScalar(prhs[1]);
+  }
+  int usfac = 1;
+  if (nrhs == 4)
+  {
+    if (!mxIsNumeric(prhs[3]) || mxGetNumberOfElements(prhs[3]) != 1 ||
+        mxGetScalar(prhs[3]) < 0 || mxGetScalar(prhs[3]) != (int) mxGetScalar(prhs[3]))
+      mexErrMsgIdAndTxt("metrix:gtstore_native", "USFAC must be a nonnegative integer.");
+    usfac = (int) mxGetScalar(prhs[3]);
+  }
+
+  metrix::DftRegOutput out;
+  const unsigned char* frame = 0;
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      if (!store || store->Path() != path)
+      {
+        if (!store) mexAtExit(FreeAll);
+        delete store;
+        store = 0;
+        store = new metrix::GroundTruthStore(path);
+      }
+      if (nrhs == 2)
+        frame = store->Frame((int) j - 1);
+      else if (nrhs == 4)
+      {
+        metrix::Image const img = metrix::ImageArg(prhs[2], "IMG");
+        if (img.Rows() != store->Rows() || img.Cols() != store->Cols())
+          throw std::runtime_error("IMG differs in size from the images of STORE.");
+        if (!plan || plan->Rows() != img.Rows() || plan->Cols() != img.Cols() ||
+            plan->Upsampling() != usfac)
+        {
+          FreePlan();
+          plan = new metrix::DftRegistration(img.Rows(), img.Cols(), usfac);
+          cache = new metrix::DftSpectrumCache(CACHE_CAPACITY);
+        }
+        const metrix::Complex* buf1ft = store->Spectrum((int) j - 1);
+        if (!buf1ft) buf1ft = &cache->Spectrum(*plan, store->MeanImage((int) j - 1))[0];
+        const std::vector<metrix::Complex>& buf2ft = cache->Spectrum(*plan, img);
+        out = plan->Register(buf1ft, &buf2ft[0]);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:gtstore_native", "%s", msg);
+
+  if (nrhs == 1)
+  {
+    plhs[0] = mxCreateDoubleMatrix(1, 4, mxREAL);
+    double* o = mxGetPr(plhs[0]);
+    o[0] = store->Rows();
+    o[1] = store->Cols();
+    o[2] = store->Channels();
+    o[3] = store->Frames();
+  }
+  else if (nrhs == 2)
+  {
+    mwSize const dims[3] = {(mwSize) store->Rows(), (mwSize) store->Cols(), (mwSize) store->Channels()};
+    plhs[0] = mxCreateNumericArray(3, dims, mxUINT8_CLASS, mxREAL);
+    std::memcpy(mxGetData(plhs[0]), frame, (std::size_t) dims[0] * dims[1] * dims[2]);
+  }
+  else
+  {
+    std::size_t const cols = (usfac == 0) ? 2 : 4;
+    plhs[0] = mxCreateDoubleMatrix(1, cols, mxREAL);
+    double* o = mxGetPr(plhs[0]);
+    o[0] = out.error;
+    o[1] = out.diffphase;
+    if (cols == 4)
+    {
+      o[2] = out.row_shift;
+      o[3] = out.col_shift;
+    }
+  }
+}
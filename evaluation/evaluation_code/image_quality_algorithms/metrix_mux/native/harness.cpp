@@ -0,0 +1,287 @@
+//=========================================================================
+// harness.cpp
+//=========================================================================
+#include "harness.h"
+#include "parallel.h"
+#include "resultcache.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace metrix {
+
+namespace {
+
+std::string Join(const std::string& dir, const std::string& name)
+{
+  return (dir.empty() || dir[dir.size() - 1] == '/') ? dir + name : dir + "/" + name;
+}
+
+bool EndsWith(const std::string& s, const std::string& suffix)
+{
+  return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool IsDirectory(const std::string& path)
+{
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// dir(fullfile(DIR, ['*' SUFFIX])) (or every entry but . and .. for an
+// empty SUFFIX), by name; a missing directory lists nothing
+std::vector<std::string> ListDirectory(const std::string& dir, const std::string& suffix)
+{
+  std::vector<std::string> names;
+  DIR* d = opendir(dir.c_str());
+  if (!d) return names;
+  for (struct dirent* e = readdir(d); e; e = readdir(d))
+  {
+    std::string const name = e->d_name;
+    if (name == "." || name == "..") continue;
+    if (suffix.empty() || EndsWith(name, suffix)) names.push_back(name);
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+  return names;
+}
+//-------------------------------------------------------------------------
+
+// A pair decoded by a reader
+struct Decoded
+{
+  std::size_t index;
+  std::string key;   // in the result cache
+  Frame gt, result;
+};
+
+class Pipeline
+{
+public:
+  Pipeline(const std::vector<FramePair>& pairs, const HarnessOptions& opt, FrameSink& sink,
+           int readers, std::size_t capacity)
+    : pairs_(pairs), opt_(opt), sink_(sink), capacity_(capacity), next_read_(0),
+      readers_left_(readers), scores_(pairs.size()), done_(pairs.size(), false), next_out_(0),
+      failed_(false) {}
+
+  void Read();
+  void Work(int threads);
+
+  bool Failed() const { return failed_; }
+  const std::string& Error() const { return error_; }
+
+private:
+  void Fail(const std::string& what);
+  void Deliver(std::size_t index, const FrameScores& scores);
+
+  const std::vector<FramePair>& pairs_;
+  const HarnessOptions& opt_;
+  FrameSink& sink_;
+  std::size_t const capacity_;
+
+  std::mutex mutex_;
+  std::condition_variable not_full_, not_empty_;
+  std::size_t next_read_;          // next pair to decode
+  int readers_left_;
+  std::deque<Decoded> queue_;
+  std::vector<FrameScores> scores_;
+  std::vector<bool> done_;
+  std::size_t next_out_;           // next pair for the sink
+  bool failed_;
+  std::string error_;
+};
+
+void Pipeline::Fail(const std::string& what)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!failed_)
+    {
+      failed_ = true;
+      error_ = what;
+    }
+  }
+  not_full_.notify_all();
+  not_empty_.notify_all();
+}
+
+// The reader claims pairs in order, so the queue stays close to list
+// order and the sink's backlog small.  Pairs found in the result cache
+// go to the sink without being decoded.
+void Pipeline::Read()
+{
+  for (;;)
+  {
+    Decoded d;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (failed_ || next_read_ == pairs_.size()) break;
+      d.index = next_read_++;
+    }
+    try
+    {
+      if (opt_.cache)
+      {
+        d.key = ResultCache::Key(pairs_[d.index].gt_path, pairs_[d.index].result_path, opt_.eval);
+        FrameScores s;
+        if (opt_.cache->Find(d.key, s))
+        {
+          Deliver(d.index, s);
+          continue;
+        }
+      }
+      d.gt = ReadFrame(pairs_[d.index].gt_path);
+      d.result = ReadFrame(pairs_[d.index].result_path);
+    }
+    catch (const std::exception& e)
+    {
+      Fail(e.what());
+      break;
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!failed_ && queue_.size() >= capacity_) not_full_.wait(lock);
+      if (failed_) break;
+      queue_.push_back(std::move(d));
+    }
+    not_empty_.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --readers_left_;
+  }
+  not_empty_.notify_all();
+}
+
+void Pipeline::Work(int threads)
+{
+  SetThreads(threads);
+  std::size_t index = pairs_.size();
+  try
+  {
+    FrameEvaluator evaluator(opt_.eval);
+    for (;;)
+    {
+      Decoded d;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!failed_ && queue_.empty() && readers_left_ > 0) not_empty_.wait(lock);
+        if (failed_ || queue_.empty()) break;
+        d = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      not_full_.notify_one();
+      index = d.index;
+      FrameScores const s = evaluator.Evaluate(d.gt, d.result);
+      if (opt_.cache) opt_.cache->Put(d.key, s);
+      Deliver(index, s);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    Fail((index < pairs_.size()) ? pairs_[index].result_path + ": " + e.what() : e.what());
+  }
+}
+
+void Pipeline::Deliver(std::size_t index, const FrameScores& scores)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  scores_[index] = scores;
+  done_[index] = true;
+  try
+  {
+    for (; !failed_ && next_out_ < pairs_.size() && done_[next_out_]; ++next_out_)
+      sink_.Add(pairs_[next_out_], scores_[next_out_]);
+  }
+  catch (const std::exception& e)
+  {
+    // Fail() takes the lock
+    failed_ = true;
+    error_ = e.what();
+  }
+  if (failed_)
+  {
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+std::vector<FramePair> ListFramePairs(const std::string& test_offset, const std::string& test_set,
+                                      const std::string& folder_result, const std::string& test_model)
+{
+  std::string gt_dir, gt_suffix;
+  if (test_set == "DVD")
+  {
+    gt_dir = "GT";
+    gt_suffix = ".jpg";
+  }
+  else if (test_set == "nah")
+  {
+    gt_dir = "sharp";
+    gt_suffix = ".png";
+  }
+  else
+    throw std::runtime_error("unknown test set '" + test_set + "' (DVD or nah)");
+  std::string const folder_gt = Join(test_offset, "test_" + test_set);
+  if (!IsDirectory(folder_gt)) throw std::runtime_error(folder_gt + ": no such directory");
+
+  std::vector<FramePair> pairs;
+  std::vector<std::string> const videos = ListDirectory(folder_gt, "");
+  for (std::size_t i = 0; i < videos.size(); ++i)
+  {
+    std::string const gt_path = Join(Join(folder_gt, videos[i]), gt_dir);
+    std::string const result_path = Join(folder_result, videos[i]);
+    std::vector<std::string> const gt = ListDirectory(gt_path, gt_suffix);
+    std::vector<std::string> const result = ListDirectory(result_path, ".png");
+    int const num = (int) result.size();
+    for (int j = 2; j <= num; ++j)
+    {
+      int const gt_idx = (test_model == "OVD") ? j + 1 : j;
+      if (gt_idx > (int) gt.size())
+        throw std::runtime_error(Join(result_path, result[j - 1]) + ": no ground-truth frame " +
+                                 "in " + gt_path);
+      FramePair p;
+      p.video = videos[i];
+      p.gt_name = gt[gt_idx - 1];
+      p.result_name = result[j - 1];
+      p.gt_path = Join(gt_path, p.gt_name);
+      p.result_path = Join(result_path, p.result_name);
+      p.video_index = (int) i + 1;
+      p.videos = (int) videos.size();
+      p.frame = j;
+      p.frames = num;
+      pairs.push_back(p);
+    }
+  }
+  return pairs;
+}
+//-------------------------------------------------------------------------
+
+void RunEvaluation(const std::vector<FramePair>& pairs, const HarnessOptions& opt, FrameSink& sink)
+{
+  int workers = opt.workers;
+  if (workers < 1) workers = std::max(1, (int) std::thread::hardware_concurrency());
+  int const readers = std::max(1, opt.readers);
+  std::size_t const capacity = (opt.queue > 0) ? opt.queue : 2 * workers;
+  int const threads = std::max(1, MaxThreads() / workers);
+
+  Pipeline pipeline(pairs, opt, sink, readers, capacity);
+  std::vector<std::thread> pool;
+  for (int i = 0; i < readers; ++i) pool.push_back(std::thread(&Pipeline::Read, &pipeline));
+  for (int i = 0; i < workers; ++i) pool.push_back(std::thread(&Pipeline::Work, &pipeline, threads));
+  for (std::size_t i = 0; i < pool.size(); ++i) pool[i].join();
+  if (pipeline.Failed()) throw std::runtime_error(pipeline.Error());
+}
+
+} // namespace metrix
@@ -0,0 +1,72 @@
+//=========================================================================
+// harness.h
+//
+// Streaming evaluation of a test set, as evaluation.m runs it, without
+// Matlab.  ListFramePairs gives evaluation.m's frame list for the DVD
+// or nah layout; RunEvaluation decodes the pairs ahead on reader
+// threads into a bounded queue, evaluates them (frameeval.h) on a pool
+// of worker threads, and hands the scores to a FrameSink in list
+// order.  Each worker runs the engines' parallel regions with its
+// share of the cores, so a run saturates the machine whether frames
+// are large or many.  With a ResultCache (resultcache.h), frames
+// scored by an earlier run are taken from it.
+//=========================================================================
+#ifndef metrix_harnessH
+#define metrix_harnessH
+
+#include <string>
+#include <vector>
+
+#include "frameeval.h"
+
+namespace metrix {
+
+struct FramePair
+{
+  std::string video;
+  std::string gt_path, result_path;
+  std::string gt_name, result_name;
+  int video_index, videos;   // 1-based, as evaluation.m's i
+  int frame, frames;         // and j, of the result frames
+};
+
+// evaluation.m's pairs for TEST_SET 'DVD' (ground truth
+// TEST_OFFSET/test_DVD/<video>/GT/*.jpg) or 'nah'
+// (TEST_OFFSET/test_nah/<video>/sharp/*.png), against
+// FOLDER_RESULT/<video>/*.png: every result frame but the first, with
+// the ground-truth frame of the same index (the next one for
+// TEST_MODEL 'OVD').  Directories are listed in name order.  Throws
+// std::runtime_error for an unknown set, a missing ground-truth
+// directory, or a result frame without ground truth.
+std::vector<FramePair> ListFramePairs(const std::string& test_offset, const std::string& test_set,
+                                      const std::string& folder_result, const std::string& test_model);
+
+class ResultCache;
+
+struct HarnessOptions
+{
+  int workers;   // evaluation threads (0: one per core)
+  int readers;   // decoding threads
+  int queue;     // decoded pairs waiting for a worker, at most (0: 2 per worker)
+  FrameEvalOptions eval;
+  ResultCache* cache;   // scores of earlier runs, and of this one (null: none)
+  HarnessOptions() : workers(0), readers(2), queue(0), cache(0) {}
+};
+
+// Receives the scores of each pair, in list order and from one
+// thread at a time.  An exception stops the run.
+class FrameSink
+{
+public:
+  virtual ~FrameSink() {}
+  virtual void Add(const FramePair& pair, const FrameScores& scores) = 0;
+};
+
+// Evaluates PAIRS into SINK.  Throws std::runtime_error with the first
+// error (an unreadable frame, mismatched sizes); the pairs after it
+// are not evaluated.
+void RunEvaluation(const std::vector<FramePair>& pairs, const HarnessOptions& opt, FrameSink& sink);
+
+} // namespace metrix
+//=========================================================================
+#endif
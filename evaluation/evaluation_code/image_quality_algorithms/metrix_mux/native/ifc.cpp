@@ -0,0 +1,35 @@
+//=========================================================================
+// ifc.cpp
+//=========================================================================
+#include "ifc.h"
+#include "trace.h"
+
+namespace metrix {
+
+double IfcFromGsm(const std::vector<GsmBand>& bands, double pixels)
+{
+  double num = 0.0;
+  for (std::size_t k = 0; k < bands.size(); ++k)
+    num += GsmInformation(bands[k], IFC_SIGMA_NSQ, true);
+  return num / pixels;
+}
+//-------------------------------------------------------------------------
+
+double Ifc(const Image& ref, const Image& dist, int M)
+{
+  return IfcFromGsm(AnalyzeGsm(ref, dist, M), (double) ref.Size());
+}
+//-------------------------------------------------------------------------
+
+InformationScores VifIfc(const Image& ref, const Image& dist, const VifOptions& opt)
+{
+  METRIX_TRACE_SCOPE("eval/VifIfc");
+  std::vector<GsmBand> const bands = AnalyzeGsm(ref, dist, opt.M);
+  InformationScores s;
+  s.vif = VifFromGsm(bands, opt.sigma_nsq);
+  s.ifc = IfcFromGsm(bands, (double) ref.Size());
+  return s;
+}
+
+} // namespace metrix
+//=========================================================================
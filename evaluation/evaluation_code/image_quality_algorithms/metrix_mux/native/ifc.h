@@ -0,0 +1,40 @@
+//=========================================================================
+// ifc.h
+//
+// Information Fidelity Criterion, as ifcvec.m (LIVE ifcvec_release).
+// IFC uses the subbands, block size and GSM statistics of VIF (its
+// distsub_est_M.m and refparams_vecgsm.m are vifvec's), so both scores
+// come from one AnalyzeGsm; VifIfc returns the pair for the cost of one.
+//=========================================================================
+#ifndef metrix_ifcH
+#define metrix_ifcH
+
+#include <vector>
+
+#include "gsm.h"
+#include "image.h"
+#include "vif.h"
+
+namespace metrix {
+
+// ifcvec's tolerance for zero distortion-noise variance
+const double IFC_SIGMA_NSQ = 1e-10;
+
+// IFC from the statistics of an image of PIXELS pixels: the distorted
+// image information per pixel.
+double IfcFromGsm(const std::vector<GsmBand>& bands, double pixels);
+
+double Ifc(const Image& ref, const Image& dist, int M = 3);
+
+struct InformationScores
+{
+  double vif, ifc;
+};
+
+// VIF (with OPT) and IFC (with block size OPT.M) of one image pair.
+InformationScores VifIfc(const Image& ref, const Image& dist,
+                         const VifOptions& opt = VifOptions());
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,187 @@
+//=========================================================================
+// image.cpp
+//=========================================================================
+#include "image.h"
+#include "trace.h"
+
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+// luminance weights of preprocess_metrix_mux.m
+const double LUMA_R = 0.29900;
+const double LUMA_G = 0.58700;
+const double LUMA_B = 0.11400;
+
+class File
+{
+public:
+  explicit File(const std::string& path) : path_(path), fp_(std::fopen(path.c_str(), "rb"))
+  {
+    if (!fp_) Fail("cannot open file");
+  }
+  ~File() { std::fclose(fp_); }
+
+  void Read(void* p, std::size_t n)
+  {
+    if (std::fread(p, 1, n, fp_) != n) Fail("unexpected end of file");
+  }
+  int Getc() { return std::getc(fp_); }
+  void Seek(long pos)
+  {
+    if (std::fseek(fp_, pos, SEEK_SET) != 0) Fail("bad offset");
+  }
+
+  // next decimal integer of a PNM header or ASCII body, skipping
+  // white space and '#' comments
+  int PnmInt()
+  {
+    int c = Getc();
+    while (c != EOF && (std::isspace(c) || c == '#'))
+    {
+      if (c == '#') while (c != EOF && c != '\n') c = Getc();
+      c = Getc();
+    }
+    if (c == EOF || !std::isdigit(c)) Fail("bad PNM header or data");
+    int v = 0;
+    for (; c != EOF && std::isdigit(c); c = Getc()) v = 10 * v + (c - '0');
+    return v;
+  }
+
+  void Fail(const char* what) const
+  {
+    throw std::runtime_error(path_ + ": " + what);
+  }
+
+private:
+  File(const File&);
+  File& operator=(const File&);
+
+  std::string path_;
+  std::FILE* fp_;
+};
+
+unsigned Le16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+long Le32(const unsigned char* p)
+{
+  return (long) (int) (p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned) p[3] << 24));
+}
+
+Image ReadPnm(File& f, int kind)
+{
+  int const cols = f.PnmInt();
+  int const rows = f.PnmInt();
+  int const maxval = f.PnmInt();
+  if (cols <= 0 || rows <= 0 || maxval <= 0 || maxval > 255)
+    f.Fail("only 8-bit PGM/PPM files are supported");
+  bool const color = (kind == 3 || kind == 6);
+  bool const binary = (kind == 5 || kind == 6);
+  int const nc = color ? 3 : 1;
+
+  Image im(rows, cols);
+  std::vector<unsigned char> line((std::size_t) cols * nc);
+  for (int r = 0; r < rows; ++r)
+  {
+    if (binary) f.Read(&line[0], line.size());
+    else
+      for (std::size_t i = 0; i < line.size(); ++i) line[i] = (unsigned char) f.PnmInt();
+    for (int c = 0; c < cols; ++c)
+    {
+      unsigned char const* p = &line[(std::size_t) c * nc];
+      im(r, c) = color ? LUMA_R * p[0] + LUMA_G * p[1] + LUMA_B * p[2] : p[0];
+    }
+  }
+  return im;
+}
+
+// 8-bit BMPs give their palette indices, as Matlab's imread does.
+Image ReadBmp(File& f)
+{
+  unsigned char h[54];
+  f.Read(h, sizeof(h));
+  long const offset = Le32(h + 10);
+  long const cols = Le32(h + 18);
+  long height = Le32(h + 22);
+  unsigned const bpp = Le16(h + 28);
+  long const compression = Le32(h + 30);
+  if (compression != 0 || (bpp != 8 && bpp != 24))
+    f.Fail("only uncompressed 8-bit and 24-bit BMP files are supported");
+  bool const top_down = (height < 0);
+  long const rows = top_down ? -height : height;
+  if (cols <= 0 || rows <= 0) f.Fail("bad BMP dimensions");
+
+  Image im((int) rows, (int) cols);
+  std::size_t const stride = (((std::size_t) cols * bpp / 8) + 3) & ~(std::size_t) 3;
+  std::vector<unsigned char> line(stride);
+  f.Seek(offset);
+  for (long y = 0; y < rows; ++y)
+  {
+    f.Read(&line[0], stride);
+    int const r = (int) (top_down ? y : rows - 1 - y);
+    for (long c = 0; c < cols; ++c)
+      if (bpp == 8) im(r, (int) c) = line[c];
+      else
+      {
+        unsigned char const* p = &line[3 * c];  // B, G, R
+        im(r, (int) c) = LUMA_R * p[2] + LUMA_G * p[1] + LUMA_B * p[0];
+      }
+  }
+  return im;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+Image ReadImage(const std::string& path)
+{
+  METRIX_TRACE_SCOPE("decode/ReadImage");
+  File f(path);
+  int const c0 = f.Getc();
+  int const c1 = f.Getc();
+  if (c0 == 'P' && c1 >= '2' && c1 <= '6' && c1 != '4')
+    return ReadPnm(f, c1 - '0');
+  if (c0 == 'B' && c1 == 'M')
+  {
+    f.Seek(0);
+    return ReadBmp(f);
+  }
+  f.Fail("unrecognized image format (PGM, PPM and BMP are supported)");
+  return Image();
+}
+//-------------------------------------------------------------------------
+
+// FNV-1a over 64-bit words, with a final avalanche (MurmurHash3's
+// fmix64) so that nearby images give unrelated hashes
+unsigned long long HashImage(const Image& im)
+{
+  unsigned long long const prime = 0x100000001b3ULL;
+  unsigned long long h = 0xcbf29ce484222325ULL;
+  h = (h ^ (unsigned long long) im.Rows()) * prime;
+  h = (h ^ (unsigned long long) im.Cols()) * prime;
+  const double* p = im.Data();
+  for (std::size_t i = 0; i < im.Size(); ++i)
+  {
+    unsigned long long bits;
+    std::memcpy(&bits, p + i, sizeof(bits));
+    h = (h ^ bits) * prime;
+  }
+  h ^= h >> 33;  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+//-------------------------------------------------------------------------
+
+bool SameImage(const Image& a, const Image& b)
+{
+  return a.Rows() == b.Rows() && a.Cols() == b.Cols() &&
+    (a.Size() == 0 || std::memcmp(a.Data(), b.Data(), a.Size() * sizeof(double)) == 0);
+}
+
+} // namespace metrix
+//=========================================================================
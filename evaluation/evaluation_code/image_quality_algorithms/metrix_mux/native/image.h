@@ -0,0 +1,57 @@
+//=========================================================================
+// image.h
+//
+// Grayscale images for the native metric engines, stored as Matlab
+// stores a double matrix: column-major, so that the row index is the
+// inner (x) index of the matlabPyrTools kernels, and a Matlab matrix
+// can be copied in or out without reordering.
+//=========================================================================
+#ifndef metrix_imageH
+#define metrix_imageH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace metrix {
+
+class Image
+{
+public:
+  Image() : rows_(0), cols_(0) {}
+  Image(int rows, int cols, double value = 0.0)
+    : rows_(rows), cols_(cols), data_((std::size_t) rows * cols, value) {}
+
+  int Rows() const { return rows_; }
+  int Cols() const { return cols_; }
+  std::size_t Size() const { return data_.size(); }
+  bool Empty() const { return data_.empty(); }
+
+  double* Data() { return data_.empty() ? 0 : &data_[0]; }
+  const double* Data() const { return data_.empty() ? 0 : &data_[0]; }
+
+  double& operator()(int r, int c) { return data_[r + (std::size_t) c * rows_]; }
+  double operator()(int r, int c) const { return data_[r + (std::size_t) c * rows_]; }
+
+private:
+  int rows_, cols_;
+  std::vector<double> data_;
+};
+//-------------------------------------------------------------------------
+
+// Reads an 8-bit binary or ASCII PGM/PPM, or an uncompressed 8-bit
+// (palette) or 24-bit BMP.  Colour images are reduced to luminance
+// with the weights of preprocess_metrix_mux.m (0.299, 0.587, 0.114).
+// Throws std::runtime_error if the file cannot be read.
+Image ReadImage(const std::string& path);
+
+// 64-bit hash of the size and sample bits of IM, for caches keyed by
+// image content.  Equal images hash alike; a cache that must not mix
+// up two images compares them (SameImage) on a hit.
+unsigned long long HashImage(const Image& im);
+
+bool SameImage(const Image& a, const Image& b);
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,203 @@
+//=========================================================================
+// imshift.cpp
+//=========================================================================
+#include "imshift.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+// The nonzeros of a row of shiftmatrix1d(N, D): output sample i is
+// sum(weight[k] * x[i + offset[k]]), for i < n
+struct Taps
+{
+  int n;
+  int count;
+  int offset[2];
+  double weight[2];
+};
+
+void AddTap(Taps& t, int offset, double weight)
+{
+  // a zero weight is not stored in the sparse shiftmatrix either
+  if (weight == 0.0) return;
+  t.offset[t.count] = offset;
+  t.weight[t.count] = weight;
+  ++t.count;
+}
+
+Taps ShiftTaps(int n, double d)
+{
+  double const a = std::fabs(d);
+  if (a > n) throw std::runtime_error("imshift: the shift is larger than the image.");
+  int const cd = (int) std::ceil(a);
+  double const w = a - cd + 1;
+  Taps t;
+  t.n = n - cd;
+  t.count = 0;
+  if (d > 0)
+  {
+    AddTap(t, cd, w);
+    AddTap(t, cd - 1, 1 - w);
+  }
+  else if (d < 0)
+  {
+    AddTap(t, 1, 1 - w);
+    AddTap(t, 0, w);
+  }
+  else
+    AddTap(t, 0, 1.0);
+  return t;
+}
+
+bool IsCopy(const Taps& t)
+{
+  return t.count == 1 && t.weight[0] == 1.0;
+}
+
+void CheckShift(double row_shift, double col_shift, ShiftBox box)
+{
+  if (!(std::fabs(row_shift) < 1e9 && std::fabs(col_shift) < 1e9))
+    throw std::runtime_error("imshift: the shift must be finite.");
+  if (box != SHIFT_CROP && (row_shift != std::floor(row_shift) || col_shift != std::floor(col_shift)))
+    throw std::runtime_error("imshift: 'same' and 'full' take whole-pixel shifts only.");
+}
+
+// 'crop': S1 * X * S2' for each plane, S1 = shiftmatrix1d(ROWS, -row
+// shift) and S2 = shiftmatrix1d(COLS, -col shift)
+void Crop(const double* x, int rows, int cols, int channels,
+          const Taps& rt, const Taps& ct, double* out)
+{
+  std::size_t const in_plane = (std::size_t) rows * cols;
+  std::size_t const out_plane = (std::size_t) rt.n * ct.n;
+  long const columns = (long) channels * ct.n;
+  OMP(omp parallel for schedule(static))
+  for (long k = 0; k < columns; ++k)
+  {
+    int const ch = (int) (k / ct.n), q = (int) (k % ct.n);
+    const double* plane = x + ch * in_plane;
+    double* o = out + ch * out_plane + (std::size_t) q * rt.n;
+    if (IsCopy(rt) && IsCopy(ct))
+    {
+      std::memcpy(o, plane + (std::size_t) (q + ct.offset[0]) * rows + rt.offset[0], rt.n * sizeof(double));
+      continue;
+    }
+    // each term of the column blend is a column of S1 * X, itself a
+    // blend of (at most) two samples, summed in shiftmatrix's order
+    for (int j = 0; j < ct.count; ++j)
+    {
+      const double* src = plane + (std::size_t) (q + ct.offset[j]) * rows;
+      double const cw = ct.weight[j];
+      for (int i = 0; i < rt.n; ++i)
+      {
+        double v = rt.weight[0] * src[i + rt.offset[0]];
+        if (rt.count == 2) v += rt.weight[1] * src[i + rt.offset[1]];
+        o[i] = (j == 0) ? cw * v : o[i] + cw * v;
+      }
+    }
+  }
+}
+
+// X, whole-pixel shifted by (ROW_SHIFT, COL_SHIFT), into OUT_ROWS x
+// OUT_COLS planes: the samples that fall inside are copied a column at
+// a time, the rest of OUT is zeroed
+void Place(const double* x, int rows, int cols, int channels, int row_shift, int col_shift,
+           int out_rows, int out_cols, double* out)
+{
+  std::size_t const in_plane = (std::size_t) rows * cols;
+  std::size_t const out_plane = (std::size_t) out_rows * out_cols;
+  int const r0 = std::max(0, -row_shift), r1 = std::min(rows, out_rows - row_shift);
+  long const columns = (long) channels * out_cols;
+  OMP(omp parallel for schedule(static))
+  for (long k = 0; k < columns; ++k)
+  {
+    int const ch = (int) (k / out_cols), q = (int) (k % out_cols);
+    double* o = out + ch * out_plane + (std::size_t) q * out_rows;
+    int const c = q - col_shift;
+    if (c < 0 || c >= cols || r1 <= r0)
+    {
+      std::memset(o, 0, out_rows * sizeof(double));
+      continue;
+    }
+    std::memset(o, 0, (r0 + row_shift) * sizeof(double));
+    std::memcpy(o + r0 + row_shift, x + ch * in_plane + (std::size_t) c * rows + r0, (r1 - r0) * sizeof(double));
+    std::memset(o + r1 + row_shift, 0, (out_rows - r1 - row_shift) * sizeof(double));
+  }
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+ShiftBox ParseShiftBox(const std::string& name)
+{
+  if (name == "crop") return SHIFT_CROP;
+  if (name == "same") return SHIFT_SAME;
+  if (name == "full") return SHIFT_FULL;
+  throw std::runtime_error("imshift: BBOX must be 'crop', 'same' or 'full'.");
+}
+
+void ShiftedSize(int rows, int cols, double row_shift, double col_shift, ShiftBox box,
+                 int& out_rows, int& out_cols)
+{
+  CheckShift(row_shift, col_shift, box);
+  if (box == SHIFT_FULL)
+  {
+    out_rows = rows + (int) std::fabs(row_shift);
+    out_cols = cols + (int) std::fabs(col_shift);
+    return;
+  }
+  // a single column is shifted along its rows only, and 'same' cannot
+  // place it anywhere else
+  bool const vector = (cols == 1);
+  if (vector && box == SHIFT_SAME && col_shift != 0)
+    throw std::runtime_error("imshift: a single column cannot be shifted across columns.");
+  out_rows = ShiftTaps(rows, -row_shift).n;
+  out_cols = vector ? cols : ShiftTaps(cols, -col_shift).n;
+  if (box == SHIFT_SAME)
+  {
+    out_rows = rows;
+    out_cols = cols;
+  }
+}
+
+void ImShift(const double* x, int rows, int cols, int channels,
+             double row_shift, double col_shift, ShiftBox box, double* out)
+{
+  METRIX_TRACE_SCOPE("shift/ImShift");
+  int out_rows, out_cols;
+  ShiftedSize(rows, cols, row_shift, col_shift, box, out_rows, out_cols);
+  if (box == SHIFT_CROP)
+  {
+    Taps const rt = ShiftTaps(rows, -row_shift);
+    Taps const ct = (cols == 1) ? ShiftTaps(1, 0.0) : ShiftTaps(cols, -col_shift);
+    Crop(x, rows, cols, channels, rt, ct, out);
+  }
+  else
+  {
+    // 'same' is the crop put back at the shift, 'full' all of X put at
+    // the positive part of the shift
+    int const rs = (int) row_shift, cs = (int) col_shift;
+    if (box == SHIFT_SAME)
+      Place(x, rows, cols, channels, rs, cs, out_rows, out_cols, out);
+    else
+      Place(x, rows, cols, channels, std::max(rs, 0), std::max(cs, 0), out_rows, out_cols, out);
+  }
+}
+
+Image ImShift(const Image& x, double row_shift, double col_shift, ShiftBox box)
+{
+  int out_rows, out_cols;
+  ShiftedSize(x.Rows(), x.Cols(), row_shift, col_shift, box, out_rows, out_cols);
+  Image out(out_rows, out_cols);
+  if (out.Size() > 0) ImShift(x.Data(), x.Rows(), x.Cols(), 1, row_shift, col_shift, box, out.Data());
+  return out;
+}
+
+} // namespace metrix
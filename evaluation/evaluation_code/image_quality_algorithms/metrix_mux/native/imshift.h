@@ -0,0 +1,51 @@
+//=========================================================================
+// imshift.h
+//
+// Image translation, as imshift.m (evaluation_code), without its
+// shiftmatrix products.  shiftmatrix1d(N, D) has at most two nonzeros
+// per row, so each output sample is a copy of one input sample
+// (whole-pixel D) or the blend of two neighbours with the weights of
+// shiftmatrix1d (sub-pixel D), applied along the columns and then
+// along the rows as imshift's S1 * X * S2' is.  A whole-pixel shift is
+// thus one memcpy per column, and any shift is O(rows * cols).
+//
+// The bounding boxes are imshift's: 'crop' keeps the part of the
+// shifted image covered by X (rows - ceil(|row shift|) by
+// cols - ceil(|col shift|)), 'same' places it back into an image the
+// size of X with zeros elsewhere, and 'full' pads X to hold the whole
+// shifted image.  'same' and 'full' take whole-pixel shifts only, as
+// in imshift.m.  A single-column image is shifted along its rows only.
+//=========================================================================
+#ifndef metrix_imshiftH
+#define metrix_imshiftH
+
+#include <string>
+
+#include "image.h"
+
+namespace metrix {
+
+enum ShiftBox { SHIFT_CROP, SHIFT_SAME, SHIFT_FULL };
+
+// 'crop', 'same' or 'full'; throws std::runtime_error otherwise
+ShiftBox ParseShiftBox(const std::string& name);
+
+// Size of imshift(X, [ROW_SHIFT COL_SHIFT], BOX) for a ROWS x COLS X;
+// throws std::runtime_error if the shift is not finite, is larger
+// than the image ('crop', 'same'), or is not whole-pixel ('same',
+// 'full').
+void ShiftedSize(int rows, int cols, double row_shift, double col_shift, ShiftBox box,
+                 int& out_rows, int& out_cols);
+
+// imshift(X, [ROW_SHIFT COL_SHIFT], BOX) of the CHANNELS column-major
+// ROWS x COLS planes of X, stored one after the other as in a Matlab
+// ROWS x COLS x CHANNELS array, into OUT (ShiftedSize planes, same
+// layout).  X and OUT must not overlap.
+void ImShift(const double* x, int rows, int cols, int channels,
+             double row_shift, double col_shift, ShiftBox box, double* out);
+
+Image ImShift(const Image& x, double row_shift, double col_shift, ShiftBox box = SHIFT_CROP);
+
+} // namespace metrix
+//=========================================================================
+#endif
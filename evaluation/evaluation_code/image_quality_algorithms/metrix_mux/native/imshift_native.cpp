@@ -0,0 +1,100 @@
+//=========================================================================
+// imshift_native.cpp
+//
+// XS = imshift_native(X, T, BBOX)
+//
+// Matlab interface to the native image translation (imshift.h):
+// imshift(X, T, BBOX) (evaluation_code) for a real 2D matrix or
+// ROWS x COLS x CHANNELS array X (double, single or uint8), all
+// channels in one call.  T is [row_shift col_shift] (a scalar shifts
+// the rows only), BBOX 'crop' (default), 'same' or 'full'; 'same' and
+// 'full' take whole-pixel shifts.  XS is double, as imshift returns.
+// Built by metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+#include <vector>
+
+#include "imshift.h"
+#include "mexutil.h"
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs < 2 || nrhs > 3) mexErrMsgIdAndTxt("metrix:imshift_native", "requires 2 or 3 arguments.");
+  if (nlhs > 1) mexErrMsgIdAndTxt("metrix:imshift_native", "returns 1 value.");
+  const mxArray* x = prhs[0];
+  if (mxIsComplex(x) || mxIsSparse(x) || mxGetNumberOfDimensions(x) > 3 ||
+      !(mxIsDouble(x) || mxIsSingle(x) || mxIsUint8(x)))
+    mexErrMsgIdAndTxt("metrix:imshift_native", "X must be a real 2D or 3D double, single or uint8 array.");
+  if (!mxIsDouble(prhs[1]) || mxIsComplex(prhs[1]) ||
+      mxGetNumberOfElements(prhs[1]) < 1 || mxGetNumberOfElements(prhs[1]) > 2)
+    mexErrMsgIdAndTxt("metrix:imshift_native", "T must be a real double 2-element vector.");
+  char box_name[8] = "crop";
+  if (nrhs == 3 && mxGetNumberOfElements(prhs[2]) > 0 &&
+      (!mxIsChar(prhs[2]) || mxGetString(prhs[2], box_name, sizeof(box_name)) != 0))
+    mexErrMsgIdAndTxt("metrix:imshift_native", "BBOX must be 'crop', 'same' or 'full'.");
+
+  const mwSize* dims = mxGetDimensions(x);
+  int const rows = (int) dims[0], cols = (int) dims[1];
+  int const channels = (mxGetNumberOfDimensions(x) == 3) ? (int) dims[2] : 1;
+  double const* t = mxGetPr(prhs[1]);
+  double const row_shift = t[0];
+  double const col_shift = (mxGetNumberOfElements(prhs[1]) == 2) ? t[1] : 0.0;
+
+  // validate and size the result before it is allocated
+  metrix::ShiftBox box = metrix::SHIFT_CROP;
+  int out_rows = 0, out_cols = 0;
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      box = metrix::ParseShiftBox(box_name);
+      metrix::ShiftedSize(rows, cols, row_shift, col_shift, box, out_rows, out_cols);
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:imshift_native", "%s", msg);
+
+  mwSize out_dims[3] = { (mwSize) out_rows, (mwSize) out_cols, (mwSize) channels };
+  plhs[0] = mxCreateNumericArray(channels > 1 ? 3 : 2, out_dims, mxDOUBLE_CLASS, mxREAL);
+  if (out_rows == 0 || out_cols == 0 || channels == 0) return;
+  double* out = mxGetPr(plhs[0]);
+  if (mxIsDouble(x))
+  {
+    metrix::ImShift(mxGetPr(x), rows, cols, channels, row_shift, col_shift, box, out);
+    return;
+  }
+  {
+    try
+    {
+      std::size_t const n = (std::size_t) rows * cols * channels;
+      std::vector<double> xd(n);
+      if (mxIsSingle(x))
+      {
+        const float* src = (const float*) mxGetData(x);
+        for (std::size_t i = 0; i < n; ++i) xd[i] = src[i];
+      }
+      else
+      {
+        const unsigned char* src = (const unsigned char*) mxGetData(x);
+        for (std::size_t i = 0; i < n; ++i) xd[i] = src[i];
+      }
+      metrix::ImShift(&xd[0], rows, cols, channels, row_shift, col_shift, box, out);
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed)
+  {
+    mxDestroyArray(plhs[0]);
+    mexErrMsgIdAndTxt("metrix:imshift_native", "%s", msg);
+  }
+}
@@ -0,0 +1,509 @@
+//=========================================================================
+// mad.cpp
+//=========================================================================
+#include "mad.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// hi_index: luminance k*pixel^(2.2/3), and the masking parameters
+const double LUM_K = 0.02874;
+const double LUM_POWER = 2.2 / 3.0;
+const double LUM_THRESHOLD = 0.5;   // G
+const double C_SLOPE = 1.0;
+const double CI_THRESHOLD = -5.0;
+const double CD_THRESHOLD = -5.0;
+const double MS_SCALE = 1.0;
+const double HI_SCALE = 200.0;
+
+// make_csf(M, N, 32): wsnr.m's CSF on a half-bin grid
+const double CSF_NFREQ = 32.0;
+const double CSF_SYMMETRY = 0.7;
+const double CSF_FLAT_BELOW = 7.8909;
+const double CSF_PEAK = 0.9809;
+
+// gaborconvolve: wavelengths 3*3^s, sigmaOnf 0.55, dThetaOnSigma 1.5
+const double MIN_WAVELENGTH = 3.0;
+const double WAVELENGTH_MULT = 3.0;
+const double SIGMA_ON_F = 0.55;
+const double D_THETA_ON_SIGMA = 1.5;
+
+// lo_index's weights of the scales (normalized to sum 1)
+const double SCALE_WEIGHT[MAD_SCALES] = {0.5, 0.75, 1.0, 5.0, 6.0};
+
+// the sigmoid blend of MAD_index.m (thresh1, thresh2)
+const double BLEND_T1 = 2.55;
+const double BLEND_T2 = 3.35;
+
+// ical_std/ical_stat blocks: BLOCK x BLOCK, every TILE pixels; the
+// maps are cropped by BORDER (MAD_index.m's BSIZE+1:end-BSIZE-1)
+const int TILE = 4;
+const int TILES_PER_BLOCK = 4;
+const int BLOCK = TILE * TILES_PER_BLOCK;
+const int BORDER = 16;
+const int MIN_SIZE = 2 * BORDER + 2;
+
+const int STATS = 3;        // std, skewness, kurtosis
+const int MOMENTS = 4;      // per tile: mean, central sums of powers 2..4
+
+struct RealPart
+{
+  double operator()(const Complex& z) const { return z.real(); }
+};
+
+struct Magnitude
+{
+  double operator()(const Complex& z) const { return std::sqrt(std::norm(z)); }
+};
+
+// The mean and the central sums of squares, cubes and fourth powers of
+// VALUE(DATA) over each 4x4 tile of a TROWS x TCOLS grid (column-major,
+// ROWS rows), into OUT.  Blocks are merged from these, so each pixel
+// is read once however much the blocks overlap.
+template <class Value>
+void TileMoments(const Complex* data, int rows, int trows, int tcols, Value value, double* out)
+{
+  OMP(omp parallel for schedule(static))
+  for (int b = 0; b < tcols; ++b)
+  {
+    for (int a = 0; a < trows; ++a)
+    {
+      double v[TILE * TILE];
+      double s = 0.0;
+      for (int j = 0; j < TILE; ++j)
+      {
+        const Complex* col = data + (std::size_t) (b * TILE + j) * rows + a * TILE;
+        for (int i = 0; i < TILE; ++i)
+        {
+          v[j * TILE + i] = value(col[i]);
+          s += v[j * TILE + i];
+        }
+      }
+      double const m = s / (TILE * TILE);
+      double s2 = 0.0, s3 = 0.0, s4 = 0.0;
+      for (int i = 0; i < TILE * TILE; ++i)
+      {
+        double const d = v[i] - m, d2 = d * d;
+        s2 += d2;
+        s3 += d2 * d;
+        s4 += d2 * d2;
+      }
+      double* o = out + ((std::size_t) b * trows + a) * MOMENTS;
+      o[0] = m;
+      o[1] = s2;
+      o[2] = s3;
+      o[3] = s4;
+    }
+  }
+}
+
+// The central moments of the union of N x N tiles from (A, B) of a
+// grid of TROWS rows: mean, and sums of powers 2..4 about it (the
+// pairwise update of Chan et al.; all tiles have 16 pixels).
+void MergeTiles(const double* tiles, int trows, int a, int b, int n, double res[MOMENTS])
+{
+  double m = 0.0;
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < n; ++i) m += tiles[((std::size_t) (b + j) * trows + a + i) * MOMENTS];
+  m /= n * n;
+
+  double const c = TILE * TILE;
+  double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < n; ++i)
+    {
+      const double* t = tiles + ((std::size_t) (b + j) * trows + a + i) * MOMENTS;
+      double const d = t[0] - m, d2 = d * d;
+      m2 += t[1] + c * d2;
+      m3 += t[2] + 3.0 * d * t[1] + c * d2 * d;
+      m4 += t[3] + 4.0 * d * t[2] + 6.0 * d2 * t[1] + c * d2 * d2;
+    }
+  res[0] = m;
+  res[1] = m2;
+  res[2] = m3;
+  res[3] = m4;
+}
+
+// Matlab's std, skewness and kurtosis of the block with moments MOM
+void BlockStats(const double mom[MOMENTS], double* stats)
+{
+  double const n = BLOCK * BLOCK;
+  stats[0] = std::sqrt(mom[1] / (n - 1.0));
+  if (mom[1] > 0.0)
+  {
+    double const v = mom[1] / n;
+    stats[1] = (mom[2] / n) / (v * std::sqrt(v));
+    stats[2] = (mom[3] / n) / (v * v);
+  }
+  else
+    stats[1] = stats[2] = 0.0;
+}
+
+// Pixels of tile I (rows 4I..4I+3) inside the cropped map of N rows
+int CroppedCount(int i, int n)
+{
+  int const lo = std::max(i * TILE, BORDER), hi = std::min(i * TILE + TILE, n - BORDER - 1);
+  return std::max(hi - lo, 0);
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+MadPlan::MadPlan(int rows, int cols)
+  : fft_(rows, cols)
+{
+  if (rows < MIN_SIZE || cols < MIN_SIZE)
+    throw std::runtime_error("MadPlan: images must be at least 34x34");
+  tile_rows_ = (rows - BLOCK) / TILE + 1;
+  tile_cols_ = (cols - BLOCK) / TILE + 1;
+
+  std::size_t const n = (std::size_t) rows * cols;
+
+  // make_csf(M, N, 32)' at the bins of the unshifted spectrum
+  // (fftshift moves bin k to k + floor(n/2)), then averaged with its
+  // mirror image: real(ifft2(F.*W)) is ifft2 of F times that average
+  std::vector<double> w(n);
+  for (int c = 0; c < cols; ++c)
+  {
+    double const yp = -cols / 2.0 + 0.5 + (c + cols / 2) % cols;
+    for (int r = 0; r < rows; ++r)
+    {
+      double const xp = -rows / 2.0 + 0.5 + (r + rows / 2) % rows;
+      double const re = xp / cols * 2.0 * CSF_NFREQ;
+      double const im = yp / cols * 2.0 * CSF_NFREQ;
+      double const s = (1.0 - CSF_SYMMETRY) / 2.0 * std::cos(4.0 * std::atan2(im, re)) + (1.0 + CSF_SYMMETRY) / 2.0;
+      double const f = std::hypot(re, im) / s;
+      w[r + (std::size_t) c * rows] = (f < CSF_FLAT_BELOW) ? CSF_PEAK
+        : 2.6 * (0.0192 + 0.114 * f) * std::exp(-std::pow(0.114 * f, 1.1));
+    }
+  }
+  csf_.resize(n);
+  for (int c = 0; c < cols; ++c)
+    for (int r = 0; r < rows; ++r)
+      csf_[r + (std::size_t) c * rows] =
+        0.5 * (w[r + (std::size_t) c * rows] + w[(rows - r) % rows + (std::size_t) ((cols - c) % cols) * rows]);
+
+  // gaborconvolve's filters on its centered grid (normalized radius
+  // and polar angle, with the centre's radius taken as 1), at the bins
+  // of the unshifted spectrum (fftshift moves bin k to k + ceil(n/2))
+  radial_.resize(MAD_SCALES * n);
+  spread_.resize(MAD_ORIENTS * n);
+  int const center_r = (int) std::floor(rows / 2.0 + 1.5) - 1;   // round(rows/2 + 1)
+  int const center_c = (int) std::floor(cols / 2.0 + 1.5) - 1;
+  double const theta_sigma = PI / MAD_ORIENTS / D_THETA_ON_SIGMA;
+  double const log_sigma = -(2.0 * std::log(SIGMA_ON_F) * std::log(SIGMA_ON_F));
+  for (int c = 0; c < cols; ++c)
+  {
+    int const ic = (c + (cols + 1) / 2) % cols;
+    double const x = (-cols / 2.0 + ic) / (cols / 2.0);
+    for (int r = 0; r < rows; ++r)
+    {
+      int const ir = (r + (rows + 1) / 2) % rows;
+      double const y = (-rows / 2.0 + ir) / (rows / 2.0);
+      bool const center = (ir == center_r && ic == center_c);
+      double const lr = center ? 0.0 : std::log(std::sqrt(x * x + y * y));
+      double const theta = std::atan2(-y, x);
+      double const st = std::sin(theta), ct = std::cos(theta);
+      std::size_t const k = r + (std::size_t) c * rows;
+
+      double wavelength = MIN_WAVELENGTH;
+      for (int s = 0; s < MAD_SCALES; ++s, wavelength *= WAVELENGTH_MULT)
+      {
+        double const d = lr - std::log((1.0 / wavelength) / 0.5);
+        radial_[s * n + k] = center ? 0.0 : std::exp(d * d / log_sigma);
+      }
+      for (int o = 0; o < MAD_ORIENTS; ++o)
+      {
+        double const angle = o * PI / MAD_ORIENTS;
+        double const ds = st * std::cos(angle) - ct * std::sin(angle);
+        double const dc = ct * std::cos(angle) + st * std::sin(angle);
+        double const dtheta = std::fabs(std::atan2(ds, dc));
+        spread_[o * n + k] = std::exp(-dtheta * dtheta / (2.0 * theta_sigma * theta_sigma));
+      }
+    }
+  }
+
+  spec_.resize(n);
+  work_.resize(n);
+  moments_.resize((std::size_t) (tile_rows_ + TILES_PER_BLOCK - 1) * (tile_cols_ + TILES_PER_BLOCK - 1) * MOMENTS);
+  lum_.resize(n);
+}
+//-------------------------------------------------------------------------
+
+void MadPlan::Transform(const double* re, const double* im)
+{
+  int const rows = Rows(), cols = Cols();
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    std::size_t const o = (std::size_t) c * rows;
+    for (int r = 0; r < rows; ++r) work_[o + r] = Complex(re[o + r], im[o + r]);
+  }
+  fft_.Forward(&work_[0]);
+
+  // fft2(re) = (Z(k) + Z*(-k))/2, and fft2(im) = (Z(k) - fft2(re))/i
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    const Complex* zn = &work_[(std::size_t) ((cols - c) % cols) * rows];
+    Complex* sp = &spec_[(std::size_t) c * rows];
+    for (int r = 0; r < rows; ++r)
+      sp[r] = 0.5 * (work_[(std::size_t) c * rows + r] + std::conj(zn[(rows - r) % rows]));
+  }
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    std::size_t const o = (std::size_t) c * rows;
+    for (int r = 0; r < rows; ++r)
+    {
+      Complex const d = work_[o + r] - spec_[o + r];
+      work_[o + r] = csf_[o + r] * Complex(d.imag(), -d.real());
+    }
+  }
+  fft_.Inverse(&work_[0]);
+}
+//-------------------------------------------------------------------------
+
+void MadPlan::Band(int s, int o)
+{
+  int const rows = Rows(), cols = Cols();
+  std::size_t const n = (std::size_t) rows * cols;
+  const double* rad = &radial_[s * n];
+  const double* spr = &spread_[o * n];
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    std::size_t const k0 = (std::size_t) c * rows;
+    for (int r = 0; r < rows; ++r) work_[k0 + r] = spec_[k0 + r] * (rad[k0 + r] * spr[k0 + r]);
+  }
+  fft_.Inverse(&work_[0]);
+}
+//-------------------------------------------------------------------------
+
+MadReference::MadReference(MadPlan& plan, const Image& ref)
+  : ref_(ref)
+{
+  METRIX_TRACE_SCOPE("eval/MadReference");
+  int const rows = plan.Rows();
+  if (ref.Rows() != rows || ref.Cols() != plan.Cols())
+    throw std::runtime_error("MadReference: image size differs from the plan's");
+
+  std::size_t const n = ref.Size();
+  const double* x = ref.Data();
+  lum_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) lum_[i] = LUM_K * std::pow(x[i], LUM_POWER);
+
+  // hi_index: mean and stdmod of the CSF-filtered luminance
+  int const trows = plan.tile_rows_, tcols = plan.tile_cols_;
+  int const grid = trows + TILES_PER_BLOCK - 1;
+  std::size_t const tiles = (std::size_t) trows * tcols;
+  plan.Transform(x, &lum_[0]);
+  double* mom = &plan.moments_[0];
+  TileMoments(&plan.work_[0], rows, grid, tcols + TILES_PER_BLOCK - 1, RealPart(), mom);
+  mean_.resize(tiles);
+  std_mod_.resize(tiles);
+  OMP(omp parallel for schedule(static))
+  for (int b = 0; b < tcols; ++b)
+    for (int a = 0; a < trows; ++a)
+    {
+      double blk[MOMENTS];
+      MergeTiles(mom, grid, a, b, TILES_PER_BLOCK, blk);
+      double sd = std::numeric_limits<double>::infinity();
+      int const half = TILES_PER_BLOCK / 2;
+      for (int q = 0; q < 4; ++q)
+      {
+        double quad[MOMENTS];
+        MergeTiles(mom, grid, a + (q % 2) * half, b + (q / 2) * half, half, quad);
+        sd = std::min(sd, std::sqrt(quad[1] / (BLOCK * BLOCK / 4 - 1.0)));
+      }
+      mean_[a + (std::size_t) b * trows] = blk[0];
+      std_mod_[a + (std::size_t) b * trows] = sd;
+    }
+
+  // lo_index: statistics of each Gabor band's magnitude
+  stats_.resize(MAD_SCALES * MAD_ORIENTS * tiles * STATS);
+  for (int s = 0; s < MAD_SCALES; ++s)
+    for (int o = 0; o < MAD_ORIENTS; ++o)
+    {
+      plan.Band(s, o);
+      TileMoments(&plan.work_[0], rows, grid, tcols + TILES_PER_BLOCK - 1, Magnitude(), mom);
+      double* st = &stats_[(s * MAD_ORIENTS + o) * tiles * STATS];
+      OMP(omp parallel for schedule(static))
+      for (int b = 0; b < tcols; ++b)
+        for (int a = 0; a < trows; ++a)
+        {
+          double blk[MOMENTS];
+          MergeTiles(mom, grid, a, b, TILES_PER_BLOCK, blk);
+          BlockStats(blk, st + (a + (std::size_t) b * trows) * STATS);
+        }
+    }
+}
+//-------------------------------------------------------------------------
+
+MadScores MadPlan::Score(const MadReference& ref, const Image& dist)
+{
+  METRIX_TRACE_SCOPE("eval/MadPlan::Score");
+  int const rows = Rows(), cols = Cols();
+  if (ref.ref_.Rows() != rows || ref.ref_.Cols() != cols || dist.Rows() != rows || dist.Cols() != cols)
+    throw std::runtime_error("MadPlan: image size differs from the plan's");
+
+  int const trows = tile_rows_, tcols = tile_cols_;
+  int const grid = trows + TILES_PER_BLOCK - 1, grid_cols = tcols + TILES_PER_BLOCK - 1;
+  std::size_t const tiles = (std::size_t) trows * tcols;
+  const double* x = ref.ref_.Data();
+  const double* y = dist.Data();
+  double* mom = &moments_[0];
+
+  // hi_index: the masking map from the CSF-filtered luminance error
+  // (dst - ref in MAD_index.m, by linearity one filtering here)
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    std::size_t const o = (std::size_t) c * rows;
+    for (int r = 0; r < rows; ++r) lum_[o + r] = LUM_K * std::pow(y[o + r], LUM_POWER) - ref.lum_[o + r];
+  }
+  Transform(y, &lum_[0]);
+  TileMoments(&work_[0], rows, grid, grid_cols, RealPart(), mom);
+  std::vector<double> msk(tiles);
+  OMP(omp parallel for schedule(static))
+  for (int b = 0; b < tcols; ++b)
+    for (int a = 0; a < trows; ++a)
+    {
+      std::size_t const t = a + (std::size_t) b * trows;
+      double blk[MOMENTS];
+      MergeTiles(mom, grid, a, b, TILES_PER_BLOCK, blk);
+      double const m1 = ref.mean_[t];
+      double const ci_ref = std::log(ref.std_mod_[t] / m1);
+      double const ci_dst = (m1 < LUM_THRESHOLD) ? -std::numeric_limits<double>::infinity()
+        : std::log(std::sqrt(blk[1] / (BLOCK * BLOCK - 1.0)) / m1);
+      double const edge = C_SLOPE * (ci_ref - CI_THRESHOLD) + CD_THRESHOLD;
+      double m = 0.0;
+      if (ci_ref > CI_THRESHOLD && ci_dst > edge)
+        m = (ci_dst - edge) / MS_SCALE;
+      else if (ci_ref <= CI_THRESHOLD && ci_dst > CD_THRESHOLD)
+        m = (ci_dst - CD_THRESHOLD) / MS_SCALE;
+      msk[t] = m;
+    }
+
+  // the local MSE (filter2 of a 16x16 box, 'same': rows r-7..r+8),
+  // weighted by the mask, over the cropped map; lum_ holds the sums
+  // down the columns
+  int const half = BLOCK / 2;
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    std::size_t const o = (std::size_t) c * rows;
+    for (int r = 0; r < rows; ++r)
+    {
+      double s = 0.0;
+      int const hi = std::min(r + half, rows - 1);
+      for (int i = std::max(r - half + 1, 0); i <= hi; ++i)
+      {
+        double const d = x[o + i] - y[o + i];
+        s += d * d;
+      }
+      lum_[o + r] = s;
+    }
+  }
+  std::vector<double> col_sum(cols, 0.0);
+  OMP(omp parallel for schedule(static))
+  for (int c = BORDER; c < cols - BORDER - 1; ++c)
+  {
+    int const lo = std::max(c - half + 1, 0), hi = std::min(c + half, cols - 1);
+    const double* m = &msk[(std::size_t) (c / TILE) * trows];
+    double sum = 0.0;
+    for (int r = BORDER; r < rows - BORDER - 1; ++r)
+    {
+      double s = 0.0;
+      for (int j = lo; j <= hi; ++j) s += lum_[(std::size_t) j * rows + r];
+      double const v = m[r / TILE] * (s / (BLOCK * BLOCK));
+      sum += v * v;
+    }
+    col_sum[c] = sum;
+  }
+  double const count = (double) (rows - 2 * BORDER - 1) * (cols - 2 * BORDER - 1);
+  double sum = 0.0;
+  for (int c = 0; c < cols; ++c) sum += col_sum[c];
+
+  MadScores res;
+  res.hi = std::sqrt(sum / count) * HI_SCALE;
+
+  // lo_index: the weighted differences of the Gabor band statistics,
+  // per tile (they are constant over each); equal images give 0
+  double lo = 0.0;
+  if (!SameImage(ref.ref_, dist))
+  {
+    double wsum = 0.0;
+    for (int s = 0; s < MAD_SCALES; ++s) wsum += SCALE_WEIGHT[s];
+    std::vector<double> mp(tiles, 0.0);
+    for (int s = 0; s < MAD_SCALES; ++s)
+      for (int o = 0; o < MAD_ORIENTS; ++o)
+      {
+        Band(s, o);
+        TileMoments(&work_[0], rows, grid, grid_cols, Magnitude(), mom);
+        const double* st = &ref.stats_[(s * MAD_ORIENTS + o) * tiles * STATS];
+        double const wt = SCALE_WEIGHT[s] / wsum;
+        OMP(omp parallel for schedule(static))
+        for (int b = 0; b < tcols; ++b)
+          for (int a = 0; a < trows; ++a)
+          {
+            std::size_t const t = a + (std::size_t) b * trows;
+            double blk[MOMENTS], d[STATS];
+            MergeTiles(mom, grid, a, b, TILES_PER_BLOCK, blk);
+            BlockStats(blk, d);
+            const double* r = st + t * STATS;
+            mp[t] += wt * (std::fabs(r[0] - d[0]) + 2.0 * std::fabs(r[1] - d[1]) + std::fabs(r[2] - d[2]));
+          }
+      }
+    std::vector<double> col(tcols, 0.0);
+    OMP(omp parallel for schedule(static))
+    for (int b = 0; b < tcols; ++b)
+    {
+      int const nc = CroppedCount(b, cols);
+      double s = 0.0;
+      for (int a = 0; a < trows; ++a)
+      {
+        double const v = mp[a + (std::size_t) b * trows];
+        s += v * v * (double) (CroppedCount(a, rows) * nc);
+      }
+      col[b] = s;
+    }
+    for (int b = 0; b < tcols; ++b) lo += col[b];
+    lo = std::sqrt(lo / count);
+  }
+  res.lo = lo;
+
+  double const b1 = std::exp(-BLEND_T1 / BLEND_T2);
+  double const b2 = 1.0 / (std::log(10.0) * BLEND_T2);
+  res.sig = 1.0 / (1.0 + b1 * std::pow(res.hi, b2));
+  res.mad = std::pow(res.lo, 1.0 - res.sig) * std::pow(res.hi, res.sig);
+  return res;
+}
+//-------------------------------------------------------------------------
+
+MadScores MadPlan::Score(const Image& ref, const Image& dist)
+{
+  return Score(MadReference(*this, ref), dist);
+}
+//-------------------------------------------------------------------------
+
+MadScores Mad(const Image& ref, const Image& dist)
+{
+  if (ref.Rows() != dist.Rows() || ref.Cols() != dist.Cols())
+    throw std::runtime_error("Mad: images differ in size");
+  MadPlan plan(ref.Rows(), ref.Cols());
+  return plan.Score(ref, dist);
+}
+
+} // namespace metrix
+//=========================================================================
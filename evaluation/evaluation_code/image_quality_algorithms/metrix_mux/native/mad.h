@@ -0,0 +1,118 @@
+//=========================================================================
+// mad.h
+//
+// Most apparent distortion, as MAD_index.m (evaluation_code): the
+// high-quality index (hi_index: CSF-filtered luminance, local contrast
+// masking of the local MSE), the low-quality index (lo_index: local
+// statistics of the magnitudes of a log-Gabor decomposition,
+// gaborconvolve), and their sigmoid blend.
+//
+// MAD_index.m takes its local statistics from the ical_std and
+// ical_stat MEX functions, whose sources are not in this tree.  They
+// follow the original MAD code: 16x16 blocks at a step of 4 pixels,
+// each block's statistics filling the 4x4 tile at its top-left corner
+// (the pixels beyond the last block are 0 and lie outside the cropped
+// maps).  ical_std(ERR, REF) gives the standard deviation of ERR, the
+// smallest standard deviation of REF's four 8x8 quadrants (stdmod in
+// MAD_index.m) and the mean of REF; ical_stat(X) the standard
+// deviation, skewness and kurtosis of X.  Standard deviations are
+// Matlab's std (normalized by N-1), skewness and kurtosis those of
+// Matlab's skewness and kurtosis (0 for a constant block).
+//
+// Everything that depends only on the image size is in a MadPlan: the
+// CSF of hi_index, the 5 radial and 4 angular factors of the 20
+// log-Gabor filters, the FFT plans and the buffers.  Everything that
+// depends only on the reference is in a MadReference: its luminance,
+// the block statistics of its CSF-filtered luminance and of its 20
+// Gabor bands.  Per distorted image, one forward FFT of
+// dist + i*(luminance error) gives the spectra of both, then one
+// inverse FFT gives the CSF-filtered error and 20 more the Gabor bands
+// of dist; the FFTs and the block statistics are multithreaded.
+//=========================================================================
+#ifndef metrix_madH
+#define metrix_madH
+
+#include <cstddef>
+#include <vector>
+
+#include "fft.h"
+#include "image.h"
+
+namespace metrix {
+
+const int MAD_SCALES = 5;    // gaborconvolve's nscale
+const int MAD_ORIENTS = 4;   // and norient
+
+struct MadScores
+{
+  double mad;   // LO^(1-sig) * HI^sig
+  double hi;    // high-quality (detection) index
+  double lo;    // low-quality (appearance) index
+  double sig;   // blending weight of HI
+};
+
+class MadReference;
+
+class MadPlan
+{
+public:
+  // Throws std::runtime_error if ROWS or COLS is below 34 (MAD_index.m
+  // crops 17 pixels from each side of its maps) or the FFT plans
+  // cannot be made.
+  MadPlan(int rows, int cols);
+
+  int Rows() const { return fft_.Rows(); }
+  int Cols() const { return fft_.Cols(); }
+
+  // Throws std::runtime_error unless REF and DIST are ROWS x COLS.
+  // Pixel values are 0..255 (the luminance is k*pixel^(2.2/3)).
+  // Not thread-safe: the plan holds the FFT scratch and buffers.
+  MadScores Score(const MadReference& ref, const Image& dist);
+  MadScores Score(const Image& ref, const Image& dist);
+
+private:
+  friend class MadReference;
+
+  // fft2(RE) into spec_, and the CSF-filtered IM (real) into work_
+  void Transform(const double* re, const double* im);
+  // Gabor band (S, O) of spec_'s image, into work_
+  void Band(int s, int o);
+
+  Fft2d fft_;
+  int tile_rows_, tile_cols_;         // 4x4 tiles with a 16x16 block
+
+  std::vector<double> csf_;           // hi_index's CSF, made real-symmetric
+  std::vector<double> radial_;        // log-Gabor radial factors, by scale
+  std::vector<double> spread_;        // angular factors, by orientation
+
+  std::vector<Complex> spec_;         // fft2 of the image analyzed
+  std::vector<Complex> work_;         // a filtered image
+  std::vector<double> moments_;       // block statistics scratch
+  std::vector<double> lum_;           // luminance error of a distorted image
+};
+//-------------------------------------------------------------------------
+
+class MadReference
+{
+public:
+  // Throws std::runtime_error unless REF is the size of PLAN.
+  MadReference(MadPlan& plan, const Image& ref);
+
+  const Image& Reference() const { return ref_; }
+
+private:
+  friend class MadPlan;
+
+  Image ref_;
+  std::vector<double> lum_;           // k*ref^(2.2/3)
+  std::vector<double> mean_;          // ical_std's m1_1, per tile
+  std::vector<double> std_mod_;       // and std_1
+  std::vector<double> stats_;         // std, skewness, kurtosis per band and tile
+};
+//-------------------------------------------------------------------------
+
+MadScores Mad(const Image& ref, const Image& dist);
+
+} // namespace metrix
+//=========================================================================
+#endif
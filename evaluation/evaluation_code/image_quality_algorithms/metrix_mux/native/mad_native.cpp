@@ -0,0 +1,85 @@
+//=========================================================================
+// mad_native.cpp
+//
+// [MAD, HI, LO, SIG] = mad_native(REF, DST)
+// mad_native('clear')
+//
+// Matlab interface to the native MAD engine (mad.h): the MAD, HI, LO
+// and sig fields of MAD_index(REF, DST) (evaluation_code) for grayscale
+// images.  REF and DST are real 2D matrices of the same size (double,
+// single or uint8), at least 34x34, with pixel values 0..255.
+//
+// The plan for the last image size (CSF, log-Gabor filters, FFT plans
+// and buffers) and the analysis of the last reference are kept between
+// calls, so scoring many distorted images against one reference
+// filters the reference once.  mad_native('clear') frees both.  Built
+// by metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+
+#include "mad.h"
+#include "mexutil.h"
+
+namespace {
+
+metrix::MadPlan* plan = 0;
+metrix::MadReference* reference = 0;
+
+void FreePlan()
+{
+  delete reference;
+  reference = 0;
+  delete plan;
+  plan = 0;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs == 1 && mxIsChar(prhs[0]))
+  {
+    FreePlan();
+    return;
+  }
+  if (nrhs != 2) mexErrMsgIdAndTxt("metrix:mad_native", "requires 2 arguments.");
+  if (nlhs > 4) mexErrMsgIdAndTxt("metrix:mad_native", "too many output arguments.");
+
+  metrix::MadScores res = metrix::MadScores();
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      metrix::Image const ref = metrix::ImageArg(prhs[0], "REF");
+      metrix::Image const dst = metrix::ImageArg(prhs[1], "DST");
+      if (ref.Rows() != dst.Rows() || ref.Cols() != dst.Cols())
+        throw std::runtime_error("REF and DST differ in size.");
+      if (!plan || plan->Rows() != ref.Rows() || plan->Cols() != ref.Cols())
+      {
+        if (!plan) mexAtExit(FreePlan);
+        FreePlan();
+        plan = new metrix::MadPlan(ref.Rows(), ref.Cols());
+      }
+      if (!reference || !metrix::SameImage(reference->Reference(), ref))
+      {
+        delete reference;
+        reference = 0;
+        reference = new metrix::MadReference(*plan, ref);
+      }
+      res = plan->Score(*reference, dst);
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:mad_native", "%s", msg);
+  plhs[0] = mxCreateDoubleScalar(res.mad);
+  if (nlhs > 1) plhs[1] = mxCreateDoubleScalar(res.hi);
+  if (nlhs > 2) plhs[2] = mxCreateDoubleScalar(res.lo);
+  if (nlhs > 3) plhs[3] = mxCreateDoubleScalar(res.sig);
+}
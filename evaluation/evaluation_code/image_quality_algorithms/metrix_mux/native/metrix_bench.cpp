@@ -0,0 +1,948 @@
+//=========================================================================
+// metrix_bench.cpp
+//
+// metrix_bench [-s SIZES] [-t THREADS] [-b FILTER] [-r REPETITIONS]
+//              [-m MIN_TIME] [-i IMAGE] [-o JSON] [-l]
+//
+// Times the kernels under the metrics: GWavelift's Decompose and
+// Reconstruct (VSNR's DWT), the matlabPyrTools MEX functions corrDn and
+// upConv (each edge mode, double and single), histo, innerProd and
+// pointOp, run through their mexFunctions as Matlab calls them
+// (mexhost/), and the native engines, one benchmark per frame size
+// (SIZES, comma-separated: 720p, 1080p, 4k or ROWSxCOLS; default all
+// three named ones) and frame.  The frames are fixed: a synthetic
+// pattern, and with IMAGE a real image mirrored to the size, each with
+// a distorted copy (blur and noise) for the metrics of a pair.  The
+// OpenMP kernels run at each of THREADS (comma-separated; default 1, 2,
+// 4, ... up to the cores), the others with one thread.
+//
+// Each benchmark is repeated until it has run MIN_TIME seconds
+// (default 0.5), REPETITIONS times (default 1); CPU time is the
+// process's, all threads.  A table goes to stdout; JSON (the layout of Google Benchmark's --benchmark_out, so
+// its compare.py reads it) to the file JSON.  FILTER (comma-separated)
+// runs only the benchmarks whose names contain one of its parts; -l
+// lists the names without running them.
+//=========================================================================
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "dftreg.h"
+#include "fused.h"
+#include "ifc.h"
+#include "image.h"
+#include "imshift.h"
+#include "mad.h"
+#include "mssim.h"
+#include "nqm.h"
+#include "parallel.h"
+#include "vif.h"
+#include "vsnr.h"
+
+#define GBUFFER_NO_RANGE_CHECK
+#include "ginclude/gwavelift.h"
+
+#include "mexhost/mex.h"
+
+// the matlabPyrTools mexFunctions, renamed when compiled (see Makefile)
+extern "C" {
+void corrDn_mex(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]);
+void upConv_mex(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]);
+void histo_mex(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]);
+void innerProd_mex(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]);
+void pointOp_mex(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]);
+}
+
+namespace {
+
+using metrix::Image;
+
+const long MAX_ITERATIONS = 1000000000L;
+const int DWT_LEVELS = 5;          // VsnrOptions' num_levels
+const int INNER_PROD_COLS = 16;    // innerProd's matrix: the frame as N x 16
+const int HISTO_BINS = 256;
+
+// corrDn.c's edge modes ('circular' by wrap.c)
+const char* const EDGES[] = {"circular", "reflect1", "reflect2", "qreflect2", "repeat",
+                             "zero", "extend", "ereflect", "dont-compute"};
+const int NUM_EDGES = sizeof(EDGES) / sizeof(EDGES[0]);
+
+typedef buf::GDoubleWaveList bands_type;
+typedef wavlet::GDoubleWavelift wave_type;
+
+//-------------------------------------------------------------------------
+// Frames
+
+struct Frame
+{
+  std::string size, source;
+  Image ref, dist;
+};
+
+// 64-bit LCG (Knuth's MMIX), so the frames are the same everywhere
+class Random
+{
+public:
+  explicit Random(unsigned long long seed) : state_(seed) {}
+  // uniform in [-1, 1)
+  double Next()
+  {
+    state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double) (state_ >> 11) / 4503599627370496.0 - 1.0;
+  }
+
+private:
+  unsigned long long state_;
+};
+
+double Clamp255(double x)
+{
+  return std::min(255.0, std::max(0.0, x));
+}
+
+// gratings of three periods and orientations, plus noise, in 0..255
+Image SyntheticFrame(int rows, int cols)
+{
+  double const pi = 3.14159265358979323846;
+  Image im(rows, cols);
+  Random random(1);
+  for (int c = 0; c < cols; ++c)
+    for (int r = 0; r < rows; ++r)
+      im(r, c) = Clamp255(128.0 + 60.0 * std::sin(2 * pi * c / 37.0) * std::cos(2 * pi * r / 53.0) +
+                          30.0 * std::sin(2 * pi * (r + c) / 11.0) + 10.0 * random.Next());
+  return im;
+}
+
+// SRC extended symmetrically (edge samples repeated) to ROWS x COLS
+Image MirrorTile(const Image& src, int rows, int cols)
+{
+  Image im(rows, cols);
+  int const h = src.Rows(), w = src.Cols();
+  for (int c = 0; c < cols; ++c)
+  {
+    int sc = c % (2 * w);
+    if (sc >= w) sc = 2 * w - 1 - sc;
+    for (int r = 0; r < rows; ++r)
+    {
+      int sr = r % (2 * h);
+      if (sr >= h) sr = 2 * h - 1 - sr;
+      im(r, c) = src(sr, sc);
+    }
+  }
+  return im;
+}
+
+// a 3x3 box blur of REF plus noise, in 0..255
+Image Distort(const Image& ref)
+{
+  int const h = ref.Rows(), w = ref.Cols();
+  Image im(h, w);
+  Random random(2);
+  for (int c = 0; c < w; ++c)
+    for (int r = 0; r < h; ++r)
+    {
+      double s = 0.0;
+      for (int dc = -1; dc <= 1; ++dc)
+        for (int dr = -1; dr <= 1; ++dr)
+          s += ref(std::min(h - 1, std::max(0, r + dr)), std::min(w - 1, std::max(0, c + dc)));
+      im(r, c) = Clamp255(s / 9.0 + 6.0 * random.Next());
+    }
+  return im;
+}
+
+Frame MakeFrame(const std::string& size, const std::string& source, const Image& ref)
+{
+  Frame f;
+  f.size = size;
+  f.source = source;
+  f.ref = ref;
+  f.dist = Distort(ref);
+  return f;
+}
+
+struct FrameSize
+{
+  std::string name;
+  int rows, cols;
+};
+
+FrameSize ParseSize(const std::string& s)
+{
+  FrameSize f;
+  f.name = s;
+  if (s == "720p") f.rows = 720, f.cols = 1280;
+  else if (s == "1080p") f.rows = 1080, f.cols = 1920;
+  else if (s == "4k" || s == "2160p") f.rows = 2160, f.cols = 3840;
+  else if (std::sscanf(s.c_str(), "%dx%d", &f.rows, &f.cols) != 2 || f.rows < 1 || f.cols < 1)
+    throw std::runtime_error("unknown frame size '" + s + "' (720p, 1080p, 4k or ROWSxCOLS)");
+  return f;
+}
+
+std::vector<std::string> Split(const std::string& s)
+{
+  std::vector<std::string> parts;
+  std::size_t start = 0;
+  while (start <= s.size())
+  {
+    std::size_t const end = std::min(s.find(',', start), s.size());
+    if (end > start) parts.push_back(s.substr(start, end - start));
+    start = end + 1;
+  }
+  return parts;
+}
+
+//-------------------------------------------------------------------------
+// Timing, as Google Benchmark's State: the loop
+//
+//   while (state.KeepRunning()) ...
+//
+// runs the iterations asked for and times them, and what comes before
+// it (or between PauseTiming and ResumeTiming) is not timed.
+
+class State
+{
+public:
+  explicit State(long iterations)
+    : iterations_(iterations), done_(0), running_(false), real_(0), cpu_(0), bytes_(0) {}
+
+  bool KeepRunning()
+  {
+    if (done_ == 0 && !running_) ResumeTiming();
+    if (done_ < iterations_)
+    {
+      ++done_;
+      return true;
+    }
+    PauseTiming();
+    return false;
+  }
+
+  void PauseTiming()
+  {
+    if (!running_) return;
+    real_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start_).count();
+    cpu_ += (double) (std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+    running_ = false;
+  }
+
+  void ResumeTiming()
+  {
+    if (running_) return;
+    running_ = true;
+    real_start_ = std::chrono::steady_clock::now();
+    cpu_start_ = std::clock();
+  }
+
+  // input bytes each iteration reads, for bytes_per_second
+  void SetBytesProcessed(double bytes) { bytes_ = bytes; }
+
+  long Iterations() const { return iterations_; }
+  double RealTime() const { return real_; }
+  double CpuTime() const { return cpu_; }
+  double Bytes() const { return bytes_; }
+
+private:
+  long iterations_, done_;
+  bool running_;
+  std::chrono::steady_clock::time_point real_start_;
+  std::clock_t cpu_start_;
+  double real_, cpu_, bytes_;
+};
+
+//-------------------------------------------------------------------------
+// mexhost arguments
+
+class MxArray
+{
+public:
+  explicit MxArray(mxArray* a) : a_(a)
+  {
+    if (!a_) throw std::runtime_error("out of memory");
+  }
+  ~MxArray() { mxDestroyArray(a_); }
+  const mxArray* Get() const { return a_; }
+
+private:
+  MxArray(const MxArray&);
+  MxArray& operator=(const MxArray&);
+
+  mxArray* a_;
+};
+
+// the ROWS x COLS matrix of the first ROWS*COLS samples of IM
+mxArray* MxMatrix(const Image& im, bool single, int rows, int cols)
+{
+  mxArray* a = mxCreateNumericMatrix(rows, cols, single ? mxSINGLE_CLASS : mxDOUBLE_CLASS, mxREAL);
+  if (!a) return 0;
+  std::size_t const n = (std::size_t) rows * cols;
+  if (single) std::copy(im.Data(), im.Data() + n, (float*) mxGetData(a));
+  else std::copy(im.Data(), im.Data() + n, mxGetPr(a));
+  return a;
+}
+
+mxArray* MxMatrix(const Image& im, bool single = false)
+{
+  return MxMatrix(im, single, im.Rows(), im.Cols());
+}
+
+mxArray* MxVector(const std::vector<double>& v)
+{
+  mxArray* a = mxCreateDoubleMatrix(1, v.size(), mxREAL);
+  if (a) std::copy(v.begin(), v.end(), mxGetPr(a));
+  return a;
+}
+
+// calls F with the NRHS arguments ARGS, as [~] = F(...) or [~, ~] = ...
+void MexCall(mexhost_function f, const char* name, int nlhs, int nrhs, const MxArray* const* args)
+{
+  const mxArray* prhs[8];
+  mxArray* plhs[2];
+  for (int i = 0; i < nrhs; ++i) prhs[i] = args[i]->Get();
+  char msg[256];
+  if (mexhost_call(f, nlhs, plhs, nrhs, prhs, msg, sizeof(msg)))
+    throw std::runtime_error(std::string(name) + ": " + msg);
+  for (int i = 0; i < std::max(nlhs, 1); ++i) mxDestroyArray(plhs[i]);
+}
+
+// blurDn's binomial filter, binom5 as a 5x5 kernel summing to 1
+Image Binom5()
+{
+  double const taps[5] = {1, 4, 6, 4, 1};
+  Image filt(5, 5);
+  for (int c = 0; c < 5; ++c)
+    for (int r = 0; r < 5; ++r) filt(r, c) = taps[r] * taps[c] / 256.0;
+  return filt;
+}
+
+// ARG is "EDGES/double" or "EDGES/single"
+void ParseEdgeArg(const std::string& arg, std::string& edges, bool& single)
+{
+  std::size_t const slash = arg.find('/');
+  edges = arg.substr(0, slash);
+  single = arg.substr(slash + 1) == "single";
+}
+
+//-------------------------------------------------------------------------
+// Benchmarks: FN(state, frame, arg)
+
+void BenchDecompose(State& state, const Frame& f, const std::string&)
+{
+  state.SetBytesProcessed(f.ref.Size() * sizeof(double));
+  while (state.KeepRunning())
+  {
+    bands_type bands(f.ref.Rows(), f.ref.Cols());
+    std::copy(f.ref.Data(), f.ref.Data() + f.ref.Size(), bands.Image().Data());
+    wave_type().Decompose(bands, DWT_LEVELS);
+  }
+}
+
+void BenchReconstruct(State& state, const Frame& f, const std::string&)
+{
+  bands_type bands(f.ref.Rows(), f.ref.Cols());
+  std::copy(f.ref.Data(), f.ref.Data() + f.ref.Size(), bands.Image().Data());
+  wave_type().Decompose(bands, DWT_LEVELS);
+  bands_type work;
+  state.SetBytesProcessed(f.ref.Size() * sizeof(double));
+  while (state.KeepRunning())
+  {
+    state.PauseTiming();
+    work = bands;
+    state.ResumeTiming();
+    wave_type().Reconstruct(work);
+  }
+}
+
+// corrDn(IM, binom5, EDGES, [2 2]): blurDn's reduction
+void BenchCorrDn(State& state, const Frame& f, const std::string& arg)
+{
+  std::string edges;
+  bool single;
+  ParseEdgeArg(arg, edges, single);
+  MxArray const im(MxMatrix(f.ref, single)), filt(MxMatrix(Binom5(), single));
+  MxArray const e(mxCreateString(edges.c_str()));
+  MxArray const step(MxVector(std::vector<double>(2, 2.0)));
+  const MxArray* args[] = {&im, &filt, &e, &step};
+  state.SetBytesProcessed(f.ref.Size() * (single ? sizeof(float) : sizeof(double)));
+  while (state.KeepRunning()) MexCall(corrDn_mex, "corrDn", 1, 4, args);
+}
+
+// upConv(IM, binom5, EDGES, [2 2], [1 1], [ROWS COLS]) of the frame
+// decimated by 2: blurDn's inverse, back to the frame size
+void BenchUpConv(State& state, const Frame& f, const std::string& arg)
+{
+  std::string edges;
+  bool single;
+  ParseEdgeArg(arg, edges, single);
+  int const rows = f.ref.Rows(), cols = f.ref.Cols();
+  Image half((rows + 1) / 2, (cols + 1) / 2);
+  for (int c = 0; c < half.Cols(); ++c)
+    for (int r = 0; r < half.Rows(); ++r) half(r, c) = f.ref(2 * r, 2 * c);
+  std::vector<double> stop(2);
+  stop[0] = rows;
+  stop[1] = cols;
+  MxArray const im(MxMatrix(half, single)), filt(MxMatrix(Binom5(), single));
+  MxArray const e(mxCreateString(edges.c_str()));
+  MxArray const step(MxVector(std::vector<double>(2, 2.0)));
+  MxArray const start(MxVector(std::vector<double>(2, 1.0)));
+  MxArray const last(MxVector(stop));
+  const MxArray* args[] = {&im, &filt, &e, &step, &start, &last};
+  state.SetBytesProcessed(half.Size() * (single ? sizeof(float) : sizeof(double)));
+  while (state.KeepRunning()) MexCall(upConv_mex, "upConv", 1, 6, args);
+}
+
+// [N, X] = histo(IM, 256)
+void BenchHisto(State& state, const Frame& f, const std::string&)
+{
+  MxArray const im(MxMatrix(f.ref));
+  MxArray const nbins(MxVector(std::vector<double>(1, HISTO_BINS)));
+  const MxArray* args[] = {&im, &nbins};
+  state.SetBytesProcessed(f.ref.Size() * sizeof(double));
+  while (state.KeepRunning()) MexCall(histo_mex, "histo", 2, 2, args);
+}
+
+// innerProd(M), M the frame's samples as an N x 16 matrix (as the
+// neighbourhood matrices of vifvec)
+void BenchInnerProd(State& state, const Frame& f, const std::string&)
+{
+  int const rows = (int) (f.ref.Size() / INNER_PROD_COLS);
+  MxArray const m(MxMatrix(f.ref, false, rows, INNER_PROD_COLS));
+  const MxArray* args[] = {&m};
+  state.SetBytesProcessed((double) rows * INNER_PROD_COLS * sizeof(double));
+  while (state.KeepRunning()) MexCall(innerProd_mex, "innerProd", 1, 1, args);
+}
+
+// pointOp(IM, LUT, 0, 1, 0), LUT a 256-entry gamma curve (VSNR's
+// luminance)
+void BenchPointOp(State& state, const Frame& f, const std::string&)
+{
+  std::vector<double> lut(256);
+  for (int p = 0; p < 256; ++p) lut[p] = std::pow(0.02874 * p, 2.2);
+  MxArray const im(MxMatrix(f.ref)), table(MxVector(lut));
+  MxArray const origin(MxVector(std::vector<double>(1, 0.0)));
+  MxArray const increment(MxVector(std::vector<double>(1, 1.0)));
+  MxArray const warnings(MxVector(std::vector<double>(1, 0.0)));
+  const MxArray* args[] = {&im, &table, &origin, &increment, &warnings};
+  state.SetBytesProcessed(f.ref.Size() * sizeof(double));
+  while (state.KeepRunning()) MexCall(pointOp_mex, "pointOp", 1, 5, args);
+}
+
+// The engines, as metrix_mux and the MEX interfaces run them: VIF, IFC
+// and VSNR on the pair padded by preprocess_metrix_mux, the plans of
+// NQM, MAD and the registration made once per size.
+
+void BenchVif(State& state, const Frame& f, const std::string&)
+{
+  Image const ref = metrix::PadForDecomposition(f.ref), dist = metrix::PadForDecomposition(f.dist);
+  while (state.KeepRunning()) metrix::Vif(ref, dist);
+}
+
+void BenchIfc(State& state, const Frame& f, const std::string&)
+{
+  Image const ref = metrix::PadForDecomposition(f.ref), dist = metrix::PadForDecomposition(f.dist);
+  while (state.KeepRunning()) metrix::Ifc(ref, dist);
+}
+
+void BenchVifIfc(State& state, const Frame& f, const std::string&)
+{
+  Image const ref = metrix::PadForDecomposition(f.ref), dist = metrix::PadForDecomposition(f.dist);
+  while (state.KeepRunning()) metrix::VifIfc(ref, dist);
+}
+
+void BenchVsnr(State& state, const Frame& f, const std::string&)
+{
+  Image const ref = metrix::PadForDecomposition(f.ref), dist = metrix::PadForDecomposition(f.dist);
+  while (state.KeepRunning()) metrix::Vsnr(ref, dist);
+}
+
+void BenchMssim(State& state, const Frame& f, const std::string&)
+{
+  while (state.KeepRunning()) metrix::Mssim(f.ref, f.dist);
+}
+
+void BenchSsim(State& state, const Frame& f, const std::string&)
+{
+  while (state.KeepRunning()) metrix::Ssim(f.ref, f.dist);
+}
+
+void BenchNqm(State& state, const Frame& f, const std::string&)
+{
+  metrix::NqmPlan plan(f.ref.Rows(), f.ref.Cols());
+  while (state.KeepRunning()) plan.Score(f.ref, f.dist);
+}
+
+void BenchMad(State& state, const Frame& f, const std::string&)
+{
+  metrix::MadPlan plan(f.ref.Rows(), f.ref.Cols());
+  while (state.KeepRunning()) plan.Score(f.ref, f.dist);
+}
+
+// dftregistration(fft2(REF), fft2(DIST), 1), both spectra included
+void BenchDftReg(State& state, const Frame& f, const std::string&)
+{
+  metrix::DftRegistration plan(f.ref.Rows(), f.ref.Cols(), 1);
+  std::vector<metrix::Complex> ref_ft, dist_ft;
+  while (state.KeepRunning())
+  {
+    plan.Spectrum(f.ref, ref_ft);
+    plan.Spectrum(f.dist, dist_ft);
+    plan.Register(&ref_ft[0], &dist_ft[0]);
+  }
+}
+
+// imshift(DIST, [3 -2], 'same'), as eval_image.m aligns
+void BenchImShift(State& state, const Frame& f, const std::string&)
+{
+  while (state.KeepRunning()) metrix::ImShift(f.dist, 3.0, -2.0, metrix::SHIFT_SAME);
+}
+
+// all six metrics of fused.h
+void BenchFused(State& state, const Frame& f, const std::string&)
+{
+  unsigned const all = metrix::METRIC_MSE | metrix::METRIC_PSNR | metrix::METRIC_SSIM |
+                       metrix::METRIC_MSSIM | metrix::METRIC_VIF | metrix::METRIC_IFC;
+  while (state.KeepRunning()) metrix::FusedMetrics(f.ref, f.dist, all);
+}
+
+typedef void (*BenchFunction)(State& state, const Frame& f, const std::string& arg);
+
+struct Family
+{
+  const char* name;
+  BenchFunction fn;
+  bool threaded;        // OpenMP, run at each thread count
+  bool edges;           // one benchmark per edge mode and precision
+};
+
+const Family FAMILIES[] = {
+  {"GWavelift/Decompose", BenchDecompose, false, false},
+  {"GWavelift/Reconstruct", BenchReconstruct, false, false},
+  {"corrDn", BenchCorrDn, false, true},
+  {"upConv", BenchUpConv, false, true},
+  {"histo", BenchHisto, true, false},
+  {"innerProd", BenchInnerProd, true, false},
+  {"pointOp", BenchPointOp, true, false},
+  {"Vif", BenchVif, true, false},
+  {"Ifc", BenchIfc, true, false},
+  {"VifIfc", BenchVifIfc, true, false},
+  {"Vsnr", BenchVsnr, true, false},
+  {"Mssim", BenchMssim, true, false},
+  {"Ssim", BenchSsim, true, false},
+  {"Nqm", BenchNqm, true, false},
+  {"Mad", BenchMad, true, false},
+  {"DftRegistration", BenchDftReg, true, false},
+  {"ImShift", BenchImShift, true, false},
+  {"FusedMetrics", BenchFused, true, false}
+};
+const int NUM_FAMILIES = sizeof(FAMILIES) / sizeof(FAMILIES[0]);
+
+//-------------------------------------------------------------------------
+// Running and reporting
+
+struct Options
+{
+  std::vector<FrameSize> sizes;
+  std::vector<int> threads;
+  std::vector<std::string> filter;
+  int repetitions;
+  double min_time;
+  std::string image;
+};
+
+struct Case
+{
+  const Family* family;
+  std::string arg;
+  int threads;
+};
+
+struct Run
+{
+  std::string name;
+  int threads, repetition;
+  long iterations;
+  double real, cpu;     // seconds per iteration
+  double pixels, bytes; // per iteration
+  std::string error;
+};
+
+std::string CaseName(const Case& c, const std::string& size, const std::string& source)
+{
+  char threads[32];
+  std::snprintf(threads, sizeof(threads), "/threads:%d", c.threads);
+  return std::string(c.family->name) + (c.arg.empty() ? "" : "/" + c.arg) + "/" + size + "/" +
+         source + threads;
+}
+
+bool Selected(const Options& opt, const std::string& name)
+{
+  if (opt.filter.empty()) return true;
+  for (std::size_t i = 0; i < opt.filter.size(); ++i)
+    if (name.find(opt.filter[i]) != std::string::npos) return true;
+  return false;
+}
+
+std::vector<Case> Cases(const Options& opt)
+{
+  std::vector<Case> cases;
+  for (int k = 0; k < NUM_FAMILIES; ++k)
+  {
+    std::vector<std::string> args;
+    if (FAMILIES[k].edges)
+      for (int e = 0; e < NUM_EDGES; ++e)
+      {
+        args.push_back(std::string(EDGES[e]) + "/double");
+        args.push_back(std::string(EDGES[e]) + "/single");
+      }
+    else
+      args.push_back("");
+    for (std::size_t a = 0; a < args.size(); ++a)
+    {
+      Case c = {&FAMILIES[k], args[a], 1};
+      if (!FAMILIES[k].threaded)
+        cases.push_back(c);
+      else
+        for (std::size_t t = 0; t < opt.threads.size(); ++t)
+        {
+          c.threads = opt.threads[t];
+          cases.push_back(c);
+        }
+    }
+  }
+  return cases;
+}
+
+Run Measure(const Case& c, const Frame& f, long iterations)
+{
+  metrix::SetThreads(c.threads);
+  State state(iterations);
+  c.family->fn(state, f, c.arg);
+  Run run;
+  run.threads = c.threads;
+  run.repetition = 0;
+  run.iterations = iterations;
+  run.real = state.RealTime() / iterations;
+  run.cpu = state.CpuTime() / iterations;
+  run.pixels = (double) f.ref.Size();
+  run.bytes = state.Bytes();
+  return run;
+}
+
+// Google Benchmark's search: grow the iterations until a run lasts
+// MIN_TIME, then repeat that many
+std::vector<Run> RunCase(const Options& opt, const Case& c, const Frame& f, const std::string& name)
+{
+  std::vector<Run> runs;
+  try
+  {
+    long iterations = 1;
+    Run run = Measure(c, f, iterations);
+    while (run.real * iterations < opt.min_time && iterations < MAX_ITERATIONS)
+    {
+      double const total = run.real * iterations;
+      double const multiplier = (total / opt.min_time > 0.1) ? 1.4 * opt.min_time / total : 10.0;
+      iterations = (long) std::min((double) MAX_ITERATIONS,
+                                   std::max(iterations + 1.0, std::ceil(iterations * multiplier)));
+      run = Measure(c, f, iterations);
+    }
+    runs.push_back(run);
+    for (int r = 1; r < opt.repetitions; ++r)
+    {
+      runs.push_back(Measure(c, f, iterations));
+      runs.back().repetition = r;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    Run run;
+    run.threads = c.threads;
+    run.repetition = 0;
+    run.iterations = 0;
+    run.real = run.cpu = run.pixels = run.bytes = 0;
+    run.error = e.what();
+    runs.assign(1, run);
+  }
+  for (std::size_t i = 0; i < runs.size(); ++i) runs[i].name = name;
+  metrix::SetThreads(metrix::MaxThreads());
+  return runs;
+}
+
+// AGGREGATE is 0 for a repetition; no rates for "stddev"
+bool HasRates(const char* aggregate)
+{
+  return !aggregate || std::strcmp(aggregate, "stddev") != 0;
+}
+
+void PrintRun(const Run& r, const char* aggregate)
+{
+  std::string const name = aggregate ? r.name + "_" + aggregate : r.name;
+  if (!r.error.empty())
+    std::printf("%-64s ERROR: %s\n", name.c_str(), r.error.c_str());
+  else if (!HasRates(aggregate))
+    std::printf("%-64s %12.3f ms %12.3f ms %10ld\n", name.c_str(), 1e3 * r.real, 1e3 * r.cpu,
+                r.iterations);
+  else
+    std::printf("%-64s %12.3f ms %12.3f ms %10ld %10.1f Mpix/s\n", name.c_str(), 1e3 * r.real,
+                1e3 * r.cpu, r.iterations, r.pixels / r.real * 1e-6);
+  std::fflush(stdout);
+}
+
+std::string JsonString(const std::string& s)
+{
+  std::string out = "\"";
+  for (std::size_t i = 0; i < s.size(); ++i)
+  {
+    char const ch = s[i];
+    if (ch == '"' || ch == '\\') out += '\\', out += ch;
+    else if ((unsigned char) ch < 0x20)
+    {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned) (unsigned char) ch);
+      out += buf;
+    }
+    else
+      out += ch;
+  }
+  return out + "\"";
+}
+
+void JsonRun(std::FILE* fp, const Run& r, int repetitions, const char* aggregate, bool& first)
+{
+  std::fprintf(fp, "%s    {\n", first ? "" : ",\n");
+  first = false;
+  std::string const name = aggregate ? r.name + "_" + aggregate : r.name;
+  std::fprintf(fp, "      \"name\": %s,\n", JsonString(name).c_str());
+  std::fprintf(fp, "      \"run_name\": %s,\n", JsonString(r.name).c_str());
+  std::fprintf(fp, "      \"run_type\": \"%s\",\n", aggregate ? "aggregate" : "iteration");
+  std::fprintf(fp, "      \"repetitions\": %d,\n", repetitions);
+  if (aggregate) std::fprintf(fp, "      \"aggregate_name\": \"%s\",\n", aggregate);
+  else std::fprintf(fp, "      \"repetition_index\": %d,\n", r.repetition);
+  std::fprintf(fp, "      \"threads\": %d,\n", r.threads);
+  if (!r.error.empty())
+  {
+    std::fprintf(fp, "      \"error_occurred\": true,\n");
+    std::fprintf(fp, "      \"error_message\": %s\n    }", JsonString(r.error).c_str());
+    return;
+  }
+  std::fprintf(fp, "      \"iterations\": %ld,\n", r.iterations);
+  std::fprintf(fp, "      \"real_time\": %.17g,\n", 1e3 * r.real);
+  std::fprintf(fp, "      \"cpu_time\": %.17g,\n", 1e3 * r.cpu);
+  std::fprintf(fp, "      \"time_unit\": \"ms\"");
+  if (HasRates(aggregate))
+  {
+    if (r.bytes > 0) std::fprintf(fp, ",\n      \"bytes_per_second\": %.17g", r.bytes / r.real);
+    std::fprintf(fp, ",\n      \"items_per_second\": %.17g", r.pixels / r.real);
+  }
+  std::fprintf(fp, "\n    }");
+}
+
+// mean, median and stddev of the repetitions of one benchmark
+std::vector<Run> Aggregates(const std::vector<Run>& runs)
+{
+  std::size_t const n = runs.size();
+  std::vector<double> real(n), cpu(n);
+  for (std::size_t i = 0; i < n; ++i) real[i] = runs[i].real, cpu[i] = runs[i].cpu;
+  Run mean = runs[0], median = runs[0], stddev = runs[0];
+  double sr = 0, sc = 0;
+  for (std::size_t i = 0; i < n; ++i) sr += real[i], sc += cpu[i];
+  mean.real = sr / n;
+  mean.cpu = sc / n;
+  double vr = 0, vc = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    vr += (real[i] - mean.real) * (real[i] - mean.real);
+    vc += (cpu[i] - mean.cpu) * (cpu[i] - mean.cpu);
+  }
+  stddev.real = std::sqrt(vr / (n - 1));
+  stddev.cpu = std::sqrt(vc / (n - 1));
+  std::sort(real.begin(), real.end());
+  std::sort(cpu.begin(), cpu.end());
+  median.real = (n % 2) ? real[n / 2] : 0.5 * (real[n / 2 - 1] + real[n / 2]);
+  median.cpu = (n % 2) ? cpu[n / 2] : 0.5 * (cpu[n / 2 - 1] + cpu[n / 2]);
+  std::vector<Run> out;
+  out.push_back(mean);
+  out.push_back(median);
+  out.push_back(stddev);
+  return out;
+}
+
+void JsonContext(std::FILE* fp, const char* executable, const Options& opt)
+{
+  char date[64];
+  std::time_t const now = std::time(0);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+  char host[256] = "";
+#ifndef _WIN32
+  if (gethostname(host, sizeof(host)) != 0) host[0] = '\0';
+  host[sizeof(host) - 1] = '\0';
+#else
+  if (const char* h = std::getenv("COMPUTERNAME")) std::snprintf(host, sizeof(host), "%s", h);
+#endif
+  std::fprintf(fp, "{\n  \"context\": {\n");
+  std::fprintf(fp, "    \"date\": %s,\n", JsonString(date).c_str());
+  std::fprintf(fp, "    \"host_name\": %s,\n", JsonString(host).c_str());
+  std::fprintf(fp, "    \"executable\": %s,\n", JsonString(executable).c_str());
+  std::fprintf(fp, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+  std::fprintf(fp, "    \"max_threads\": %d,\n", metrix::MaxThreads());
+#ifdef _OPENMP
+  std::fprintf(fp, "    \"openmp\": true,\n");
+#else
+  std::fprintf(fp, "    \"openmp\": false,\n");
+#endif
+  std::fprintf(fp, "    \"min_time\": %g,\n", opt.min_time);
+  std::fprintf(fp, "    \"image\": %s\n", JsonString(opt.image).c_str());
+  std::fprintf(fp, "  },\n  \"benchmarks\": [\n");
+}
+
+std::vector<int> DefaultThreads()
+{
+  std::vector<int> threads;
+  int const n = metrix::MaxThreads();
+  for (int t = 1; t < n; t *= 2) threads.push_back(t);
+  threads.push_back(n);
+  return threads;
+}
+
+void Usage(const char* argv0)
+{
+  std::fprintf(stderr, "usage: %s [-s SIZES] [-t THREADS] [-b FILTER] [-r REPETITIONS] "
+               "[-m MIN_TIME] [-i IMAGE] [-o JSON] [-l]\n", argv0);
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  Options opt;
+  opt.repetitions = 1;
+  opt.min_time = 0.5;
+  std::string sizes = "720p,1080p,4k", threads, json;
+  bool list = false;
+  int a = 1;
+  for (; a < argc && argv[a][0] == '-' && argv[a][1] && !argv[a][2]; ++a)
+  {
+    if (argv[a][1] == 'l')
+    {
+      list = true;
+      continue;
+    }
+    if (a + 1 == argc) break;
+    const char* v = argv[++a];
+    switch (argv[a - 1][1])
+    {
+    case 's': sizes = v; break;
+    case 't': threads = v; break;
+    case 'b': opt.filter = Split(v); break;
+    case 'r': opt.repetitions = std::atoi(v); break;
+    case 'm': opt.min_time = std::atof(v); break;
+    case 'i': opt.image = v; break;
+    case 'o': json = v; break;
+    default: a = argc + 1; break;
+    }
+  }
+  if (a != argc || opt.repetitions < 1 || !(opt.min_time >= 0))
+  {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  std::FILE* fp = 0;
+  int status = 0;
+  try
+  {
+    std::vector<std::string> const names = Split(sizes);
+    for (std::size_t i = 0; i < names.size(); ++i) opt.sizes.push_back(ParseSize(names[i]));
+    if (threads.empty())
+      opt.threads = DefaultThreads();
+    else
+    {
+      std::vector<std::string> const counts = Split(threads);
+      for (std::size_t i = 0; i < counts.size(); ++i)
+      {
+        int const t = std::atoi(counts[i].c_str());
+        if (t < 1) throw std::runtime_error("thread counts must be positive");
+        opt.threads.push_back(t);
+      }
+    }
+    Image real;
+    if (!opt.image.empty()) real = metrix::ReadImage(opt.image);
+
+    std::vector<Case> const cases = Cases(opt);
+    if (list)
+    {
+      for (std::size_t s = 0; s < opt.sizes.size(); ++s)
+        for (int k = 0; k < (real.Empty() ? 1 : 2); ++k)
+          for (std::size_t c = 0; c < cases.size(); ++c)
+          {
+            std::string const name = CaseName(cases[c], opt.sizes[s].name, k ? "real" : "synthetic");
+            if (Selected(opt, name)) std::printf("%s\n", name.c_str());
+          }
+      return 0;
+    }
+
+    if (!json.empty())
+    {
+      fp = std::fopen(json.c_str(), "w");
+      if (!fp) throw std::runtime_error(json + ": cannot create file");
+      JsonContext(fp, argv[0], opt);
+    }
+    std::printf("%-64s %15s %15s %10s %17s\n", "Benchmark", "Time", "CPU", "Iterations", "Pixels");
+    bool first = true;
+    for (std::size_t s = 0; s < opt.sizes.size(); ++s)
+    {
+      FrameSize const& size = opt.sizes[s];
+      // the frames of one size at a time: a 4k pair is 130 MB
+      std::vector<Frame> frames;
+      frames.push_back(MakeFrame(size.name, "synthetic", SyntheticFrame(size.rows, size.cols)));
+      if (!real.Empty())
+        frames.push_back(MakeFrame(size.name, "real", MirrorTile(real, size.rows, size.cols)));
+      for (std::size_t k = 0; k < frames.size(); ++k)
+        for (std::size_t c = 0; c < cases.size(); ++c)
+        {
+          std::string const name = CaseName(cases[c], size.name, frames[k].source);
+          if (!Selected(opt, name)) continue;
+          std::vector<Run> const runs = RunCase(opt, cases[c], frames[k], name);
+          for (std::size_t r = 0; r < runs.size(); ++r)
+          {
+            PrintRun(runs[r], 0);
+            if (fp) JsonRun(fp, runs[r], opt.repetitions, 0, first);
+          }
+          if (runs.size() > 1)
+          {
+            std::vector<Run> const agg = Aggregates(runs);
+            const char* const labels[] = {"mean", "median", "stddev"};
+            for (int i = 0; i < 3; ++i)
+            {
+              PrintRun(agg[i], labels[i]);
+              if (fp) JsonRun(fp, agg[i], opt.repetitions, labels[i], first);
+            }
+          }
+        }
+    }
+    if (fp) std::fprintf(fp, "\n  ]\n}\n");
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    status = 1;
+  }
+  if (fp && std::fclose(fp) != 0 && status == 0)
+  {
+    std::fprintf(stderr, "%s: %s: write error\n", argv[0], json.c_str());
+    status = 1;
+  }
+  return status;
+}
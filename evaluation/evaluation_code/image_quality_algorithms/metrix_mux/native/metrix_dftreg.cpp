@@ -0,0 +1,54 @@
+//=========================================================================
+// metrix_dftreg.cpp
+//
+// metrix_dftreg [-u USFAC] IMAGE REFERENCE [REFERENCE ...]
+//
+// Registers IMAGE to each reference (as eval_image.m registers the
+// deblurred image to each ground-truth frame) with dftregistration.m's
+// algorithm, upsampling factor USFAC (default 1), and prints one
+// "name error diffphase row_shift col_shift" line per reference.  The
+// spectrum of IMAGE is computed once, with one plan for every
+// reference of its size.
+//=========================================================================
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "dftreg.h"
+#include "image.h"
+
+int main(int argc, char* argv[])
+{
+  int usfac = 1, first = 1;
+  if (argc > 2 && std::strcmp(argv[1], "-u") == 0)
+  {
+    usfac = std::atoi(argv[2]);
+    first = 3;
+  }
+  if (argc - first < 2)
+  {
+    std::fprintf(stderr, "usage: %s [-u USFAC] IMAGE REFERENCE [REFERENCE ...]\n", argv[0]);
+    return 2;
+  }
+  try
+  {
+    metrix::Image const im = metrix::ReadImage(argv[first]);
+    metrix::DftRegistration reg(im.Rows(), im.Cols(), usfac);
+    std::vector<metrix::Complex> buf2ft, buf1ft;
+    reg.Spectrum(im, buf2ft);
+    for (int i = first + 1; i < argc; ++i)
+    {
+      reg.Spectrum(metrix::ReadImage(argv[i]), buf1ft);
+      metrix::DftRegOutput const o = reg.Register(&buf1ft[0], &buf2ft[0]);
+      std::printf("%s %.10f %.10f %.4f %.4f\n", argv[i], o.error, o.diffphase, o.row_shift, o.col_shift);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,164 @@
+//=========================================================================
+// metrix_eval.cpp
+//
+// metrix_eval [-m MODEL] [-w WORKERS] [-r READERS] [-q QUEUE]
+//             [-f FRAME_CSV] [-v VIDEO_CSV] [-c CACHE]
+//             SET TEST_OFFSET FOLDER_RESULT
+//
+// evaluation.m without Matlab: scores the result frames of
+// FOLDER_RESULT against the DVD or nah test set (SET) under
+// TEST_OFFSET, printing evaluation.m's line per frame and the mean
+// PSNR and SSIM over all frames.  MODEL 'OVD' pairs each result with
+// the next ground-truth frame, as evaluation.m does.  FRAME_CSV gets
+// one row per frame (video, frame, file names, PSNR, SSIM, intensity
+// scale and registration shift), VIDEO_CSV one row per video with its
+// means and a last "all" row.  WORKERS (default: one per core)
+// evaluate the frames that READERS (default 2) decode ahead, at most
+// QUEUE (default: 2 per worker) waiting.  With CACHE, frames whose
+// files and options an earlier run with the same CACHE scored are not
+// evaluated again; the hits and misses go to stderr.
+//=========================================================================
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "resultcache.h"
+
+namespace {
+
+class CsvSink : public metrix::FrameSink
+{
+public:
+  CsvSink(const std::string& model, const std::string& set, std::FILE* frames, std::FILE* videos)
+    : model_(model), set_(set), frames_(frames), videos_(videos),
+      count_(0), psnr_(0), ssim_(0), video_count_(0), video_psnr_(0), video_ssim_(0)
+  {
+    if (frames_) std::fprintf(frames_, "video,frame,gt,result,psnr,ssim,scale,row_shift,col_shift\n");
+    if (videos_) std::fprintf(videos_, "video,frames,psnr,ssim\n");
+  }
+
+  void Add(const metrix::FramePair& p, const metrix::FrameScores& s)
+  {
+    std::printf("[%s on %s] [%d/%d] [%d/%d] [gt_name: %s / input_name: %s] PSNR: %0.4f, SSIM: %0.4f\n",
+                model_.c_str(), set_.c_str(), p.video_index, p.videos, p.frame, p.frames,
+                p.gt_name.c_str(), p.result_name.c_str(), s.psnr, s.ssim);
+    if (frames_)
+      std::fprintf(frames_, "%s,%d,%s,%s,%.10g,%.10g,%.10g,%g,%g\n", p.video.c_str(), p.frame,
+                   p.gt_name.c_str(), p.result_name.c_str(), s.psnr, s.ssim, s.scale,
+                   s.row_shift, s.col_shift);
+    if (video_count_ > 0 && p.video != video_) EndVideo();
+    video_ = p.video;
+    ++video_count_;
+    video_psnr_ += s.psnr;
+    video_ssim_ += s.ssim;
+    ++count_;
+    psnr_ += s.psnr;
+    ssim_ += s.ssim;
+  }
+
+  // the last video's row and the "all" row
+  void Finish()
+  {
+    if (video_count_ > 0) EndVideo();
+    if (videos_) std::fprintf(videos_, "all,%d,%.10g,%.10g\n", count_, PsnrMean(), SsimMean());
+  }
+
+  double PsnrMean() const { return psnr_ / count_; }
+  double SsimMean() const { return ssim_ / count_; }
+
+private:
+  void EndVideo()
+  {
+    if (videos_)
+      std::fprintf(videos_, "%s,%d,%.10g,%.10g\n", video_.c_str(), video_count_,
+                   video_psnr_ / video_count_, video_ssim_ / video_count_);
+    video_count_ = 0;
+    video_psnr_ = video_ssim_ = 0;
+  }
+
+  std::string model_, set_;
+  std::FILE* frames_;
+  std::FILE* videos_;
+  int count_;
+  double psnr_, ssim_;
+  std::string video_;
+  int video_count_;
+  double video_psnr_, video_ssim_;
+};
+
+std::FILE* OpenCsv(const char* path)
+{
+  if (!path) return 0;
+  std::FILE* fp = std::fopen(path, "w");
+  if (!fp) throw std::runtime_error(std::string(path) + ": cannot create file");
+  return fp;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  std::string model;
+  const char* frame_csv = 0;
+  const char* video_csv = 0;
+  const char* cache_path = 0;
+  metrix::HarnessOptions opt;
+  int a = 1;
+  for (; a + 1 < argc && argv[a][0] == '-' && argv[a][1] && !argv[a][2]; a += 2)
+  {
+    const char* v = argv[a + 1];
+    switch (argv[a][1])
+    {
+    case 'm': model = v; break;
+    case 'w': opt.workers = std::atoi(v); break;
+    case 'r': opt.readers = std::atoi(v); break;
+    case 'q': opt.queue = std::atoi(v); break;
+    case 'f': frame_csv = v; break;
+    case 'v': video_csv = v; break;
+    case 'c': cache_path = v; break;
+    default: a = argc; break;
+    }
+  }
+  if (argc - a != 3)
+  {
+    std::fprintf(stderr, "usage: %s [-m MODEL] [-w WORKERS] [-r READERS] [-q QUEUE] "
+                 "[-f FRAME_CSV] [-v VIDEO_CSV] [-c CACHE] DVD|nah TEST_OFFSET FOLDER_RESULT\n",
+                 argv[0]);
+    return 2;
+  }
+  std::FILE* frames = 0;
+  std::FILE* videos = 0;
+  metrix::ResultCache* cache = 0;
+  int status = 0;
+  try
+  {
+    std::string const set = argv[a];
+    std::vector<metrix::FramePair> const pairs = metrix::ListFramePairs(argv[a + 1], set, argv[a + 2], model);
+    if (pairs.empty()) throw std::runtime_error("no result frames to evaluate");
+    frames = OpenCsv(frame_csv);
+    videos = OpenCsv(video_csv);
+    if (cache_path) opt.cache = cache = new metrix::ResultCache(cache_path);
+    CsvSink sink(model, set, frames, videos);
+    metrix::RunEvaluation(pairs, opt, sink);
+    sink.Finish();
+    std::printf("PSNR (Koehler): %f, SSIM (Koehler): %f\n", sink.PsnrMean(), sink.SsimMean());
+    if (cache)
+      std::fprintf(stderr, "%s: cache %s: %ld hits, %ld misses\n", argv[0], cache_path,
+                   cache->Hits(), cache->Misses());
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    status = 1;
+  }
+  if (frames) std::fclose(frames);
+  if (videos) std::fclose(videos);
+  delete cache;
+  return status;
+}
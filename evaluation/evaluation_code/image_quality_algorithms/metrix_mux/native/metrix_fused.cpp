@@ -0,0 +1,80 @@
+//=========================================================================
+// metrix_fused.cpp
+//
+// metrix_fused [-m METRICS] REFERENCE DISTORTED [DISTORTED ...]
+//
+// Prints several metrix_mux scores of each distorted image against the
+// reference, one "name score ..." line per image, from one pass over
+// the pair (fused.h).  METRICS is a comma-separated list of MSE, PSNR,
+// SSIM, MSSIM, VIF and IFC, in the order of the scores (default: all,
+// in that order).
+//=========================================================================
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "fused.h"
+#include "image.h"
+
+namespace {
+
+double Score(const metrix::FusedScores& s, unsigned flag)
+{
+  switch (flag)
+  {
+  case metrix::METRIC_MSE: return s.mse;
+  case metrix::METRIC_PSNR: return s.psnr;
+  case metrix::METRIC_SSIM: return s.ssim;
+  case metrix::METRIC_MSSIM: return s.mssim;
+  case metrix::METRIC_VIF: return s.vif;
+  default: return s.ifc;
+  }
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  std::string list = "MSE,PSNR,SSIM,MSSIM,VIF,IFC";
+  int first = 1;
+  if (argc > 2 && std::strcmp(argv[1], "-m") == 0)
+  {
+    list = argv[2];
+    first = 3;
+  }
+  if (argc - first < 2)
+  {
+    std::fprintf(stderr, "usage: %s [-m METRICS] REFERENCE DISTORTED [DISTORTED ...]\n", argv[0]);
+    return 2;
+  }
+  try
+  {
+    std::vector<unsigned> flags;
+    unsigned metrics = 0;
+    for (std::size_t b = 0; b <= list.size();)
+    {
+      std::size_t e = list.find(',', b);
+      if (e == std::string::npos) e = list.size();
+      flags.push_back(metrix::MetricFlag(list.substr(b, e - b)));
+      metrics |= flags.back();
+      b = e + 1;
+    }
+    metrix::Image const ref = metrix::ReadImage(argv[first]);
+    for (int i = first + 1; i < argc; ++i)
+    {
+      metrix::FusedScores const s = metrix::FusedMetrics(ref, metrix::ReadImage(argv[i]), metrics);
+      std::printf("%s", argv[i]);
+      for (std::size_t k = 0; k < flags.size(); ++k) std::printf(" %.10f", Score(s, flags[k]));
+      std::printf("\n");
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,133 @@
+//=========================================================================
+// metrix_gtstore.cpp
+//
+// metrix_gtstore [-m] [-s] -o STORE FRAME [FRAME ...]
+// metrix_gtstore -i STORE
+// metrix_gtstore [-u USFAC] STORE IMAGE
+//
+// Ground-truth stores (gtstore.h).  -o writes STORE from JPEG or PNG
+// frames of one size (as convert_gt_store.m writes it from a
+// GroundTruth%d_%d.mat file), with their channel means (-m) and the
+// spectra of the means (-s).  -i prints "rows cols channels frames
+// means spectra" (the last two 0 or 1).  Otherwise IMAGE is registered
+// to the channel mean of each frame, as eval_image.m registers the
+// deblurred image, and one "frame error diffphase row_shift col_shift"
+// line (frames from 1) is printed per frame; stored spectra are used
+// as they are.
+//=========================================================================
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dftreg.h"
+#include "frame.h"
+#include "gtstore.h"
+#include "image.h"
+
+namespace {
+
+void Write(const char* path, char* frames[], int count, bool means, bool spectra)
+{
+  std::vector<unsigned char> data;
+  int rows = 0, cols = 0, channels = 0;
+  for (int j = 0; j < count; ++j)
+  {
+    metrix::Frame const f = metrix::ReadFrame(frames[j]);
+    if (j == 0)
+    {
+      rows = f.Rows();
+      cols = f.Cols();
+      channels = f.Channels();
+      data.reserve(f.Size() * count);
+    }
+    else if (f.Rows() != rows || f.Cols() != cols || f.Channels() != channels)
+      throw std::runtime_error(std::string(frames[j]) + ": differs in size from " + frames[0]);
+    data.insert(data.end(), f.Plane(0), f.Plane(0) + f.Size());
+  }
+  metrix::WriteGroundTruthStore(path, rows, cols, channels, count, &data[0], means, spectra);
+}
+
+void Info(const char* path)
+{
+  metrix::GroundTruthStore const store(path);
+  std::printf("%d %d %d %d %d %d\n", store.Rows(), store.Cols(), store.Channels(), store.Frames(),
+              store.HasMeans() ? 1 : 0, store.HasSpectra() ? 1 : 0);
+}
+
+void Register(const char* path, const char* image, int usfac)
+{
+  metrix::GroundTruthStore const store(path);
+  metrix::Image const im = metrix::ReadImage(image);
+  if (im.Rows() != store.Rows() || im.Cols() != store.Cols())
+    throw std::runtime_error(std::string(image) + ": differs in size from the frames of " + path);
+  metrix::DftRegistration reg(im.Rows(), im.Cols(), usfac);
+  std::vector<metrix::Complex> buf2ft, buf1ft;
+  reg.Spectrum(im, buf2ft);
+  for (int j = 0; j < store.Frames(); ++j)
+  {
+    const metrix::Complex* ref = store.Spectrum(j);
+    if (!ref)
+    {
+      reg.Spectrum(store.MeanImage(j), buf1ft);
+      ref = &buf1ft[0];
+    }
+    metrix::DftRegOutput const o = reg.Register(ref, &buf2ft[0]);
+    std::printf("%d %.10f %.10f %.4f %.4f\n", j + 1, o.error, o.diffphase, o.row_shift, o.col_shift);
+  }
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  bool means = false, spectra = false;
+  const char* out = 0;
+  const char* info = 0;
+  int usfac = 1;
+  int a = 1;
+  for (; a < argc && argv[a][0] == '-' && argv[a][1] && !argv[a][2]; ++a)
+  {
+    char const flag = argv[a][1];
+    if (flag == 'm')
+      means = true;
+    else if (flag == 's')
+      spectra = true;
+    else if (a + 1 < argc && (flag == 'o' || flag == 'i' || flag == 'u'))
+    {
+      const char* v = argv[++a];
+      if (flag == 'o') out = v;
+      else if (flag == 'i') info = v;
+      else usfac = std::atoi(v);
+    }
+    else
+      break;
+  }
+  int const rest = argc - a;
+  if (!((out && !info && rest >= 1) || (info && !out && rest == 0) || (!out && !info && rest == 2)))
+  {
+    std::fprintf(stderr, "usage: %s [-m] [-s] -o STORE FRAME [FRAME ...]\n"
+                 "       %s -i STORE\n"
+                 "       %s [-u USFAC] STORE IMAGE\n", argv[0], argv[0], argv[0]);
+    return 2;
+  }
+  try
+  {
+    if (out)
+      Write(out, argv + a, rest, means, spectra);
+    else if (info)
+      Info(info);
+    else
+      Register(argv[a], argv[a + 1], usfac);
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
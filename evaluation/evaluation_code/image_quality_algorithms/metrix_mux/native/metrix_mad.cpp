@@ -0,0 +1,42 @@
+//=========================================================================
+// metrix_mad.cpp
+//
+// metrix_mad REFERENCE DISTORTED [DISTORTED ...]
+//
+// Prints the MAD of each distorted image against the reference, one
+// "name mad hi lo" line per image, as MAD_index.m's MAD, HI and LO.
+// The reference is analyzed once (its CSF-filtered luminance and
+// Gabor band statistics), with one plan for every image of its size.
+// Images must be at least 34x34.
+//=========================================================================
+#include <cstdio>
+#include <exception>
+
+#include "image.h"
+#include "mad.h"
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::fprintf(stderr, "usage: %s REFERENCE DISTORTED [DISTORTED ...]\n", argv[0]);
+    return 2;
+  }
+  try
+  {
+    metrix::Image const ref = metrix::ReadImage(argv[1]);
+    metrix::MadPlan plan(ref.Rows(), ref.Cols());
+    metrix::MadReference const analysis(plan, ref);
+    for (int i = 2; i < argc; ++i)
+    {
+      metrix::MadScores const s = plan.Score(analysis, metrix::ReadImage(argv[i]));
+      std::printf("%s %.10f %.10f %.10f\n", argv[i], s.mad, s.hi, s.lo);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,50 @@
+//=========================================================================
+// metrix_mssim.cpp
+//
+// metrix_mssim [-detail] REFERENCE DISTORTED [DISTORTED ...]
+//
+// Prints the multi-scale SSIM of each distorted image against the
+// reference, one "name score" line per image.  With -detail the line
+// goes on with mssim_index's COMP (luminance, contrast, structure) and
+// DETAIL (mean, contrast at scales 1-5, structure at scales 1-5).
+//=========================================================================
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+#include "image.h"
+#include "mssim.h"
+
+int main(int argc, char* argv[])
+{
+  bool const detail = (argc > 1 && std::strcmp(argv[1], "-detail") == 0);
+  int const first = detail ? 2 : 1;
+  if (argc - first < 2)
+  {
+    std::fprintf(stderr, "usage: %s [-detail] REFERENCE DISTORTED [DISTORTED ...]\n", argv[0]);
+    return 2;
+  }
+  try
+  {
+    metrix::Image const ref = metrix::ReadImage(argv[first]);
+    for (int i = first + 1; i < argc; ++i)
+    {
+      metrix::MssimScores const s = metrix::Mssim(ref, metrix::ReadImage(argv[i]));
+      std::printf("%s %.10f", argv[i], s.mssim);
+      if (detail)
+      {
+        for (int k = 0; k < 3; ++k) std::printf(" %.10f", s.comp[k]);
+        std::printf(" %.10f", s.mean);
+        for (int k = 0; k < metrix::MSSIM_LEVELS; ++k) std::printf(" %.10f", s.contrast[k]);
+        for (int k = 0; k < metrix::MSSIM_LEVELS; ++k) std::printf(" %.10f", s.structure[k]);
+      }
+      std::printf("\n");
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
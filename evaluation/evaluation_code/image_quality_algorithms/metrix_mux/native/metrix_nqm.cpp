@@ -0,0 +1,41 @@
+//=========================================================================
+// metrix_nqm.cpp
+//
+// metrix_nqm REFERENCE DISTORTED [DISTORTED ...]
+//
+// Prints the NQM and WSNR (dB) of each distorted image against the
+// reference, one "name nqm wsnr" line per image, with the viewing
+// conditions of metrix_nqm.m and metrix_wsnr.m.  One plan (filter
+// bank, CSF, FFT) serves every image of the reference's size.  Image
+// dimensions must be even.
+//=========================================================================
+#include <cstdio>
+#include <exception>
+
+#include "image.h"
+#include "nqm.h"
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::fprintf(stderr, "usage: %s REFERENCE DISTORTED [DISTORTED ...]\n", argv[0]);
+    return 2;
+  }
+  try
+  {
+    metrix::Image const ref = metrix::ReadImage(argv[1]);
+    metrix::NqmPlan plan(ref.Rows(), ref.Cols());
+    for (int i = 2; i < argc; ++i)
+    {
+      metrix::NqmScores const s = plan.Score(ref, metrix::ReadImage(argv[i]));
+      std::printf("%s %.10f %.10f\n", argv[i], s.nqm, s.wsnr);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,36 @@
+//=========================================================================
+// metrix_vsnr.cpp
+//
+// metrix_vsnr REFERENCE DISTORTED [DISTORTED ...]
+//
+// Prints the VSNR (dB) of each distorted image against the reference,
+// one "name score" line per image.  The reference is analyzed once,
+// so each further image costs one DWT.  Image sizes must be multiples
+// of 32 (see preprocess_metrix_mux.m).
+//=========================================================================
+#include <cstdio>
+#include <exception>
+
+#include "image.h"
+#include "vsnr.h"
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::fprintf(stderr, "usage: %s REFERENCE DISTORTED [DISTORTED ...]\n", argv[0]);
+    return 2;
+  }
+  try
+  {
+    metrix::VsnrReference const ref(metrix::ReadImage(argv[1]));
+    for (int i = 2; i < argc; ++i)
+      std::printf("%s %.10f\n", argv[i], ref.Score(metrix::ReadImage(argv[i])));
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,4 @@
+/*=========================================================================
+  matrix.h (mexhost): the mxArray functions are all in mex.h
+=========================================================================*/
+#include "mex.h"
@@ -0,0 +1,84 @@
+/*=========================================================================
+  mex.h (mexhost)
+
+  The part of the MEX API that the matlabPyrTools MEX sources
+  (utilities/matlabPyrTools/MEX) use, so their mexFunctions run outside
+  Matlab: metrix_bench compiles corrDn.c, upConv.c, histo.c, innerProd.c
+  and pointOp.c against this header (with -Imexhost and mexFunction
+  renamed) and calls them through mexhost_call.  Only real, full
+  double, single, uint8 and uint16 matrices, strings and cell arrays
+  are supported.  Not for the MEX interfaces of native/, which build
+  against Matlab's own mex.h.
+=========================================================================*/
+#ifndef metrix_mexhostH
+#define metrix_mexhostH
+
+#include <stddef.h>
+#include <string.h>   /* as Matlab's headers, which corrDn.c relies on */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef size_t mwSize;
+
+typedef enum
+{
+  mxUNKNOWN_CLASS, mxCELL_CLASS, mxCHAR_CLASS, mxDOUBLE_CLASS,
+  mxSINGLE_CLASS, mxUINT8_CLASS, mxUINT16_CLASS
+} mxClassID;
+
+typedef enum { mxREAL, mxCOMPLEX } mxComplexity;
+
+typedef struct mxArray_tag mxArray;
+
+/* Matrices; the data of a new numeric matrix is zeroed */
+mxArray* mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity complexity);
+mxArray* mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity complexity);
+mxArray* mxCreateCellMatrix(mwSize m, mwSize n);
+mxArray* mxCreateString(const char* str);
+mxArray* mxDuplicateArray(const mxArray* a);
+void mxDestroyArray(mxArray* a);
+#define mxFreeMatrix mxDestroyArray
+
+mxClassID mxGetClassID(const mxArray* a);
+mwSize mxGetM(const mxArray* a);
+mwSize mxGetN(const mxArray* a);
+mwSize mxGetNumberOfElements(const mxArray* a);
+double* mxGetPr(const mxArray* a);
+void* mxGetData(const mxArray* a);
+int mxGetString(const mxArray* a, char* buf, mwSize len);
+mxArray* mxGetCell(const mxArray* a, mwSize i);
+void mxSetCell(mxArray* a, mwSize i, mxArray* value);
+
+int mxIsNumeric(const mxArray* a);
+int mxIsDouble(const mxArray* a);
+int mxIsSingle(const mxArray* a);
+int mxIsUint8(const mxArray* a);
+int mxIsUint16(const mxArray* a);
+int mxIsChar(const mxArray* a);
+int mxIsCell(const mxArray* a);
+int mxIsComplex(const mxArray* a);
+int mxIsSparse(const mxArray* a);
+
+/* mxCalloc'd memory is not freed after the call, as Matlab would */
+void* mxCalloc(size_t n, size_t size);
+void mxFree(void* p);
+
+/* mexPrintf writes to stderr; mexErrMsgTxt ends the mexhost_call */
+int mexPrintf(const char* format, ...);
+void mexErrMsgTxt(const char* msg);
+
+typedef void (*mexhost_function)(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]);
+
+/* Calls F as Matlab would.  Returns 0, or 1 if F raised an error, with
+   its message in MSG (SIZE bytes, truncated).  Outputs F created
+   before the error are destroyed.  Not reentrant across threads. */
+int mexhost_call(mexhost_function f, int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[],
+                 char* msg, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
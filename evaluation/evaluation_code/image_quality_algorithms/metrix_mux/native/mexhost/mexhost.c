@@ -0,0 +1,203 @@
+/*=========================================================================
+  mexhost.c: see mex.h
+=========================================================================*/
+#include "mex.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct mxArray_tag
+{
+  mxClassID id;
+  mwSize m, n;
+  void* data;   /* elements; mxArray* for cells, chars for strings */
+};
+
+static jmp_buf* error_jump = NULL;
+static char error_msg[256];
+
+static size_t ElementSize(mxClassID id)
+{
+  switch (id)
+  {
+  case mxCELL_CLASS: return sizeof(mxArray*);
+  case mxCHAR_CLASS: return 1;
+  case mxDOUBLE_CLASS: return sizeof(double);
+  case mxSINGLE_CLASS: return sizeof(float);
+  case mxUINT8_CLASS: return 1;
+  case mxUINT16_CLASS: return 2;
+  default: return 0;
+  }
+}
+
+static mxArray* NewArray(mxClassID id, mwSize m, mwSize n, size_t extra)
+{
+  mxArray* a = (mxArray*) calloc(1, sizeof(mxArray));
+  if (!a) return NULL;
+  a->id = id;
+  a->m = m;
+  a->n = n;
+  a->data = calloc(m * n * ElementSize(id) + extra, 1);
+  if (!a->data && m * n * ElementSize(id) + extra > 0)
+  {
+    free(a);
+    return NULL;
+  }
+  return a;
+}
+/*-------------------------------------------------------------------------*/
+
+mxArray* mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity complexity)
+{
+  return mxCreateNumericMatrix(m, n, mxDOUBLE_CLASS, complexity);
+}
+
+mxArray* mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity complexity)
+{
+  if (complexity != mxREAL || ElementSize(id) == 0 || id == mxCELL_CLASS || id == mxCHAR_CLASS)
+    return NULL;
+  return NewArray(id, m, n, 0);
+}
+
+mxArray* mxCreateCellMatrix(mwSize m, mwSize n)
+{
+  return NewArray(mxCELL_CLASS, m, n, 0);
+}
+
+mxArray* mxCreateString(const char* str)
+{
+  size_t const len = strlen(str);
+  mxArray* a = NewArray(mxCHAR_CLASS, 1, len, 1);
+  if (a) memcpy(a->data, str, len);
+  return a;
+}
+
+mxArray* mxDuplicateArray(const mxArray* a)
+{
+  mxArray* b;
+  mwSize i;
+  if (a->id == mxCHAR_CLASS) return mxCreateString((const char*) a->data);
+  b = NewArray(a->id, a->m, a->n, 0);
+  if (!b) return NULL;
+  if (a->id != mxCELL_CLASS)
+    memcpy(b->data, a->data, a->m * a->n * ElementSize(a->id));
+  else
+    for (i = 0; i < a->m * a->n; ++i)
+      if (((mxArray**) a->data)[i])
+        ((mxArray**) b->data)[i] = mxDuplicateArray(((mxArray**) a->data)[i]);
+  return b;
+}
+
+void mxDestroyArray(mxArray* a)
+{
+  mwSize i;
+  if (!a) return;
+  if (a->id == mxCELL_CLASS)
+    for (i = 0; i < a->m * a->n; ++i) mxDestroyArray(((mxArray**) a->data)[i]);
+  free(a->data);
+  free(a);
+}
+/*-------------------------------------------------------------------------*/
+
+mxClassID mxGetClassID(const mxArray* a) { return a->id; }
+mwSize mxGetM(const mxArray* a) { return a->m; }
+mwSize mxGetN(const mxArray* a) { return a->n; }
+mwSize mxGetNumberOfElements(const mxArray* a) { return a->m * a->n; }
+double* mxGetPr(const mxArray* a) { return (double*) a->data; }
+void* mxGetData(const mxArray* a) { return a->data; }
+
+int mxGetString(const mxArray* a, char* buf, mwSize len)
+{
+  size_t n;
+  if (a->id != mxCHAR_CLASS || len == 0) return 1;
+  n = strlen((const char*) a->data);
+  if (n >= len) n = len - 1;
+  memcpy(buf, a->data, n);
+  buf[n] = '\0';
+  return (n < a->n) ? 1 : 0;
+}
+
+mxArray* mxGetCell(const mxArray* a, mwSize i)
+{
+  return ((mxArray**) a->data)[i];
+}
+
+void mxSetCell(mxArray* a, mwSize i, mxArray* value)
+{
+  ((mxArray**) a->data)[i] = value;
+}
+/*-------------------------------------------------------------------------*/
+
+int mxIsNumeric(const mxArray* a)
+{
+  return a->id == mxDOUBLE_CLASS || a->id == mxSINGLE_CLASS || a->id == mxUINT8_CLASS ||
+         a->id == mxUINT16_CLASS;
+}
+
+int mxIsDouble(const mxArray* a) { return a->id == mxDOUBLE_CLASS; }
+int mxIsSingle(const mxArray* a) { return a->id == mxSINGLE_CLASS; }
+int mxIsUint8(const mxArray* a) { return a->id == mxUINT8_CLASS; }
+int mxIsUint16(const mxArray* a) { return a->id == mxUINT16_CLASS; }
+int mxIsChar(const mxArray* a) { return a->id == mxCHAR_CLASS; }
+int mxIsCell(const mxArray* a) { return a->id == mxCELL_CLASS; }
+int mxIsComplex(const mxArray* a) { (void) a; return 0; }
+int mxIsSparse(const mxArray* a) { (void) a; return 0; }
+/*-------------------------------------------------------------------------*/
+
+void* mxCalloc(size_t n, size_t size)
+{
+  return calloc(n ? n : 1, size ? size : 1);
+}
+
+void mxFree(void* p)
+{
+  free(p);
+}
+
+int mexPrintf(const char* format, ...)
+{
+  int n;
+  va_list args;
+  va_start(args, format);
+  n = vfprintf(stderr, format, args);
+  va_end(args);
+  return n;
+}
+
+void mexErrMsgTxt(const char* msg)
+{
+  snprintf(error_msg, sizeof(error_msg), "%s", msg);
+  if (!error_jump)
+  {
+    fprintf(stderr, "mexErrMsgTxt outside mexhost_call: %s\n", msg);
+    abort();
+  }
+  longjmp(*error_jump, 1);
+}
+/*-------------------------------------------------------------------------*/
+
+int mexhost_call(mexhost_function f, int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[],
+                 char* msg, size_t size)
+{
+  jmp_buf jump;
+  int i, nout = (nlhs > 0) ? nlhs : 1;   /* Matlab passes room for ans */
+  for (i = 0; i < nout; ++i) plhs[i] = NULL;
+  error_jump = &jump;
+  if (setjmp(jump))
+  {
+    error_jump = NULL;
+    for (i = 0; i < nout; ++i)
+    {
+      mxDestroyArray(plhs[i]);
+      plhs[i] = NULL;
+    }
+    if (msg && size) snprintf(msg, size, "%s", error_msg);
+    return 1;
+  }
+  f(nlhs, plhs, nrhs, prhs);
+  error_jump = NULL;
+  return 0;
+}
@@ -0,0 +1,51 @@
+//=========================================================================
+// mexutil.h
+//
+// Helpers shared by the MEX interfaces of the native engines.  Only
+// MEX sources include this (it needs mex.h).
+//=========================================================================
+#ifndef metrix_mexutilH
+#define metrix_mexutilH
+
+#include <mex.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "image.h"
+
+namespace metrix {
+
+// Copies a real 2D double, single or uint8 matrix into an Image;
+// throws std::runtime_error (naming the argument NAME) for anything
+// else, so that the caller reports it with the other engine errors.
+inline Image ImageArg(const mxArray* arg, const char* name)
+{
+  if (mxIsComplex(arg) || mxIsSparse(arg) || mxGetNumberOfDimensions(arg) != 2 ||
+      !(mxIsDouble(arg) || mxIsSingle(arg) || mxIsUint8(arg)))
+    throw std::runtime_error(std::string(name) +
+                             " must be a real 2D double, single or uint8 matrix.");
+  Image im((int) mxGetM(arg), (int) mxGetN(arg));
+  double* dst = im.Data();
+  std::size_t const n = im.Size();
+  if (mxIsDouble(arg))
+  {
+    const double* src = mxGetPr(arg);
+    for (std::size_t i = 0; i < n; ++i) dst[i] = src[i];
+  }
+  else if (mxIsSingle(arg))
+  {
+    const float* src = (const float*) mxGetData(arg);
+    for (std::size_t i = 0; i < n; ++i) dst[i] = src[i];
+  }
+  else
+  {
+    const unsigned char* src = (const unsigned char*) mxGetData(arg);
+    for (std::size_t i = 0; i < n; ++i) dst[i] = src[i];
+  }
+  return im;
+}
+
+} // namespace metrix
+//=========================================================================
+#endif
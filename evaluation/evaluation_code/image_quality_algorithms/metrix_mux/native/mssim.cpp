@@ -0,0 +1,354 @@
+//=========================================================================
+// mssim.cpp
+//=========================================================================
+#include "mssim.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+const int WIN = 11;             // fspecial('gaussian', 11, 1.5)
+const double WIN_SIGMA = 1.5;
+const int LPF_RADIUS = 4;       // 9-tap 9/7 analysis lowpass
+const int LANES = 8;            // rows per block: fixed-length inner loops vectorize
+
+// mssim_index's lod (lpf = lod*lod' / sum)
+const double LOD[2 * LPF_RADIUS + 1] = {
+  0.037828455507260, -0.023849465019560, -0.110624404418440,
+  0.377402855612830, 0.852698679008890, 0.377402855612830,
+  -0.110624404418440, -0.023849465019560, 0.037828455507260 };
+
+// exponents of the terms (mssim_index's alpha, beta = gamma)
+const double ALPHA = 0.1333;
+const double BETA[MSSIM_LEVELS] = {0.0448, 0.2856, 0.3001, 0.2363, 0.1333};
+
+// 'symmetric' padding: mirror about the edge, repeating the edge sample
+inline int Symmetric(int i, int n)
+{
+  while (i < 0 || i >= n) i = (i < 0) ? -i - 1 : 2 * n - 1 - i;
+  return i;
+}
+
+struct Scale
+{
+  Image x, y;
+};
+
+// Per-column sums over the valid part of one scale: of the SSIM terms
+// (M, V, R), and of the single-scale SSIM map (S)
+struct ColumnSums
+{
+  std::vector<double> m, v, r, s;
+};
+
+// The normalized 1D Gaussian: fspecial's 2D window is its outer product.
+std::vector<double> GaussianWindow()
+{
+  std::vector<double> w(WIN);
+  double s = 0.0;
+  for (int i = 0; i < WIN; ++i)
+  {
+    double const d = i - WIN / 2;
+    w[i] = std::exp(-d * d / (2.0 * WIN_SIGMA * WIN_SIGMA));
+    s += w[i];
+  }
+  for (int i = 0; i < WIN; ++i) w[i] /= s;
+  return w;
+}
+
+// ssim_index_modified's M, V, R for one window's moments
+inline void SsimTerms(double mu1, double mu2, double e11, double e22, double e12,
+                      double C1, double C2, double& M, double& V, double& R)
+{
+  double const mu1_sq = mu1 * mu1, mu2_sq = mu2 * mu2, mu1_mu2 = mu1 * mu2;
+  double const s1_sq = e11 - mu1_sq;
+  double const s2_sq = e22 - mu2_sq;
+  double const s12 = e12 - mu1_mu2;
+  double const s1 = (s1_sq > 0.0) ? std::sqrt(s1_sq) : 0.0;   // real(sqrt())
+  double const s2 = (s2_sq > 0.0) ? std::sqrt(s2_sq) : 0.0;
+  if (C1 > 0 && C2 > 0)
+  {
+    M = (2 * mu1_mu2 + C1) / (mu1_sq + mu2_sq + C1);
+    V = (2 * s1 * s2 + C2) / (s1_sq + s2_sq + C2);
+    R = (s12 + C2 / 2) / (s1 * s2 + C2 / 2);
+  }
+  else
+  {
+    double const ld = mu1_sq + mu2_sq, cd = s1_sq + s2_sq;
+    M = (ld > 0) ? 2 * mu1_mu2 / ld : 1.0;
+    V = (cd > 0) ? 2 * s1 * s2 / cd : 1.0;
+    R = (s1 > 0 && s2 > 0) ? s12 / (s1 * s2) : (s1 > 0 || s2 > 0) ? 0.0 : 1.0;
+  }
+}
+
+// ssim_index's SSIM map for one window's moments
+inline double SsimMap(double mu1, double mu2, double e11, double e22, double e12,
+                      double C1, double C2)
+{
+  double const mu1_sq = mu1 * mu1, mu2_sq = mu2 * mu2, mu1_mu2 = mu1 * mu2;
+  double const s1_sq = e11 - mu1_sq;
+  double const s2_sq = e22 - mu2_sq;
+  double const s12 = e12 - mu1_mu2;
+  if (C1 > 0 && C2 > 0)
+    return ((2 * mu1_mu2 + C1) * (2 * s12 + C2)) / ((mu1_sq + mu2_sq + C1) * (s1_sq + s2_sq + C2));
+  double const n1 = 2 * mu1_mu2 + C1, n2 = 2 * s12 + C2;
+  double const d1 = mu1_sq + mu2_sq + C1, d2 = s1_sq + s2_sq + C2;
+  if (d1 * d2 > 0) return (n1 * n2) / (d1 * d2);
+  if (d1 != 0 && d2 == 0) return n1 / d1;
+  return 1.0;
+}
+
+// One sweep over scale S: the sums of each valid output column into
+// SUMS, of the SSIM terms with TERMS and of the SSIM map with MAP (both
+// from the same windowed moments), and (unless NEXT is null) the
+// lowpassed, decimated images into NEXT.
+void Sweep(const Scale& s, const std::vector<double>& w, const std::vector<double>& h,
+           double C1, double C2, bool terms, bool map, ColumnSums* sums, Scale* next)
+{
+  int const rows = s.x.Rows(), cols = s.x.Cols();
+  int const vrows = rows - WIN + 1, vcols = cols - WIN + 1;
+  int const drows = (rows + 1) / 2, dcols = (cols + 1) / 2;
+  sums->m.assign(terms ? vcols : 0, 0.0);
+  sums->v.assign(terms ? vcols : 0, 0.0);
+  sums->r.assign(terms ? vcols : 0, 0.0);
+  sums->s.assign(map ? vcols : 0, 0.0);
+  if (next)
+  {
+    next->x = Image(drows, dcols);
+    next->y = Image(drows, dcols);
+  }
+
+  OMP(omp parallel)
+  {
+    std::vector<double> acc(5 * (std::size_t) rows), mom(5 * (std::size_t) vrows);
+    std::vector<double> lx(rows), ly(rows);
+
+    OMP(omp for schedule(static))
+    for (int c = 0; c < cols; ++c)
+    {
+      if (c < vcols)
+      {
+        // across columns: x, y, x^2, y^2, xy for every row, in blocks
+        // of LANES rows held in registers
+        double* const ax = &acc[0];
+        double* const ay = ax + rows;
+        double* const axx = ay + rows;
+        double* const ayy = axx + rows;
+        double* const axy = ayy + rows;
+        const double* const x0 = s.x.Data() + (std::size_t) c * rows;
+        const double* const y0 = s.y.Data() + (std::size_t) c * rows;
+        int r = 0;
+        for (; r + LANES <= rows; r += LANES)
+        {
+          double bx[LANES] = {0}, by[LANES] = {0}, bxx[LANES] = {0}, byy[LANES] = {0}, bxy[LANES] = {0};
+          for (int d = 0; d < WIN; ++d)
+          {
+            const double* xc = x0 + (std::size_t) d * rows + r;
+            const double* yc = y0 + (std::size_t) d * rows + r;
+            double const wd = w[d];
+            for (int l = 0; l < LANES; ++l)
+            {
+              double const a = xc[l], b = yc[l];
+              bx[l] += wd * a;  by[l] += wd * b;
+              bxx[l] += wd * (a * a);  byy[l] += wd * (b * b);  bxy[l] += wd * (a * b);
+            }
+          }
+          for (int l = 0; l < LANES; ++l)
+          {
+            ax[r + l] = bx[l];  ay[r + l] = by[l];
+            axx[r + l] = bxx[l];  ayy[r + l] = byy[l];  axy[r + l] = bxy[l];
+          }
+        }
+        for (; r < rows; ++r)
+        {
+          double tx = 0.0, ty = 0.0, txx = 0.0, tyy = 0.0, txy = 0.0;
+          for (int d = 0; d < WIN; ++d)
+          {
+            double const a = x0[(std::size_t) d * rows + r], b = y0[(std::size_t) d * rows + r];
+            tx += w[d] * a;  ty += w[d] * b;
+            txx += w[d] * (a * a);  tyy += w[d] * (b * b);  txy += w[d] * (a * b);
+          }
+          ax[r] = tx;  ay[r] = ty;  axx[r] = txx;  ayy[r] = tyy;  axy[r] = txy;
+        }
+        // down the rows: the five windowed moments of the valid rows
+        for (int k = 0; k < 5; ++k)
+        {
+          const double* src = &acc[(std::size_t) k * rows];
+          double* dst = &mom[(std::size_t) k * vrows];
+          int i = 0;
+          for (; i + LANES <= vrows; i += LANES)
+          {
+            double t[LANES] = {0};
+            for (int d = 0; d < WIN; ++d)
+              for (int l = 0; l < LANES; ++l) t[l] += w[d] * src[i + d + l];
+            for (int l = 0; l < LANES; ++l) dst[i + l] = t[l];
+          }
+          for (; i < vrows; ++i)
+          {
+            double t = 0.0;
+            for (int d = 0; d < WIN; ++d) t += w[d] * src[i + d];
+            dst[i] = t;
+          }
+        }
+        if (map)
+        {
+          double ss = 0.0;
+          for (int i = 0; i < vrows; ++i)
+            ss += SsimMap(mom[i], mom[vrows + i], mom[2 * vrows + i], mom[3 * vrows + i],
+                          mom[4 * vrows + i], C1, C2);
+          sums->s[c] = ss;
+        }
+        if (terms)
+        {
+          double sm = 0.0, sv = 0.0, sr = 0.0;
+          for (int i = 0; i < vrows; ++i)
+          {
+            double M, V, R;
+            SsimTerms(mom[i], mom[vrows + i], mom[2 * vrows + i], mom[3 * vrows + i],
+                      mom[4 * vrows + i], C1, C2, M, V, R);
+            sm += M;  sv += V;  sr += R;
+          }
+          sums->m[c] = sm;
+          sums->v[c] = sv;
+          sums->r[c] = sr;
+        }
+      }
+
+      if (next && c % 2 == 0)
+      {
+        // imfilter(img, lpf, 'symmetric', 'same') at the even samples
+        std::fill(lx.begin(), lx.end(), 0.0);
+        std::fill(ly.begin(), ly.end(), 0.0);
+        for (int d = -LPF_RADIUS; d <= LPF_RADIUS; ++d)
+        {
+          std::size_t const cc = (std::size_t) Symmetric(c + d, cols) * rows;
+          const double* xc = s.x.Data() + cc;
+          const double* yc = s.y.Data() + cc;
+          double const hd = h[d + LPF_RADIUS];
+          for (int r = 0; r < rows; ++r)
+          {
+            lx[r] += hd * xc[r];
+            ly[r] += hd * yc[r];
+          }
+        }
+        double* ox = next->x.Data() + (std::size_t) (c / 2) * drows;
+        double* oy = next->y.Data() + (std::size_t) (c / 2) * drows;
+        for (int i = 0; i < drows; ++i)
+        {
+          double tx = 0.0, ty = 0.0;
+          int const r0 = 2 * i - LPF_RADIUS;
+          if (r0 >= 0 && r0 + 2 * LPF_RADIUS < rows)
+            for (int d = 0; d <= 2 * LPF_RADIUS; ++d)
+            {
+              tx += h[d] * lx[r0 + d];
+              ty += h[d] * ly[r0 + d];
+            }
+          else
+            for (int d = 0; d <= 2 * LPF_RADIUS; ++d)
+            {
+              int const r = Symmetric(r0 + d, rows);
+              tx += h[d] * lx[r];
+              ty += h[d] * ly[r];
+            }
+          ox[i] = tx;
+          oy[i] = ty;
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+MssimScores Mssim(const Image& ref, const Image& dist, const MssimOptions& opt, double* ssim)
+{
+  METRIX_TRACE_SCOPE("stats/Mssim");
+  if (ref.Rows() != dist.Rows() || ref.Cols() != dist.Cols())
+    throw std::runtime_error("Mssim: images differ in size");
+  int const min_size = (WIN - 1) * (1 << (MSSIM_LEVELS - 1)) + 1;
+  if (ref.Rows() < min_size || ref.Cols() < min_size)
+    throw std::runtime_error("Mssim: image smaller than the window at the coarsest scale");
+
+  double const C1 = (opt.K1 * opt.L) * (opt.K1 * opt.L);
+  double const C2 = (opt.K2 * opt.L) * (opt.K2 * opt.L);
+  std::vector<double> const w = GaussianWindow();
+  std::vector<double> h(LOD, LOD + 2 * LPF_RADIUS + 1);
+  double hs = 0.0;
+  for (std::size_t i = 0; i < h.size(); ++i) hs += h[i];
+  for (std::size_t i = 0; i < h.size(); ++i) h[i] /= hs;
+
+  MssimScores res;
+  Scale cur, next;
+  cur.x = ref;
+  cur.y = dist;
+  for (int s = 0; s < MSSIM_LEVELS; ++s)
+  {
+    ColumnSums sums;
+    bool const map = (s == 0 && ssim);
+    Sweep(cur, w, h, C1, C2, true, map, &sums, (s + 1 < MSSIM_LEVELS) ? &next : 0);
+    double sm = 0.0, sv = 0.0, sr = 0.0, ss = 0.0;
+    for (std::size_t c = 0; c < sums.m.size(); ++c)
+    {
+      sm += sums.m[c];  sv += sums.v[c];  sr += sums.r[c];
+    }
+    for (std::size_t c = 0; c < sums.s.size(); ++c) ss += sums.s[c];
+    double const count = (double) (cur.x.Rows() - WIN + 1) * sums.m.size();
+    if (map) *ssim = ss / count;
+    res.mean = sm / count;
+    res.contrast[s] = sv / count;
+    res.structure[s] = sr / count;
+    if (s + 1 < MSSIM_LEVELS) std::swap(cur, next);
+  }
+
+  res.comp[0] = std::pow(res.mean, ALPHA);
+  res.comp[1] = res.comp[2] = 1.0;
+  for (int s = 0; s < MSSIM_LEVELS; ++s)
+  {
+    res.comp[1] *= std::pow(res.contrast[s], BETA[s]);
+    res.comp[2] *= std::pow(res.structure[s], BETA[s]);
+  }
+  res.mssim = res.comp[0] * res.comp[1] * res.comp[2];
+  return res;
+}
+//-------------------------------------------------------------------------
+
+double Ssim(const Image& ref, const Image& dist, const MssimOptions& opt)
+{
+  METRIX_TRACE_SCOPE("stats/Ssim");
+  if (ref.Rows() != dist.Rows() || ref.Cols() != dist.Cols())
+    throw std::runtime_error("Ssim: images differ in size");
+  if (ref.Rows() < WIN || ref.Cols() < WIN)
+    throw std::runtime_error("Ssim: image smaller than the window");
+
+  double const C1 = (opt.K1 * opt.L) * (opt.K1 * opt.L);
+  double const C2 = (opt.K2 * opt.L) * (opt.K2 * opt.L);
+  Scale s;
+  s.x = ref;
+  s.y = dist;
+  ColumnSums sums;
+  Sweep(s, GaussianWindow(), std::vector<double>(), C1, C2, false, true, &sums, 0);
+  double ss = 0.0;
+  for (std::size_t c = 0; c < sums.s.size(); ++c) ss += sums.s[c];
+  return ss / ((double) (ref.Rows() - WIN + 1) * sums.s.size());
+}
+//-------------------------------------------------------------------------
+
+std::vector<MssimScores> Mssim(const std::vector<Image>& refs, const std::vector<Image>& dists,
+                               const MssimOptions& opt)
+{
+  if (refs.size() != dists.size())
+    throw std::runtime_error("Mssim: batches differ in length");
+  std::vector<MssimScores> res(refs.size());
+  for (std::size_t i = 0; i < refs.size(); ++i) res[i] = Mssim(refs[i], dists[i], opt);
+  return res;
+}
+
+} // namespace metrix
+//=========================================================================
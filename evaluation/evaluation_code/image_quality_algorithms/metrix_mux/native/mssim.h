@@ -0,0 +1,70 @@
+//=========================================================================
+// mssim.h
+//
+// Multi-scale SSIM, as mssim_index.m (metrix/mssim): the mean, contrast
+// and structure terms of ssim_index_modified.m (11x11 Gaussian window,
+// sigma 1.5) at five scales, each scale the previous one lowpassed
+// with the 9/7 analysis filter ('symmetric' edges) and decimated by 2.
+//
+// Each scale is one sweep over the image.  It reads every column
+// once: an 11-tap pass across columns accumulates the five products
+// (x, y, x^2, y^2, xy), an 11-tap pass down the rows gives the windowed
+// moments, and the SSIM terms are summed on the fly.  The lowpass and
+// decimation for the next scale run in the same sweep.  The sweep is
+// split into bands of columns (contiguous in memory) across threads.
+// Each column's sums are kept separately and added in order, so the
+// scores do not depend on the number of threads.
+//=========================================================================
+#ifndef metrix_mssimH
+#define metrix_mssimH
+
+#include <vector>
+
+#include "image.h"
+
+namespace metrix {
+
+const int MSSIM_LEVELS = 5;
+
+struct MssimOptions
+{
+  double K1, K2;   // stabilizing constants, relative to the dynamic range
+  double L;        // dynamic range
+  MssimOptions() : K1(0.01), K2(0.03), L(255.0) {}
+};
+
+// The outputs of mssim_index.m: MSSIM, COMP = [luminance contrast
+// structure] and DETAIL = [mean, contrast(1:5), structure(1:5)] (the
+// per-scale means of the SSIM terms; only the coarsest scale's mean is
+// used).  A negative structure mean makes Matlab's score complex; here
+// it is NaN.
+struct MssimScores
+{
+  double mssim;
+  double comp[3];
+  double mean;
+  double contrast[MSSIM_LEVELS];
+  double structure[MSSIM_LEVELS];
+};
+
+// Throws std::runtime_error if the images differ in size or the
+// coarsest scale is smaller than the 11x11 window (images under
+// 161x161).  With SSIM, also Ssim() of the pair, from the windowed
+// moments of the first scale.
+MssimScores Mssim(const Image& ref, const Image& dist,
+                  const MssimOptions& opt = MssimOptions(), double* ssim = 0);
+
+// ssim_index.m (metrix/ssim, the SSIM of metrix_mux): the mean SSIM
+// map over the 11x11 windows inside the image, from the first-scale
+// sweep.  Throws std::runtime_error if the images differ in size or
+// are smaller than the window (ssim_index returns -Inf).
+double Ssim(const Image& ref, const Image& dist, const MssimOptions& opt = MssimOptions());
+
+// Scores of a batch of pairs: REFS[i] against DISTS[i].  Each pair
+// uses all threads.
+std::vector<MssimScores> Mssim(const std::vector<Image>& refs, const std::vector<Image>& dists,
+                               const MssimOptions& opt = MssimOptions());
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,81 @@
+//=========================================================================
+// mssim_native.cpp
+//
+// [MSSIM, COMP, DETAIL] = mssim_native(IMG1, IMG2)
+//
+// Matlab interface to the native MS-SSIM engine (mssim.h): the outputs
+// of mssim_index(IMG1, IMG2) with its default K and filters, to
+// floating-point roundoff.  IMG1 and IMG2 are real 2D matrices of the
+// same size (double, single or uint8), or cell arrays of N such pairs.
+// For a batch MSSIM is N x 1, COMP N x 3 and DETAIL N x 11, one row
+// per pair.  Built by metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+#include <vector>
+
+#include "mexutil.h"
+#include "mssim.h"
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs != 2) mexErrMsgIdAndTxt("metrix:mssim_native", "requires 2 arguments.");
+  if (nlhs > 3) mexErrMsgIdAndTxt("metrix:mssim_native", "returns at most 3 values.");
+  bool const batch = mxIsCell(prhs[0]);
+  if (batch != (bool) mxIsCell(prhs[1]) ||
+      (batch && mxGetNumberOfElements(prhs[0]) != mxGetNumberOfElements(prhs[1])))
+    mexErrMsgIdAndTxt("metrix:mssim_native",
+                      "IMG1 and IMG2 must both be images or cell arrays of the same length.");
+  std::size_t const n = batch ? mxGetNumberOfElements(prhs[0]) : 1;
+
+  std::vector<metrix::MssimScores> scores;
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      std::vector<metrix::Image> refs(n), dists(n);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        const mxArray* a = batch ? mxGetCell(prhs[0], i) : prhs[0];
+        const mxArray* b = batch ? mxGetCell(prhs[1], i) : prhs[1];
+        if (!a || !b) throw std::runtime_error("empty cell in the batch.");
+        refs[i] = metrix::ImageArg(a, "IMG1");
+        dists[i] = metrix::ImageArg(b, "IMG2");
+      }
+      scores = metrix::Mssim(refs, dists);
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:mssim_native", "%s", msg);
+
+  int const L = metrix::MSSIM_LEVELS;
+  plhs[0] = mxCreateDoubleMatrix(n, 1, mxREAL);
+  double* mssim = mxGetPr(plhs[0]);
+  for (std::size_t i = 0; i < n; ++i) mssim[i] = scores[i].mssim;
+  if (nlhs > 1)
+  {
+    plhs[1] = mxCreateDoubleMatrix(n, 3, mxREAL);
+    double* comp = mxGetPr(plhs[1]);
+    for (std::size_t i = 0; i < n; ++i)
+      for (int k = 0; k < 3; ++k) comp[i + k * n] = scores[i].comp[k];
+  }
+  if (nlhs > 2)
+  {
+    plhs[2] = mxCreateDoubleMatrix(n, 1 + 2 * L, mxREAL);
+    double* detail = mxGetPr(plhs[2]);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      detail[i] = scores[i].mean;
+      for (int k = 0; k < L; ++k)
+      {
+        detail[i + (1 + k) * n] = scores[i].contrast[k];
+        detail[i + (1 + L + k) * n] = scores[i].structure[k];
+      }
+    }
+  }
+}
@@ -0,0 +1,285 @@
+//=========================================================================
+// nqm.cpp
+//=========================================================================
+#include "nqm.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// nqm.m's cosine-log filter bank: band B is
+// 0.5*(1 + cos(pi*log2(r) - SHIFT*pi)) for LO <= r <= HI (r + 2 for
+// the lowpass band), and 0 elsewhere.  No band reaches beyond radius
+// MAX_RADIUS.
+const double BAND_LO[NQM_BANDS] = {1, 1, 2, 4, 8, 16};
+const double BAND_HI[NQM_BANDS] = {4, 4, 8, 16, 32, 64};
+const double BAND_OUT[NQM_BANDS] = {4, 4, 0.5, 4, 0.5, 4};   // log2 of these gives 0
+const bool BAND_SHIFT[NQM_BANDS] = {true, true, false, true, false, true};
+const int MAX_RADIUS = 64;
+
+// wsnr.m's CSF (Mannos-Sakrison, modified by Mitsa and Varkur)
+const double CSF_SYMMETRY = 0.7;
+const double CSF_FLAT_BELOW = 7.8909;
+const double CSF_PEAK = 0.9809;
+
+// ctf.m: bandpass contrast threshold at F cycles/degree
+double Ctf(double f)
+{
+  return 1.0 / (200.0 * (2.6 * (0.0192 + 0.114 * f) * std::exp(-std::pow(0.114 * f, 1.1))));
+}
+
+double BandGain(int b, double r)
+{
+  double const v = (b == 0) ? r + 2.0 : r;
+  double const x = (v >= BAND_LO[b] && v <= BAND_HI[b]) ? v : BAND_OUT[b];
+  double const phase = PI * std::log2(x);
+  return 0.5 * (1.0 + std::cos(BAND_SHIFT[b] ? phase - PI : phase));
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+NqmPlan::NqmPlan(int rows, int cols, const NqmOptions& opt)
+  : fft_(rows, cols), opt_(opt)
+{
+  if (rows % 2 != 0 || cols % 2 != 0)
+    throw std::runtime_error("NqmPlan: image dimensions must be even");
+
+  // the filter bank, at the bins within MAX_RADIUS of DC (nqm.m's
+  // fftshift'ed grid: bin k has frequency k, or k - n above n/2)
+  for (int b = 0; b < NQM_BANDS; ++b) radius_[b] = -1;
+  for (int c = 0; c < cols; ++c)
+  {
+    int const fc = BinFrequency(c, cols);
+    if (std::abs(fc) > MAX_RADIUS) continue;
+    for (int r = 0; r < rows; ++r)
+    {
+      int const fr = BinFrequency(r, rows);
+      if (std::abs(fr) > MAX_RADIUS) continue;
+      double const rad = std::sqrt((double) (fc * fc + fr * fr));
+      double g[NQM_BANDS];
+      bool any = false;
+      for (int b = 0; b < NQM_BANDS; ++b)
+      {
+        g[b] = BandGain(b, rad);
+        if (g[b] != 0.0)
+        {
+          any = true;
+          radius_[b] = std::max(radius_[b], std::abs(fr));
+        }
+      }
+      if (!any) continue;
+      bins_.push_back(r + (std::size_t) c * rows);
+      gains_.insert(gains_.end(), g, g + NQM_BANDS);
+    }
+  }
+
+  for (int b = 0; b < NQM_BANDS; ++b)
+  {
+    ctf_band_[b] = Ctf(b);
+    ctf_detect_[b] = Ctf(std::pow(2.0, b) / opt.viewing_angle);
+  }
+
+  // wsnr.m's CSF on its centered half-bin grid, at the bins of the
+  // unshifted spectrum (fftshift moves bin k to k + n/2)
+  csf2_.resize((std::size_t) rows * cols);
+  double const w = CSF_SYMMETRY;
+  for (int c = 0; c < cols; ++c)
+  {
+    double const xp = -cols / 2.0 + 0.5 + (c + cols / 2) % cols;
+    for (int r = 0; r < rows; ++r)
+    {
+      double const yp = -rows / 2.0 + 0.5 + (r + rows / 2) % rows;
+      double const re = xp / rows * 2.0 * opt.nyquist_freq;
+      double const im = yp / rows * 2.0 * opt.nyquist_freq;
+      double const s = (1.0 - w) / 2.0 * std::cos(4.0 * std::atan2(im, re)) + (1.0 + w) / 2.0;
+      double const f = std::hypot(re, im) / s;
+      double const csf = (f < CSF_FLAT_BELOW) ? CSF_PEAK
+        : 2.6 * (0.0192 + 0.114 * f) * std::exp(-std::pow(0.114 * f, 1.1));
+      csf2_[r + (std::size_t) c * rows] = csf * csf;
+    }
+  }
+
+  std::size_t const n = (std::size_t) rows * cols;
+  spec_.resize(n);
+  work_.resize(n);
+  den_.resize(n);
+  sum_.resize(n);
+}
+//-------------------------------------------------------------------------
+
+double NqmPlan::Wsnr(bool same) const
+{
+  int const rows = Rows(), cols = Cols();
+  std::vector<double> mss(cols), mse(cols);
+
+  // fft2(ref) = (Z(k) + Z*(-k))/2 and fft2(dist) = (Z(k) - Z*(-k))/2i
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    const Complex* z = &spec_[(std::size_t) c * rows];
+    const Complex* zn = &spec_[(std::size_t) ((cols - c) % cols) * rows];
+    const double* w2 = &csf2_[(std::size_t) c * rows];
+    double ss = 0.0, se = 0.0;
+    for (int r = 0; r < rows; ++r)
+    {
+      Complex const a = z[r], b = std::conj(zn[(rows - r) % rows]);
+      Complex const fo = 0.5 * (a + b);
+      Complex const fi = Complex(0.0, -0.5) * (a - b);
+      ss += std::norm(fo);
+      se += w2[r] * std::norm(fo - fi);
+    }
+    mss[c] = ss;
+    mse[c] = se;
+  }
+
+  double ss = 0.0, se = 0.0;
+  for (int c = 0; c < cols; ++c)
+  {
+    ss += mss[c];
+    se += mse[c];
+  }
+  if (same) se = 0.0;   // the error spectrum is exactly zero
+  return 10.0 * std::log10(ss / se);
+}
+//-------------------------------------------------------------------------
+
+void NqmPlan::Band(int b)
+{
+  int const rows = Rows(), cols = Cols();
+  int const rad = radius_[b];
+  if (rad < 0)
+  {
+    std::fill(work_.begin(), work_.end(), Complex());
+    return;
+  }
+  // rows beyond RAD are cleared by the pruned inverse
+  int const lo = std::min(rad, rows - 1), hi = std::max(rows - rad, lo + 1);
+  OMP(omp parallel for schedule(static))
+  for (int c = 0; c < cols; ++c)
+  {
+    Complex* w = &work_[(std::size_t) c * rows];
+    std::fill(w, w + lo + 1, Complex());
+    std::fill(w + hi, w + rows, Complex());
+  }
+  for (std::size_t j = 0; j < bins_.size(); ++j)
+  {
+    double const g = gains_[j * NQM_BANDS + b];
+    if (g != 0.0) work_[bins_[j]] = g * spec_[bins_[j]];
+  }
+  fft_.Inverse(&work_[0], rad);
+}
+//-------------------------------------------------------------------------
+
+void NqmPlan::Transform(const Image& ref, const Image& dist)
+{
+  int const rows = Rows(), cols = Cols();
+  if (ref.Rows() != rows || ref.Cols() != cols || dist.Rows() != rows || dist.Cols() != cols)
+    throw std::runtime_error("NqmPlan: image size differs from the plan's");
+
+  std::size_t const n = ref.Size();
+  const double* x = ref.Data();
+  const double* y = dist.Data();
+  for (std::size_t i = 0; i < n; ++i) spec_[i] = Complex(x[i], y[i]);
+  fft_.Forward(&spec_[0]);
+}
+//-------------------------------------------------------------------------
+
+double NqmPlan::ScoreWsnr(const Image& ref, const Image& dist)
+{
+  Transform(ref, dist);
+  return Wsnr(SameImage(ref, dist));
+}
+//-------------------------------------------------------------------------
+
+NqmScores NqmPlan::Score(const Image& ref, const Image& dist)
+{
+  METRIX_TRACE_SCOPE("eval/NqmPlan::Score");
+  int const rows = Rows(), cols = Cols();
+  Transform(ref, dist);
+
+  // the unpacked spectra (and band images) of equal images differ by
+  // roundoff; Matlab's are equal, and both scores infinite
+  bool const same = SameImage(ref, dist);
+
+  NqmScores res;
+  res.wsnr = Wsnr(same);
+
+  // the real parts are nqm.m's a_b (ref), the imaginary parts ai_b (dist)
+  Band(0);
+  std::copy(work_.begin(), work_.end(), den_.begin());
+  std::fill(sum_.begin(), sum_.end(), Complex());
+
+  std::vector<double> col_sp(cols), col_np(cols);
+  for (int b = 1; b < NQM_BANDS; ++b)
+  {
+    Band(b);
+    bool const last = (b + 1 == NQM_BANDS);
+    double const ct = ctf_band_[b], d = ctf_detect_[b];
+
+    OMP(omp parallel for schedule(static))
+    for (int c = 0; c < cols; ++c)
+    {
+      std::size_t const o = (std::size_t) c * rows;
+      Complex* w = &work_[o];
+      Complex* den = &den_[o];
+      Complex* sum = &sum_[o];
+      double sp = 0.0, np = 0.0;
+      for (int r = 0; r < rows; ++r)
+      {
+        double const a = w[r].real(), ai = same ? a : w[r].imag();
+        double const da = den[r].real(), dai = same ? da : den[r].imag();
+        // contrast images
+        double const cx = a / da, ci = ai / dai;
+        // cmaskn: suprathreshold masking of the distorted band
+        double const cc = (std::fabs(ci) > 1.0) ? 1.0 : ci;
+        double const T = ct * (0.86 * ((cx / ct) - 1.0) + 0.3);
+        double const am = (std::fabs(cc - cx) - T < 0.0) ? a : ai;
+        // gthresh: detection thresholds
+        double const y1 = sum[r].real() + ((std::fabs(cx) < d) ? 0.0 : a);
+        double const y2 = sum[r].imag() + ((std::fabs(ci) < d) ? 0.0 : am);
+        if (last)
+        {
+          sp += y1 * y1;
+          np += (y1 - y2) * (y1 - y2);
+        }
+        else
+        {
+          sum[r] = Complex(y1, y2);
+          den[r] += w[r];
+        }
+      }
+      col_sp[c] = sp;
+      col_np[c] = np;
+    }
+  }
+
+  double sp = 0.0, np = 0.0;
+  for (int c = 0; c < cols; ++c)
+  {
+    sp += col_sp[c];
+    np += col_np[c];
+  }
+  res.nqm = 10.0 * std::log10(sp / np);
+  return res;
+}
+//-------------------------------------------------------------------------
+
+NqmScores Nqm(const Image& ref, const Image& dist, const NqmOptions& opt)
+{
+  if (ref.Rows() != dist.Rows() || ref.Cols() != dist.Cols())
+    throw std::runtime_error("Nqm: images differ in size");
+  return NqmPlan(ref.Rows(), ref.Cols(), opt).Score(ref, dist);
+}
+
+} // namespace metrix
+//=========================================================================
@@ -0,0 +1,102 @@
+//=========================================================================
+// nqm.h
+//
+// Noise quality measure and weighted SNR, as nqm_modified.m and
+// wsnr_new_modified.m (metrix/nqm/ImageQuality) with the arguments of
+// metrix_nqm.m and metrix_wsnr.m.
+//
+// Everything that depends only on the image size is in an NqmPlan: the
+// cosine-log filter bank of nqm.m (nonzero only within radius 64 of DC,
+// so it is stored as a list of bins), the CSF weights of wsnr.m, the
+// detection thresholds of ctf.m, and the FFT plans and buffers.  One
+// plan scores any number of frames of its size.
+//
+// Per frame, one forward FFT of ref + i*dist gives both spectra (they
+// are separated by conjugate symmetry); WSNR is summed in the same
+// pass over the spectrum.  Each band of the filter bank is one inverse
+// FFT, giving the band-passed ref and dist as its real and imaginary
+// parts, and only the rows within the band's radius are transformed
+// across the columns.  The contrast, masking and threshold steps and
+// the NQM sums are one pass over the pixels per band.
+//=========================================================================
+#ifndef metrix_nqmH
+#define metrix_nqmH
+
+#include <cstddef>
+#include <vector>
+
+#include "fft.h"
+#include "image.h"
+
+namespace metrix {
+
+const int NQM_BANDS = 6;   // lowpass (l_0) and five bandpass channels
+
+struct NqmOptions
+{
+  double viewing_angle;   // degrees; metrix_nqm: 3.5 picture heights
+  double nyquist_freq;    // cycles/degree at the Nyquist frequency (wsnr.m's MAXFREQ)
+  NqmOptions() : viewing_angle(180.0 / (3.5 * 3.14159265358979323846)), nyquist_freq(60.0) {}
+};
+
+struct NqmScores
+{
+  double nqm;    // dB
+  double wsnr;   // dB
+};
+
+class NqmPlan
+{
+public:
+  // Throws std::runtime_error if ROWS or COLS is odd (nqm_modified.m's
+  // frequency grid is then offset by half a bin and its filters are
+  // not conjugate-symmetric; preprocess_metrix_mux pads to 32) or the
+  // FFT plans cannot be made.
+  NqmPlan(int rows, int cols, const NqmOptions& opt = NqmOptions());
+
+  int Rows() const { return fft_.Rows(); }
+  int Cols() const { return fft_.Cols(); }
+  const NqmOptions& Options() const { return opt_; }
+
+  // Throws std::runtime_error unless REF and DIST are ROWS x COLS.
+  // Not thread-safe: the plan holds the FFT scratch.
+  NqmScores Score(const Image& ref, const Image& dist);
+
+  // WSNR alone: the forward FFT and one pass over the spectrum.
+  double ScoreWsnr(const Image& ref, const Image& dist);
+
+private:
+  // fft2(ref + i*dist) into spec_
+  void Transform(const Image& ref, const Image& dist);
+  // WSNR from the spectra in spec_ (one pass); SAME if the images
+  // are equal
+  double Wsnr(bool same) const;
+  // band B of the filter bank applied to spec_, inverse-transformed
+  // into work_
+  void Band(int b);
+
+  Fft2d fft_;
+  NqmOptions opt_;
+
+  // filter bank: the bins with a nonzero gain in any band, and their
+  // NQM_BANDS gains each
+  std::vector<std::size_t> bins_;
+  std::vector<double> gains_;
+  int radius_[NQM_BANDS];          // largest row frequency of each band
+  double ctf_band_[NQM_BANDS];     // ctf(b), cmaskn's masking threshold
+  double ctf_detect_[NQM_BANDS];   // ctf(2^b / VA), the detection threshold
+
+  std::vector<double> csf2_;       // squared CSF weight of each FFT bin
+
+  std::vector<Complex> spec_;      // fft2(ref + i*dist)
+  std::vector<Complex> work_;      // a band: band-passed ref + i*dist
+  std::vector<Complex> den_;       // sum of the lower bands
+  std::vector<Complex> sum_;       // thresholded bands, y1 + i*y2
+};
+//-------------------------------------------------------------------------
+
+NqmScores Nqm(const Image& ref, const Image& dist, const NqmOptions& opt = NqmOptions());
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,89 @@
+//=========================================================================
+// nqm_native.cpp
+//
+// [NQM, WSNR] = nqm_native(REF, DIST)
+// WSNR = nqm_native(REF, DIST, 'wsnr')
+// nqm_native('clear')
+//
+// Matlab interface to the native NQM/WSNR engine (nqm.h): the scores
+// of metrix_nqm(REF, DIST) and metrix_wsnr(REF, DIST).  REF and DIST
+// are real 2D matrices of the same size (double, single or uint8),
+// even in each dimension.  With 'wsnr' only WSNR is computed (one FFT).
+//
+// The plan for the last image size (filter bank, CSF weights, FFT
+// plans and buffers) is kept between calls, so the frames of a video
+// share it.  nqm_native('clear') frees it.  Built by
+// metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+#include <cstring>
+
+#include "mexutil.h"
+#include "nqm.h"
+
+namespace {
+
+metrix::NqmPlan* plan = 0;
+
+void FreePlan()
+{
+  delete plan;
+  plan = 0;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs == 1 && mxIsChar(prhs[0]))
+  {
+    FreePlan();
+    return;
+  }
+  bool wsnr_only = false;
+  if (nrhs == 3)
+  {
+    char mode[8] = "";
+    if (!mxIsChar(prhs[2]) || mxGetString(prhs[2], mode, sizeof(mode)) != 0 ||
+        std::strcmp(mode, "wsnr") != 0)
+      mexErrMsgIdAndTxt("metrix:nqm_native", "the third argument must be 'wsnr'.");
+    wsnr_only = true;
+  }
+  else if (nrhs != 2)
+    mexErrMsgIdAndTxt("metrix:nqm_native", "requires 2 or 3 arguments.");
+  if (nlhs > (wsnr_only ? 1 : 2))
+    mexErrMsgIdAndTxt("metrix:nqm_native", "too many output arguments.");
+
+  metrix::NqmScores res = metrix::NqmScores();
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      metrix::Image const ref = metrix::ImageArg(prhs[0], "REF");
+      metrix::Image const dist = metrix::ImageArg(prhs[1], "DIST");
+      if (ref.Rows() != dist.Rows() || ref.Cols() != dist.Cols())
+        throw std::runtime_error("REF and DIST differ in size.");
+      if (!plan || plan->Rows() != ref.Rows() || plan->Cols() != ref.Cols())
+      {
+        if (!plan) mexAtExit(FreePlan);
+        FreePlan();
+        plan = new metrix::NqmPlan(ref.Rows(), ref.Cols());
+      }
+      if (wsnr_only)
+        res.wsnr = plan->ScoreWsnr(ref, dist);
+      else
+        res = plan->Score(ref, dist);
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:nqm_native", "%s", msg);
+  plhs[0] = mxCreateDoubleScalar(wsnr_only ? res.wsnr : res.nqm);
+  if (nlhs > 1) plhs[1] = mxCreateDoubleScalar(res.wsnr);
+}
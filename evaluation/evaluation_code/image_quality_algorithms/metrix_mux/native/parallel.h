@@ -0,0 +1,52 @@
+//=========================================================================
+// parallel.h
+//
+// OMP(directive) is an OpenMP pragma, dropped when not compiling with
+// OpenMP (as in the matlabPyrTools MEX sources).  MaxThreads() and
+// ThreadNum() are 1 and 0 without OpenMP, and SetThreads() does
+// nothing.
+//=========================================================================
+#ifndef metrix_parallelH
+#define metrix_parallelH
+
+#ifdef _OPENMP
+#include <omp.h>
+#define OMP(x) _Pragma(#x)
+#else
+#define OMP(x)
+#endif
+
+namespace metrix {
+
+inline int MaxThreads()
+{
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+// Threads of the parallel regions the calling thread starts (each
+// worker of a pool that runs the engines gives its share of the cores)
+inline void SetThreads(int n)
+{
+#ifdef _OPENMP
+  omp_set_num_threads(n);
+#else
+  (void) n;
+#endif
+}
+
+inline int ThreadNum()
+{
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+} // namespace metrix
+
+#endif
@@ -0,0 +1,152 @@
+//=========================================================================
+// pyrtools.cpp
+//=========================================================================
+#include "pyrtools.h"
+#include "trace.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+// sp5Filters.m (Eero Simoncelli, 6/96).  The 2D filters are symmetric,
+// so Matlab's column-major order is the order written there; each
+// row of bfilts is one 7x7 filter, as in the file before its final
+// transpose.  lofilt is stored as written, before the factor 2.
+static const double sp5_hi0filt[81] = {
+  -0.00033429, -0.00113093, -0.00171484, -0.00133542, -0.00080639, -0.00133542, -0.00171484, -0.00113093, -0.00033429,
+  -0.00113093, -0.00350017, -0.00243812, 0.00631653, 0.01261227, 0.00631653, -0.00243812, -0.00350017, -0.00113093,
+  -0.00171484, -0.00243812, -0.00290081, -0.00673482, -0.00981051, -0.00673482, -0.00290081, -0.00243812, -0.00171484,
+  -0.00133542, 0.00631653, -0.00673482, -0.07027679, -0.11435863, -0.07027679, -0.00673482, 0.00631653, -0.00133542,
+  -0.00080639, 0.01261227, -0.00981051, -0.11435863, 0.81380200, -0.11435863, -0.00981051, 0.01261227, -0.00080639,
+  -0.00133542, 0.00631653, -0.00673482, -0.07027679, -0.11435863, -0.07027679, -0.00673482, 0.00631653, -0.00133542,
+  -0.00171484, -0.00243812, -0.00290081, -0.00673482, -0.00981051, -0.00673482, -0.00290081, -0.00243812, -0.00171484,
+  -0.00113093, -0.00350017, -0.00243812, 0.00631653, 0.01261227, 0.00631653, -0.00243812, -0.00350017, -0.00113093,
+  -0.00033429, -0.00113093, -0.00171484, -0.00133542, -0.00080639, -0.00133542, -0.00171484, -0.00113093, -0.00033429};
+
+static const double sp5_lo0filt[25] = {
+  0.00341614, -0.01551246, -0.03848215, -0.01551246, 0.00341614,
+  -0.01551246, 0.05586982, 0.15925570, 0.05586982, -0.01551246,
+  -0.03848215, 0.15925570, 0.40304148, 0.15925570, -0.03848215,
+  -0.01551246, 0.05586982, 0.15925570, 0.05586982, -0.01551246,
+  0.00341614, -0.01551246, -0.03848215, -0.01551246, 0.00341614};
+
+static const double sp5_lofilt_half[81] = {
+  0.00085404, -0.00244917, -0.00387812, -0.00944432, -0.00962054, -0.00944432, -0.00387812, -0.00244917, 0.00085404,
+  -0.00244917, -0.00523281, -0.00661117, 0.00410600, 0.01002988, 0.00410600, -0.00661117, -0.00523281, -0.00244917,
+  -0.00387812, -0.00661117, 0.01396746, 0.03277038, 0.03981393, 0.03277038, 0.01396746, -0.00661117, -0.00387812,
+  -0.00944432, 0.00410600, 0.03277038, 0.06426333, 0.08169618, 0.06426333, 0.03277038, 0.00410600, -0.00944432,
+  -0.00962054, 0.01002988, 0.03981393, 0.08169618, 0.10096540, 0.08169618, 0.03981393, 0.01002988, -0.00962054,
+  -0.00944432, 0.00410600, 0.03277038, 0.06426333, 0.08169618, 0.06426333, 0.03277038, 0.00410600, -0.00944432,
+  -0.00387812, -0.00661117, 0.01396746, 0.03277038, 0.03981393, 0.03277038, 0.01396746, -0.00661117, -0.00387812,
+  -0.00244917, -0.00523281, -0.00661117, 0.00410600, 0.01002988, 0.00410600, -0.00661117, -0.00523281, -0.00244917,
+  0.00085404, -0.00244917, -0.00387812, -0.00944432, -0.00962054, -0.00944432, -0.00387812, -0.00244917, 0.00085404};
+
+static const double sp5_bfilts[294] = {
+  0.00277643, 0.00496194, 0.01026699, 0.01455399, 0.01026699, 0.00496194, 0.00277643,
+  -0.00986904, -0.00893064, 0.01189859, 0.02755155, 0.01189859, -0.00893064, -0.00986904,
+  -0.01021852, -0.03075356, -0.08226445, -0.11732297, -0.08226445, -0.03075356, -0.01021852,
+  0.00000000, 0.00000000, 0.00000000, 0.00000000, 0.00000000, 0.00000000, 0.00000000,
+  0.01021852, 0.03075356, 0.08226445, 0.11732297, 0.08226445, 0.03075356, 0.01021852,
+  0.00986904, 0.00893064, -0.01189859, -0.02755155, -0.01189859, 0.00893064, 0.00986904,
+  -0.00277643, -0.00496194, -0.01026699, -0.01455399, -0.01026699, -0.00496194, -0.00277643,
+  -0.00343249, -0.00640815, -0.00073141, 0.01124321, 0.00182078, 0.00285723, 0.01166982,
+  -0.00358461, -0.01977507, -0.04084211, -0.00228219, 0.03930573, 0.01161195, 0.00128000,
+  0.01047717, 0.01486305, -0.04819057, -0.12227230, -0.05394139, 0.00853965, -0.00459034,
+  0.00790407, 0.04435647, 0.09454202, -0.00000000, -0.09454202, -0.04435647, -0.00790407,
+  0.00459034, -0.00853965, 0.05394139, 0.12227230, 0.04819057, -0.01486305, -0.01047717,
+  -0.00128000, -0.01161195, -0.03930573, 0.00228219, 0.04084211, 0.01977507, 0.00358461,
+  -0.01166982, -0.00285723, -0.00182078, -0.01124321, 0.00073141, 0.00640815, 0.00343249,
+  0.00343249, 0.00358461, -0.01047717, -0.00790407, -0.00459034, 0.00128000, 0.01166982,
+  0.00640815, 0.01977507, -0.01486305, -0.04435647, 0.00853965, 0.01161195, 0.00285723,
+  0.00073141, 0.04084211, 0.04819057, -0.09454202, -0.05394139, 0.03930573, 0.00182078,
+  -0.01124321, 0.00228219, 0.12227230, -0.00000000, -0.12227230, -0.00228219, 0.01124321,
+  -0.00182078, -0.03930573, 0.05394139, 0.09454202, -0.04819057, -0.04084211, -0.00073141,
+  -0.00285723, -0.01161195, -0.00853965, 0.04435647, 0.01486305, -0.01977507, -0.00640815,
+  -0.01166982, -0.00128000, 0.00459034, 0.00790407, 0.01047717, -0.00358461, -0.00343249,
+  -0.00277643, 0.00986904, 0.01021852, -0.00000000, -0.01021852, -0.00986904, 0.00277643,
+  -0.00496194, 0.00893064, 0.03075356, -0.00000000, -0.03075356, -0.00893064, 0.00496194,
+  -0.01026699, -0.01189859, 0.08226445, -0.00000000, -0.08226445, 0.01189859, 0.01026699,
+  -0.01455399, -0.02755155, 0.11732297, -0.00000000, -0.11732297, 0.02755155, 0.01455399,
+  -0.01026699, -0.01189859, 0.08226445, -0.00000000, -0.08226445, 0.01189859, 0.01026699,
+  -0.00496194, 0.00893064, 0.03075356, -0.00000000, -0.03075356, -0.00893064, 0.00496194,
+  -0.00277643, 0.00986904, 0.01021852, -0.00000000, -0.01021852, -0.00986904, 0.00277643,
+  -0.01166982, -0.00128000, 0.00459034, 0.00790407, 0.01047717, -0.00358461, -0.00343249,
+  -0.00285723, -0.01161195, -0.00853965, 0.04435647, 0.01486305, -0.01977507, -0.00640815,
+  -0.00182078, -0.03930573, 0.05394139, 0.09454202, -0.04819057, -0.04084211, -0.00073141,
+  -0.01124321, 0.00228219, 0.12227230, -0.00000000, -0.12227230, -0.00228219, 0.01124321,
+  0.00073141, 0.04084211, 0.04819057, -0.09454202, -0.05394139, 0.03930573, 0.00182078,
+  0.00640815, 0.01977507, -0.01486305, -0.04435647, 0.00853965, 0.01161195, 0.00285723,
+  0.00343249, 0.00358461, -0.01047717, -0.00790407, -0.00459034, 0.00128000, 0.01166982,
+  -0.01166982, -0.00285723, -0.00182078, -0.01124321, 0.00073141, 0.00640815, 0.00343249,
+  -0.00128000, -0.01161195, -0.03930573, 0.00228219, 0.04084211, 0.01977507, 0.00358461,
+  0.00459034, -0.00853965, 0.05394139, 0.12227230, 0.04819057, -0.01486305, -0.01047717,
+  0.00790407, 0.04435647, 0.09454202, -0.00000000, -0.09454202, -0.04435647, -0.00790407,
+  0.01047717, 0.01486305, -0.04819057, -0.12227230, -0.05394139, 0.00853965, -0.00459034,
+  -0.00358461, -0.01977507, -0.04084211, -0.00228219, 0.03930573, 0.01161195, 0.00128000,
+  -0.00343249, -0.00640815, -0.00073141, 0.01124321, 0.00182078, 0.00285723, 0.01166982};
+
+SpyrFilters MakeSp5Filters()
+{
+  static double lofilt[81];
+  for (int i = 0; i < 81; ++i) lofilt[i] = 2 * sp5_lofilt_half[i];
+
+  SpyrFilters f;
+  f.lo0 = sp5_lo0filt;  f.lo0_dim = 5;
+  f.hi0 = sp5_hi0filt;  f.hi0_dim = 9;
+  f.lo = lofilt;        f.lo_dim = 9;
+  f.bfilts = sp5_bfilts; f.bfilt_dim = 7;
+  f.nbands = 6;
+  return f;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+const SpyrFilters& Sp5Filters()
+{
+  static const SpyrFilters filters = MakeSp5Filters();
+  return filters;
+}
+//-------------------------------------------------------------------------
+
+SteerablePyramid::SteerablePyramid(const Image& im, int ht, const SpyrFilters& f,
+                                   const char* edges, const int* levs, const int* bands)
+  : ht_(ht), nbands_(f.nbands)
+{
+  METRIX_TRACE_SCOPE("pyramid/SteerablePyramid");
+  if (ht < 0 || ht > max_pyr_ht(im.Rows(), im.Cols(), f.lo_dim))
+    throw std::runtime_error("SteerablePyramid: image too small for the pyramid height");
+
+  int const nb = spyr_bands(im.Rows(), im.Cols(), ht, nbands_, NULL);
+  pind_.resize(2 * nb);
+  spyr_bands(im.Rows(), im.Cols(), ht, nbands_, &pind_[0]);
+  offset_.resize(nb);
+  std::size_t total = 0;
+  for (int b = 0; b < nb; ++b)
+  {
+    offset_[b] = total;
+    total += (std::size_t) pind_[2 * b] * pind_[2 * b + 1];
+  }
+  pyr_.assign(total, 0.0);
+  METRIX_TRACE_ALLOC("pyramid/SteerablePyramid", (long long) (total * sizeof(double)));
+
+  // the kernels take non-const pointers, but do not write the inputs
+  char edge_name[16];
+  std::strncpy(edge_name, edges, sizeof(edge_name) - 1);
+  edge_name[sizeof(edge_name) - 1] = 0;
+  int const status =
+    build_spyr(const_cast<double*>(im.Data()), im.Rows(), im.Cols(), ht,
+               const_cast<double*>(f.hi0), f.hi0_dim,
+               const_cast<double*>(f.lo0), f.lo0_dim,
+               const_cast<double*>(f.lo), f.lo_dim,
+               const_cast<double*>(f.bfilts), f.bfilt_dim, nbands_,
+               const_cast<int*>(levs), const_cast<int*>(bands), edge_name, &pyr_[0], &pind_[0]);
+  if (status != 0)
+    throw std::runtime_error("SteerablePyramid: build_spyr failed (bad EDGES?)");
+}
+
+} // namespace metrix
+//=========================================================================
@@ -0,0 +1,76 @@
+//=========================================================================
+// pyrtools.h
+//
+// C++ access to the matlabPyrTools kernels (utilities/matlabPyrTools/
+// MEX: convolve.c, edges.c, wrap.c, fftconv.c, pyramid.c), which the
+// native engines link directly, so a pyramid built here is the one
+// buildSpyr returns in Matlab.
+//=========================================================================
+#ifndef metrix_pyrtoolsH
+#define metrix_pyrtoolsH
+
+#include <cstddef>
+#include <vector>
+
+extern "C" {
+#include "pyramid.h"
+}
+// convolve.h's spelled-out operators are for the C sources only
+#undef IS
+#undef ISNT
+#undef AND
+#undef OR
+
+#include "image.h"
+
+namespace metrix {
+
+// The filters of a *Filters.m file (see buildSpyr): square LO0, HI0
+// and LO filters, and NBANDS square band filters of size BFILT_DIM,
+// stored one after the other.
+struct SpyrFilters
+{
+  const double* lo0;   int lo0_dim;
+  const double* hi0;   int hi0_dim;
+  const double* lo;    int lo_dim;
+  const double* bfilts; int bfilt_dim;
+  int nbands;
+};
+
+// sp5Filters.m: six orientation bands, as used by VIF and IFC.
+const SpyrFilters& Sp5Filters();
+//-------------------------------------------------------------------------
+
+// buildSpyr(IM, HT, FILTERS, EDGES).  The bands are in buildSpyr's
+// order: the highpass residual, then NBANDS orientations per level
+// from the finest level down, then the lowpass residual.  LEVS (HT+2
+// flags: highpass, levels, lowpass) and BANDS (one per orientation)
+// restrict the bands computed, as in build_spyr; the others are zero.
+class SteerablePyramid
+{
+public:
+  SteerablePyramid(const Image& im, int ht, const SpyrFilters& filters,
+                   const char* edges = "reflect1",
+                   const int* levs = NULL, const int* bands = NULL);
+
+  int Height() const { return ht_; }
+  int Orientations() const { return nbands_; }
+  int NumBands() const { return (int) offset_.size(); }
+
+  // LEV = 0 is the finest level
+  int BandIndex(int lev, int orient) const { return 1 + lev * nbands_ + orient; }
+
+  const double* Band(int b) const { return &pyr_[offset_[b]]; }
+  int BandRows(int b) const { return pind_[2 * b]; }
+  int BandCols(int b) const { return pind_[2 * b + 1]; }
+
+private:
+  int ht_, nbands_;
+  std::vector<double> pyr_;
+  std::vector<int> pind_;
+  std::vector<std::size_t> offset_;
+};
+
+} // namespace metrix
+//=========================================================================
+#endif
@@ -0,0 +1,160 @@
+//=========================================================================
+// resultcache.cpp
+//=========================================================================
+#include "resultcache.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace metrix {
+
+namespace {
+
+// first line of a store; a new measure or key layout changes it, and a
+// store with another one is not read
+const char* const MAGIC = "metrix_eval result cache 1";
+
+unsigned long long const FNV_PRIME = 0x100000001b3ULL;
+unsigned long long const FNV_BASIS = 0xcbf29ce484222325ULL;
+
+unsigned long long Avalanche(unsigned long long h)
+{
+  h ^= h >> 33;  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+unsigned long long HashString(const std::string& s)
+{
+  unsigned long long h = FNV_BASIS;
+  for (std::size_t i = 0; i < s.size(); ++i) h = (h ^ (unsigned char) s[i]) * FNV_PRIME;
+  return Avalanche(h);
+}
+
+void StripNewline(char* line)
+{
+  std::size_t n = std::strlen(line);
+  while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r')) line[--n] = 0;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+// FNV-1a over 64-bit words (and the bytes of a short tail), as HashImage
+unsigned long long HashFile(const std::string& path)
+{
+  std::FILE* fp = std::fopen(path.c_str(), "rb");
+  if (!fp) throw std::runtime_error(path + ": cannot open file");
+  unsigned long long h = FNV_BASIS;
+  unsigned long long size = 0;
+  unsigned char buf[65536];
+  std::size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), fp)) > 0)
+  {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+      unsigned long long word;
+      std::memcpy(&word, buf + i, sizeof(word));
+      h = (h ^ word) * FNV_PRIME;
+    }
+    for (; i < n; ++i) h = (h ^ buf[i]) * FNV_PRIME;
+    size += n;
+  }
+  bool const failed = std::ferror(fp) != 0;
+  std::fclose(fp);
+  if (failed) throw std::runtime_error(path + ": read error");
+  return Avalanche((h ^ size) * FNV_PRIME);
+}
+//-------------------------------------------------------------------------
+
+ResultCache::ResultCache(const std::string& path)
+  : file_(0), hits_(0), misses_(0)
+{
+  bool fresh = true;
+  bool partial = false;   // the last line has no newline
+  if (std::FILE* in = std::fopen(path.c_str(), "r"))
+  {
+    char line[256];
+    if (std::fgets(line, sizeof(line), in))
+    {
+      StripNewline(line);
+      if (std::strcmp(line, MAGIC) != 0)
+      {
+        std::fclose(in);
+        throw std::runtime_error(path + ": not a result cache of this metrix_eval");
+      }
+      fresh = false;
+    }
+    // A line longer than LINE comes in pieces; none of them is a
+    // record.  The buffer is cleared before each read, so its newline
+    // is found even after a NUL byte of a damaged file.
+    bool tail = false;   // LINE continues a line already rejected
+    for (;;)
+    {
+      std::memset(line, 0, sizeof(line));
+      if (!std::fgets(line, sizeof(line), in)) break;
+      partial = !std::memchr(line, '\n', sizeof(line));
+      bool const whole = !partial && !tail;
+      tail = partial;
+      char key[64];
+      FrameScores s;
+      if (whole && std::sscanf(line, "%63s %lf %lf %lf %lf %lf", key, &s.psnr, &s.ssim,
+                               &s.scale, &s.row_shift, &s.col_shift) == 6)
+        entries_[key] = s;
+    }
+    std::fclose(in);
+  }
+  file_ = std::fopen(path.c_str(), "a");
+  if (!file_) throw std::runtime_error(path + ": cannot write file");
+  if (fresh) std::fprintf(file_, "%s\n", MAGIC);
+  else if (partial) std::fputc('\n', file_);
+  std::fflush(file_);
+}
+//-------------------------------------------------------------------------
+
+ResultCache::~ResultCache()
+{
+  std::fclose(file_);
+}
+//-------------------------------------------------------------------------
+
+std::string ResultCache::Key(const std::string& gt_path, const std::string& result_path,
+                             const FrameEvalOptions& opt)
+{
+  char measure[64];
+  std::snprintf(measure, sizeof(measure), "koehler psnr ssim crop %d landscape %d", opt.crop,
+                opt.landscape_width);
+  char key[64];
+  std::snprintf(key, sizeof(key), "%016llx%016llx%016llx", HashFile(gt_path),
+                HashFile(result_path), HashString(measure));
+  return key;
+}
+//-------------------------------------------------------------------------
+
+bool ResultCache::Find(const std::string& key, FrameScores& scores)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<std::string, FrameScores>::const_iterator const it = entries_.find(key);
+  if (it == entries_.end())
+  {
+    ++misses_;
+    return false;
+  }
+  ++hits_;
+  scores = it->second;
+  return true;
+}
+//-------------------------------------------------------------------------
+
+void ResultCache::Put(const std::string& key, const FrameScores& scores)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[key] = scores;
+  std::fprintf(file_, "%s %.17g %.17g %.17g %.17g %.17g\n", key.c_str(), scores.psnr, scores.ssim,
+               scores.scale, scores.row_shift, scores.col_shift);
+  std::fflush(file_);
+}
+
+} // namespace metrix
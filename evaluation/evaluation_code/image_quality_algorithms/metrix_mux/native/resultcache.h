@@ -0,0 +1,64 @@
+//=========================================================================
+// resultcache.h
+//
+// On-disk cache of frame scores for metrix_eval, so that re-running an
+// evaluation after one model changed computes the new frames only.  A
+// key hashes the bytes of the ground-truth and result files, the
+// measure and its options (crop, landscape width); a hit skips the
+// decoding as well as the evaluation.  The store is a text file of one
+// "key psnr ssim scale row_shift col_shift" line per frame, read whole
+// when opened and appended to as frames are scored, so runs that stop
+// early keep what they computed.
+//=========================================================================
+#ifndef metrix_resultcacheH
+#define metrix_resultcacheH
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "frameeval.h"
+
+namespace metrix {
+
+// 64-bit hash of the bytes of the file PATH (FNV-1a with HashImage's
+// final avalanche).  Throws std::runtime_error if it cannot be read.
+unsigned long long HashFile(const std::string& path);
+
+class ResultCache
+{
+public:
+  // Opens (or creates) the store PATH.  Lines that do not parse, such
+  // as one cut short by a killed run, are skipped.  Throws
+  // std::runtime_error if PATH cannot be read or written.
+  explicit ResultCache(const std::string& path);
+  ~ResultCache();
+
+  // The key of the pair GT_PATH, RESULT_PATH scored with OPT
+  static std::string Key(const std::string& gt_path, const std::string& result_path,
+                         const FrameEvalOptions& opt);
+
+  // Finds KEY into SCORES, counting a hit or a miss.  Thread-safe.
+  bool Find(const std::string& key, FrameScores& scores);
+
+  // Stores and appends SCORES under KEY.  Thread-safe.
+  void Put(const std::string& key, const FrameScores& scores);
+
+  long Hits() const { return hits_; }
+  long Misses() const { return misses_; }
+  std::size_t Size() const { return entries_.size(); }
+
+private:
+  ResultCache(const ResultCache&);
+  ResultCache& operator=(const ResultCache&);
+
+  std::mutex mutex_;
+  std::map<std::string, FrameScores> entries_;
+  std::FILE* file_;
+  long hits_, misses_;
+};
+
+} // namespace metrix
+//=========================================================================
+#endif
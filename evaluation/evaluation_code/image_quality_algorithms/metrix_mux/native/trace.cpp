@@ -0,0 +1,320 @@
+//=========================================================================
+// trace.cpp: see trace.h (empty without METRIX_TRACE)
+//=========================================================================
+#include "trace.h"
+
+#ifdef METRIX_TRACE
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Scopes kept per thread for the Chrome trace; the statistics count
+// them all
+const std::size_t MAX_EVENTS = 1 << 20;
+
+struct Event
+{
+  const char* name;
+  long long start, duration;
+};
+
+struct Stat
+{
+  Stat() : calls(0), total(0), self(0), min(0), max(0) {}
+  long long calls, total, self, min, max;
+};
+
+struct Tally
+{
+  Tally() : count(0), sum(0) {}
+  long long count, sum;
+};
+
+struct OpenScope
+{
+  long long start, children;
+};
+
+struct ThreadLog
+{
+  int tid;
+  std::vector<Event> events;
+  long long dropped;
+  std::vector<OpenScope> open;
+  std::unordered_map<const char*, Stat> stats;
+  std::unordered_map<const char*, Tally> counters, allocs;
+};
+
+// Never destroyed: threads may still trace while the program exits
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<ThreadLog*> logs;
+  std::chrono::steady_clock::time_point epoch;
+};
+
+void AtExit();
+
+Registry& GetRegistry()
+{
+  static Registry* r = 0;
+  static std::once_flag once;
+  std::call_once(once, []
+  {
+    r = new Registry;
+    r->epoch = std::chrono::steady_clock::now();
+    std::atexit(AtExit);
+  });
+  return *r;
+}
+
+ThreadLog& Log()
+{
+  thread_local ThreadLog* log = 0;
+  if (!log)
+  {
+    Registry& r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    log = new ThreadLog;
+    log->tid = (int) r.logs.size() + 1;
+    log->dropped = 0;
+    r.logs.push_back(log);
+  }
+  return *log;
+}
+
+long long Now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now() - GetRegistry().epoch).count();
+}
+
+void AddTally(std::unordered_map<const char*, Tally>& m, const char* name, long long n)
+{
+  Tally& t = m[name];
+  ++t.count;
+  t.sum += n;
+}
+
+// The statistics of all threads by name (not by pointer: each
+// translation unit has its own copy of a literal)
+struct Merged
+{
+  std::map<std::string, Stat> stats;
+  std::map<std::string, Tally> counters, allocs;
+  std::map<std::string, long long> stage_self;
+  long long events, dropped;
+};
+
+void MergeTallies(const std::unordered_map<const char*, Tally>& from, std::map<std::string, Tally>& to)
+{
+  for (std::unordered_map<const char*, Tally>::const_iterator i = from.begin(); i != from.end(); ++i)
+  {
+    Tally& t = to[i->first];
+    t.count += i->second.count;
+    t.sum += i->second.sum;
+  }
+}
+
+Merged Merge()
+{
+  Registry& r = GetRegistry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  Merged m;
+  m.events = m.dropped = 0;
+  for (std::size_t k = 0; k < r.logs.size(); ++k)
+  {
+    const ThreadLog& log = *r.logs[k];
+    m.events += (long long) log.events.size();
+    m.dropped += log.dropped;
+    for (std::unordered_map<const char*, Stat>::const_iterator i = log.stats.begin();
+         i != log.stats.end(); ++i)
+    {
+      const Stat& s = i->second;
+      Stat& t = m.stats[i->first];
+      t.min = t.calls ? std::min(t.min, s.min) : s.min;
+      t.max = std::max(t.max, s.max);
+      t.calls += s.calls;
+      t.total += s.total;
+      t.self += s.self;
+    }
+    MergeTallies(log.counters, m.counters);
+    MergeTallies(log.allocs, m.allocs);
+  }
+  for (std::map<std::string, Stat>::const_iterator i = m.stats.begin(); i != m.stats.end(); ++i)
+    m.stage_self[i->first.substr(0, i->first.find('/'))] += i->second.self;
+  return m;
+}
+
+void WriteJsonString(std::FILE* fp, const char* s)
+{
+  std::fputc('"', fp);
+  for (; *s; ++s)
+  {
+    if (*s == '"' || *s == '\\') std::fputc('\\', fp);
+    if ((unsigned char) *s >= 0x20) std::fputc(*s, fp);
+  }
+  std::fputc('"', fp);
+}
+
+void AtExit()
+{
+  metrix_trace_summary(stderr);
+  const char* path = std::getenv("METRIX_TRACE_JSON");
+  if (path && *path && metrix_trace_write(path) != 0)
+    std::fprintf(stderr, "trace: cannot write %s\n", path);
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+long long metrix_trace_begin(void)
+{
+  ThreadLog& log = Log();
+  OpenScope const o = {Now(), 0};
+  log.open.push_back(o);
+  return o.start;
+}
+
+void metrix_trace_end(const char* name, long long start)
+{
+  long long const end = Now();
+  ThreadLog& log = Log();
+  long long const duration = end - start;
+  long long children = 0;
+  if (!log.open.empty())
+  {
+    children = log.open.back().children;
+    log.open.pop_back();
+  }
+  if (!log.open.empty()) log.open.back().children += duration;
+
+  Stat& s = log.stats[name];
+  s.min = s.calls ? std::min(s.min, duration) : duration;
+  s.max = std::max(s.max, duration);
+  ++s.calls;
+  s.total += duration;
+  s.self += duration - children;
+
+  if (log.events.size() < MAX_EVENTS)
+  {
+    Event const e = {name, start, duration};
+    log.events.push_back(e);
+  }
+  else ++log.dropped;
+}
+
+void metrix_trace_count(const char* name, long long n)
+{
+  AddTally(Log().counters, name, n);
+}
+
+void metrix_trace_alloc(const char* name, long long bytes)
+{
+  AddTally(Log().allocs, name, bytes);
+}
+//-------------------------------------------------------------------------
+
+void metrix_trace_summary(FILE* out)
+{
+  Merged const m = Merge();
+  if (m.stats.empty() && m.counters.empty() && m.allocs.empty()) return;
+
+  long long all_self = 0;
+  for (std::map<std::string, long long>::const_iterator i = m.stage_self.begin();
+       i != m.stage_self.end(); ++i)
+    all_self += i->second;
+
+  std::fprintf(out, "trace: %lld scopes", m.events + m.dropped);
+  if (m.dropped) std::fprintf(out, " (%lld not kept for the JSON trace)", m.dropped);
+  std::fprintf(out, "; times in ms, self excludes nested scopes of the same thread\n");
+  std::fprintf(out, "%-36s %10s %12s %12s %10s %10s %10s\n", "scope", "calls", "total", "self",
+               "mean", "min", "max");
+  for (std::map<std::string, Stat>::const_iterator i = m.stats.begin(); i != m.stats.end(); ++i)
+  {
+    const Stat& s = i->second;
+    std::fprintf(out, "%-36s %10lld %12.3f %12.3f %10.4f %10.4f %10.4f\n", i->first.c_str(),
+                 s.calls, s.total * 1e-6, s.self * 1e-6, s.total * 1e-6 / s.calls, s.min * 1e-6,
+                 s.max * 1e-6);
+  }
+  std::fprintf(out, "%-36s %12s %8s\n", "stage", "self", "share");
+  for (std::map<std::string, long long>::const_iterator i = m.stage_self.begin();
+       i != m.stage_self.end(); ++i)
+    std::fprintf(out, "%-36s %12.3f %7.1f%%\n", i->first.c_str(), i->second * 1e-6,
+                 all_self ? 100.0 * i->second / all_self : 0.0);
+  if (!m.counters.empty())
+  {
+    std::fprintf(out, "%-36s %10s %16s\n", "counter", "adds", "total");
+    for (std::map<std::string, Tally>::const_iterator i = m.counters.begin(); i != m.counters.end(); ++i)
+      std::fprintf(out, "%-36s %10lld %16lld\n", i->first.c_str(), i->second.count, i->second.sum);
+  }
+  if (!m.allocs.empty())
+  {
+    std::fprintf(out, "%-36s %10s %16s\n", "allocation", "count", "bytes");
+    for (std::map<std::string, Tally>::const_iterator i = m.allocs.begin(); i != m.allocs.end(); ++i)
+      std::fprintf(out, "%-36s %10lld %16lld\n", i->first.c_str(), i->second.count, i->second.sum);
+  }
+}
+
+int metrix_trace_write(const char* path)
+{
+  std::FILE* fp = std::fopen(path, "w");
+  if (!fp) return -1;
+  Registry& r = GetRegistry();
+  {
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    const char* sep = "\n";
+    for (std::size_t k = 0; k < r.logs.size(); ++k)
+    {
+      const ThreadLog& log = *r.logs[k];
+      std::fprintf(fp, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                   "\"args\": {\"name\": \"thread %d\"}}", sep, log.tid, log.tid);
+      sep = ",\n";
+      for (std::size_t i = 0; i < log.events.size(); ++i)
+      {
+        const Event& e = log.events[i];
+        std::string const stage(e.name, std::strcspn(e.name, "/"));
+        std::fprintf(fp, "%s{\"name\": ", sep);
+        WriteJsonString(fp, e.name);
+        std::fprintf(fp, ", \"cat\": ");
+        WriteJsonString(fp, stage.c_str());
+        std::fprintf(fp, ", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d}",
+                     e.start * 1e-3, e.duration * 1e-3, log.tid);
+      }
+    }
+    std::fprintf(fp, "\n]");
+  }
+
+  // counters and allocations as trace metadata
+  Merged const m = Merge();
+  std::fprintf(fp, ", \"otherData\": {");
+  const char* sep = "";
+  for (std::map<std::string, Tally>::const_iterator i = m.counters.begin(); i != m.counters.end(); ++i)
+  {
+    std::fprintf(fp, "%s", sep);
+    WriteJsonString(fp, i->first.c_str());
+    std::fprintf(fp, ": \"%lld\"", i->second.sum);
+    sep = ", ";
+  }
+  for (std::map<std::string, Tally>::const_iterator i = m.allocs.begin(); i != m.allocs.end(); ++i)
+  {
+    std::fprintf(fp, "%s", sep);
+    WriteJsonString(fp, i->first.c_str());
+    std::fprintf(fp, ": \"%lld allocations, %lld bytes\"", i->second.count, i->second.sum);
+    sep = ", ";
+  }
+  std::fprintf(fp, "}}\n");
+  return (std::fclose(fp) == 0) ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,91 @@
+//=========================================================================
+// trace.h
+//
+// Hot-path instrumentation, compiled in with -DMETRIX_TRACE (make
+// TRACE=-DMETRIX_TRACE) and absent otherwise: without it the macros
+// below expand to nothing and trace.cpp is empty.
+//
+// METRIX_TRACE_SCOPE("stage/name") times the rest of the enclosing
+// block; METRIX_TRACE_COUNT and METRIX_TRACE_ALLOC add to a counter and
+// to the allocations (count and bytes) of a name.  Names are string
+// literals, "stage/what" with the stage one of decode, register,
+// shift, pyramid, conv, stats or eval, so the summary can say where
+// the time goes.  Each thread logs its own scopes (no locking after
+// its first); at exit a summary (calls, total, self and extreme times
+// per name, self time per stage, counters, allocations) goes to
+// stderr, and with the environment variable METRIX_TRACE_JSON set,
+// every scope goes to that file as Chrome trace events
+// (chrome://tracing, Perfetto).
+//
+// The C interface is for the matlabPyrTools kernels and for the
+// imdwt headers, which include this file and call it only under
+// #ifdef METRIX_TRACE (their own builds do not see native/).
+//=========================================================================
+#ifndef metrix_traceH
+#define metrix_traceH
+
+#include <stdio.h>
+
+// METRIX_TRACE_NAME(internal_reduce) is "internal_reduce", or
+// "internal_reduce_f" where convolve.h renames it for PYR_FLOAT
+#define METRIX_TRACE_STRING(x) #x
+#define METRIX_TRACE_NAME(f) METRIX_TRACE_STRING(f)
+
+#ifdef METRIX_TRACE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start of a scope, in nanoseconds; every begin is ended, innermost
+// first, on the same thread
+long long metrix_trace_begin(void);
+void metrix_trace_end(const char* name, long long start);
+void metrix_trace_count(const char* name, long long n);
+void metrix_trace_alloc(const char* name, long long bytes);
+
+// What is printed and written at exit, on demand.  Not while other
+// threads are tracing.  metrix_trace_write returns 0, or -1 if PATH
+// cannot be written.
+void metrix_trace_summary(FILE* out);
+int metrix_trace_write(const char* path);
+
+#ifdef __cplusplus
+}
+
+namespace metrix {
+
+class TraceScope
+{
+public:
+  explicit TraceScope(const char* name) : name_(name), start_(metrix_trace_begin()) {}
+  ~TraceScope() { metrix_trace_end(name_, start_); }
+
+private:
+  TraceScope(const TraceScope&);
+  TraceScope& operator=(const TraceScope&);
+
+  const char* name_;
+  long long start_;
+};
+
+} // namespace metrix
+
+#define METRIX_TRACE_JOIN2(a, b) a##b
+#define METRIX_TRACE_JOIN(a, b) METRIX_TRACE_JOIN2(a, b)
+#define METRIX_TRACE_SCOPE(name) \
+  metrix::TraceScope const METRIX_TRACE_JOIN(metrix_trace_scope_, __LINE__)(name)
+#endif
+
+#define METRIX_TRACE_COUNT(name, n) metrix_trace_count(name, n)
+#define METRIX_TRACE_ALLOC(name, bytes) metrix_trace_alloc(name, bytes)
+
+#else
+
+#define METRIX_TRACE_SCOPE(name)
+#define METRIX_TRACE_COUNT(name, n) ((void) 0)
+#define METRIX_TRACE_ALLOC(name, bytes) ((void) 0)
+
+#endif
+
+#endif
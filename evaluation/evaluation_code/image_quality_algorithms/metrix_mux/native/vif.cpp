@@ -0,0 +1,84 @@
+//=========================================================================
+// vif.cpp
+//=========================================================================
+#include "vif.h"
+#include "parallel.h"
+#include "pyrtools.h"
+#include "trace.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace metrix {
+
+namespace {
+
+const int PYR_HEIGHT = 4;
+const int NUM_SUBBANDS = 8;
+
+// vifvec.m's subbands = [4 7 10 13 16 19 22 25] index ind2wtree's
+// reversed band list; subband k is orientation 4 (k even) or 1 (k
+// odd) of level 3 - k/2, counting from the finest level as 0.  The
+// distortion-channel window is 2^lev+1 with lev = ceil((sub-1)/6),
+// i.e. 3 at the coarsest level up to 17 at the finest.
+int SubbandLevel(int k) { return PYR_HEIGHT - 1 - k / 2; }
+int SubbandOrient(int k) { return (k % 2 == 0) ? 3 : 0; }
+int SubbandWindow(int k) { return (1 << (k / 2 + 1)) + 1; }
+
+} // namespace
+//-------------------------------------------------------------------------
+
+std::vector<GsmBand> AnalyzeGsm(const Image& ref, const Image& dist, int M)
+{
+  if (ref.Rows() != dist.Rows() || ref.Cols() != dist.Cols())
+    throw std::runtime_error("AnalyzeGsm: images differ in size");
+
+  // only orientations 1 and 4 of the levels are used
+  int const levs[PYR_HEIGHT + 2] = {0, 1, 1, 1, 1, 0};
+  int const orients[6] = {1, 0, 0, 1, 0, 0};
+  SteerablePyramid const pref(ref, PYR_HEIGHT, Sp5Filters(), "reflect1", levs, orients);
+  SteerablePyramid const pdist(dist, PYR_HEIGHT, Sp5Filters(), "reflect1", levs, orients);
+
+  // bands differ in size by up to 64x: hand them out one at a time
+  std::vector<GsmBand> bands(NUM_SUBBANDS);
+  std::string error;
+  OMP(omp parallel for schedule(dynamic, 1))
+  for (int k = 0; k < NUM_SUBBANDS; ++k)
+  {
+    int const b = pref.BandIndex(SubbandLevel(k), SubbandOrient(k));
+    try
+    {
+      EstimateGsmBand(pref.Band(b), pdist.Band(b), pref.BandRows(b), pref.BandCols(b),
+                      M, SubbandWindow(k), &bands[k]);
+    }
+    catch (const std::exception& e)
+    {
+      OMP(omp critical)
+      error = e.what();
+    }
+  }
+  if (!error.empty()) throw std::runtime_error(error);
+  return bands;
+}
+//-------------------------------------------------------------------------
+
+double VifFromGsm(const std::vector<GsmBand>& bands, double sigma_nsq)
+{
+  double num = 0.0, den = 0.0;
+  for (std::size_t k = 0; k < bands.size(); ++k)
+  {
+    num += GsmInformation(bands[k], sigma_nsq, true);
+    den += GsmInformation(bands[k], sigma_nsq, false);
+  }
+  return num / den;
+}
+//-------------------------------------------------------------------------
+
+double Vif(const Image& ref, const Image& dist, const VifOptions& opt)
+{
+  METRIX_TRACE_SCOPE("eval/Vif");
+  return VifFromGsm(AnalyzeGsm(ref, dist, opt.M), opt.sigma_nsq);
+}
+
+} // namespace metrix
+//=========================================================================
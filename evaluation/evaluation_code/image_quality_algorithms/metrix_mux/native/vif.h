@@ -0,0 +1,41 @@
+//=========================================================================
+// vif.h
+//
+// Visual Information Fidelity, as vifvec.m (LIVE vifvec_release):
+// an sp5 steerable pyramid of height 4 ('reflect1' edges) of each
+// image, GSM statistics of eight of its subbands (orientations 1 and 4
+// of every level), and the ratio of distorted to reference image
+// information summed over them.  Scores agree with vifvec.m to
+// floating-point roundoff.
+//=========================================================================
+#ifndef metrix_vifH
+#define metrix_vifH
+
+#include <vector>
+
+#include "gsm.h"
+#include "image.h"
+
+namespace metrix {
+
+struct VifOptions
+{
+  int M;             // block size of the GSM vectors
+  double sigma_nsq;  // variance of the visual noise
+  VifOptions() : M(3), sigma_nsq(0.4) {}
+};
+
+// GSM statistics of vifvec's subbands, coarsest first (its subband
+// order), shared by VIF and IFC (ifc.h).  Subbands are done in
+// parallel when built with OpenMP.
+// Throws std::runtime_error if the images differ in size or are too
+// small for a 4-level pyramid.
+std::vector<GsmBand> AnalyzeGsm(const Image& ref, const Image& dist, int M);
+
+double VifFromGsm(const std::vector<GsmBand>& bands, double sigma_nsq);
+
+double Vif(const Image& ref, const Image& dist, const VifOptions& opt = VifOptions());
+
+} // namespace metrix
+//=========================================================================
+#endif
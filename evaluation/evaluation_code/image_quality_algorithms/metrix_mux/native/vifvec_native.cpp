@@ -0,0 +1,45 @@
+//=========================================================================
+// vifvec_native.cpp
+//
+// [VIF, IFC] = vifvec_native(IMORG, IMDIST)
+//
+// Matlab interface to the native VIF/IFC engine (vif.h, ifc.h): the
+// scores of vifvec(IMORG, IMDIST) and ifcvec(IMORG, IMDIST), to
+// floating-point roundoff.  IFC comes from the same pyramids and
+// subband statistics, so asking for both costs little more than VIF.
+// IMORG and IMDIST are real 2D matrices of the same size (double,
+// single or uint8).
+// Built by metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+
+#include "ifc.h"
+#include "mexutil.h"
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs != 2) mexErrMsgIdAndTxt("metrix:vifvec_native", "requires 2 arguments.");
+  if (nlhs > 2) mexErrMsgIdAndTxt("metrix:vifvec_native", "returns at most 2 values.");
+
+  metrix::InformationScores scores = {0.0, 0.0};
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      metrix::Image const ref = metrix::ImageArg(prhs[0], "IMORG");
+      metrix::Image const dist = metrix::ImageArg(prhs[1], "IMDIST");
+      if (nlhs > 1) scores = metrix::VifIfc(ref, dist);
+      else scores.vif = metrix::Vif(ref, dist);
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:vifvec_native", "%s", msg);
+  plhs[0] = mxCreateDoubleScalar(scores.vif);
+  if (nlhs > 1) plhs[1] = mxCreateDoubleScalar(scores.ifc);
+}
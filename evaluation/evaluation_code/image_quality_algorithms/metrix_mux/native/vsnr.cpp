@@ -0,0 +1,251 @@
+//=========================================================================
+// vsnr.cpp
+//=========================================================================
+#include "vsnr.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#define GBUFFER_NO_RANGE_CHECK
+#include "ginclude/gwavelift.h"
+
+namespace metrix {
+
+namespace {
+
+typedef buf::GDoubleBuffer band_type;
+typedef buf::GDoubleWaveList bands_type;
+typedef wavlet::GDoubleWavelift wave_type;
+
+const double PI = 3.14159265358979323846;
+const int NUM_ORIENTS = 3;
+const int NUM_BISECTIONS = 32;    // find_best_csnrs' iteration limit
+
+// Matlab's uint8(): round half away from zero, saturate to [0, 255]
+inline int ToUint8(double x)
+{
+  if (!(x > 0.0)) return 0;       // also NaN
+  return (x >= 254.5) ? 255 : (int) (x + 0.5);
+}
+
+double Mean(const double* p, std::size_t n)
+{
+  double s = 0.0;
+  for (std::size_t i = 0; i < n; ++i) s += p[i];
+  return s / n;
+}
+
+// std(X, 1)
+double StdDev(const double* p, std::size_t n)
+{
+  double const m = Mean(p, n);
+  double s = 0.0;
+  for (std::size_t i = 0; i < n; ++i) s += (p[i] - m) * (p[i] - m);
+  return std::sqrt(s / n);
+}
+
+double Norm(const std::vector<double>& x)
+{
+  double s = 0.0;
+  for (std::size_t i = 0; i < x.size(); ++i) s += x[i] * x[i];
+  return std::sqrt(s);
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+VsnrReference::VsnrReference(const Image& ref, const VsnrOptions& opt)
+  : ref_(ref), opt_(opt)
+{
+  METRIX_TRACE_SCOPE("eval/VsnrReference");
+  int const step = 1 << opt.num_levels;
+  if (ref.Rows() % step != 0 || ref.Cols() % step != 0)
+    throw std::runtime_error("VsnrReference: image size is not a multiple of 2^num_levels");
+
+  lum_.resize(256);
+  for (int p = 0; p < 256; ++p) lum_[p] = std::pow(opt.b + opt.k * p, opt.g);
+  fs_.resize(opt.num_levels);
+  for (int s = 0; s < opt.num_levels; ++s)
+    fs_[s] = opt.r * opt.v * std::tan(PI / 180.0) * std::pow(2.0, -(s + 1));
+
+  // analyze_src_img (with vsnr_modified's uint8 luminance lookup)
+  std::size_t const n = ref.Size();
+  const double* x = ref.Data();
+  mX_ = Mean(x, n);
+  std::vector<double> lum(n);
+  for (std::size_t i = 0; i < n; ++i) lum[i] = lum_[ToUint8(x[i])];
+  mL_ = Mean(&lum[0], n);
+  Ci_ = StdDev(&lum[0], n) / mL_;
+  zeta_ = mL_ * std::pow(opt.b + opt.k * mX_, 1.0 - opt.g) / (opt.k * opt.g);
+
+  Cis_ = LevelContrasts(ref);
+  std::vector<double> const ctsnrs = ThresholdContrasts(0.0);
+  std::vector<double> ctes(opt.num_levels);
+  for (int s = 0; s < opt.num_levels; ++s) ctes[s] = Cis_[s] / ctsnrs[s];
+  CTe_ = Norm(ctes);
+}
+//-------------------------------------------------------------------------
+
+std::vector<double> VsnrReference::LevelContrasts(const Image& im) const
+{
+  // a Matlab matrix read as a GBuffer is transposed: rows are the
+  // buffer's width, as in imdwt.cpp (which swaps no orientations
+  // either; the per-level sums do not depend on them)
+  bands_type bands(im.Rows(), im.Cols());
+  std::copy(im.Data(), im.Data() + im.Size(), bands.Image().Data());
+  wave_type().Decompose(bands, opt_.num_levels);
+
+  std::vector<double> c(opt_.num_levels, 0.0);
+  for (int s = 1; s <= opt_.num_levels; ++s)
+  {
+    double const scale = zeta_ * std::pow(2.0, s);   // filter_gains
+    for (int o = 0; o < NUM_ORIENTS; ++o)
+    {
+      band_type const& band = bands(s, o);
+      double const cb = StdDev(band.Data(), band.Size()) / scale;
+      c[s - 1] += cb * cb;
+    }
+    c[s - 1] = std::sqrt(c[s - 1]);
+  }
+  return c;
+}
+//-------------------------------------------------------------------------
+
+// best_csnrs(v_idx)
+std::vector<double> VsnrReference::ThresholdContrasts(double v_idx) const
+{
+  double const a0 = 59.8, a1 = -0.1258, a2 = -0.1087;
+  double const b2 = (-1 - a2) * v_idx + a2;
+  double const b1 = (1 - a1) * v_idx + a1;
+  double const b0 = -a0 * v_idx + a0;
+  std::vector<double> res(fs_.size());
+  for (std::size_t s = 0; s < fs_.size(); ++s)
+    res[s] = std::max(0.0, b0 * std::pow(fs_[s], b2 * std::log(fs_[s]) + b1));
+  return res;
+}
+//-------------------------------------------------------------------------
+
+double VsnrReference::Score(const Image& dist) const
+{
+  METRIX_TRACE_SCOPE("eval/VsnrReference::Score");
+  if (dist.Rows() != ref_.Rows() || dist.Cols() != ref_.Cols())
+    throw std::runtime_error("Vsnr: images differ in size");
+  int const L = opt_.num_levels;
+
+  // analyze_dst_img
+  std::size_t const n = ref_.Size();
+  Image err(ref_.Rows(), ref_.Cols());
+  std::vector<double> err_lum(n);
+  const double* x = ref_.Data();
+  const double* y = dist.Data();
+  double* e = err.Data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    int const v = ToUint8(y[i] - x[i] + mX_);
+    e[i] = v;
+    err_lum[i] = lum_[v];
+  }
+  double const Ce = StdDev(&err_lum[0], n) / mL_;
+
+  if (Ce <= CTe_)
+  {
+    // subthreshold, unless the mean luminance changed
+    double const lum_diff = std::fabs(Mean(&err_lum[0], n) - mL_);
+    if (lum_diff / mL_ < 0.01) return std::numeric_limits<double>::infinity();
+    // vsnr.m overwrites the cached Ci here; it is local instead
+    double const Ci = std::pow(10.0, mL_ / lum_diff);
+    return 20.0 * std::log10(Ci / 1.5);
+  }
+
+  std::vector<double> const Ces = LevelContrasts(err);
+
+  // find_best_csnrs: bisect for the threshold curve through Ce
+  std::vector<double> csnrs_str;
+  double v_min = 0.0, v_max = 1.0;
+  std::vector<double> ces(L);
+  for (int it = 0; it < NUM_BISECTIONS; ++it)
+  {
+    double const v_idx = 0.5 * (v_min + v_max);
+    csnrs_str = ThresholdContrasts(v_idx);
+    for (int s = 0; s < L; ++s) ces[s] = Cis_[s] / csnrs_str[s];
+    double const hat_Ce = Norm(ces);
+    if (v_min == v_max) break;
+    double const diff = hat_Ce - Ce;
+    if (std::fabs(diff) < 0.01 * Ce) break;
+    else if (diff < 0) v_min = v_idx;
+    else v_max = v_idx;
+  }
+
+  // distance of the actual from the best per-level error contrasts
+  std::vector<double> diff(L);
+  for (int s = 0; s < L; ++s)
+  {
+    double const csnr_act = Cis_[s] / Ces[s];
+    diff[s] = Cis_[s] / csnrs_str[s] - Cis_[s] / csnr_act;
+  }
+  double const d_gp = Norm(diff);
+  double const d = opt_.alpha * Ce + (1.0 - opt_.alpha) * d_gp / std::sqrt(2.0);
+  return 20.0 * std::log10(Ci_ / d);
+}
+//-------------------------------------------------------------------------
+
+VsnrReferenceCache::VsnrReferenceCache(std::size_t capacity, const VsnrOptions& opt)
+  : capacity_(capacity > 0 ? capacity : 1), opt_(opt), hits_(0), misses_(0)
+{
+}
+//-------------------------------------------------------------------------
+
+const VsnrReference& VsnrReferenceCache::Lookup(const Image& ref)
+{
+  unsigned long long const h = HashImage(ref);
+  std::pair<Index::iterator, Index::iterator> const range = index_.equal_range(h);
+  for (Index::iterator i = range.first; i != range.second; ++i)
+    if (SameImage(i->second->analysis.Reference(), ref))
+    {
+      ++hits_;
+      entries_.splice(entries_.begin(), entries_, i->second);
+      return entries_.front().analysis;
+    }
+
+  ++misses_;
+  entries_.emplace_front(h, ref, opt_);
+  index_.insert(std::make_pair(h, entries_.begin()));
+  if (entries_.size() > capacity_)
+  {
+    Entries::iterator const last = --entries_.end();
+    std::pair<Index::iterator, Index::iterator> const old = index_.equal_range(last->hash);
+    for (Index::iterator i = old.first; i != old.second; ++i)
+      if (i->second == last)
+      {
+        index_.erase(i);
+        break;
+      }
+    entries_.erase(last);
+  }
+  return entries_.front().analysis;
+}
+//-------------------------------------------------------------------------
+
+double VsnrReferenceCache::Score(const Image& ref, const Image& dist)
+{
+  return Lookup(ref).Score(dist);
+}
+//-------------------------------------------------------------------------
+
+void VsnrReferenceCache::Clear()
+{
+  index_.clear();
+  entries_.clear();
+}
+//-------------------------------------------------------------------------
+
+double Vsnr(const Image& ref, const Image& dist, const VsnrOptions& opt)
+{
+  return VsnrReference(ref, opt).Score(dist);
+}
+
+} // namespace metrix
+//=========================================================================
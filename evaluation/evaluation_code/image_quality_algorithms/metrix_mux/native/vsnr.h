@@ -0,0 +1,108 @@
+//=========================================================================
+// vsnr.h
+//
+// Visual signal-to-noise ratio, as vsnr_modified.m (metrix/vsnr): the
+// contrast of the reference, and of the error image in each level of a
+// 9/7 DWT (GWavelift, as the imdwt MEX function), against the
+// contrast-detection thresholds of the default viewing conditions.
+//
+// All the reference-side work of vsnr.m (analyze_src_img: luminance
+// statistics, the reference DWT and its per-level contrasts, the
+// threshold contrast) is in VsnrReference, so one reference scores
+// any number of distorted images for one DWT each.  VsnrReferenceCache
+// keeps the analyses of recently used references, keyed by a hash of
+// their content.
+//=========================================================================
+#ifndef metrix_vsnrH
+#define metrix_vsnrH
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "image.h"
+
+namespace metrix {
+
+// vsnr.m's defaults: sRGB-like display (b, k, g), 96 pixels/inch,
+// 19.1 inch viewing distance, 5 DWT levels, and alpha = 0.04.
+struct VsnrOptions
+{
+  double alpha;   // weight of perceived contrast against global precedence
+  double b, k, g; // pixel value to luminance: (b + k*pixel)^g
+  double r, v;    // display resolution (pixels/inch), viewing distance (inches)
+  int num_levels;
+  VsnrOptions() : alpha(0.04), b(0.0), k(0.02874), g(2.2), r(96.0), v(19.1), num_levels(5) {}
+};
+
+class VsnrReference
+{
+public:
+  // Throws std::runtime_error unless the size of REF is a multiple of
+  // 2^num_levels (as dwt2d.m requires; preprocess_metrix_mux pads to 32).
+  explicit VsnrReference(const Image& ref, const VsnrOptions& opt = VsnrOptions());
+
+  // VSNR of DIST (in dB); Inf for a distortion below threshold.
+  double Score(const Image& dist) const;
+
+  const Image& Reference() const { return ref_; }
+  const VsnrOptions& Options() const { return opt_; }
+
+private:
+  // per-level RMS contrast of the detail bands of IM's DWT
+  std::vector<double> LevelContrasts(const Image& im) const;
+  std::vector<double> ThresholdContrasts(double v_idx) const;
+
+  Image ref_;
+  VsnrOptions opt_;
+  std::vector<double> lum_;        // pixel value (0..255) to luminance
+  std::vector<double> fs_;         // spatial frequency of each level
+  double mX_, mL_, Ci_, zeta_;
+  std::vector<double> Cis_;        // per-level contrast of the reference
+  double CTe_;                     // threshold contrast of the error
+};
+//-------------------------------------------------------------------------
+
+// The VsnrReference analyses of up to CAPACITY references, least
+// recently used dropped first.  A hit is checked against the stored
+// reference, so a hash collision costs time, never a wrong score.
+// Not thread-safe.
+class VsnrReferenceCache
+{
+public:
+  explicit VsnrReferenceCache(std::size_t capacity = 4,
+                              const VsnrOptions& opt = VsnrOptions());
+
+  double Score(const Image& ref, const Image& dist);
+  void Clear();
+
+  std::size_t Hits() const { return hits_; }
+  std::size_t Misses() const { return misses_; }
+
+private:
+  const VsnrReference& Lookup(const Image& ref);
+
+  struct Entry
+  {
+    unsigned long long hash;
+    VsnrReference analysis;
+    Entry(unsigned long long h, const Image& ref, const VsnrOptions& opt)
+      : hash(h), analysis(ref, opt) {}
+  };
+  typedef std::list<Entry> Entries;   // most recently used first
+  typedef std::multimap<unsigned long long, Entries::iterator> Index;
+
+  std::size_t capacity_;
+  VsnrOptions opt_;
+  Entries entries_;
+  Index index_;
+  std::size_t hits_, misses_;
+};
+//-------------------------------------------------------------------------
+
+double Vsnr(const Image& ref, const Image& dist, const VsnrOptions& opt = VsnrOptions());
+
+} // namespace metrix
+//=========================================================================
+#endif
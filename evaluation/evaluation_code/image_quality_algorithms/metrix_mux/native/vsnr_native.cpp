@@ -0,0 +1,73 @@
+//=========================================================================
+// vsnr_native.cpp
+//
+// RES = vsnr_native(SRC_IMG, DST_IMG)
+// vsnr_native('clear')
+//
+// Matlab interface to the native VSNR engine (vsnr.h): the score of
+// vsnr_modified(SRC_IMG, DST_IMG) with the default viewing conditions
+// and alpha.  SRC_IMG and DST_IMG are real 2D matrices of the same
+// size (double, single or uint8), a multiple of 32 in each dimension.
+//
+// The analyses of the last few reference images are kept between
+// calls (VsnrReferenceCache), so scoring many distorted images
+// against one reference decomposes the reference once.
+// vsnr_native('clear') empties the cache.  Built by
+// metrix/compile_metrix_native.m.
+//=========================================================================
+#include <cstdio>
+
+#include "mexutil.h"
+#include "vsnr.h"
+
+namespace {
+
+const std::size_t CACHE_CAPACITY = 4;
+
+metrix::VsnrReferenceCache* cache = 0;
+
+void FreeCache()
+{
+  delete cache;
+  cache = 0;
+}
+
+} // namespace
+//-------------------------------------------------------------------------
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[])
+{
+  if (nrhs == 1 && mxIsChar(prhs[0]))
+  {
+    if (cache) cache->Clear();
+    return;
+  }
+  if (nrhs != 2) mexErrMsgIdAndTxt("metrix:vsnr_native", "requires 2 arguments.");
+  if (nlhs > 1) mexErrMsgIdAndTxt("metrix:vsnr_native", "returns 1 value.");
+
+  if (!cache)
+  {
+    cache = new metrix::VsnrReferenceCache(CACHE_CAPACITY);
+    mexAtExit(FreeCache);
+  }
+
+  double res = 0.0;
+  bool failed = false;
+  char msg[256];
+  {
+    // no Matlab error (a longjmp) while C++ objects are alive
+    try
+    {
+      metrix::Image const src = metrix::ImageArg(prhs[0], "SRC_IMG");
+      metrix::Image const dst = metrix::ImageArg(prhs[1], "DST_IMG");
+      res = cache->Score(src, dst);
+    }
+    catch (const std::exception& e)
+    {
+      failed = true;
+      std::snprintf(msg, sizeof(msg), "%s", e.what());
+    }
+  }
+  if (failed) mexErrMsgIdAndTxt("metrix:vsnr_native", "%s", msg);
+  plhs[0] = mxCreateDoubleScalar(res);
+}
@@ -0,0 +1,64 @@
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%%%
+%%%  FUNCTION:  test_float_kernels
+%%%
+%%%  INPUTS:    NONE
+%%%
+%%%  OUTPUTS:   report - struct array, one entry per test image, with the
+%%%                      VIF and IFC scores computed with double and with
+%%%                      single-precision pyramid kernels
+%%%
+%%%  CHANGES:   Loads the reference and distorted images included with the
+%%%             VSNR algorithm code and computes VIF and IFC twice: once
+%%%             from double images, and once from single images, which
+%%%             makes corrDn/upConv/buildSpyr run the single-precision
+%%%             (-DPYR_FLOAT) kernels.  The subband statistics are double
+%%%             in both cases (vifvec/ifcvec convert the pyramid back), so
+%%%             the difference is the error due to the float kernels alone.
+%%%
+%%%  RESULTS:   Not from this script (Matlab was not available): the
+%%%             same computation with the native engine (native/), its
+%%%             build_spyr replaced by a shim that rounds the image and
+%%%             filters to single, calls the -DPYR_FLOAT build_spyr_f and
+%%%             converts the pyramid back to double:
+%%%
+%%%             image          metric         double         single  abs. diff  rel. diff
+%%%             horse.bmp      VIF      1.0000000000   1.0000000000    0.0e+00    0.0e+00
+%%%                            IFC     80.9732214233  80.9732212488    1.7e-07    2.2e-09
+%%%             horse.JP2.bmp  VIF      0.2887371867   0.2887371937    7.0e-09    2.4e-08
+%%%                            IFC      2.3072907579   2.3072904204    3.4e-07    1.5e-07
+%%%             horse.NOZ.bmp  VIF      0.3625576500   0.3625576321    1.8e-08    4.9e-08
+%%%                            IFC      2.8247717765   2.8247715813    2.0e-07    6.9e-08
+%%%
+%%%             Every score moves by less than 2e-7 of its value, far
+%%%             below the differences between distortions.
+%%%
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+function report = test_float_kernels
+
+%%%
+%%% load test images
+%%%
+reference_image = double(imread('horse.bmp'));
+query_names = {'horse.bmp', 'horse.JP2.bmp', 'horse.NOZ.bmp'};
+
+fprintf('%-14s %-4s %14s %14s %10s %10s\n', 'image', '', 'double', 'single', 'abs. diff', 'rel. diff');
+for k = 1:length(query_names)
+    query_image = double(imread(query_names{k}));
+
+    report(k).name = query_names{k};
+    report(k).vif_double = vifvec(reference_image, query_image);
+    report(k).vif_single = vifvec(single(reference_image), single(query_image));
+    report(k).ifc_double = ifcvec(reference_image, query_image);
+    report(k).ifc_single = ifcvec(single(reference_image), single(query_image));
+
+    fprintf('%-14s %-4s %14.10f %14.10f %10.1e %10.1e\n', query_names{k}, 'VIF', ...
+        report(k).vif_double, report(k).vif_single, ...
+        abs(report(k).vif_single - report(k).vif_double), ...
+        abs(report(k).vif_single - report(k).vif_double) / abs(report(k).vif_double));
+    fprintf('%-14s %-4s %14.10f %14.10f %10.1e %10.1e\n', '', 'IFC', ...
+        report(k).ifc_double, report(k).ifc_single, ...
+        abs(report(k).ifc_single - report(k).ifc_double), ...
+        abs(report(k).ifc_single - report(k).ifc_double) / abs(report(k).ifc_double));
+end
@@ -0,0 +1,210 @@
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%%%
+%%%  FUNCTION:  test_native_metrics
+%%%
+%%%  INPUTS:    NONE
+%%%
+%%%  OUTPUTS:   report - struct array, one entry per test image, with the
+%%%                      scores of the Matlab metric code and of the
+%%%                      native engines (native/, built by
+%%%                      compile_metrix_native)
+%%%
+%%%  CHANGES:   Loads the reference and distorted images included with the
+%%%             VSNR algorithm code, scores each pair with vifvec/ifcvec
+%%%             and vifvec_native (both scores from one call), and with
+%%%             vsnr_modified and vsnr_native, with mssim_index and
+%%%             mssim_native, and with nqm_modified/wsnr_new_modified
+%%%             and nqm_native (as metrix_nqm and metrix_wsnr call
+%%%             them), and reports the relative
+%%%             differences.  It also registers the reference to each
+%%%             image, and to a copy of it circularly shifted by
+%%%             DFT_SHIFT, with dftregistration (evaluation_code, on
+%%%             the spectra) and dftreg_native for USFAC 0, 1 and 20,
+%%%             and compares the errors, phases and shifts (relative to
+%%%             the larger of 1 and the Matlab value, as the phase and
+%%%             the shifts may be 0).  Last, it shifts a grey and a
+%%%             three-channel crop of the images with imshift (also in
+%%%             evaluation_code) by its shift matrices (USE_NATIVE
+%%%             false) and by imshift_native: sub-pixel and whole-pixel
+%%%             'crop' shifts, and 'same' and 'full' shifts of either
+%%%             sign, compared to the larger of 1 and the largest Matlab
+%%%             pixel.  fused_native is compared with metrix_mux for
+%%%             each of its metrics, on the grey double pairs and on a
+%%%             uint8 RGB pair (and its double copy) such as eval_image
+%%%             passes.  These should be at the level of roundoff
+%%%             (TOL; the engines compute the same sums in another
+%%%             order), or TOL_VSNR for VSNR: GWavelift's lifting
+%%%             constants are single precision, where vsnr_modified uses
+%%%             dwt2d.m.  The number of scores outside tolerance is
+%%%             returned as report(1).failed.
+%%%
+%%%             mad_native is not compared: MAD_index.m calls the
+%%%             ical_std and ical_stat MEX functions, whose sources are
+%%%             not in this tree, so there is no Matlab MAD to run here.
+%%%             The native MAD is checked by "make check" (native/)
+%%%             against a port of MAD_index.m only.
+%%%
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+function report = test_native_metrics
+
+TOL = 1e-9;
+TOL_VSNR = 1e-6;
+DFT_SHIFT = [3 -5];
+
+if exist('vifvec_native', 'file') ~= 3 | exist('vsnr_native', 'file') ~= 3 | ...
+   exist('mssim_native', 'file') ~= 3 | exist('nqm_native', 'file') ~= 3 | ...
+   exist('dftreg_native', 'file') ~= 3 | exist('imshift_native', 'file') ~= 3 | ...
+   exist('fused_native', 'file') ~= 3
+    error('test_native_metrics: the native engines are not built (run compile_metrix_native)');
+end
+
+%%% dftregistration.m and imshift.m are with the evaluation code, two
+%%% levels up
+if exist('dftregistration', 'file') ~= 2
+    addpath(fullfile(fileparts(mfilename('fullpath')), '..', '..'));
+end
+
+%%%
+%%% load test images
+%%%
+reference_image = double(imread('horse.bmp'));
+query_names = {'horse.bmp', 'horse.JP2.bmp', 'horse.NOZ.bmp'};
+
+failed = 0;
+fprintf('%-14s %-4s %14s %14s %10s\n', 'image', '', 'matlab', 'native', 'rel. diff');
+for k = 1:length(query_names)
+    query_image = double(imread(query_names{k}));
+
+    report(k).name = query_names{k};
+    report(k).vif_matlab = vifvec(reference_image, query_image);
+    report(k).ifc_matlab = ifcvec(reference_image, query_image);
+    [report(k).vif_native, report(k).ifc_native] = vifvec_native(reference_image, query_image);
+
+    rel = abs(report(k).vif_native - report(k).vif_matlab) / abs(report(k).vif_matlab);
+    fprintf('%-14s %-4s %14.10f %14.10f %10.2e\n', query_names{k}, 'VIF', ...
+        report(k).vif_matlab, report(k).vif_native, rel);
+    failed = failed + (rel > TOL);
+    rel = abs(report(k).ifc_native - report(k).ifc_matlab) / abs(report(k).ifc_matlab);
+    fprintf('%-14s %-4s %14.10f %14.10f %10.2e\n', '', 'IFC', ...
+        report(k).ifc_matlab, report(k).ifc_native, rel);
+    failed = failed + (rel > TOL);
+
+    report(k).vsnr_matlab = vsnr_modified(reference_image, query_image);
+    report(k).vsnr_native = vsnr_native(reference_image, query_image);
+    rel = abs(report(k).vsnr_native - report(k).vsnr_matlab) / abs(report(k).vsnr_matlab);
+    fprintf('%-14s %-4s %14.10f %14.10f %10.2e\n', '', 'VSNR', ...
+        report(k).vsnr_matlab, report(k).vsnr_native, rel);
+    failed = failed + (rel > TOL_VSNR);
+
+    report(k).mssim_matlab = mssim_index(reference_image, query_image);
+    report(k).mssim_native = mssim_native(reference_image, query_image);
+    rel = abs(report(k).mssim_native - report(k).mssim_matlab) / abs(report(k).mssim_matlab);
+    fprintf('%-14s %-4s %14.10f %14.10f %10.2e\n', '', 'MSSIM', ...
+        report(k).mssim_matlab, report(k).mssim_native, rel);
+    failed = failed + (rel > TOL);
+
+    %%% equal images score Inf in both (rel is then NaN, not a failure)
+    report(k).nqm_matlab = nqm_modified(reference_image, query_image, ...
+        1/3.5 * 180/pi, sqrt(prod(size(reference_image))));
+    report(k).wsnr_matlab = wsnr_new_modified(reference_image, query_image);
+    [report(k).nqm_native, report(k).wsnr_native] = nqm_native(reference_image, query_image);
+    rel = abs(report(k).nqm_native - report(k).nqm_matlab) / abs(report(k).nqm_matlab);
+    fprintf('%-14s %-4s %14.10f %14.10f %10.2e\n', '', 'NQM', ...
+        report(k).nqm_matlab, report(k).nqm_native, rel);
+    failed = failed + (rel > TOL);
+    rel = abs(report(k).wsnr_native - report(k).wsnr_matlab) / abs(report(k).wsnr_matlab);
+    fprintf('%-14s %-4s %14.10f %14.10f %10.2e\n', '', 'WSNR', ...
+        report(k).wsnr_matlab, report(k).wsnr_native, rel);
+    failed = failed + (rel > TOL);
+
+    %%% output is [error diffphase] for USFAC 0, [... row_shift col_shift]
+    %%% otherwise
+    shifted_image = circshift(query_image, DFT_SHIFT);
+    for usfac = [0 1 20]
+        for shifted = 0:1
+            if shifted
+                moving = shifted_image;
+                name = sprintf('REG%i+', usfac);
+            else
+                moving = query_image;
+                name = sprintf('REG%i', usfac);
+            end
+            matlab = dftregistration(fft2(reference_image), fft2(moving), usfac);
+            native = dftreg_native(reference_image, moving, usfac);
+            if numel(native) == numel(matlab)
+                rel = max(abs(native - matlab) ./ max(1, abs(matlab)));
+            else
+                rel = Inf;
+            end
+            fprintf('%-14s %-6s %s  %s %10.2e\n', '', name, ...
+                mat2str(matlab, 6), mat2str(native, 6), rel);
+            failed = failed + (rel > TOL);
+        end
+    end
+end
+dftreg_native('clear');
+
+%%% each row of SHIFTS is a [row col] shift for the bounding box in
+%%% BOXES; 'same' and 'full' take whole pixels
+boxes = {'crop', 'crop', 'crop', 'same', 'same', 'same', 'same', ...
+         'full', 'full', 'full', 'full'};
+shifts = [2.5 -3.25; -1.75 0.5; 3 -4; 3 4; -3 -4; 2 -5; -2 5; ...
+          3 4; -3 -4; 2 -5; -2 5];
+grey = reference_image(101:164, 201:248);
+color = double(cat(3, imread(query_names{1}), imread(query_names{2}), ...
+                   imread(query_names{3})));
+color = color(101:164, 201:248, :);
+for x = {grey, color}
+    for j = 1:length(boxes)
+        matlab = imshift(x{1}, shifts(j,:), boxes{j}, false);
+        native = imshift(x{1}, shifts(j,:), boxes{j});
+        if isequal(size(native), size(matlab))
+            rel = max(abs(native(:) - matlab(:))) / max(1, max(abs(matlab(:))));
+        else
+            rel = Inf;
+        end
+        fprintf('%-14s %-4s %-14s %i channel(s) %10.2e\n', '', boxes{j}, ...
+            mat2str(shifts(j,:)), size(x{1},3), rel);
+        failed = failed + (rel > TOL);
+    end
+end
+
+%%% fused_native with metrix_mux; the RGB pair permutes the images
+%%% across the channels.  Equal images have PSNR Inf in both.
+metrics = {'MSE', 'PSNR', 'SSIM', 'MSSIM', 'VIF', 'IFC'};
+rgb_reference = cat(3, imread(query_names{1}), imread(query_names{2}), ...
+                    imread(query_names{3}));
+rgb_query = rgb_reference(:,:,[3 1 2]);
+pairs = {};
+for k = 1:length(query_names)
+    pairs(end+1,:) = {query_names{k}, reference_image, double(imread(query_names{k}))};
+end
+pairs(end+1,:) = {'uint8 RGB', rgb_reference, rgb_query};
+pairs(end+1,:) = {'double RGB', double(rgb_reference), double(rgb_query)};
+for k = 1:size(pairs,1)
+    native = fused_native(pairs{k,2}, pairs{k,3}, metrics);
+    for m = 1:length(metrics)
+        matlab = metrix_mux(pairs{k,2}, pairs{k,3}, metrics{m});
+        if native(m) == matlab
+            rel = 0;
+        else
+            rel = abs(native(m) - matlab) / abs(matlab);
+        end
+        if m == 1
+            name = pairs{k,1};
+        else
+            name = '';
+        end
+        fprintf('%-14s %-4s %14.10f %14.10f %10.2e\n', name, metrics{m}, ...
+            matlab, native(m), rel);
+        failed = failed + ~(rel <= TOL);
+    end
+end
+
+report(1).failed = failed;
+if failed > 0
+    fprintf('%i score(s) differ by more than %g\n', failed, TOL);
+else
+    fprintf('[Passed!]\n');
+end
@@ -29,6 +29,7 @@
 % Convolution (first two are significantly faster):
 %   corrDn     - Correlate & downsample with boundary-handling [MEX file]
 %   upConv     - Upsample & convolve with boundary-handling [MEX file]
+%   winMoments - Windowed means, covariance and variances of two images [MEX file]
 %   blurDn     - Blur and subsample a signal/image.
 %   upBlur     - Upsample and blur a signal/image.
 %   blur       - Multi-scale blurring, calls blurDn and then upBlur.
@@ -42,6 +43,8 @@
 %   setPyrBand - Insert an image into (any type of) pyramid as a subband 
 %   pyrBandIndices - Returns indices for given band in a pyramid vector
 %   maxPyrHt   - compute maximum number of scales in a pyramid
+%   buildPyr   - Build a Laplacian, wavelet or steerable pyramid in one call [MEX file]
+%   reconPyr   - Reconstruct a pyramid built by buildPyr in one call [MEX file]
 %
 % Gaussian/Laplacian Pyramids:
 %   buildGpyr  - Build a Gaussian pyramid of an input signal/image.
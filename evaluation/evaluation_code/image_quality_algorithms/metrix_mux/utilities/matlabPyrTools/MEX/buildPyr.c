@@ -0,0 +1,231 @@
+/*
+[PYR, INDICES] = buildPyr(TYPE, IM, HT, FILTERS..., EDGES);
+  >>> See buildPyr.m for documentation <<<
+  This is a matlab interface to the build_lpyr, build_spyr and
+  build_wpyr functions of pyramid.c.  A single-precision IM is built
+  with the float kernels (filters are always given in double).
+*/
+
+#define V4_COMPAT
+#include <matrix.h>  /* Matlab matrices */
+#include <mex.h>
+
+#include <string.h>
+#include <math.h>
+#include "pyramid.h"
+
+#define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notFltMtx(it) (!mxIsNumeric(it) || !(mxIsDouble(it) || mxIsSingle(it)) || mxIsSparse(it) || mxIsComplex(it))
+
+/* Check that ARG is a 1D double filter, returning its length. */
+static int vector_filter(const mxArray *arg, char *name)
+  {
+  char msg[80];
+
+  if (notDblMtx(arg) || ((mxGetM(arg) > 1) && (mxGetN(arg) > 1)))
+      {
+      sprintf(msg, "%s should be a 1D double filter (i.e., a vector).", name);
+      mexErrMsgTxt(msg);
+      }
+  return((int) (mxGetM(arg) * mxGetN(arg)));
+  }
+
+/* Single-precision copy of the double matrix ARG. */
+static float *float_copy(const mxArray *arg)
+  {
+  int i, n = (int) (mxGetM(arg) * mxGetN(arg));
+  double *src = mxGetPr(arg);
+  float *dst = mxCalloc(n > 0 ? n : 1, sizeof(float));
+
+  if (dst == NULL) mexErrMsgTxt("Cannot allocate necessary temporary space");
+  for (i=0; i<n; i++) dst[i] = (float) src[i];
+  return(dst);
+  }
+
+/* Check that ARG is a square double filter, returning its size. */
+static int square_filter(const mxArray *arg, char *name)
+  {
+  char msg[80];
+
+  if (notDblMtx(arg) || (mxGetM(arg) != mxGetN(arg)))
+      {
+      sprintf(msg, "%s should be a square double filter.", name);
+      mexErrMsgTxt(msg);
+      }
+  return((int) mxGetM(arg));
+  }
+
+void mexFunction(int nlhs,	     /* Num return vals on lhs */
+		 mxArray *plhs[],    /* Matrices on lhs      */
+		 int nrhs,	     /* Num args on rhs    */
+		 const mxArray *prhs[]     /* Matrices on rhs */
+		 )
+  {
+  double *image, *pyr, *ind;
+  int x_idim, y_idim, ht, max_ht;
+  int type = WAVELET_PYR, nfilt = 1;
+  int nbands, total, b, status, single;
+  int *pind;
+  int flen1 = 0, flen2 = 0, hi0_fdim = 0, lo0_fdim = 0, lo_fdim = 0, bfilt_fdim = 0;
+  double *filt1 = NULL, *filt2 = NULL, *bfilts = NULL;
+  const mxArray *arg;
+  char type_str[16];
+  char edges[15] = "reflect1";
+  char msg[80];
+
+  if (nrhs<3) mexErrMsgTxt("requres at least 3 args.");
+
+  /* ARG 1: TYPE */
+  if (!mxIsChar(prhs[0])) mexErrMsgTxt("TYPE arg must be a string.");
+  mxGetString(prhs[0], type_str, 16);
+  if (!strcmp(type_str, "laplacian"))       { type = LAPLACIAN_PYR; nfilt = 2; }
+  else if (!strcmp(type_str, "steerable"))  { type = STEERABLE_PYR; nfilt = 4; }
+  else if (!strcmp(type_str, "wavelet"))    { type = WAVELET_PYR;   nfilt = 1; }
+  else mexErrMsgTxt("TYPE must be one of 'laplacian', 'steerable' or 'wavelet'.");
+
+  if (nrhs < 3+nfilt) mexErrMsgTxt("Not enough filter arguments for this pyramid TYPE.");
+
+  /* ARG 2: IMAGE */
+  arg = prhs[1];
+  if notFltMtx(arg) mexErrMsgTxt("IMAGE arg must be a non-sparse double or single float matrix.");
+  single = mxIsSingle(arg);
+  image = mxGetPr(arg);
+  x_idim = (int) mxGetM(arg); /* X is inner index! */
+  y_idim = (int) mxGetN(arg);
+
+  /* ARG 3: HT */
+  arg = prhs[2];
+  if (notDblMtx(arg) || (mxGetM(arg) * mxGetN(arg) != 1))
+    mexErrMsgTxt("HT arg must be a scalar.");
+  ht = (int) mxGetPr(arg)[0];
+
+  /* ARGS 4..: FILTERS */
+  switch (type)
+      {
+      case LAPLACIAN_PYR:
+	flen1 = vector_filter(prhs[3], "FILT1");
+	flen2 = vector_filter(prhs[4], "FILT2");
+	filt1 = mxGetPr(prhs[3]);
+	filt2 = mxGetPr(prhs[4]);
+	max_ht = 1 + max_pyr_ht(x_idim, y_idim, (flen1 > flen2) ? flen1 : flen2);
+	break;
+      case STEERABLE_PYR:
+	lo0_fdim = square_filter(prhs[3], "LO0FILT");
+	hi0_fdim = square_filter(prhs[4], "HI0FILT");
+	lo_fdim = square_filter(prhs[5], "LOFILT");
+	if notDblMtx(prhs[6]) mexErrMsgTxt("BFILTS arg must be a double float matrix.");
+	bfilt_fdim = (int) (sqrt((double) mxGetM(prhs[6])) + 0.5);
+	if (bfilt_fdim*bfilt_fdim != (int) mxGetM(prhs[6]))
+	  mexErrMsgTxt("BFILTS columns must hold square filters.");
+	bfilts = mxGetPr(prhs[6]);
+	max_ht = max_pyr_ht(x_idim, y_idim, lo_fdim);
+	break;
+      default:
+	flen1 = vector_filter(prhs[3], "FILT");
+	filt1 = mxGetPr(prhs[3]);
+	max_ht = max_pyr_ht(x_idim, y_idim, flen1);
+	break;
+      }
+  if (ht > max_ht)
+      {
+      sprintf(msg, "Cannot build pyramid higher than %d levels.", max_ht);
+      mexErrMsgTxt(msg);
+      }
+
+  /* ARG 4+NFILT (optional): EDGES */
+  if (nrhs > 3+nfilt)
+      {
+      if (!mxIsChar(prhs[3+nfilt]))
+	mexErrMsgTxt("EDGES arg must be a string.");
+      mxGetString(prhs[3+nfilt], edges, 15);
+      }
+  if ((strcmp(edges,"circular") != 0) && (edge_function(edges) == NULL))
+    mexErrMsgTxt("Unknown EDGES type.");
+
+  /* Size the outputs */
+  switch (type)
+      {
+      case LAPLACIAN_PYR: nbands = lpyr_bands(x_idim, y_idim, ht, NULL); break;
+      case STEERABLE_PYR:
+	nbands = spyr_bands(x_idim, y_idim, ht, (int) mxGetN(prhs[6]), NULL);
+	break;
+      default: nbands = wpyr_bands(x_idim, y_idim, ht, flen1, NULL); break;
+      }
+  pind = mxCalloc(2*nbands, sizeof(int));
+  if (pind == NULL) mexErrMsgTxt("Cannot allocate necessary temporary space");
+  switch (type)
+      {
+      case LAPLACIAN_PYR: lpyr_bands(x_idim, y_idim, ht, pind); break;
+      case STEERABLE_PYR:
+	spyr_bands(x_idim, y_idim, ht, (int) mxGetN(prhs[6]), pind);
+	break;
+      default: wpyr_bands(x_idim, y_idim, ht, flen1, pind); break;
+      }
+  for (total=0, b=0; b<nbands; b++) total += pind[2*b]*pind[2*b+1];
+
+  if (single)
+      {
+      plhs[0] = (mxArray *) mxCreateNumericMatrix(total,1,mxSINGLE_CLASS,mxREAL);
+      if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+      switch (type)
+	  {
+	  case LAPLACIAN_PYR:
+	    status = build_lpyr_f((float *) mxGetData(prhs[1]), x_idim, y_idim, ht,
+				  float_copy(prhs[3]), flen1, float_copy(prhs[4]), flen2,
+				  edges, (float *) mxGetData(plhs[0]), pind);
+	    break;
+	  case STEERABLE_PYR:
+	    status = build_spyr_f((float *) mxGetData(prhs[1]), x_idim, y_idim, ht,
+				  float_copy(prhs[4]), hi0_fdim, float_copy(prhs[3]), lo0_fdim,
+				  float_copy(prhs[5]), lo_fdim,
+				  float_copy(prhs[6]), bfilt_fdim, (int) mxGetN(prhs[6]),
+				  NULL, NULL, edges, (float *) mxGetData(plhs[0]), pind);
+	    break;
+	  default:
+	    status = build_wpyr_f((float *) mxGetData(prhs[1]), x_idim, y_idim, ht,
+				  float_copy(prhs[3]), flen1,
+				  edges, (float *) mxGetData(plhs[0]), pind);
+	    break;
+	  }
+      }
+  else
+      {
+      plhs[0] = (mxArray *) mxCreateDoubleMatrix(total,1,mxREAL);
+      if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+      pyr = mxGetPr(plhs[0]);
+      switch (type)
+	  {
+	  case LAPLACIAN_PYR:
+	    status = build_lpyr(image, x_idim, y_idim, ht, filt1, flen1, filt2, flen2,
+				edges, pyr, pind);
+	    break;
+	  case STEERABLE_PYR:
+	    status = build_spyr(image, x_idim, y_idim, ht,
+				mxGetPr(prhs[4]), hi0_fdim, mxGetPr(prhs[3]), lo0_fdim,
+				mxGetPr(prhs[5]), lo_fdim,
+				bfilts, bfilt_fdim, (int) mxGetN(prhs[6]),
+				NULL, NULL, edges, pyr, pind);
+	    break;
+	  default:
+	    status = build_wpyr(image, x_idim, y_idim, ht, filt1, flen1,
+				edges, pyr, pind);
+	    break;
+	  }
+      }
+  if (status != 0) mexErrMsgTxt("Pyramid construction failed.");
+
+  if (nlhs > 1)
+      {
+      plhs[1] = (mxArray *) mxCreateDoubleMatrix(nbands,2,mxREAL);
+      if (plhs[1] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+      ind = mxGetPr(plhs[1]);
+      for (b=0; b<nbands; b++)
+	  {
+	  ind[b] = (double) pind[2*b];
+	  ind[nbands+b] = (double) pind[2*b+1];
+	  }
+      }
+
+  mxFree((char *) pind);
+  return;
+  }
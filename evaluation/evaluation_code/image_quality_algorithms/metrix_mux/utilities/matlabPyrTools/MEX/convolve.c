@@ -11,6 +11,12 @@
 ;;;      8/97: Bug: when calling internal_reduce with edges in {reflect1,repeat,
 ;;;            extend} and an even filter dimension.  Solution: embed the filter
 ;;;            in the upper-left corner of a filter with odd Y and X dimensions.
+;;;     10/26: the center sections of internal_reduce and internal_expand
+;;;            are computed in polyphase form (reduce_center, expand_center).
+;;;     10/26: internal_moments: the five windowed moments used by VIF/IFC
+;;;            in one pass.
+;;;     10/26: internal_reduce and internal_expand are timed when compiled
+;;;            with -DMETRIX_TRACE (native/trace.h).
 ;;;  ----------------------------------------------------------------
 ;;;    Object-Based Vision and Image Understanding System (OBVIUS),
 ;;;      Copyright 1988, Vision Science Group,  Media Laboratory,  
@@ -21,6 +27,9 @@
 #include <stdio.h>
 #include <math.h>
 #include "convolve.h"
+#ifdef METRIX_TRACE
+#include "trace.h"   /* native/, hot-path instrumentation */
+#endif
 
 /*
   --------------------------------------------------------------------
@@ -34,6 +43,74 @@
   of the filter is assumed to be (floor(x_fdim/2), floor(y_fdim/2)).
 ------------------------------------------------------------------------ */
 
+/*
+  Center section of internal_reduce, in polyphase form.  Each image
+  row is first split into its x_step phases (samples x_step apart,
+  stored contiguously), so that the tap at fx reads phase fx%x_step
+  at offset fx/x_step with unit stride.  Each tap is then applied to a
+  whole row of outputs at once (a multiply-add into ACC) instead of
+  walking the full filter separately at every output; the multiply
+  count is the same as INPROD's.  IMAGE points at the filter corner of
+  the first center output, RESULT at that output; X_CNT by Y_CNT
+  outputs are computed.  Returns -1 (doing nothing) if the row buffers
+  cannot be allocated.
+*/
+static int reduce_center(image, x_dim, x_cnt, y_cnt, temp, x_fdim, y_fdim,
+			 x_step, y_step, result, x_res_dim)
+  image_type *image, *temp, *result;
+  int x_dim, x_cnt, y_cnt, x_fdim, y_fdim, x_step, y_step, x_res_dim;
+  {
+  register image_type tap, tap2;
+  register image_type *acc, *src;
+  register int m;
+  int r, fx, fy, p, k, ph_len, row_len;
+  image_type *buf, *ph, *im_row, *im_row2;
+
+  if ((x_cnt <= 0) OR (y_cnt <= 0)) return(0);
+  ph_len = x_cnt + (x_fdim-1)/x_step;
+  row_len = (x_cnt-1)*x_step + x_fdim;
+  buf = (image_type *) malloc((x_cnt + x_step*ph_len)*sizeof(image_type));
+  if (buf IS NULL) return(-1);
+  acc = buf;
+  ph = acc + x_cnt;
+
+  for (r=0; r<y_cnt; r++, result+=x_res_dim)
+    {
+    for (m=0; m<x_cnt; m++) acc[m] = 0.0;
+    for (fy=0; fy<y_fdim; fy++)
+      {
+      im_row = image + (r*y_step+fy)*x_dim;
+      if (x_step IS 1) src = im_row;
+      else
+	{
+	for (p=0; p<x_step; p++)
+	  for (k=0; p+k*x_step<row_len; k++)
+	    ph[p*ph_len+k] = im_row[p+k*x_step];
+	src = ph;
+	}
+      for (fx=0; fx<x_fdim; fx+=2)	/* two taps per pass over ACC */
+	{
+	tap = temp[fy*x_fdim+fx];
+	im_row = (x_step IS 1) ? src+fx : src+(fx%x_step)*ph_len+fx/x_step;
+	if (fx+1 IS x_fdim)
+	  for (m=0; m<x_cnt; m++)
+	    acc[m] += im_row[m]*tap;
+	else
+	  {
+	  tap2 = temp[fy*x_fdim+fx+1];
+	  im_row2 = (x_step IS 1) ? src+fx+1 : src+((fx+1)%x_step)*ph_len+(fx+1)/x_step;
+	  for (m=0; m<x_cnt; m++)
+	    acc[m] += im_row[m]*tap + im_row2[m]*tap2;
+	  }
+	}
+      }
+    for (m=0; m<x_cnt; m++) result[m] = acc[m];
+    }
+
+  free(buf);
+  return(0);
+  }
+
 /* abstract out the inner product computation */
 #define INPROD(XCNR,YCNR)  \
         { \
@@ -61,7 +138,7 @@ int internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
   int y_dim, y_fdim;
   char *edges;
   { 
-  register double sum;
+  register image_type sum;
   register int filt_pos, im_pos, x_filt_stop;
   register int x_pos, filt_size = x_fdim*y_fdim;
   register int y_pos, res_pos;
@@ -72,10 +149,13 @@ int internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
   int y_ctr_start = ((y_fdim==1)?0:1);
   int x_fmid = x_fdim/2;
   int y_fmid = y_fdim/2;
-  int base_res_pos;
+  int base_res_pos, x_ctr_cnt, y_ctr_cnt;
   fptr reflect = edge_function(edges);  /* look up edge-handling function */
 
   if (!reflect) return(-1);
+#ifdef METRIX_TRACE
+  long long const trace_start = metrix_trace_begin();
+#endif
 
   /* shift start/stop coords to filter upper left hand corner */
   x_start -= x_fmid;   y_start -=  y_fmid;
@@ -124,7 +204,21 @@ int internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
     }
 
   (*reflect)(filt,x_fdim,y_fdim,0,0,temp,REDUCE);
-  for (;				      /* CENTER */
+  if (x_pos<x_ctr_stop)			      /* CENTER */
+      {
+      x_ctr_cnt = (x_ctr_stop-x_pos+x_step-1)/x_step;
+      y_ctr_cnt = (y_ctr_stop>y_ctr_start) ? (y_ctr_stop-y_ctr_start+y_step-1)/y_step : 0;
+      if (reduce_center(image+y_ctr_start*x_dim+x_pos, x_dim, x_ctr_cnt, y_ctr_cnt,
+			temp, x_fdim, y_fdim, x_step, y_step,
+			result+base_res_pos, x_res_dim) IS 0)
+	  { /* leave the positions as the loop below would */
+	  x_pos += x_ctr_cnt*x_step;
+	  y_pos = y_ctr_start + y_ctr_cnt*y_step;
+	  base_res_pos += x_ctr_cnt;
+	  res_pos = base_res_pos - 1 + y_ctr_cnt*x_res_dim;
+	  }
+      }
+  for (;				      /* CENTER (if out of memory) */
        x_pos<x_ctr_stop;
        x_pos+=x_step, base_res_pos++) 
     for (y_pos=y_ctr_start, res_pos=base_res_pos;
@@ -169,6 +263,9 @@ int internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
       INPROD(x_ctr_stop,y_ctr_stop)
       }
     } /* end BOTTOM */
+#ifdef METRIX_TRACE
+  metrix_trace_end("conv/" METRIX_TRACE_NAME(internal_reduce), trace_start);
+#endif
   return(0);
   } /* end of internal_reduce */
 
@@ -183,6 +280,113 @@ int internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
   WARNING: this subroutine destructively modifies the RESULT array!
  ------------------------------------------------------------------------ */
 
+/*
+  Center section of internal_expand, in polyphase form.  Scattering
+  each input sample times the whole filter (INPROD2) costs a load and a
+  store of RESULT per multiply.  Instead, the result samples in the
+  center are gathered from the inputs that reach them: with steps
+  (x_step, y_step), result column u only sees the taps of phase
+  u%x_step (fx = u - kx*x_step), and row v those of phase v%y_step.
+  For the columns reached by all taps of their phase, each tap is
+  applied to a whole row of inputs at once (a unit-stride
+  multiply-add into ACC), and ACC is added into every x_step-th result
+  sample; the few remaining columns near the ends are summed one by
+  one.  The multiply count is unchanged (only the non-zero samples of
+  the upsampled image are ever used), but RESULT is touched once per
+  sample instead of once per multiply.  IMAGE points at the first
+  center input, whose filter upper-left corner falls on RESULT[0];
+  X_CNT by Y_CNT inputs are done.  Returns -1 (doing nothing) if the
+  index tables cannot be allocated.
+*/
+static int expand_center(image, x_im_dim, x_cnt, y_cnt, temp, x_fdim, y_fdim,
+			 x_step, y_step, result, x_dim)
+  image_type *image, *temp, *result;
+  int x_im_dim, x_cnt, y_cnt, x_fdim, y_fdim, x_step, y_step, x_dim;
+  {
+  register image_type sum, tap;
+  register image_type *im_row, *filt_row, *acc;
+  register int kx, kx_stop, fx, m, m_stop;
+  int u, v, ky, ky_first, ky_last, x_len, y_len, px, ntap, j;
+  int *kx_first, *kx_last;
+  image_type *acc_buf;
+
+  if ((x_cnt <= 0) OR (y_cnt <= 0)) return(0);
+  x_len = (x_cnt-1)*x_step + x_fdim;
+  y_len = (y_cnt-1)*y_step + y_fdim;
+  kx_first = (int *) malloc(2*x_len*sizeof(int));
+  acc_buf = (image_type *) malloc(x_cnt*sizeof(image_type));
+  if ((kx_first IS NULL) OR (acc_buf IS NULL))
+      {
+      if (kx_first ISNT NULL) free(kx_first);
+      if (acc_buf ISNT NULL) free(acc_buf);
+      return(-1);
+      }
+  kx_last = kx_first + x_len;
+
+  /* inputs kx reaching result column u: 0 <= u-kx*x_step < x_fdim.
+     Columns reached by all taps of their phase are marked -1. */
+  for (u=0; u<x_len; u++)
+      {
+      kx_first[u] = (u < x_fdim) ? 0 : (u-x_fdim)/x_step + 1;
+      kx_last[u] = u/x_step;
+      if (kx_last[u] > x_cnt-1) kx_last[u] = x_cnt-1;
+      ntap = (x_fdim - u%x_step + x_step - 1)/x_step;
+      if ((ntap > 0) AND (u/x_step >= ntap-1) AND (u/x_step <= x_cnt-1))
+	kx_first[u] = -1;
+      }
+
+  for (v=0; v<y_len; v++, result+=x_dim)
+    {
+    ky_first = (v < y_fdim) ? 0 : (v-y_fdim)/y_step + 1;
+    ky_last = v/y_step;
+    if (ky_last > y_cnt-1) ky_last = y_cnt-1;
+
+    for (u=0; u<x_len; u++)		/* partial columns */
+      {
+      if (kx_first[u] < 0) continue;
+      sum = 0.0;
+      for (ky=ky_first; ky<=ky_last; ky++)
+	{
+	im_row = image + ky*x_im_dim;
+	filt_row = temp + (v-ky*y_step)*x_fdim + u;
+	for (kx=kx_first[u], kx_stop=kx_last[u], fx=-kx*x_step;
+	     kx<=kx_stop;
+	     kx++, fx-=x_step)
+	  sum += im_row[kx]*filt_row[fx];
+	}
+      result[u] += sum;
+      }
+
+    for (px=0; (px<x_step) AND (px<x_fdim); px++)   /* full columns */
+      {
+      /* u = px + m*x_step, taps fx = px + j*x_step from input kx = m-j */
+      ntap = (x_fdim - px + x_step - 1)/x_step;
+      m = ntap-1;
+      m_stop = x_cnt;
+      if (m >= m_stop) continue;
+      acc = acc_buf;
+      for (kx=m; kx<m_stop; kx++) acc[kx] = 0.0;
+      for (ky=ky_first; ky<=ky_last; ky++)
+	{
+	filt_row = temp + (v-ky*y_step)*x_fdim + px;
+	for (j=0; j<ntap; j++)
+	  {
+	  tap = filt_row[j*x_step];
+	  im_row = image + ky*x_im_dim - j;
+	  for (kx=m; kx<m_stop; kx++)
+	    acc[kx] += im_row[kx]*tap;
+	  }
+	}
+      for (kx=m; kx<m_stop; kx++)
+	result[px + kx*x_step] += acc[kx];
+      }
+    }
+
+  free(kx_first);
+  free(acc_buf);
+  return(0);
+  }
+
 /* abstract out the inner product computation */
 #define INPROD2(XCNR,YCNR)  \
         { \
@@ -204,11 +408,12 @@ int internal_expand(image,filt,temp,x_fdim,y_fdim,
   register int x_step, y_step;
   register image_type *image; 
   int x_start, y_start;
+  int x_stop, y_stop;
   image_type *filt; 
   int y_fdim, y_dim;
   char *edges;
   {
-  register double val;
+  register image_type val;
   register int filt_pos, res_pos, x_filt_stop;
   register int x_pos, filt_size = x_fdim*y_fdim;
   register int y_pos, im_pos;
@@ -219,9 +424,13 @@ int internal_expand(image,filt,temp,x_fdim,y_fdim,
   int x_fmid = x_fdim/2;
   int y_fmid = y_fdim/2;
   int base_im_pos, x_im_dim = (x_stop-x_start+x_step-1)/x_step;
+  int x_ctr_cnt, y_ctr_cnt;
   fptr reflect = edge_function(edges);  /* look up edge-handling function */	 
 
   if (!reflect) return(-1);
+#ifdef METRIX_TRACE
+  long long const trace_start = metrix_trace_begin();
+#endif
 
   /* shift start/stop coords to filter upper left hand corner */
   x_start -= x_fmid;   y_start -=  y_fmid;
@@ -270,7 +479,21 @@ int internal_expand(image,filt,temp,x_fdim,y_fdim,
     }
 
   (*reflect)(filt,x_fdim,y_fdim,0,0,temp,EXPAND);
-  for (;				      /* CENTER */
+  if (x_pos<x_ctr_stop)			      /* CENTER */
+      {
+      x_ctr_cnt = (x_ctr_stop-x_pos+x_step-1)/x_step;
+      y_ctr_cnt = (y_ctr_stop>y_ctr_start) ? (y_ctr_stop-y_ctr_start+y_step-1)/y_step : 0;
+      if (expand_center(image+base_im_pos, x_im_dim, x_ctr_cnt, y_ctr_cnt,
+			temp, x_fdim, y_fdim, x_step, y_step,
+			result+y_ctr_start*x_dim+x_pos, x_dim) IS 0)
+	  { /* leave the positions as the loop below would */
+	  x_pos += x_ctr_cnt*x_step;
+	  y_pos = y_ctr_start + y_ctr_cnt*y_step;
+	  base_im_pos += x_ctr_cnt;
+	  im_pos = base_im_pos - 1 + y_ctr_cnt*x_im_dim;
+	  }
+      }
+  for (;				      /* CENTER (if out of memory) */
        x_pos<x_ctr_stop;
        x_pos+=x_step, base_im_pos++) 
     for (y_pos=y_ctr_start, im_pos=base_im_pos;
@@ -315,9 +538,103 @@ int internal_expand(image,filt,temp,x_fdim,y_fdim,
       INPROD2(x_ctr_stop,y_ctr_stop)
       }
     } /* end BOTTOM */
+#ifdef METRIX_TRACE
+  metrix_trace_end("conv/" METRIX_TRACE_NAME(internal_expand), trace_start);
+#endif
   return(0);
   } /* end of internal_expand */
 
+/*
+  Windowed moments of two images of the same size, X_IM and Y_IM, in
+  one pass.  With W the sum of FILT, and sums taken under the
+  (edge-reflected) filter as in internal_reduce:
+
+    mean_x = sum(f*x)/W          mean_y = sum(f*y)/W
+    cov_xy = sum(f*x*y) - W*mean_x*mean_y
+    ss_x   = sum(f*x^2) - W*mean_x^2
+    ss_y   = sum(f*y^2) - W*mean_y^2
+
+  This is what corrDn of x, y, x.*y, x.^2 and y.^2 gives (see
+  vifsub_est_M.m), without forming the product images.  EDGES, steps
+  and start/stop are those of internal_reduce, and each output uses
+  the same region (corner, edge or center) and reflected filter as it
+  would there; TEMP is refilled only when that changes.  Sums are
+  accumulated in double.  Returns -1 for an unknown EDGES or a filter
+  that sums to zero.
+*/
+int internal_moments(x_im, y_im, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
+		     x_start, x_step, x_stop, y_start, y_step, y_stop,
+		     mean_x, mean_y, cov_xy, ss_x, ss_y, edges)
+  image_type *x_im, *y_im, *filt, *temp;
+  int x_dim, y_dim, x_fdim, y_fdim;
+  int x_start, x_step, x_stop, y_start, y_step, y_stop;
+  image_type *mean_x, *mean_y, *cov_xy, *ss_x, *ss_y;
+  char *edges;
+  {
+  register double sx, sy, sxy, sxx, syy, f, a, b;
+  register int fx, im_pos, filt_pos;
+  int fy, x_pos, y_pos, res_pos;
+  int x_corner, y_corner, x_ref, y_ref, last_x_ref = 0, last_y_ref = 0;
+  int have_temp = 0;
+  int y_ctr_stop = y_dim - ((y_fdim==1)?0:y_fdim);
+  int x_ctr_stop = x_dim - ((x_fdim==1)?0:x_fdim);
+  int x_ctr_start = ((x_fdim==1)?0:1);
+  int y_ctr_start = ((y_fdim==1)?0:1);
+  double wsum, mx, my;
+  fptr reflect = edge_function(edges);  /* look up edge-handling function */
+
+  if (!reflect) return(-1);
+  for (wsum=0.0, filt_pos=0; filt_pos<x_fdim*y_fdim; filt_pos++)
+    wsum += filt[filt_pos];
+  if (wsum IS 0.0) return(-1);
+
+  /* shift start/stop coords to filter upper left hand corner */
+  x_start -= x_fdim/2;   y_start -= y_fdim/2;
+  x_stop -=  x_fdim/2;   y_stop -=  y_fdim/2;
+
+  if (x_stop < x_ctr_stop) x_ctr_stop = x_stop;
+  if (y_stop < y_ctr_stop) y_ctr_stop = y_stop;
+
+  for (res_pos=0, y_pos=y_start; y_pos<y_stop; y_pos+=y_step)
+    {
+    if (y_pos < y_ctr_start)	   { y_ref = y_pos-1; y_corner = 0; }
+    else if (y_pos < y_ctr_stop)   { y_ref = 0; y_corner = y_pos; }
+    else   { y_ref = y_pos-y_ctr_stop+1; y_corner = y_ctr_stop; }
+
+    for (x_pos=x_start; x_pos<x_stop; x_pos+=x_step, res_pos++)
+      {
+      if (x_pos < x_ctr_start)	   { x_ref = x_pos-1; x_corner = 0; }
+      else if (x_pos < x_ctr_stop) { x_ref = 0; x_corner = x_pos; }
+      else { x_ref = x_pos-x_ctr_stop+1; x_corner = x_ctr_stop; }
+
+      if (!have_temp OR (x_ref ISNT last_x_ref) OR (y_ref ISNT last_y_ref))
+	{
+	(*reflect)(filt,x_fdim,y_fdim,x_ref,y_ref,temp,REDUCE);
+	last_x_ref = x_ref;  last_y_ref = y_ref;  have_temp = 1;
+	}
+
+      sx = sy = sxy = sxx = syy = 0.0;
+      for (fy=0, filt_pos=0; fy<y_fdim; fy++)
+	for (fx=0, im_pos=(y_corner+fy)*x_dim+x_corner;
+	     fx<x_fdim;
+	     fx++, im_pos++, filt_pos++)
+	  {
+	  f = temp[filt_pos];  a = x_im[im_pos];  b = y_im[im_pos];
+	  sx += f*a;  sy += f*b;
+	  sxy += f*a*b;  sxx += f*a*a;  syy += f*b*b;
+	  }
+
+      mx = sx/wsum;  my = sy/wsum;
+      mean_x[res_pos] = mx;
+      mean_y[res_pos] = my;
+      cov_xy[res_pos] = sxy - wsum*mx*my;
+      ss_x[res_pos] = sxx - wsum*mx*mx;
+      ss_y[res_pos] = syy - wsum*my*my;
+      }
+    }
+  return(0);
+  } /* end of internal_moments */
+
 
 /* Local Variables: */
 /* buffer-read-only: t */
@@ -31,7 +31,42 @@ typedef struct
   fptr func;
   } EDGE_HANDLER;
 
+/* Compiling with -DPYR_FLOAT gives the single-precision kernels.  The
+   same sources are built twice (see the Makefiles), and every external
+   name in the float objects carries an _f suffix so both sets can be
+   linked into one MEX file. */
+#ifdef PYR_FLOAT
+typedef float image_type;
+#define edge_function        edge_function_f
+#define internal_reduce      internal_reduce_f
+#define internal_expand      internal_expand_f
+#define internal_wrap_reduce internal_wrap_reduce_f
+#define internal_wrap_expand internal_wrap_expand_f
+#define internal_fft_reduce  internal_fft_reduce_f
+#define internal_fft_expand  internal_fft_expand_f
+#define internal_moments     internal_moments_f
+#define fft_plan_create      fft_plan_create_f
+#define fft_plan_destroy     fft_plan_destroy_f
+#define fft_1d               fft_1d_f
+#else
 typedef double image_type;
+#endif
+
+/* Filters with at least this many taps per retained output sample
+   (x_fdim*y_fdim / (x_step*y_step)) are applied by FFT (fftconv.c). */
+#define FFT_MIN_FILT_AREA 140
+#define USE_FFT_CONV(x_fdim,y_fdim,x_step,y_step) \
+        ((x_fdim)*(y_fdim) >= FFT_MIN_FILT_AREA*(x_step)*(y_step))
+
+/* The FFT of fftconv.c (also used by the native metric engines):
+   fft_1d is a forward, unscaled, in-place transform of N interleaved
+   complex doubles (re, im).  A plan holds scratch buffers, so threads
+   transforming at the same time need a plan each.  fft_plan_create
+   returns NULL if out of memory. */
+typedef struct fft_plan_struct FFT_PLAN;
+FFT_PLAN *fft_plan_create(int n);
+void fft_plan_destroy(FFT_PLAN *plan);
+void fft_1d(FFT_PLAN *plan, double *data);
 
 fptr edge_function(char *edges);
 int internal_reduce(image_type *image, int x_idim, int y_idim, 
@@ -53,3 +88,56 @@ int internal_wrap_expand(image_type *image, image_type *filt, int x_fdim, int y_
 			 int x_start, int x_step, int x_stop, 
 			 int y_start, int y_step, int y_stop,
 			 image_type *result, int x_rdim, int y_rdim);
+int internal_fft_reduce(image_type *image, int x_idim, int y_idim, 
+			image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+			int x_start, int x_step, int x_stop, 
+			int y_start, int y_step, int y_stop,
+			image_type *result, char *edges);
+int internal_fft_expand(image_type *image, 
+			image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+			int x_start, int x_step, int x_stop, 
+			int y_start, int y_step, int y_stop,
+			image_type *result, int x_rdim, int y_rdim, char *edges);
+int internal_moments(image_type *x_im, image_type *y_im, int x_idim, int y_idim,
+		     image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+		     int x_start, int x_step, int x_stop, 
+		     int y_start, int y_step, int y_stop,
+		     image_type *mean_x, image_type *mean_y, image_type *cov_xy,
+		     image_type *ss_x, image_type *ss_y, char *edges);
+
+/* Single-precision versions, for callers compiled in double. */
+int internal_reduce_f(float *image, int x_idim, int y_idim, 
+		      float *filt, float *temp, int x_fdim, int y_fdim,
+		      int x_start, int x_step, int x_stop, 
+		      int y_start, int y_step, int y_stop,
+		      float *result, char *edges);
+int internal_expand_f(float *image, 
+		      float *filt, float *temp, int x_fdim, int y_fdim,
+		      int x_start, int x_step, int x_stop, 
+		      int y_start, int y_step, int y_stop,
+		      float *result, int x_rdim, int y_rdim, char *edges);
+int internal_wrap_reduce_f(float *image, int x_idim, int y_idim, 
+			   float *filt, int x_fdim, int y_fdim,
+			   int x_start, int x_step, int x_stop, 
+			   int y_start, int y_step, int y_stop,
+			   float *result);
+int internal_wrap_expand_f(float *image, float *filt, int x_fdim, int y_fdim,
+			   int x_start, int x_step, int x_stop, 
+			   int y_start, int y_step, int y_stop,
+			   float *result, int x_rdim, int y_rdim);
+int internal_fft_reduce_f(float *image, int x_idim, int y_idim, 
+			  float *filt, float *temp, int x_fdim, int y_fdim,
+			  int x_start, int x_step, int x_stop, 
+			  int y_start, int y_step, int y_stop,
+			  float *result, char *edges);
+int internal_fft_expand_f(float *image, 
+			  float *filt, float *temp, int x_fdim, int y_fdim,
+			  int x_start, int x_step, int x_stop, 
+			  int y_start, int y_step, int y_stop,
+			  float *result, int x_rdim, int y_rdim, char *edges);
+int internal_moments_f(float *x_im, float *y_im, int x_idim, int y_idim,
+		       float *filt, float *temp, int x_fdim, int y_fdim,
+		       int x_start, int x_step, int x_stop, 
+		       int y_start, int y_step, int y_stop,
+		       float *mean_x, float *mean_y, float *cov_xy,
+		       float *ss_x, float *ss_y, char *edges);
@@ -3,6 +3,7 @@ RES = corrDn(IM, FILT, EDGES, STEP, START, STOP);
   >>> See corrDn.m for documentation <<<
   This is a matlab interface to the internal_reduce function. 
   EPS, 7/96.
+  Single-precision IM runs the float kernels (-DPYR_FLOAT build), 10/26.
 */
 
 #define V4_COMPAT
@@ -12,6 +13,7 @@ RES = corrDn(IM, FILT, EDGES, STEP, START, STOP);
 #include "convolve.h"
 
 #define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notFltMtx(it) (!mxIsNumeric(it) || !(mxIsDouble(it) || mxIsSingle(it)) || mxIsSparse(it) || mxIsComplex(it))
 
 void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 mxArray *plhs[],    /* Matrices on lhs      */
@@ -20,6 +22,8 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 )
   {
   double *image,*filt, *temp, *result;
+  float *fimage, *ffilt, *ftemp, *fresult;
+  int single, i;
   int x_fdim, y_fdim, x_idim, y_idim;
   int x_rdim, y_rdim;
   int x_start = 1;
@@ -27,7 +31,7 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
   int y_start = 1;
   int y_step = 1;
   int x_stop, y_stop;
-  mxArray *arg;
+  const mxArray *arg;
   double *mxMat;
   char edges[15] = "reflect1";
   
@@ -35,14 +39,18 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
 
   /* ARG 1: IMAGE  */
   arg = prhs[0];
-  if notDblMtx(arg) mexErrMsgTxt("IMAGE arg must be a non-sparse double float matrix.");
+  if notFltMtx(arg) mexErrMsgTxt("IMAGE arg must be a non-sparse double or single float matrix.");
+  single = mxIsSingle(arg);
   image = mxGetPr(arg);
   x_idim = (int) mxGetM(arg); /* X is inner index! */
   y_idim = (int) mxGetN(arg);
 
   /* ARG 2: FILTER */
   arg = prhs[1];
-  if notDblMtx(arg) mexErrMsgTxt("FILTER arg must be non-sparse double float matrix.");
+  if (single && notFltMtx(arg))
+    mexErrMsgTxt("FILTER arg must be non-sparse double or single float matrix.");
+  if (!single && notDblMtx(arg))
+    mexErrMsgTxt("FILTER arg must be non-sparse double float matrix.");
   filt = mxGetPr(arg);
   x_fdim = (int) mxGetM(arg); 
   y_fdim = (int) mxGetN(arg);
@@ -114,6 +122,35 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
   x_rdim = (x_stop-x_start+x_step-1) / x_step;
   y_rdim = (y_stop-y_start+y_step-1) / y_step;
   
+  if (single)
+      {
+      plhs[0] = (mxArray *) mxCreateNumericMatrix(x_rdim,y_rdim,mxSINGLE_CLASS,mxREAL);
+      if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+      fresult = (float *) mxGetData(plhs[0]);
+      fimage = (float *) mxGetData(prhs[0]);
+      ftemp = mxCalloc(2*x_fdim*y_fdim, sizeof(float));
+      if (ftemp == NULL)
+	mexErrMsgTxt("Cannot allocate necessary temporary space");
+      ffilt = ftemp + x_fdim*y_fdim;
+      for (i=0; i<x_fdim*y_fdim; i++)
+	ffilt[i] = mxIsSingle(prhs[1]) ? ((float *) mxGetData(prhs[1]))[i] : (float) filt[i];
+
+      if (USE_FFT_CONV(x_fdim, y_fdim, x_step, y_step))
+	internal_fft_reduce_f(fimage, x_idim, y_idim, ffilt, ftemp, x_fdim, y_fdim,
+			      x_start, x_step, x_stop, y_start, y_step, y_stop,
+			      fresult, edges);
+      else if (strcmp(edges,"circular") == 0)
+	internal_wrap_reduce_f(fimage, x_idim, y_idim, ffilt, x_fdim, y_fdim,
+			       x_start, x_step, x_stop, y_start, y_step, y_stop,
+			       fresult);
+      else internal_reduce_f(fimage, x_idim, y_idim, ffilt, ftemp, x_fdim, y_fdim,
+			     x_start, x_step, x_stop, y_start, y_step, y_stop,
+			     fresult, edges);
+
+      mxFree((char *) ftemp);
+      return;
+      }
+
   /*  mxFreeMatrix(plhs[0]); */
   plhs[0] = (mxArray *) mxCreateDoubleMatrix(x_rdim,y_rdim,mxREAL);
   if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
@@ -129,7 +166,11 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
 	 x_start,x_step,x_stop,y_start,y_step,y_stop,edges);
 	 */
 
-  if (strcmp(edges,"circular") == 0)
+  if (USE_FFT_CONV(x_fdim, y_fdim, x_step, y_step))
+	internal_fft_reduce(image, x_idim, y_idim, filt, temp, x_fdim, y_fdim,
+			    x_start, x_step, x_stop, y_start, y_step, y_stop,
+			    result, edges);
+  else if (strcmp(edges,"circular") == 0)
   	internal_wrap_reduce(image, x_idim, y_idim, filt, x_fdim, y_fdim,
 			     x_start, x_step, x_stop, y_start, y_step, y_stop,
 			     result);
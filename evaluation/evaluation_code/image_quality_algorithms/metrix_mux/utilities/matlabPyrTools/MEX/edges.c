@@ -9,6 +9,8 @@
 ;;;  MODIFIED, 8/97: reflect1, reflect2, repeat, extend upgraded to 
 ;;;       work properly for non-symmetric filters.  Added qreflect2 to handle
 ;;;       even-length QMF's which broke under the reflect2 modification.
+;;;  MODIFIED, 10/26: filters are image_type, for the single-precision
+;;;       (-DPYR_FLOAT) build.
 ;;;  ----------------------------------------------------------------
 ;;;    Object-Based Vision and Image Understanding System (OBVIUS),
 ;;;      Copyright 1988, Vision Science Group,  Media Laboratory,  
@@ -40,6 +42,18 @@ below.
 #define sgn(a)  ( ((a)>0)?1:(((a)<0)?-1:0) )
 #define clip(a,mn,mx)  ( ((a)<(mn))?(mn):(((a)>=(mx))?(mx-1):(a)) )
 
+#ifdef PYR_FLOAT	/* keep the single-precision handlers distinct */
+#define reflect1  reflect1_f
+#define reflect2  reflect2_f
+#define qreflect2 qreflect2_f
+#define repeat    repeat_f
+#define zero      zero_f
+#define Extend    Extend_f
+#define nocompute nocompute_f
+#define ereflect  ereflect_f
+#define predict   predict_f
+#endif
+
 int reflect1(), reflect2(), qreflect2(), repeat(), zero(), Extend(), nocompute();
 int ereflect(), predict();
 
@@ -139,7 +153,7 @@ nocompute() - Return zero for values where filter hangs over the edge.
 */
 
 int nocompute(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
@@ -158,7 +172,7 @@ int nocompute(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
 zero() - Zero outside of image.  Discontinuous, but adds zero energy. */
 
 int zero(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
@@ -191,7 +205,7 @@ remain even, odd ones remain odd).
 */	 
 
 int reflect1(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
@@ -260,7 +274,7 @@ derivative.
 */
 
 int reflect2(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
@@ -335,7 +349,7 @@ even-length QMF filters.
 */
 
 int qreflect2(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  double *filt, *result;
+  image_type *filt, *result;
   int x_dim, y_dim, x_pos, y_pos, r_or_e;
   {
   reflect2(filt,x_dim,y_dim,x_pos,y_pos,result,0);
@@ -348,7 +362,7 @@ derivative.
 */
 
 int repeat(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
@@ -419,7 +433,7 @@ not higher derivs).
 */
 
 int Extend(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
@@ -535,7 +549,7 @@ by the reciprocal of the percentage of filter being used.  (i.e. if
 taps being used by 2).  */
 
 int predict(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
@@ -580,7 +594,7 @@ QMF filters, but it is not useful for most applications, since it
 alters the DC level.  */
 
 int ereflect(filt,x_dim,y_dim,x_pos,y_pos,result,r_or_e)
-  register double *filt, *result;
+  register image_type *filt, *result;
   register int x_dim;
   int y_dim, x_pos, y_pos, r_or_e;
   {
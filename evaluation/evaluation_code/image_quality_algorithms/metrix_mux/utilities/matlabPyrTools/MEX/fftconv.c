@@ -0,0 +1,708 @@
+/*
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;;;  File: fftconv.c
+;;;  Description: FFT-based versions of internal_reduce/internal_expand
+;;;               for filters too large for the direct inner product.
+;;;  ----------------------------------------------------------------
+;;;    Object-Based Vision and Image Understanding System (OBVIUS),
+;;;      Copyright 1988, Vision Science Group,  Media Laboratory,
+;;;              Massachusetts Institute of Technology.
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+*/
+
+/* The direct code in convolve.c and wrap.c costs x_fdim*y_fdim
+multiplies per output sample.  The routines below compute the same
+result with a 2D FFT of the (unpadded) image, which costs O(log N)
+per sample regardless of filter size.  The transforms are
+self-contained: a mixed-radix (4,2,3,5,...) Stockham FFT, with
+Bluestein's algorithm for lengths having a large prime factor.
+
+Edge handling is identical to the direct code:
+
+  circular - the FFT of the full image IS a circular correlation, so
+             every output sample comes from the transform.
+  others   - only samples in the CENTER section (filter entirely
+             inside the image, where the edge handler returns the
+             unmodified filter) come from the transform.  The
+             TOP/BOTTOM rows and LEFT/RIGHT columns are handed to
+             internal_reduce/internal_expand on sub-windows of the
+             START/STEP/STOP lattice, which yields exactly the same
+             samples as a single call on the whole lattice.
+
+The image and filter are packed into the real and imaginary parts of
+ONE complex array, so each call does one forward and one inverse 2D
+transform and needs 16 bytes of scratch per image pixel.
+
+Crossover (FFT_MIN_FILT_AREA in convolve.h), measured on a 512x512
+image, edges = 'reflect1', gcc -O2, one core.  Times are ms per call:
+
+                step [1 1]         step [2 2]
+   filter    direct    fft      direct    fft
+    5x5         3.2    15.2        1.0    14.7
+    9x9         9.7    15.6        2.8    15.4
+   13x13       19.0    16.8        5.4    15.5
+   17x17       32.7    18.9        8.7    16.2
+   21x21       51.0    22.1       13.8    17.0
+   25x25       73.5    27.5       19.2    19.5
+   33x33      137.7    45.3       34.5    23.1
+   41x41      199.3    70.8       52.9    28.9
+
+The FFT cost is nearly flat in the filter size.  The direct code only
+visits retained samples while the FFT computes all of them, so the
+crossover is expressed in taps per retained sample: about 140 for
+step [1 1] and 155 for step [2 2], hence 140.  (Before the radix-3/5
+butterflies and per-pass twiddle lookup of fft_stockham, the FFT took
+1.2 to 1.8 times as long.)
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "convolve.h"
+#ifdef METRIX_TRACE
+#include "trace.h"   /* native/, hot-path instrumentation */
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MAX_DIRECT_RADIX 64	/* larger prime factors go to Bluestein */
+
+struct fft_plan_struct
+  {
+  int n;			/* transform length */
+  int nfact, fact[32];		/* radix of each Stockham pass */
+  double *tw;			/* exp(-2 pi i k/n), k = 0..n-1 */
+  double *work;			/* ping-pong buffer, n complex */
+  double *dft;			/* per-pass twiddles and radix scratch */
+  struct fft_plan_struct *sub;	/* power-of-2 plan for Bluestein */
+  double *chirp, *chirp_ft;	/* Bluestein chirp and its transform */
+  double *bwork;		/* Bluestein scratch, sub->n complex */
+  };
+
+static void fft_stockham(FFT_PLAN *plan, double *data);
+
+/* Complex values are stored interleaved: re = d[2k], im = d[2k+1]. */
+
+FFT_PLAN *fft_plan_create(int n)
+  {
+  FFT_PLAN *plan;
+  int i, m, p, maxp = 4;
+
+  plan = (FFT_PLAN *) calloc(1, sizeof(FFT_PLAN));
+  if (plan IS NULL) return(NULL);
+  plan->n = n;
+
+  for (m = n; (m%4) IS 0; m /= 4) plan->fact[plan->nfact++] = 4;
+  for (p = 2; m > 1; )
+    if ((m%p) IS 0)
+      {
+      plan->fact[plan->nfact++] = p;
+      if (p > maxp) maxp = p;
+      m /= p;
+      }
+    else p = (p IS 2) ? 3 : p+2;
+
+  if (maxp > MAX_DIRECT_RADIX)
+      {				/* Bluestein: n-point DFT as a 2m-point convolution */
+      for (m = 1; m < 2*n-1; m *= 2) ;
+      plan->sub = fft_plan_create(m);
+      plan->chirp = (double *) malloc(2*n*sizeof(double));
+      plan->chirp_ft = (double *) calloc(2*m, sizeof(double));
+      plan->bwork = (double *) malloc(2*m*sizeof(double));
+      if ((plan->sub IS NULL) OR (plan->chirp IS NULL) OR
+	  (plan->chirp_ft IS NULL) OR (plan->bwork IS NULL))
+	  {
+	  fft_plan_destroy(plan);
+	  return(NULL);
+	  }
+      for (i=0; i<n; i++)
+	  {			/* reduce k^2 mod 2n to keep the angle accurate */
+	  double a = M_PI * (double)(((long)i*i) % (2L*n)) / n;
+	  plan->chirp[2*i] = cos(a);
+	  plan->chirp[2*i+1] = -sin(a);
+	  }
+      plan->chirp_ft[0] = 1.0;
+      for (i=1; i<n; i++)
+	  {
+	  plan->chirp_ft[2*i] = plan->chirp_ft[2*(m-i)] = plan->chirp[2*i];
+	  plan->chirp_ft[2*i+1] = plan->chirp_ft[2*(m-i)+1] = -plan->chirp[2*i+1];
+	  }
+      fft_stockham(plan->sub, plan->chirp_ft);
+      return(plan);
+      }
+
+  plan->tw = (double *) malloc(2*n*sizeof(double));
+  plan->work = (double *) malloc(2*n*sizeof(double));
+  plan->dft = (double *) malloc(4*MAX_DIRECT_RADIX*sizeof(double));
+  if ((plan->tw IS NULL) OR (plan->work IS NULL) OR (plan->dft IS NULL))
+      {
+      fft_plan_destroy(plan);
+      return(NULL);
+      }
+  for (i=0; i<n; i++)
+      {
+      plan->tw[2*i] = cos(2.0*M_PI*i/n);
+      plan->tw[2*i+1] = -sin(2.0*M_PI*i/n);
+      }
+  return(plan);
+  }
+
+void fft_plan_destroy(FFT_PLAN *plan)
+  {
+  if (plan IS NULL) return;
+  if (plan->sub) fft_plan_destroy(plan->sub);
+  free(plan->tw);  free(plan->work);  free(plan->dft);
+  free(plan->chirp);  free(plan->chirp_ft);  free(plan->bwork);
+  free(plan);
+  }
+
+/* Butterflies of one Stockham pass, for the S sub-transforms that
+   share twiddles W (interleaved, W[0] = 1): input r of sub-transform b
+   is IN[2*(b + r*STRIDE)], output rr is OUT[2*(b + rr*S)], multiplied
+   by W[rr].  The loops over b are the inner ones. */
+
+#define TWIDDLE(k, re, im) \
+  out[k] = (re)*w[2*rr] - (im)*w[2*rr+1];  out[k+1] = (re)*w[2*rr+1] + (im)*w[2*rr]
+
+static void butterfly2(const double *in, double *out, int s, int stride, const double *w)
+  {
+  int b, k, rr = 1;
+  for (b=0; b<s; b++)
+      {
+      const double *t0 = in + 2*b, *t1 = t0 + 2*stride;
+      k = 2*b;
+      out[k] = t0[0]+t1[0];  out[k+1] = t0[1]+t1[1];
+      k += 2*s;
+      TWIDDLE(k, t0[0]-t1[0], t0[1]-t1[1]);
+      }
+  }
+
+static void butterfly3(const double *in, double *out, int s, int stride, const double *w)
+  {
+  const double c3 = -0.5, s3 = -0.86602540378443864676;	/* W_3 = c3 + i s3 */
+  int b, k, rr;
+  for (b=0; b<s; b++)
+      {
+      const double *t0 = in + 2*b, *t1 = t0 + 2*stride, *t2 = t1 + 2*stride;
+      double sr = t1[0]+t2[0], si = t1[1]+t2[1];
+      double dr = t1[0]-t2[0], di = t1[1]-t2[1];
+      double mr = t0[0] + c3*sr, mi = t0[1] + c3*si;
+      k = 2*b;
+      out[k] = t0[0]+sr;  out[k+1] = t0[1]+si;
+      rr = 1;  k += 2*s;
+      TWIDDLE(k, mr - s3*di, mi + s3*dr);
+      rr = 2;  k += 2*s;
+      TWIDDLE(k, mr + s3*di, mi - s3*dr);
+      }
+  }
+
+static void butterfly4(const double *in, double *out, int s, int stride, const double *w)
+  {
+  int b, k, rr;
+  for (b=0; b<s; b++)
+      {				/* -i rotation inlined */
+      const double *t0 = in + 2*b, *t1 = t0 + 2*stride;
+      const double *t2 = t1 + 2*stride, *t3 = t2 + 2*stride;
+      double a0r = t0[0]+t2[0], a0i = t0[1]+t2[1];
+      double a1r = t0[0]-t2[0], a1i = t0[1]-t2[1];
+      double a2r = t1[0]+t3[0], a2i = t1[1]+t3[1];
+      double a3r = t1[1]-t3[1], a3i = t3[0]-t1[0];
+      k = 2*b;
+      out[k] = a0r+a2r;  out[k+1] = a0i+a2i;
+      rr = 1;  k += 2*s;
+      TWIDDLE(k, a1r+a3r, a1i+a3i);
+      rr = 2;  k += 2*s;
+      TWIDDLE(k, a0r-a2r, a0i-a2i);
+      rr = 3;  k += 2*s;
+      TWIDDLE(k, a1r-a3r, a1i-a3i);
+      }
+  }
+
+static void butterfly5(const double *in, double *out, int s, int stride, const double *w)
+  {
+  const double c1 = 0.30901699437494742410, c2 = -0.80901699437494742410;
+  const double s1 = -0.95105651629515357212, s2 = -0.58778525229247312917;
+  int b, k, rr;
+  for (b=0; b<s; b++)
+      {				/* W_5^k = cos + i sin, sin < 0 (forward) */
+      const double *t0 = in + 2*b, *t1 = t0 + 2*stride, *t2 = t1 + 2*stride;
+      const double *t3 = t2 + 2*stride, *t4 = t3 + 2*stride;
+      double a1r = t1[0]+t4[0], a1i = t1[1]+t4[1], b1r = t1[0]-t4[0], b1i = t1[1]-t4[1];
+      double a2r = t2[0]+t3[0], a2i = t2[1]+t3[1], b2r = t2[0]-t3[0], b2i = t2[1]-t3[1];
+      double p1r = t0[0] + c1*a1r + c2*a2r, p1i = t0[1] + c1*a1i + c2*a2i;
+      double p2r = t0[0] + c2*a1r + c1*a2r, p2i = t0[1] + c2*a1i + c1*a2i;
+      double q1r = s1*b1r + s2*b2r, q1i = s1*b1i + s2*b2i;	/* times i below */
+      double q2r = s2*b1r - s1*b2r, q2i = s2*b1i - s1*b2i;
+      k = 2*b;
+      out[k] = t0[0]+a1r+a2r;  out[k+1] = t0[1]+a1i+a2i;
+      rr = 1;  k += 2*s;
+      TWIDDLE(k, p1r - q1i, p1i + q1r);
+      rr = 2;  k += 2*s;
+      TWIDDLE(k, p2r - q2i, p2i + q2r);
+      rr = 3;  k += 2*s;
+      TWIDDLE(k, p2r + q2i, p2i - q2r);
+      rr = 4;  k += 2*s;
+      TWIDDLE(k, p1r + q1i, p1i - q1r);
+      }
+  }
+
+/* Any other radix P: a direct P-point DFT (TW is the plan's table of
+   N roots, T scratch for P values). */
+static void butterflyp(const double *in, double *out, int s, int stride, const double *w,
+		       int p, const double *tw, int n, double *t)
+  {
+  double sr, si, ar, ai;
+  int b, k, r, rr, wi;
+  for (b=0; b<s; b++)
+      {
+      for (r=0; r<p; r++)
+	  {
+	  t[2*r] = in[2*(b + r*stride)];
+	  t[2*r+1] = in[2*(b + r*stride)+1];
+	  }
+      for (rr=0; rr<p; rr++)
+	  {
+	  sr = 0.0;  si = 0.0;
+	  for (r=0; r<p; r++)
+	      {
+	      wi = 2*(((r*rr) % p) * (n/p));
+	      ar = t[2*r];  ai = t[2*r+1];
+	      sr += ar*tw[wi] - ai*tw[wi+1];
+	      si += ar*tw[wi+1] + ai*tw[wi];
+	      }
+	  k = 2*(b + rr*s);
+	  TWIDDLE(k, sr, si);
+	  }
+      }
+  }
+
+#undef TWIDDLE
+
+/* In-place forward transform (no scaling) by Stockham autosort passes.
+   Pass F splits each of the S current sub-transforms of length NCUR
+   into P of length M; the twiddles depend on the position Q in the
+   sub-transform only, so they are looked up once per Q. */
+static void fft_stockham(FFT_PLAN *plan, double *data)
+  {
+  double *x = data, *y = plan->work, *swap;
+  const double *tw = plan->tw;
+  double *w = plan->dft, *t = plan->dft + 2*MAX_DIRECT_RADIX;
+  int n = plan->n, s = 1, ncur = n, m, p, f, tstep, q, rr, wi;
+
+  for (f=0; f<plan->nfact; f++)
+      {
+      p = plan->fact[f];
+      m = ncur / p;
+      tstep = n / ncur;		/* W_ncur^k = tw[k*tstep] */
+      for (q=0; q<m; q++)
+	  {
+	  const double *in = x + 2*s*q;
+	  double *out = y + 2*s*p*q;
+	  for (rr=0; rr<p; rr++)
+	      {			/* q*rr*tstep < n */
+	      wi = 2*(q*rr*tstep);
+	      w[2*rr] = tw[wi];  w[2*rr+1] = tw[wi+1];
+	      }
+	  switch (p)
+	      {
+	      case 2: butterfly2(in, out, s, s*m, w); break;
+	      case 3: butterfly3(in, out, s, s*m, w); break;
+	      case 4: butterfly4(in, out, s, s*m, w); break;
+	      case 5: butterfly5(in, out, s, s*m, w); break;
+	      default: butterflyp(in, out, s, s*m, w, p, tw, n, t);
+	      }
+	  }
+      swap = x;  x = y;  y = swap;
+      ncur = m;  s *= p;
+      }
+  if (x ISNT data) memcpy(data, x, 2*n*sizeof(double));
+  }
+
+static void fft_bluestein(FFT_PLAN *plan, double *data)
+  {
+  register double *a = plan->bwork, *w = plan->chirp, *h = plan->chirp_ft;
+  register double re, im;
+  register int i;
+  int n = plan->n, m = plan->sub->n;
+
+  for (i=0; i<n; i++)
+      {
+      a[2*i] = data[2*i]*w[2*i] - data[2*i+1]*w[2*i+1];
+      a[2*i+1] = data[2*i]*w[2*i+1] + data[2*i+1]*w[2*i];
+      }
+  for (i=2*n; i<2*m; i++) a[i] = 0.0;
+
+  fft_stockham(plan->sub, a);
+  for (i=0; i<m; i++)
+      {
+      re = a[2*i]*h[2*i] - a[2*i+1]*h[2*i+1];
+      im = a[2*i]*h[2*i+1] + a[2*i+1]*h[2*i];
+      a[2*i] = re;  a[2*i+1] = -im;	/* conjugate: inverse via forward */
+      }
+  fft_stockham(plan->sub, a);
+
+  for (i=0; i<n; i++)
+      {
+      re = a[2*i]/m;  im = -a[2*i+1]/m;
+      data[2*i] = re*w[2*i] - im*w[2*i+1];
+      data[2*i+1] = re*w[2*i+1] + im*w[2*i];
+      }
+  }
+
+void fft_1d(FFT_PLAN *plan, double *data)
+  {
+  if (plan->n IS 1) return;
+  if (plan->sub) fft_bluestein(plan, data);
+  else fft_stockham(plan, data);
+  }
+
+/* Forward 2D transform of an x_dim by y_dim complex array (X is the
+   inner index).  COL is scratch for one column. */
+static void fft_2d(double *data, int x_dim, int y_dim,
+		   FFT_PLAN *x_plan, FFT_PLAN *y_plan, double *col)
+  {
+  register int x_pos, y_pos;
+
+  for (y_pos=0; y_pos<y_dim; y_pos++)
+    fft_1d(x_plan, data + 2*y_pos*x_dim);
+  for (x_pos=0; x_pos<x_dim; x_pos++)
+      {
+      for (y_pos=0; y_pos<y_dim; y_pos++)
+	  {
+	  col[2*y_pos] = data[2*(y_pos*x_dim+x_pos)];
+	  col[2*y_pos+1] = data[2*(y_pos*x_dim+x_pos)+1];
+	  }
+      fft_1d(y_plan, col);
+      for (y_pos=0; y_pos<y_dim; y_pos++)
+	  {
+	  data[2*(y_pos*x_dim+x_pos)] = col[2*y_pos];
+	  data[2*(y_pos*x_dim+x_pos)+1] = col[2*y_pos+1];
+	  }
+      }
+  }
+
+/*
+  --------------------------------------------------------------------
+  DATA holds IM + i*FILT on input (both real, FILT zero-padded and
+  anchored at the origin).  On output its real part holds the
+  correlation of IM with FILT (R_OR_E IS REDUCE) or the convolution
+  of IM with FILT (R_OR_E IS EXPAND), both circular over the array.
+  The two spectra are separated with the conjugate symmetry of real
+  signals: IM(k) = (Z(k) + Z*(-k))/2, FILT(k) = (Z(k) - Z*(-k))/2i.
+ -------------------------------------------------------------------- */
+static int fft_filter_packed(double *data, int x_dim, int y_dim, int r_or_e)
+  {
+  FFT_PLAN *x_plan, *y_plan;
+  double *col;
+  double ar, ai, br, bi, ir, ii, fr, fi, pr, pi, scale;
+  int x_pos, y_pos, k, nk;
+  int size = x_dim*y_dim;
+
+  x_plan = fft_plan_create(x_dim);
+  y_plan = fft_plan_create(y_dim);
+  col = (double *) malloc(2*y_dim*sizeof(double));
+  if ((x_plan IS NULL) OR (y_plan IS NULL) OR (col IS NULL))
+      {
+      fft_plan_destroy(x_plan);  fft_plan_destroy(y_plan);  free(col);
+      printf("FFTCONV: Failed to allocate FFT plan!");
+      return(-1);
+      }
+
+  fft_2d(data, x_dim, y_dim, x_plan, y_plan, col);
+
+  for (y_pos=0; y_pos<y_dim; y_pos++)
+    for (x_pos=0; x_pos<x_dim; x_pos++)
+	{
+	k = y_pos*x_dim + x_pos;
+	nk = ((y_dim-y_pos)%y_dim)*x_dim + (x_dim-x_pos)%x_dim;
+	if (nk < k) continue;	/* pair already done */
+	ar = data[2*k];  ai = data[2*k+1];
+	br = data[2*nk];  bi = data[2*nk+1];
+	ir = 0.5*(ar+br);  ii = 0.5*(ai-bi);
+	fr = 0.5*(ai+bi);  fi = 0.5*(br-ar);
+	if (r_or_e IS REDUCE) fi = -fi;
+	pr = ir*fr - ii*fi;  pi = ir*fi + ii*fr;
+	/* store conj(P(k)) and conj(P(-k)) = P(k): the inverse transform
+	   is then a forward transform followed by conjugation. */
+	data[2*k] = pr;  data[2*k+1] = -pi;
+	data[2*nk] = pr;  data[2*nk+1] = pi;
+	}
+
+  fft_2d(data, x_dim, y_dim, x_plan, y_plan, col);
+
+  scale = 1.0 / size;
+  for (k=0; k<size; k++) data[2*k] *= scale;
+
+  fft_plan_destroy(x_plan);  fft_plan_destroy(y_plan);  free(col);
+  return(0);
+  }
+
+/* Index range [*lo, *hi) of lattice points START+i*STEP that fall in
+   the CENTER section [CTR_START, CTR_STOP) of the direct code.  START
+   and CTR_* are in filter-corner coordinates. */
+static void center_range(int start, int step, int n, int ctr_start, int ctr_stop,
+			 int *lo, int *hi)
+  {
+  int i;
+  for (i=0; (i<n) AND (start+i*step < ctr_start); i++) ;
+  *lo = i;
+  for (; (i<n) AND (start+i*step < ctr_stop); i++) ;
+  *hi = i;
+  }
+
+/*
+  --------------------------------------------------------------------
+  Same arguments and result as internal_reduce (for EDGES = "circular",
+  as internal_wrap_reduce).  TEMP must hold x_fdim*y_fdim values.
+ ------------------------------------------------------------------------ */
+static int fft_reduce(image_type *image, int x_dim, int y_dim,
+		      image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+		      int x_start, int x_step, int x_stop,
+		      int y_start, int y_step, int y_stop,
+		      image_type *result, char *edges)
+  {
+  double *data;
+  image_type *block;
+  int x_res_dim = (x_stop-x_start+x_step-1)/x_step;
+  int y_res_dim = (y_stop-y_start+y_step-1)/y_step;
+  int x_fmid = x_fdim/2, y_fmid = y_fdim/2;
+  int circular = (strcmp(edges,"circular") IS 0);
+  int x_lo, x_hi, y_lo, y_hi, x_pos, y_pos, x_ind, y_ind;
+  int bx[3], by[3], nx[3], ny[3], bi, bj, i;
+  int size = x_dim*y_dim;
+
+  if ((!circular) AND (!edge_function(edges))) return(-1);
+
+  if (circular)
+      {
+      x_lo = 0;  x_hi = x_res_dim;
+      y_lo = 0;  y_hi = y_res_dim;
+      }
+  else
+      {				/* same sections as internal_reduce */
+      int x_ctr_stop = x_dim - ((x_fdim==1)?0:x_fdim);
+      int y_ctr_stop = y_dim - ((y_fdim==1)?0:y_fdim);
+      if (x_stop-x_fmid < x_ctr_stop) x_ctr_stop = x_stop-x_fmid;
+      if (y_stop-y_fmid < y_ctr_stop) y_ctr_stop = y_stop-y_fmid;
+      center_range(x_start-x_fmid, x_step, x_res_dim, (x_fdim==1)?0:1, x_ctr_stop,
+		   &x_lo, &x_hi);
+      center_range(y_start-y_fmid, y_step, y_res_dim, (y_fdim==1)?0:1, y_ctr_stop,
+		   &y_lo, &y_hi);
+      if ((x_lo >= x_hi) OR (y_lo >= y_hi))
+	return(internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
+			       x_start, x_step, x_stop, y_start, y_step, y_stop,
+			       result, edges));
+      }
+
+  data = (double *) calloc(2*size, sizeof(double));
+  if (data IS NULL)
+      {
+      printf("FFTCONV: Failed to allocate temp array!");
+      return(-1);
+      }
+  for (i=0; i<size; i++) data[2*i] = image[i];
+  for (y_pos=0; y_pos<y_fdim; y_pos++)
+    for (x_pos=0; x_pos<x_fdim; x_pos++)
+      data[2*(y_pos*x_dim+x_pos)+1] = filt[y_pos*x_fdim+x_pos];
+
+  if (fft_filter_packed(data, x_dim, y_dim, REDUCE) ISNT 0)
+      {
+      free(data);
+      return(-1);
+      }
+
+  /* correlation sample p is the filter corner at p (wrapping if circular) */
+  for (y_ind=y_lo; y_ind<y_hi; y_ind++)
+      {
+      y_pos = y_start - y_fmid + y_ind*y_step;
+      if (circular) y_pos = ((y_pos%y_dim)+y_dim)%y_dim;
+      for (x_ind=x_lo; x_ind<x_hi; x_ind++)
+	  {
+	  x_pos = x_start - x_fmid + x_ind*x_step;
+	  if (circular) x_pos = ((x_pos%x_dim)+x_dim)%x_dim;
+	  result[y_ind*x_res_dim+x_ind] = data[2*(y_pos*x_dim+x_pos)];
+	  }
+      }
+  free(data);
+  if (circular) return(0);
+
+  /* Border blocks of the result lattice go through the direct code. */
+  block = (image_type *) malloc(x_res_dim*y_res_dim*sizeof(image_type));
+  if (block IS NULL)
+      {
+      printf("FFTCONV: Failed to allocate temp array!");
+      return(-1);
+      }
+  bx[0] = 0;     nx[0] = x_lo;   by[0] = 0;     ny[0] = y_lo;
+  bx[1] = x_lo;  nx[1] = x_hi-x_lo;  by[1] = y_lo;  ny[1] = y_hi-y_lo;
+  bx[2] = x_hi;  nx[2] = x_res_dim-x_hi;  by[2] = y_hi;  ny[2] = y_res_dim-y_hi;
+  for (bj=0; bj<3; bj++)
+    for (bi=0; bi<3; bi++)
+	{
+	if (((bi IS 1) AND (bj IS 1)) OR (nx[bi] IS 0) OR (ny[bj] IS 0)) continue;
+	internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
+			x_start+bx[bi]*x_step, x_step,
+			x_start+(bx[bi]+nx[bi]-1)*x_step+1,
+			y_start+by[bj]*y_step, y_step,
+			y_start+(by[bj]+ny[bj]-1)*y_step+1,
+			block, edges);
+	for (y_ind=0; y_ind<ny[bj]; y_ind++)
+	  for (x_ind=0; x_ind<nx[bi]; x_ind++)
+	    result[(by[bj]+y_ind)*x_res_dim + bx[bi]+x_ind] = block[y_ind*nx[bi]+x_ind];
+	}
+  free(block);
+  return(0);
+  }
+
+/* internal_fft_reduce is fft_reduce, timed with -DMETRIX_TRACE (its
+   error returns are scattered through it). */
+int internal_fft_reduce(image_type *image, int x_dim, int y_dim,
+			image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+			int x_start, int x_step, int x_stop,
+			int y_start, int y_step, int y_stop,
+			image_type *result, char *edges)
+  {
+#ifdef METRIX_TRACE
+  long long const trace_start = metrix_trace_begin();
+  int const status = fft_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
+				x_start, x_step, x_stop, y_start, y_step, y_stop,
+				result, edges);
+  metrix_trace_end("conv/" METRIX_TRACE_NAME(internal_fft_reduce), trace_start);
+  return(status);
+#else
+  return(fft_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
+		    x_start, x_step, x_stop, y_start, y_step, y_stop,
+		    result, edges));
+#endif
+  }
+
+/*
+  --------------------------------------------------------------------
+  Same arguments and result as internal_expand (for EDGES = "circular",
+  as internal_wrap_expand).  Values are ADDED into RESULT.
+ ------------------------------------------------------------------------ */
+static int fft_expand(image_type *image,
+		      image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+		      int x_start, int x_step, int x_stop,
+		      int y_start, int y_step, int y_stop,
+		      image_type *result, int x_dim, int y_dim, char *edges)
+  {
+  double *data;
+  image_type *block;
+  int x_im_dim = (x_stop-x_start+x_step-1)/x_step;
+  int y_im_dim = (y_stop-y_start+y_step-1)/y_step;
+  int x_fmid = x_fdim/2, y_fmid = y_fdim/2;
+  int circular = (strcmp(edges,"circular") IS 0);
+  int x_lo, x_hi, y_lo, y_hi, x_pos, y_pos, x_ind, y_ind;
+  int bx[3], by[3], nx[3], ny[3], bi, bj, i;
+  int size = x_dim*y_dim;
+
+  if ((!circular) AND (!edge_function(edges))) return(-1);
+
+  if (circular)
+      {
+      x_lo = 0;  x_hi = x_im_dim;
+      y_lo = 0;  y_hi = y_im_dim;
+      }
+  else
+      {				/* same sections as internal_expand */
+      int x_ctr_stop = x_dim - ((x_fdim==1)?0:x_fdim);
+      int y_ctr_stop = y_dim - ((y_fdim==1)?0:y_fdim);
+      if (x_stop-x_fmid < x_ctr_stop) x_ctr_stop = x_stop-x_fmid;
+      if (y_stop-y_fmid < y_ctr_stop) y_ctr_stop = y_stop-y_fmid;
+      center_range(x_start-x_fmid, x_step, x_im_dim, (x_fdim==1)?0:1, x_ctr_stop,
+		   &x_lo, &x_hi);
+      center_range(y_start-y_fmid, y_step, y_im_dim, (y_fdim==1)?0:1, y_ctr_stop,
+		   &y_lo, &y_hi);
+      if ((x_lo >= x_hi) OR (y_lo >= y_hi))
+	return(internal_expand(image, filt, temp, x_fdim, y_fdim,
+			       x_start, x_step, x_stop, y_start, y_step, y_stop,
+			       result, x_dim, y_dim, edges));
+      }
+
+  data = (double *) calloc(2*size, sizeof(double));
+  if (data IS NULL)
+      {
+      printf("FFTCONV: Failed to allocate temp array!");
+      return(-1);
+      }
+  /* upsample: each input sample lands on the filter corner position */
+  for (y_ind=y_lo; y_ind<y_hi; y_ind++)
+      {
+      y_pos = y_start - y_fmid + y_ind*y_step;
+      if (circular) y_pos = ((y_pos%y_dim)+y_dim)%y_dim;
+      for (x_ind=x_lo; x_ind<x_hi; x_ind++)
+	  {
+	  x_pos = x_start - x_fmid + x_ind*x_step;
+	  if (circular) x_pos = ((x_pos%x_dim)+x_dim)%x_dim;
+	  data[2*(y_pos*x_dim+x_pos)] = image[y_ind*x_im_dim+x_ind];
+	  }
+      }
+  for (y_pos=0; y_pos<y_fdim; y_pos++)
+    for (x_pos=0; x_pos<x_fdim; x_pos++)
+      data[2*(y_pos*x_dim+x_pos)+1] = filt[y_pos*x_fdim+x_pos];
+
+  if (fft_filter_packed(data, x_dim, y_dim, EXPAND) ISNT 0)
+      {
+      free(data);
+      return(-1);
+      }
+  for (i=0; i<size; i++) result[i] += data[2*i];
+  free(data);
+  if (circular) return(0);
+
+  /* Border samples of the input lattice go through the direct code. */
+  block = (image_type *) malloc(x_im_dim*y_im_dim*sizeof(image_type));
+  if (block IS NULL)
+      {
+      printf("FFTCONV: Failed to allocate temp array!");
+      return(-1);
+      }
+  bx[0] = 0;     nx[0] = x_lo;   by[0] = 0;     ny[0] = y_lo;
+  bx[1] = x_lo;  nx[1] = x_hi-x_lo;  by[1] = y_lo;  ny[1] = y_hi-y_lo;
+  bx[2] = x_hi;  nx[2] = x_im_dim-x_hi;  by[2] = y_hi;  ny[2] = y_im_dim-y_hi;
+  for (bj=0; bj<3; bj++)
+    for (bi=0; bi<3; bi++)
+	{
+	if (((bi IS 1) AND (bj IS 1)) OR (nx[bi] IS 0) OR (ny[bj] IS 0)) continue;
+	for (y_ind=0; y_ind<ny[bj]; y_ind++)
+	  for (x_ind=0; x_ind<nx[bi]; x_ind++)
+	    block[y_ind*nx[bi]+x_ind] = image[(by[bj]+y_ind)*x_im_dim + bx[bi]+x_ind];
+	internal_expand(block, filt, temp, x_fdim, y_fdim,
+			x_start+bx[bi]*x_step, x_step,
+			x_start+(bx[bi]+nx[bi]-1)*x_step+1,
+			y_start+by[bj]*y_step, y_step,
+			y_start+(by[bj]+ny[bj]-1)*y_step+1,
+			result, x_dim, y_dim, edges);
+	}
+  free(block);
+  return(0);
+  }
+
+/* internal_fft_expand is fft_expand, timed with -DMETRIX_TRACE. */
+int internal_fft_expand(image_type *image,
+			image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+			int x_start, int x_step, int x_stop,
+			int y_start, int y_step, int y_stop,
+			image_type *result, int x_dim, int y_dim, char *edges)
+  {
+#ifdef METRIX_TRACE
+  long long const trace_start = metrix_trace_begin();
+  int const status = fft_expand(image, filt, temp, x_fdim, y_fdim,
+				x_start, x_step, x_stop, y_start, y_step, y_stop,
+				result, x_dim, y_dim, edges);
+  metrix_trace_end("conv/" METRIX_TRACE_NAME(internal_fft_expand), trace_start);
+  return(status);
+#else
+  return(fft_expand(image, filt, temp, x_fdim, y_fdim,
+		    x_start, x_step, x_stop, y_start, y_step, y_stop,
+		    result, x_dim, y_dim, edges));
+#endif
+  }
+
+
+/* Local Variables: */
+/* buffer-read-only: t */
+/* End: */
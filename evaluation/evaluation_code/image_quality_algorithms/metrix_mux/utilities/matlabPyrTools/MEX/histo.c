@@ -1,7 +1,11 @@
-/* 
+/*
 [N, X] = histo(MTX, NBINS_OR_BINSIZE, BIN_CENTER)
   >>> See histo.m for documentation <<<
   EPS, ported from OBVIUS, 3/97.
+  Rewritten 10/26: single, uint8 and uint16 MTX are binned without
+  conversion to double; a cell array MTX gives cell arrays N and X;
+  compiled with OpenMP (see the Makefiles), large matrices are split
+  across threads, each with a private histogram.
 */
 
 #define V4_COMPAT
@@ -10,75 +14,196 @@
 
 #include <stddef.h>  /* NULL */
 #include <math.h>  /* ceil */
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notHistoMtx(it) (!mxIsNumeric(it) || mxIsSparse(it) || mxIsComplex(it) || \
+			 !(mxIsDouble(it) || mxIsSingle(it) || mxIsUint8(it) || mxIsUint16(it)))
 
 #define PAD 0.49999 /* A hair below 1/2, to avoid roundoff errors */
 #define MAXBINS 20000
+#define PAR_MIN_SIZE 65536  /* smaller matrices are done by one thread */
 
-void mexFunction(int nlhs,	     /* Num return vals on lhs */
-		 mxArray *plhs[],    /* Matrices on lhs      */
-		 int nrhs,	     /* Num args on rhs    */
-		 const mxArray *prhs[]     /* Matrices on rhs */
-		 )
+/* Number of threads to use for SIZE elements. */
+static int num_threads(int size)
   {
-  register double temp;
-  register int binnum, i, size;
-  register double *im, binsize;
-  register double origin, *hist, mn, mx, mean;
-  register int nbins;
-  double *bincenters; 
-  mxArray *arg;
-  double *mxMat;
+#ifdef _OPENMP
+  if (size >= PAR_MIN_SIZE) return(omp_get_max_threads());
+#endif
+  return(1);
+  }
 
-  if (nrhs < 1 ) mexErrMsgTxt("requires at least 1 argument.");
+/* OMP(directive) is an OpenMP pragma, dropped when not compiling with
+   OpenMP.  OMP_ROW points H at this thread's row of a per-thread array. */
+#ifdef _OPENMP
+#define OMP(x) _Pragma(#x)
+#define OMP_ROW(h, n) ((h) += omp_get_thread_num()*(n))
+#else
+#define OMP(x)
+#define OMP_ROW(h, n) ((void) 0)
+#endif
 
-  /* ARG 1: MATRIX  */
-  arg = prhs[0];
-  if notDblMtx(arg) mexErrMsgTxt("MTX arg must be a real non-sparse matrix.");
-  im = mxGetPr(arg);
+/*
+  Min, max and sum of the SIZE (>0) values of a double or single
+  matrix.  Min and max are found independently (no else-if), so
+  the loop vectorizes.
+*/
+#define RANGE_FUNC(NAME, TYPE) \
+static void NAME(TYPE *im, int size, double *mn_p, double *mx_p, double *sum_p) \
+  { \
+  double mn = im[0], mx = im[0], sum = 0.0; \
+  int i; \
+  OMP(omp parallel for if(size >= PAR_MIN_SIZE) reduction(min:mn) reduction(max:mx) reduction(+:sum)) \
+  for (i=0; i<size; i++) \
+      { \
+      double v = im[i]; \
+      mn = (v < mn) ? v : mn; \
+      mx = (v > mx) ? v : mx; \
+      sum += v; \
+      } \
+  *mn_p = mn;  *mx_p = mx;  *sum_p = sum; \
+  }
+
+/*
+  Add the counts of the SIZE values of a double or single matrix
+  to HIST (NBINS bins of BINSIZE, the first centered at ORIGIN).
+  Each thread counts into its own row of PRIV (NTHR*NBINS, zeroed).
+  Returns the number of values falling outside the bins.
+*/
+#define BIN_FUNC(NAME, TYPE) \
+static int NAME(TYPE *im, int size, double origin, double binsize, int nbins, \
+		double *hist, unsigned int *priv, int nthr) \
+  { \
+  int i, t, outside = 0; \
+  OMP(omp parallel num_threads(nthr) if(nthr > 1) reduction(+:outside)) \
+      { \
+      unsigned int *h = priv; \
+      int j, binnum; \
+      OMP_ROW(h, nbins); \
+      OMP(omp for) \
+      for (j=0; j<size; j++) \
+	  { \
+	  binnum = (int) ((im[j] - origin)/binsize + 0.5); \
+	  if ((binnum < nbins) && (binnum >= 0)) h[binnum]++; \
+	  else outside++; \
+	  } \
+      } \
+  for (t=0; t<nthr; t++) \
+    for (i=0; i<nbins; i++) \
+      hist[i] += (double) priv[t*nbins+i]; \
+  return(outside); \
+  }
+
+RANGE_FUNC(range_double, double)
+RANGE_FUNC(range_single, float)
+BIN_FUNC(bin_double, double)
+BIN_FUNC(bin_single, float)
+
+/*
+  Integer matrices are counted by value first (a table of 256 or
+  65536 entries), so they need a single pass: range, mean and the
+  histogram all come from the table.
+*/
+#define COUNT_FUNC(NAME, TYPE) \
+static void NAME(TYPE *im, int size, double *table, int nvals, \
+		 unsigned int *priv, int nthr) \
+  { \
+  int i, t; \
+  OMP(omp parallel num_threads(nthr) if(nthr > 1)) \
+      { \
+      unsigned int *h = priv; \
+      int j; \
+      OMP_ROW(h, nvals); \
+      OMP(omp for) \
+      for (j=0; j<size; j++) h[im[j]]++; \
+      } \
+  for (t=0; t<nthr; t++) \
+    for (i=0; i<nvals; i++) \
+      table[i] += (double) priv[t*nvals+i]; \
+  }
+
+COUNT_FUNC(count_uint8, unsigned char)
+COUNT_FUNC(count_uint16, unsigned short)
+
+static void range_table(double *table, int nvals, double *mn, double *mx, double *sum)
+  {
+  int i;
+
+  for (i=0; (i<nvals-1) && (table[i] == 0.0); i++);
+  *mn = i;
+  for (i=nvals-1; (i>0) && (table[i] == 0.0); i--);
+  *mx = i;
+  for (*sum=0.0, i=0; i<nvals; i++) *sum += i*table[i];
+  }
+
+static int bin_table(double *table, int nvals, double origin, double binsize,
+		     int nbins, double *hist)
+  {
+  int i, binnum, outside = 0;
+
+  for (i=0; i<nvals; i++)
+    if (table[i] != 0.0)
+      {
+      binnum = (int) ((i - origin)/binsize + 0.5);
+      if ((binnum < nbins) && (binnum >= 0)) hist[binnum] += table[i];
+      else outside += (int) table[i];
+      }
+  return(outside);
+  }
+
+/*
+  Histogram of the matrix ARG.  BINARG is NBINS_OR_BINSIZE (or
+  NULL), CTRARG is BIN_CENTER (or NULL).  Sets *N_OUT, and *X_OUT if
+  X_OUT is non-NULL.
+*/
+static void histo_mtx(const mxArray *arg, const mxArray *binarg, const mxArray *ctrarg,
+		      mxArray **n_out, mxArray **x_out)
+  {
+  double temp, binsize, origin, mn, mx, sum, mean;
+  double *hist, *bincenters, *table = NULL;
+  unsigned int *priv;
+  int i, size, nbins, nvals = 0, nthr, outside;
+  void *im;
+
+  if notHistoMtx(arg)
+    mexErrMsgTxt("MTX arg must be a real non-sparse double, single, uint8 or uint16 matrix.");
+  im = mxGetData(arg);
   size = (int) mxGetM(arg) * mxGetN(arg);
+  if (size < 1) mexErrMsgTxt("MTX must not be empty.");
+  nthr = num_threads(size);
 
   /* FIND min, max, mean values of MTX */
-  mn = *im;   mx = *im;  binsize = 0;
-  for (i=1; i<size; i++)
-    {
-      temp = im[i];
-      if (temp < mn)
-	mn = temp;
-      else if (temp > mx)
-	mx = temp;
-      binsize += temp;
-    }
-  mean = binsize / size;
+  if (mxIsUint8(arg) || mxIsUint16(arg))
+      {
+      nvals = mxIsUint8(arg) ? 256 : 65536;
+      table = mxCalloc(nvals, sizeof(double));
+      priv = mxCalloc(nthr*nvals, sizeof(unsigned int));
+      if (mxIsUint8(arg))
+	count_uint8((unsigned char *) im, size, table, nvals, priv, nthr);
+      else
+	count_uint16((unsigned short *) im, size, table, nvals, priv, nthr);
+      mxFree((char *) priv);
+      range_table(table, nvals, &mn, &mx, &sum);
+      }
+  else if (mxIsSingle(arg))
+    range_single((float *) im, size, &mn, &mx, &sum);
+  else
+    range_double((double *) im, size, &mn, &mx, &sum);
+  mean = sum / size;
 
   /* ARG 3: BIN_CENTER */
-  if (nrhs > 2)
-    {
-    arg = prhs[2];
-    if notDblMtx(arg) mexErrMsgTxt("BIN_CENTER arg must be a real scalar.");
-    if (mxGetM(arg) * mxGetN(arg) != 1)
-      mexErrMsgTxt("BIN_CENTER must be a real scalar.");
-    mxMat= mxGetPr(arg);
-    origin = *mxMat;
-    }
+  if (ctrarg != NULL)
+    origin = mxGetPr(ctrarg)[0];
   else
     origin = mean;
 
   /* ARG 2: If positive, NBINS.  If negative, -BINSIZE. */
-  if (nrhs > 1)
-    {
-    arg = prhs[1];
-    if notDblMtx(arg) mexErrMsgTxt("NBINS_OR_BINSIZE arg must be a real scalar.");
-    if (mxGetM(arg) * mxGetN(arg) != 1)
-      mexErrMsgTxt("NBINS_OR_BINSIZE must be a real scalar.");
-    mxMat= mxGetPr(arg);
-    binsize = *mxMat;
-    }
+  if (binarg != NULL)
+    binsize = mxGetPr(binarg)[0];
   else
-    {
     binsize = 101;  /* DEFAULT: 101 bins */
-    }
 
   /* --------------------------------------------------
      Adjust origin, binsize, nbins such that
@@ -112,29 +237,91 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
       }
 
   /* Allocate hist  and xvals */
-  plhs[0] = (mxArray *) mxCreateDoubleMatrix(1,nbins,mxREAL);
-  if (plhs[0] == NULL) mexErrMsgTxt("Error allocating result matrix");
-  hist = mxGetPr(plhs[0]);
+  *n_out = (mxArray *) mxCreateDoubleMatrix(1,nbins,mxREAL);
+  if (*n_out == NULL) mexErrMsgTxt("Error allocating result matrix");
+  hist = mxGetPr(*n_out);
 
-  if (nlhs > 1)
+  if (x_out != NULL)
       {
-      plhs[1] = (mxArray *) mxCreateDoubleMatrix(1,nbins,mxREAL);
-      if (plhs[1] == NULL) mexErrMsgTxt("Error allocating result matrix");
-      bincenters = mxGetPr(plhs[1]);
+      *x_out = (mxArray *) mxCreateDoubleMatrix(1,nbins,mxREAL);
+      if (*x_out == NULL) mexErrMsgTxt("Error allocating result matrix");
+      bincenters = mxGetPr(*x_out);
       for (i=0, temp=origin; i<nbins; i++, temp+=binsize)
 	bincenters[i] = temp;
       }
 
-  for (i=0; i<size; i++)
+  if (table != NULL)
+      {
+      outside = bin_table(table, nvals, origin, binsize, nbins, hist);
+      mxFree((char *) table);
+      }
+  else
       {
-      binnum = (int) ((im[i] - origin)/binsize + 0.5);
-      if ((binnum < nbins) && (binnum >= 0))
-	(hist[binnum]) += 1.0;
+      priv = mxCalloc(nthr*nbins, sizeof(unsigned int));
+      if (mxIsSingle(arg))
+	outside = bin_single((float *) im, size, origin, binsize, nbins, hist, priv, nthr);
       else
-	printf("HISTO warning: value %f outside of range [%f,%f]\n",
-	       im[i], origin-0.5*binsize, origin+(nbins-0.5)*binsize);
+	outside = bin_double((double *) im, size, origin, binsize, nbins, hist, priv, nthr);
+      mxFree((char *) priv);
       }
 
-  return;
-  }      
+  if (outside > 0)
+    mexPrintf("HISTO warning: %d values outside of range [%f,%f]\n",
+	   outside, origin-0.5*binsize, origin+(nbins-0.5)*binsize);
+  }
+
+void mexFunction(int nlhs,	     /* Num return vals on lhs */
+		 mxArray *plhs[],    /* Matrices on lhs      */
+		 int nrhs,	     /* Num args on rhs    */
+		 const mxArray *prhs[]     /* Matrices on rhs */
+		 )
+  {
+  const mxArray *arg, *binarg = NULL, *ctrarg = NULL;
+  mxArray *n, *x;
+  int i, nmtx;
+
+  if (nrhs < 1 ) mexErrMsgTxt("requires at least 1 argument.");
+
+  /* ARG 3: BIN_CENTER */
+  if (nrhs > 2)
+    {
+    ctrarg = prhs[2];
+    if notDblMtx(ctrarg) mexErrMsgTxt("BIN_CENTER arg must be a real scalar.");
+    if (mxGetM(ctrarg) * mxGetN(ctrarg) != 1)
+      mexErrMsgTxt("BIN_CENTER must be a real scalar.");
+    }
+
+  /* ARG 2: NBINS_OR_BINSIZE */
+  if (nrhs > 1)
+    {
+    binarg = prhs[1];
+    if notDblMtx(binarg) mexErrMsgTxt("NBINS_OR_BINSIZE arg must be a real scalar.");
+    if (mxGetM(binarg) * mxGetN(binarg) != 1)
+      mexErrMsgTxt("NBINS_OR_BINSIZE must be a real scalar.");
+    }
+
+  /* ARG 1: MATRIX, or cell array of matrices */
+  arg = prhs[0];
+  if (!mxIsCell(arg))
+      {
+      histo_mtx(arg, binarg, ctrarg, &plhs[0], (nlhs > 1) ? &plhs[1] : NULL);
+      return;
+      }
 
+  nmtx = (int) mxGetNumberOfElements(arg);
+  plhs[0] = mxCreateCellMatrix(mxGetM(arg), mxGetN(arg));
+  if (plhs[0] == NULL) mexErrMsgTxt("Error allocating result matrix");
+  if (nlhs > 1)
+      {
+      plhs[1] = mxCreateCellMatrix(mxGetM(arg), mxGetN(arg));
+      if (plhs[1] == NULL) mexErrMsgTxt("Error allocating result matrix");
+      }
+  for (i=0; i<nmtx; i++)
+      {
+      if (mxGetCell(arg, i) == NULL) mexErrMsgTxt("MTX cells must not be empty.");
+      histo_mtx(mxGetCell(arg, i), binarg, ctrarg, &n, (nlhs > 1) ? &x : NULL);
+      mxSetCell(plhs[0], i, n);
+      if (nlhs > 1) mxSetCell(plhs[1], i, x);
+      }
+  return;
+  }
@@ -1,17 +1,119 @@
-/* 
+/*
 RES = innerProd(MAT);
-  Computes mat'*mat  
+  Computes mat'*mat
   Odelia Schwartz, 8/97.
+  10/26: blocked over rows, with several columns per pass and
+  separate accumulators so the dot products vectorize; single MAT
+  gives a single RES (accumulated in double).  Compiled with OpenMP
+  (see the Makefiles), row blocks are split across threads.
 */
 
 #define V4_COMPAT
-#include <matrix.h>  
+#include <matrix.h>
+#include <mex.h>
 
 #include <stdio.h>
-#include <ctype.h>
-#include <math.h>
-#include <strings.h>
-#include <stdlib.h>
+#include <stddef.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* OMP(directive) is an OpenMP pragma, dropped when not compiling with
+   OpenMP. */
+#ifdef _OPENMP
+#define OMP(x) _Pragma(#x)
+#else
+#define OMP(x)
+#endif
+
+#define KBLOCK 512	/* rows per block: KBLOCK*wid values stay in cache */
+#define LANES 4		/* independent partial sums per dot product */
+#define PAR_MIN_SIZE 65536  /* smaller matrices are done by one thread */
+
+/*
+  ACC[i*wid+j] += sum over rows k0..k1-1 of MAT(k,i)*MAT(k,j), for
+  j >= i (the upper triangle of MAT'*MAT, stored by rows).  Column i
+  is multiplied against four columns j at a time, so each of its
+  values is loaded once per four products, and each product keeps
+  LANES partial sums: compilers will not vectorize a single
+  floating-point sum, but do vectorize independent ones.
+*/
+#define SYRK_FUNC(NAME, TYPE) \
+static void NAME(TYPE *mat, int len, int wid, int k0, int k1, double *acc) \
+  { \
+  double s0[LANES], s1[LANES], s2[LANES], s3[LANES], x; \
+  TYPE *a, *b0, *b1, *b2, *b3; \
+  int i, j, k, l; \
+  for (i=0; i<wid; i++) \
+      { \
+      a = mat + (size_t) i*len; \
+      for (j=i; j<wid; j+=4) \
+	  { \
+	  /* past the last column, repeat it (the sums are not used) */ \
+	  b0 = mat + (size_t) j*len; \
+	  b1 = (j+1 < wid) ? b0 + len : b0; \
+	  b2 = (j+2 < wid) ? b1 + len : b1; \
+	  b3 = (j+3 < wid) ? b2 + len : b2; \
+	  for (l=0; l<LANES; l++) s0[l] = s1[l] = s2[l] = s3[l] = 0.0; \
+	  for (k=k0; k+LANES<=k1; k+=LANES) \
+	    for (l=0; l<LANES; l++) \
+		{ \
+		x = a[k+l]; \
+		s0[l] += x*b0[k+l];  s1[l] += x*b1[k+l]; \
+		s2[l] += x*b2[k+l];  s3[l] += x*b3[k+l]; \
+		} \
+	  for (; k<k1; k++) \
+	      { \
+	      x = a[k]; \
+	      s0[0] += x*b0[k];  s1[0] += x*b1[k]; \
+	      s2[0] += x*b2[k];  s3[0] += x*b3[k]; \
+	      } \
+	  for (l=1; l<LANES; l++) \
+	      { \
+	      s0[0] += s0[l];  s1[0] += s1[l]; \
+	      s2[0] += s2[l];  s3[0] += s3[l]; \
+	      } \
+	  acc[i*wid+j] += s0[0]; \
+	  if (j+1 < wid) acc[i*wid+j+1] += s1[0]; \
+	  if (j+2 < wid) acc[i*wid+j+2] += s2[0]; \
+	  if (j+3 < wid) acc[i*wid+j+3] += s3[0]; \
+	  } \
+      } \
+  }
+
+SYRK_FUNC(syrk_double, double)
+SYRK_FUNC(syrk_single, float)
+
+/*
+  Upper triangle of MAT'*MAT into RES (WID*WID, zeroed), row blocks
+  spread over NTHR threads, each with its own row of PRIV
+  (NTHR*WID*WID, zeroed).
+*/
+static void inner_prod(void *mat, int single, int len, int wid, double *res,
+		       double *priv, int nthr)
+  {
+  int nblocks = (len+KBLOCK-1)/KBLOCK;
+  int b, t, i;
+
+  OMP(omp parallel num_threads(nthr) if(nthr > 1))
+      {
+      double *acc = priv;
+#ifdef _OPENMP
+      acc += (size_t) omp_get_thread_num()*wid*wid;
+#endif
+      OMP(omp for schedule(static))
+      for (b=0; b<nblocks; b++)
+	  {
+	  int k1 = (b+1)*KBLOCK;
+	  if (k1 > len) k1 = len;
+	  if (single) syrk_single((float *) mat, len, wid, b*KBLOCK, k1, acc);
+	  else syrk_double((double *) mat, len, wid, b*KBLOCK, k1, acc);
+	  }
+      }
+  for (t=0; t<nthr; t++)
+    for (i=0; i<wid*wid; i++)
+      res[i] += priv[(size_t) t*wid*wid+i];
+  }
 
 void mexFunction(int nlhs,           /* Num return vals on lhs */
                  mxArray *plhs[],    /* Matrices on lhs      */
@@ -19,34 +121,59 @@ void mexFunction(int nlhs,           /* Num return vals on lhs */
                  const mxArray *prhs[]     /* Matrices on rhs */
                  )
 {
-   register double *res, *mat, tmp;
-   register int len, wid, i, k, j, jlen, ilen, imat, jmat;
-   mxArray *arg;
-   
+   double *res, *priv;
+   float *fres;
+   int len, wid, i, j, single, nthr = 1;
+   const mxArray *arg;
+   char msg[80];
+
+   if (nrhs != 1) mexErrMsgTxt("requires 1 argument.");
+
    /* get matrix input argument */
    /* should be matrix in which num rows >= num columns */
-   arg=prhs[0];                     
-   mat= mxGetPr(arg);
+   arg=prhs[0];
+   if (!mxIsNumeric(arg) || !(mxIsDouble(arg) || mxIsSingle(arg)) ||
+       mxIsSparse(arg) || mxIsComplex(arg))
+     mexErrMsgTxt("MAT arg must be a real non-sparse double or single matrix.");
+   single = mxIsSingle(arg);
    len = (int) mxGetM(arg);
    wid = (int) mxGetN(arg);
    if ( wid > len )
-     printf("innerProd: Warning: width %d is greater than length %d.\n",wid,len); 
-   plhs[0] = (mxArray *) mxCreateDoubleMatrix(wid,wid,mxREAL);
-   if (plhs[0] == NULL) 
-     mexErrMsgTxt(sprintf("Error allocating %dx%d result matrix",wid,wid));
-   res = mxGetPr(plhs[0]);
+     printf("innerProd: Warning: width %d is greater than length %d.\n",wid,len);
+#ifdef _OPENMP
+   if ((double) len*wid >= PAR_MIN_SIZE) nthr = omp_get_max_threads();
+#endif
+
+   res = mxCalloc((size_t) wid*wid > 0 ? (size_t) wid*wid : 1, sizeof(double));
+   priv = mxCalloc((size_t) nthr*wid*wid > 0 ? (size_t) nthr*wid*wid : 1, sizeof(double));
+   inner_prod(mxGetData(arg), single, len, wid, res, priv, nthr);
+   mxFree((char *) priv);
 
-   for(i=0, ilen=0; i<wid; i++, ilen+=len)
+   if (single)
+     plhs[0] = (mxArray *) mxCreateNumericMatrix(wid,wid,mxSINGLE_CLASS,mxREAL);
+   else
+     plhs[0] = (mxArray *) mxCreateDoubleMatrix(wid,wid,mxREAL);
+   if (plhs[0] == NULL)
+     {
+     sprintf(msg, "Error allocating %dx%d result matrix", wid, wid);
+     mexErrMsgTxt(msg);
+     }
+
+   /* fill in the lower triangle */
+   if (single)
+     {
+     fres = (float *) mxGetData(plhs[0]);
+     for (i=0; i<wid; i++)
+       for (j=i; j<wid; j++)
+	 fres[i*wid+j] = fres[j*wid+i] = (float) res[i*wid+j];
+     }
+   else
      {
-      for(j=i, jlen=ilen; j<wid; j++, jlen+=len)
-         {
-   	    tmp = 0.0;
-            for(k=0, imat=ilen, jmat=jlen; k<len; k++, imat++, jmat++)
-	      tmp += mat[imat]*mat[jmat];
-	    res[i*wid+j] = tmp;
-            res[j*wid+i] = tmp;
-         }
-   }
+     for (i=0; i<wid; i++)
+       for (j=i; j<wid; j++)
+	 mxGetPr(plhs[0])[i*wid+j] = mxGetPr(plhs[0])[j*wid+i] = res[i*wid+j];
+     }
+   mxFree((char *) res);
    return;
 
 }
@@ -1,7 +1,12 @@
-/* 
+/*
 RES = pointOp(IM, LUT, ORIGIN, INCREMENT, WARNINGS)
   >>> See pointOp.m for documentation <<<
   EPS, ported from OBVIUS, 7/96.
+  10/26: branch-free inner loop (reciprocal of INCREMENT, clamped
+  table index, precomputed slopes) that compilers can vectorize;
+  single IM gives a single RES; a cell array IM gives a cell array
+  RES, all through the same LUT.  Compiled with OpenMP (see the
+  Makefiles), large images are split across threads.
 */
 
 #define V4_COMPAT
@@ -11,8 +16,83 @@ RES = pointOp(IM, LUT, ORIGIN, INCREMENT, WARNINGS)
 #include <stddef.h>  /* NULL */
 
 #define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notFltMtx(it) (!mxIsNumeric(it) || !(mxIsDouble(it) || mxIsSingle(it)) || mxIsSparse(it) || mxIsComplex(it))
 
-void internal_pointop();
+#define PAR_MIN_SIZE 65536  /* smaller images are done by one thread */
+
+/* OMP(directive) is an OpenMP pragma, dropped when not compiling with
+   OpenMP. */
+#ifdef _OPENMP
+#define OMP(x) _Pragma(#x)
+#else
+#define OMP(x)
+#endif
+
+#define LEFT_EXTRAP  1
+#define RIGHT_EXTRAP 2
+
+/*
+  Linear interpolation in a lookup table, as in OBVIUS (EPS, Spring,
+  1987): the table index is pos = (im-origin)/increment truncated
+  toward zero, clamped to [0, LUTSIZE-2], and the result is the line
+  through that entry and the next, evaluated at pos.  Here the divide
+  is a multiply by INV_INC and the clamps are selects, and SLOPE
+  holds lut[i+1]-lut[i], so the loop has no branches.  Returns
+  LEFT_EXTRAP and/or RIGHT_EXTRAP if the table was extrapolated.
+*/
+#define POINTOP_FUNC(NAME, TYPE) \
+static int NAME(TYPE *im, TYPE *res, int size, double *lut, double *slope, \
+		int lutsize, double origin, double inv_inc) \
+  { \
+  int i, left = 0, right = 0, max_index = lutsize - 2; \
+  OMP(omp parallel for if(size >= PAR_MIN_SIZE) reduction(|:left) reduction(|:right)) \
+  for (i=0; i<size; i++) \
+      { \
+      double pos = (im[i] - origin) * inv_inc; \
+      int index = (int) pos;   /* toward zero */ \
+      left |= (index < 0); \
+      right |= (index > max_index); \
+      index = (index < 0) ? 0 : index; \
+      index = (index > max_index) ? max_index : index; \
+      res[i] = (TYPE) (lut[index] + slope[index] * (pos - index)); \
+      } \
+  return((left ? LEFT_EXTRAP : 0) | (right ? RIGHT_EXTRAP : 0)); \
+  }
+
+POINTOP_FUNC(pointop_double, double)
+POINTOP_FUNC(pointop_single, float)
+
+/* Apply the table to the image ARG, returning the result. */
+static mxArray *internal_pointop(const mxArray *arg, double *lut, double *slope, int lutsize,
+				 double origin, double increment, int *extrap)
+  {
+  mxArray *out;
+  int i, size;
+
+  if notFltMtx(arg) mexErrMsgTxt("IMAGE arg must be a real non-sparse double or single matrix.");
+  size = (int) (mxGetM(arg) * mxGetN(arg));
+
+  if (mxIsSingle(arg))
+    out = mxCreateNumericMatrix(mxGetM(arg),mxGetN(arg),mxSINGLE_CLASS,mxREAL);
+  else
+    out = mxCreateDoubleMatrix(mxGetM(arg),mxGetN(arg),mxREAL);
+  if (out == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+
+  if (increment <= 0)
+      {
+      if (mxIsSingle(arg))
+	for (i=0; i<size; i++) ((float *) mxGetData(out))[i] = (float) *lut;
+      else
+	for (i=0; i<size; i++) mxGetPr(out)[i] = *lut;
+      }
+  else if (mxIsSingle(arg))
+    *extrap |= pointop_single((float *) mxGetData(arg), (float *) mxGetData(out), size,
+			      lut, slope, lutsize, origin, 1.0/increment);
+  else
+    *extrap |= pointop_double(mxGetPr(arg), mxGetPr(out), size,
+			      lut, slope, lutsize, origin, 1.0/increment);
+  return(out);
+  }
 
 void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 mxArray *plhs[],    /* Matrices on lhs      */
@@ -20,22 +100,15 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 const mxArray *prhs[]     /* Matrices on rhs */
 		 )
   {
-  double *image, *lut, *res;
+  double *lut, *slope;
   double origin, increment;
-  int x_dim, y_dim, lx_dim, ly_dim;
-  int warnings = 1;
-  mxArray *arg;
+  int i, lx_dim, ly_dim, lutsize, nims;
+  int warnings = 1, extrap = 0;
+  const mxArray *arg;
   double *mxMat;
 
   if (nrhs < 4 ) mexErrMsgTxt("requres  at least 4 args.");
 
-  /* ARG 1: IMAGE  */
-  arg = prhs[0];
-  if notDblMtx(arg) mexErrMsgTxt("IMAGE arg must be a real non-sparse matrix.");
-  image = mxGetPr(arg);
-  x_dim = (int) mxGetM(arg); /* X is inner index! */
-  y_dim = (int) mxGetN(arg);
-
   /* ARG 2: Lookup table */
   arg = prhs[1];
   if notDblMtx(arg) mexErrMsgTxt("LUT arg must be a real non-sparse matrix.");
@@ -44,6 +117,8 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
   ly_dim = (int) mxGetN(arg);
   if ( (lx_dim != 1) && (ly_dim != 1) )
     mexErrMsgTxt("Lookup table must be a row or column vector.");
+  lutsize = lx_dim*ly_dim;
+  if (lutsize < 2) mexErrMsgTxt("Lookup table must have at least 2 entries.");
 
   /* ARG 3: ORIGIN */
   arg = prhs[2];
@@ -72,55 +147,30 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
     warnings = (int) *mxMat;
     }
 
-  plhs[0] = (mxArray *)  mxCreateDoubleMatrix(x_dim,y_dim,mxREAL);
-  if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
-  res = mxGetPr(plhs[0]);
-      
-  internal_pointop(image, res, x_dim*y_dim, lut, lx_dim*ly_dim, 
-		   origin, increment, warnings);
-  return;
-  }      
+  slope = mxCalloc(lutsize-1, sizeof(double));
+  for (i=0; i<lutsize-1; i++) slope[i] = lut[i+1] - lut[i];
 
-
-/* Use linear interpolation on a lookup table.
-   Taken from OBVIUS.  EPS, Spring, 1987.
- */
-void internal_pointop (im, res, size, lut, lutsize, origin, increment, warnings)
-  register double *im, *res, *lut;
-  register double origin, increment; 
-  register int size, lutsize, warnings;
-  {
-  register int i, index;
-  register double pos;
-  register int l_unwarned = warnings;
-  register int r_unwarned = warnings;
-
-  lutsize = lutsize - 2;	/* Maximum index value */
-  if (increment > 0)
-    for (i=0; i<size; i++)
-	{
-	pos = (im[i] - origin) / increment;
-	index = (int) pos;   /* Floor */
-	if (index < 0)
-	    {
-	    index = 0;
-	    if (l_unwarned)
-		{
-		mexPrintf("Warning: Extrapolating to left of lookup table...\n");
-		l_unwarned = 0;
-		}
-	    }
-	else if (index > lutsize)
-	    {
-	    index = lutsize;
-	    if (r_unwarned)
-		{
-		mexPrintf("Warning: Extrapolating to right of lookup table...\n");
-		r_unwarned = 0;
-		}
-	    }
-	res[i] = lut[index] + (lut[index+1] - lut[index]) * (pos - index);
-	}
+  /* ARG 1: IMAGE, or cell array of images */
+  arg = prhs[0];
+  if (mxIsCell(arg))
+      {
+      nims = (int) mxGetNumberOfElements(arg);
+      plhs[0] = mxCreateCellMatrix(mxGetM(arg), mxGetN(arg));
+      if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+      for (i=0; i<nims; i++)
+	  {
+	  if (mxGetCell(arg, i) == NULL) mexErrMsgTxt("IMAGE cells must not be empty.");
+	  mxSetCell(plhs[0], i, internal_pointop(mxGetCell(arg, i), lut, slope, lutsize,
+						 origin, increment, &extrap));
+	  }
+      }
   else
-    for (i=0; i<size; i++) res[i] = *lut;
+    plhs[0] = internal_pointop(arg, lut, slope, lutsize, origin, increment, &extrap);
+  mxFree((char *) slope);
+
+  if (warnings && (extrap & LEFT_EXTRAP))
+    mexPrintf("Warning: Extrapolating to left of lookup table...\n");
+  if (warnings && (extrap & RIGHT_EXTRAP))
+    mexPrintf("Warning: Extrapolating to right of lookup table...\n");
+  return;
   }
@@ -0,0 +1,840 @@
+/*
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;;;  File: pyramid.c
+;;;  Description: Whole-pyramid construction (Laplacian, steerable and
+;;;               separable wavelet) into a single pre-sized vector,
+;;;               and the corresponding reconstruction.
+;;;  ----------------------------------------------------------------
+;;;    Object-Based Vision and Image Understanding System (OBVIUS),
+;;;      Copyright 1988, Vision Science Group,  Media Laboratory,
+;;;              Massachusetts Institute of Technology.
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+*/
+
+/* The build_*pyr routines perform exactly the sequence of corrDn and
+upConv operations done by buildLpyr.m, buildSpyr.m and buildWpyr.m,
+but write every band straight into its slot of the output vector PYR
+(same layout as the M-files return), and fill PIND with the band
+sizes.  All intermediate images live in ONE scratch allocation sized
+from the first level, reused (ping-pong) by the coarser levels.  The
+caller sizes PYR and PIND (2 ints per band) with the *_bands routines:
+
+    nbands = lpyr_bands(x_dim, y_dim, ht, pind);
+    total  = sum over b of pind[2b]*pind[2b+1];
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "pyramid.h"
+
+#define SELECTED(flags,i) (((flags) IS NULL) OR (flags)[i])
+
+/*
+  --------------------------------------------------------------------
+  Same arguments and result as internal_reduce.  Dispatches to the FFT,
+  circular or direct code exactly as the corrDn MEX function does, and
+  returns -1 (computing nothing) if the filter is larger than the image.
+  --------------------------------------------------------------------
+*/
+int internal_corrdn(image_type *image, int x_dim, int y_dim,
+		    image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+		    int x_start, int x_step, int x_stop,
+		    int y_start, int y_step, int y_stop,
+		    image_type *result, char *edges)
+  {
+  if ((x_fdim > x_dim) OR (y_fdim > y_dim))
+      {
+      printf("PYRAMID: FILTER dimensions [%d %d] larger than IMAGE dimensions [%d %d].\n",
+	     x_fdim, y_fdim, x_dim, y_dim);
+      return(-1);
+      }
+  if (USE_FFT_CONV(x_fdim, y_fdim, x_step, y_step))
+    return(internal_fft_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
+			       x_start, x_step, x_stop, y_start, y_step, y_stop,
+			       result, edges));
+  else if (strcmp(edges,"circular") IS 0)
+    return(internal_wrap_reduce(image, x_dim, y_dim, filt, x_fdim, y_fdim,
+				x_start, x_step, x_stop, y_start, y_step, y_stop,
+				result));
+  else
+    return(internal_reduce(image, x_dim, y_dim, filt, temp, x_fdim, y_fdim,
+			   x_start, x_step, x_stop, y_start, y_step, y_stop,
+			   result, edges));
+  }
+
+/*
+  --------------------------------------------------------------------
+  Same arguments and result as internal_expand: the upsampled and
+  filtered image is ADDED into RESULT (result += upConv(image)), which
+  is the supported way of accumulating several bands into one buffer.
+  RESULT must not overlap IMAGE.  Includes the upConv work-around for
+  even-length filters with reflect1/extend/repeat edges: the filter is
+  embedded in one with odd dimensions, so TEMP must hold
+  (x_fdim+1)*(y_fdim+1) values.  Returns -1 if the filter is larger
+  than the result.  This is the code behind the upConv MEX function.
+  --------------------------------------------------------------------
+*/
+int internal_upconv(image_type *image,
+		    image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+		    int x_start, int x_step, int x_stop,
+		    int y_start, int y_step, int y_stop,
+		    image_type *result, int x_rdim, int y_rdim, char *edges)
+  {
+  image_type *odd_filt = NULL;
+  int x, y, orig_x, orig_y, status;
+
+  if (((strcmp(edges,"reflect1") IS 0) OR (strcmp(edges,"extend") IS 0) OR
+       (strcmp(edges,"repeat") IS 0))
+      AND
+      ((x_fdim%2 IS 0) OR (y_fdim%2 IS 0)))
+      {
+      orig_x = x_fdim;
+      orig_y = y_fdim;
+      x_fdim = 2*(orig_x/2)+1;
+      y_fdim = 2*(orig_y/2)+1;
+      odd_filt = (image_type *) calloc(x_fdim*y_fdim, sizeof(image_type));
+      if (odd_filt IS NULL)
+	  {
+	  printf("PYRAMID: Failed to allocate temp array!");
+	  return(-1);
+	  }
+      for (y=0; y<orig_y; y++)
+	for (x=0; x<orig_x; x++)
+	  odd_filt[y*x_fdim + x] = filt[y*orig_x + x];
+      filt = odd_filt;
+      }
+
+  if ((x_fdim > x_rdim) OR (y_fdim > y_rdim))
+      {
+      printf("PYRAMID: FILTER dimensions [%d %d] larger than RESULT dimensions [%d %d].\n",
+	     x_fdim, y_fdim, x_rdim, y_rdim);
+      if (odd_filt ISNT NULL) free(odd_filt);
+      return(-1);
+      }
+
+  if (USE_FFT_CONV(x_fdim, y_fdim, x_step, y_step))
+    status = internal_fft_expand(image, filt, temp, x_fdim, y_fdim,
+				 x_start, x_step, x_stop, y_start, y_step, y_stop,
+				 result, x_rdim, y_rdim, edges);
+  else if (strcmp(edges,"circular") IS 0)
+    status = internal_wrap_expand(image, filt, x_fdim, y_fdim,
+				  x_start, x_step, x_stop, y_start, y_step, y_stop,
+				  result, x_rdim, y_rdim);
+  else
+    status = internal_expand(image, filt, temp, x_fdim, y_fdim,
+			     x_start, x_step, x_stop, y_start, y_step, y_stop,
+			     result, x_rdim, y_rdim, edges);
+
+  if (odd_filt ISNT NULL) free(odd_filt);
+  return(status);
+  }
+
+/* Same as maxPyrHt(IMSZ, FILTSZ) for a scalar FILTSZ. */
+int max_pyr_ht(int x_dim, int y_dim, int fsz)
+  {
+  if ((x_dim IS 1) OR (y_dim IS 1))	/* 1D image */
+      {
+      if (x_dim*y_dim < fsz) return(0);
+      return(1 + max_pyr_ht((x_dim*y_dim)/2, 1, fsz));
+      }
+  if ((x_dim < fsz) OR (y_dim < fsz)) return(0);
+  return(1 + max_pyr_ht(x_dim/2, y_dim/2, fsz));
+  }
+
+/*
+  --------------------------------------------------------------------
+  Band sizes.  Each routine fills PIND (if not NULL) with (x_dim, y_dim)
+  pairs, in the order the bands appear in PYR, and returns the number
+  of bands.
+  --------------------------------------------------------------------
+*/
+
+int lpyr_bands(int x_dim, int y_dim, int ht, int *pind)
+  {
+  int nb = 0;
+
+  for (; ht > 1; ht--)
+      {
+      if (pind) { pind[2*nb] = x_dim; pind[2*nb+1] = y_dim; }
+      nb++;
+      if (y_dim IS 1)       x_dim = (x_dim+1)/2;
+      else if (x_dim IS 1)  y_dim = (y_dim+1)/2;
+      else { x_dim = (x_dim+1)/2;  y_dim = (y_dim+1)/2; }
+      }
+  if (pind) { pind[2*nb] = x_dim; pind[2*nb+1] = y_dim; }
+  return(nb+1);
+  }
+
+int spyr_bands(int x_dim, int y_dim, int ht, int nbands, int *pind)
+  {
+  int nb = 0, b;
+
+  if (pind) { pind[0] = x_dim; pind[1] = y_dim; }	/* hi0 */
+  nb++;
+  for (; ht > 0; ht--)
+      {
+      for (b=0; b<nbands; b++, nb++)
+	if (pind) { pind[2*nb] = x_dim; pind[2*nb+1] = y_dim; }
+      x_dim = (x_dim+1)/2;
+      y_dim = (y_dim+1)/2;
+      }
+  if (pind) { pind[2*nb] = x_dim; pind[2*nb+1] = y_dim; }
+  return(nb+1);
+  }
+
+#define SET_BAND(X,Y) { if (pind) { pind[2*nb] = (X); pind[2*nb+1] = (Y); } nb++; }
+
+int wpyr_bands(int x_dim, int y_dim, int ht, int flen, int *pind)
+  {
+  int nb = 0;
+  int stag = (flen%2 IS 0) ? 2 : 1;
+  int x_lo, x_hi, y_lo, y_hi;
+
+  for (; ht > 0; ht--)
+      {
+      x_lo = (x_dim-stag+2)/2;   x_hi = x_dim/2;
+      y_lo = (y_dim-stag+2)/2;   y_hi = y_dim/2;
+      if (y_dim IS 1)
+	  {
+	  SET_BAND(x_hi, 1);
+	  x_dim = x_lo;
+	  }
+      else if (x_dim IS 1)
+	  {
+	  SET_BAND(1, y_hi);
+	  y_dim = y_lo;
+	  }
+      else
+	  {
+	  SET_BAND(x_hi, y_lo);		/* lohi: horizontal */
+	  SET_BAND(x_lo, y_hi);		/* hilo: vertical */
+	  SET_BAND(x_hi, y_hi);		/* hihi: diagonal */
+	  x_dim = x_lo;
+	  y_dim = y_lo;
+	  }
+      }
+  SET_BAND(x_dim, y_dim);
+  return(nb);
+  }
+
+/*
+  --------------------------------------------------------------------
+  Laplacian pyramid, as buildLpyr(IM, HT, FILT1, FILT2, EDGES).  FILT1
+  and FILT2 are 1D (FLEN1, FLEN2 taps).  The image of each level is
+  first copied to its band slot, the next level's lowpass is written
+  directly into the following slot, and the upsampled lowpass is then
+  subtracted in place.
+  --------------------------------------------------------------------
+*/
+int build_lpyr(image_type *image, int x_dim, int y_dim, int ht,
+	       image_type *filt1, int flen1, image_type *filt2, int flen2,
+	       char *edges, image_type *pyr, int *pind)
+  {
+  image_type *scratch, *lo, *hi2, *temp, *band, *next;
+  int nb, lev, i, size, y_lo;
+  int status = 0;
+  int fmax = (flen1 > flen2) ? flen1 : flen2;
+
+  nb = lpyr_bands(x_dim, y_dim, ht, pind);
+  size = x_dim*y_dim;
+  memcpy(pyr, image, size*sizeof(image_type));
+  if (nb IS 1) return(0);
+
+  /* lo/hi: x_dim*ceil(y_dim/2);  hi2: x_dim*y_dim;  temp: filter */
+  scratch = (image_type *) malloc((2*size + (fmax+1)*2)*sizeof(image_type));
+  if (scratch IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      return(-1);
+      }
+  lo = scratch;
+  hi2 = lo + size;
+  temp = hi2 + size;
+
+  band = pyr;
+  for (lev=0; lev<nb-1; lev++)
+      {
+      x_dim = pind[2*lev];     y_dim = pind[2*lev+1];
+      y_lo = pind[2*lev+3];
+      size = x_dim*y_dim;
+      next = band + size;
+
+      if (y_dim IS 1)
+	status |= internal_corrdn(band, x_dim, y_dim, filt1, temp, flen1, 1,
+				  0, 2, x_dim, 0, 1, y_dim, next, edges);
+      else if (x_dim IS 1)
+	status |= internal_corrdn(band, x_dim, y_dim, filt1, temp, 1, flen1,
+				  0, 1, x_dim, 0, 2, y_dim, next, edges);
+      else
+	  {
+	  status |= internal_corrdn(band, x_dim, y_dim, filt1, temp, 1, flen1,
+				    0, 1, x_dim, 0, 2, y_dim, lo, edges);
+	  status |= internal_corrdn(lo, x_dim, y_lo, filt1, temp, flen1, 1,
+				    0, 2, x_dim, 0, 1, y_lo, next, edges);
+	  }
+
+      for (i=0; i<size; i++) hi2[i] = 0.0;
+      if (x_dim IS 1)
+	status |= internal_upconv(next, filt2, temp, 1, flen2,
+				  0, 1, x_dim, 0, 2, y_dim, hi2, x_dim, y_dim, edges);
+      else if (y_dim IS 1)
+	status |= internal_upconv(next, filt2, temp, flen2, 1,
+				  0, 2, x_dim, 0, 1, y_dim, hi2, x_dim, y_dim, edges);
+      else
+	  {
+	  for (i=0; i<x_dim*y_lo; i++) lo[i] = 0.0;
+	  status |= internal_upconv(next, filt2, temp, flen2, 1,
+				    0, 2, x_dim, 0, 1, y_lo, lo, x_dim, y_lo, edges);
+	  status |= internal_upconv(lo, filt2, temp, 1, flen2,
+				    0, 1, x_dim, 0, 2, y_dim, hi2, x_dim, y_dim, edges);
+	  }
+
+      for (i=0; i<size; i++) band[i] -= hi2[i];
+      band = next;
+      }
+
+  free(scratch);
+  return(status);
+  }
+
+/*
+  --------------------------------------------------------------------
+  Steerable pyramid, as buildSpyr with the filters of a *Filters.m
+  file: HI0FILT and LO0FILT are square (HI0_FDIM, LO0_FDIM), LOFILT is
+  square (LO_FDIM), and BFILTS holds NBANDS square filters of size
+  BFILT_FDIM, one per column.  LEVS (HT+2 flags: hi0, the levels, the
+  lowpass) and BANDS (NBANDS flags) select the bands computed, as in
+  recon_spyr; NULL selects everything.  The lowpass chain is always
+  run down to the last selected level; bands not selected are not
+  computed and their part of PYR is left untouched.
+  --------------------------------------------------------------------
+*/
+int build_spyr(image_type *image, int x_dim, int y_dim, int ht,
+	       image_type *hi0filt, int hi0_fdim,
+	       image_type *lo0filt, int lo0_fdim,
+	       image_type *lofilt, int lo_fdim,
+	       image_type *bfilts, int bfilt_fdim, int nbands,
+	       int *levs, int *bands,
+	       char *edges, image_type *pyr, int *pind)
+  {
+  image_type *scratch, *temp, *ping, *pong, *cur, *next, *band;
+  int lev, b, fmax, x_cur, y_cur, last;
+  int status = 0;
+  int size = x_dim*y_dim;
+  int half = ((x_dim+1)/2)*((y_dim+1)/2);
+
+  spyr_bands(x_dim, y_dim, ht, nbands, pind);
+
+  fmax = hi0_fdim;
+  if (lo0_fdim > fmax) fmax = lo0_fdim;
+  if (lo_fdim > fmax) fmax = lo_fdim;
+  if (bfilt_fdim > fmax) fmax = bfilt_fdim;
+
+  scratch = (image_type *) malloc((size + half + fmax*fmax)*sizeof(image_type));
+  if (scratch IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      return(-1);
+      }
+  ping = scratch;
+  pong = ping + size;
+  temp = pong + half;
+
+  /* LAST: the deepest level (0 = lo0, ht+1 = lowpass) that is needed */
+  for (last=ht+1; last>0; last--)
+      {
+      if (last IS ht+1) { if (SELECTED(levs,ht+1)) break; }
+      else if (SELECTED(levs,last))
+	{
+	for (b=0; b<nbands; b++)
+	  if (SELECTED(bands,b)) break;
+	if (b < nbands) break;
+	}
+      }
+
+  band = pyr;
+  if (SELECTED(levs,0))
+    status |= internal_corrdn(image, x_dim, y_dim, hi0filt, temp, hi0_fdim, hi0_fdim,
+			      0, 1, x_dim, 0, 1, y_dim, band, edges);
+  band += size;
+
+  if (last > 0)
+      {
+      cur = (ht > 0) ? ping : band;		/* lo0 */
+      status |= internal_corrdn(image, x_dim, y_dim, lo0filt, temp, lo0_fdim, lo0_fdim,
+				0, 1, x_dim, 0, 1, y_dim, cur, edges);
+      }
+
+  x_cur = x_dim;  y_cur = y_dim;
+  for (lev=0; lev<ht AND lev<last; lev++)
+      {
+      for (b=0; b<nbands; b++)
+	  {
+	  if (SELECTED(levs,lev+1) AND SELECTED(bands,b))
+	    status |= internal_corrdn(cur, x_cur, y_cur,
+				      bfilts + b*bfilt_fdim*bfilt_fdim, temp,
+				      bfilt_fdim, bfilt_fdim,
+				      0, 1, x_cur, 0, 1, y_cur, band, edges);
+	  band += x_cur*y_cur;
+	  }
+      if (lev+1 < last)
+	  {
+	  if (lev IS ht-1) next = band;	/* final lowpass goes in place */
+	  else next = (cur IS ping) ? pong : ping;
+	  status |= internal_corrdn(cur, x_cur, y_cur, lofilt, temp, lo_fdim, lo_fdim,
+				    0, 2, x_cur, 0, 2, y_cur, next, edges);
+	  cur = next;
+	  }
+      x_cur = (x_cur+1)/2;
+      y_cur = (y_cur+1)/2;
+      }
+
+  free(scratch);
+  return(status);
+  }
+
+/*
+  --------------------------------------------------------------------
+  Separable QMF/wavelet pyramid, as buildWpyr(IM, HT, FILT, EDGES).
+  FILT is 1D (FLEN taps); the highpass filter is derived from it as in
+  modulateFlip.m.
+  --------------------------------------------------------------------
+*/
+int build_wpyr(image_type *image, int x_dim, int y_dim, int ht,
+	       image_type *filt, int flen,
+	       char *edges, image_type *pyr, int *pind)
+  {
+  image_type *scratch, *hfilt, *temp, *lo, *hi, *ping, *pong, *cur, *band;
+  image_type *next = NULL;
+  int lev, i, half, x_lo, x_hi, y_lo, y_hi;
+  int stag = (flen%2 IS 0) ? 2 : 1;
+  int size = x_dim*y_dim;
+  int status = 0;
+
+  wpyr_bands(x_dim, y_dim, ht, flen, pind);
+  if (ht <= 0)
+      {
+      memcpy(pyr, image, size*sizeof(image_type));
+      return(0);
+      }
+
+  half = ((x_dim+1)/2)*((y_dim+1)/2);
+  scratch = (image_type *) malloc((size + 2*half + 2*flen)*sizeof(image_type));
+  if (scratch IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      return(-1);
+      }
+  lo = scratch;			/* lo and hi share the first SIZE values */
+  ping = lo + size;
+  pong = ping + half;
+  hfilt = pong + half;
+  temp = hfilt + flen;
+
+  for (i=0; i<flen; i++)		/* modulateFlip */
+    hfilt[i] = ((flen - i - (flen+1)/2) % 2) ? -filt[flen-1-i] : filt[flen-1-i];
+
+  band = pyr;
+  cur = image;
+  for (lev=0; lev<ht; lev++)
+      {
+      x_lo = (x_dim-stag+2)/2;   x_hi = x_dim/2;
+      y_lo = (y_dim-stag+2)/2;   y_hi = y_dim/2;
+      /* the final lowpass goes in place, after this level's bands */
+      if (lev ISNT ht-1) next = (cur IS ping) ? pong : ping;
+
+      if (y_dim IS 1)
+	  {
+	  status |= internal_corrdn(cur, x_dim, y_dim, hfilt, temp, flen, 1,
+				    1, 2, x_dim, 0, 1, y_dim, band, edges);
+	  band += x_hi;
+	  if (lev IS ht-1) next = band;
+	  status |= internal_corrdn(cur, x_dim, y_dim, filt, temp, flen, 1,
+				    stag-1, 2, x_dim, 0, 1, y_dim, next, edges);
+	  x_dim = x_lo;
+	  }
+      else if (x_dim IS 1)
+	  {
+	  status |= internal_corrdn(cur, x_dim, y_dim, hfilt, temp, 1, flen,
+				    0, 1, x_dim, 1, 2, y_dim, band, edges);
+	  band += y_hi;
+	  if (lev IS ht-1) next = band;
+	  status |= internal_corrdn(cur, x_dim, y_dim, filt, temp, 1, flen,
+				    0, 1, x_dim, stag-1, 2, y_dim, next, edges);
+	  y_dim = y_lo;
+	  }
+      else
+	  {
+	  hi = lo + x_lo*y_dim;
+	  status |= internal_corrdn(cur, x_dim, y_dim, filt, temp, flen, 1,
+				    stag-1, 2, x_dim, 0, 1, y_dim, lo, edges);
+	  status |= internal_corrdn(cur, x_dim, y_dim, hfilt, temp, flen, 1,
+				    1, 2, x_dim, 0, 1, y_dim, hi, edges);
+	  /* lohi (horizontal) */
+	  status |= internal_corrdn(hi, x_hi, y_dim, filt, temp, 1, flen,
+				    0, 1, x_hi, stag-1, 2, y_dim, band, edges);
+	  band += x_hi*y_lo;
+	  /* hilo (vertical) */
+	  status |= internal_corrdn(lo, x_lo, y_dim, hfilt, temp, 1, flen,
+				    0, 1, x_lo, 1, 2, y_dim, band, edges);
+	  band += x_lo*y_hi;
+	  /* hihi (diagonal) */
+	  status |= internal_corrdn(hi, x_hi, y_dim, hfilt, temp, 1, flen,
+				    0, 1, x_hi, 1, 2, y_dim, band, edges);
+	  band += x_hi*y_hi;
+	  if (lev IS ht-1) next = band;
+	  status |= internal_corrdn(lo, x_lo, y_dim, filt, temp, 1, flen,
+				    0, 1, x_lo, stag-1, 2, y_dim, next, edges);
+	  x_dim = x_lo;
+	  y_dim = y_lo;
+	  }
+      cur = next;
+      }
+
+  free(scratch);
+  return(status);
+  }
+
+/*
+  --------------------------------------------------------------------
+  Reconstruction.  The recon_*pyr routines invert the build_*pyr
+  routines exactly as reconLpyr.m, reconSpyr.m and reconWpyr.m do, but
+  accumulate every upsampled band directly into its level's image with
+  internal_upconv (result += upConv(band)), instead of allocating one
+  full-size temporary per band and adding them up.  Levels are
+  reconstructed coarsest first, ping-ponging between two scratch
+  images; the finest level is written into RES (x_dim by y_dim, the
+  size of the original image).  PYR is laid out as returned by the
+  matching build routine for the same X_DIM, Y_DIM and HT.
+
+  LEVS and BANDS select what is reconstructed, as the LEVS and BANDS
+  arguments of the M-files: LEVS[l] is non-zero to include level l
+  (numbered from 0 in C, so LEVS[0] is the M-files' level 1, except
+  for the steerable pyramid whose level 0 is the hi0 band), BANDS[b]
+  to include orientation b.  NULL selects everything.  Levels below
+  which nothing is selected are not upsampled at all.
+  --------------------------------------------------------------------
+*/
+
+/* Laplacian pyramid, as reconLpyr(PYR, INDICES, LEVS, FILT2, EDGES). */
+int recon_lpyr(image_type *pyr, int x_dim, int y_dim, int ht,
+	       image_type *filt2, int flen2, int *levs,
+	       char *edges, image_type *res)
+  {
+  image_type *scratch, *ping, *pong, *mid, *temp, *cur, *dst, *band;
+  int nb, lev, i, size, y_lo;
+  int *pind, *offset;
+  int have, status = 0;
+
+  nb = lpyr_bands(x_dim, y_dim, ht, NULL);
+  pind = (int *) malloc(4*nb*sizeof(int));
+  if (pind IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      return(-1);
+      }
+  offset = pind + 2*nb;
+  lpyr_bands(x_dim, y_dim, ht, pind);
+  for (offset[0]=0, lev=1; lev<nb; lev++)
+    offset[lev] = offset[lev-1] + pind[2*lev-2]*pind[2*lev-1];
+
+  /* ping, pong: the second level;  mid: x_dim*ceil(y_dim/2);  temp: filter */
+  size = (nb > 1) ? pind[2]*pind[3] : 0;
+  scratch = (image_type *) malloc((2*size + x_dim*((y_dim+1)/2) + (flen2+1)*2)
+				  * sizeof(image_type));
+  if (scratch IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      free(pind);
+      return(-1);
+      }
+  ping = scratch;
+  pong = ping + size;
+  mid = pong + size;
+  temp = mid + x_dim*((y_dim+1)/2);
+
+  cur = NULL;
+  have = 0;
+  for (lev=nb-1; lev>=0; lev--)
+      {
+      x_dim = pind[2*lev];   y_dim = pind[2*lev+1];
+      size = x_dim*y_dim;
+      band = pyr + offset[lev];
+      dst = (lev IS 0) ? res : ((cur IS ping) ? pong : ping);
+
+      if (have)
+	  {
+	  for (i=0; i<size; i++) dst[i] = 0.0;
+	  y_lo = pind[2*lev+3];
+	  if (x_dim IS 1)
+	    status |= internal_upconv(cur, filt2, temp, 1, flen2,
+				      0, 1, x_dim, 0, 2, y_dim, dst, x_dim, y_dim, edges);
+	  else if (y_dim IS 1)
+	    status |= internal_upconv(cur, filt2, temp, flen2, 1,
+				      0, 2, x_dim, 0, 1, y_dim, dst, x_dim, y_dim, edges);
+	  else
+	      {
+	      for (i=0; i<x_dim*y_lo; i++) mid[i] = 0.0;
+	      status |= internal_upconv(cur, filt2, temp, flen2, 1,
+					0, 2, x_dim, 0, 1, y_lo, mid, x_dim, y_lo, edges);
+	      status |= internal_upconv(mid, filt2, temp, 1, flen2,
+					0, 1, x_dim, 0, 2, y_dim, dst, x_dim, y_dim, edges);
+	      }
+	  if (SELECTED(levs, lev))
+	    for (i=0; i<size; i++) dst[i] += band[i];
+	  }
+      else if (SELECTED(levs, lev))
+	memcpy(dst, band, size*sizeof(image_type));
+      else
+	for (i=0; i<size; i++) dst[i] = 0.0;
+
+      have |= SELECTED(levs, lev);
+      cur = dst;
+      }
+
+  free(scratch);
+  free(pind);
+  return(status);
+  }
+
+/*
+  Steerable pyramid, as reconSpyr(PYR, INDICES, FILTFILE, EDGES, LEVS,
+  BANDS) with the filters of FILTFILE (see build_spyr).  LEVS has
+  HT+2 entries: hi0, the HT band levels and the lowpass.
+*/
+int recon_spyr(image_type *pyr, int x_dim, int y_dim, int ht,
+	       image_type *hi0filt, int hi0_fdim,
+	       image_type *lo0filt, int lo0_fdim,
+	       image_type *lofilt, int lo_fdim,
+	       image_type *bfilts, int bfilt_fdim, int nbands,
+	       int *levs, int *bands,
+	       char *edges, image_type *res)
+  {
+  image_type *scratch, *full, *half, *temp, *cur, *dst, *band;
+  int lev, b, i, fmax, x_cur, y_cur, size;
+  int *pind;
+  int have, status = 0;
+
+  pind = (int *) malloc(2*(ht*nbands+2)*sizeof(int));
+  if (pind IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      return(-1);
+      }
+  spyr_bands(x_dim, y_dim, ht, nbands, pind);
+
+  fmax = hi0_fdim;
+  if (lo0_fdim > fmax) fmax = lo0_fdim;
+  if (lo_fdim > fmax) fmax = lo_fdim;
+  if (bfilt_fdim > fmax) fmax = bfilt_fdim;
+
+  /* full: level 1 and the other odd levels;  half: the even levels */
+  size = x_dim*y_dim;
+  scratch = (image_type *) malloc((size + ((x_dim+1)/2)*((y_dim+1)/2)
+				   + (fmax+1)*(fmax+1)) * sizeof(image_type));
+  if (scratch IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      free(pind);
+      return(-1);
+      }
+  full = scratch;
+  half = full + size;
+  temp = half + ((x_dim+1)/2)*((y_dim+1)/2);
+
+  /* lowpass (level HT+1) */
+  b = 1 + ht*nbands;
+  x_cur = pind[2*b];  y_cur = pind[2*b+1];
+  band = pyr + size;
+  for (i=1; i<b; i++) band += pind[2*i]*pind[2*i+1];
+  cur = ((ht+1)%2) ? full : half;
+  have = SELECTED(levs, ht+1);
+  if (have) memcpy(cur, band, x_cur*y_cur*sizeof(image_type));
+  else for (i=0; i<x_cur*y_cur; i++) cur[i] = 0.0;
+
+  for (lev=ht; lev>=1; lev--)
+      {
+      b = 1 + (lev-1)*nbands;
+      x_cur = pind[2*b];  y_cur = pind[2*b+1];
+      dst = (lev%2) ? full : half;
+      for (i=0; i<x_cur*y_cur; i++) dst[i] = 0.0;
+
+      if (have)
+	status |= internal_upconv(cur, lofilt, temp, lo_fdim, lo_fdim,
+				  0, 2, x_cur, 0, 2, y_cur, dst, x_cur, y_cur, edges);
+      if (SELECTED(levs, lev))
+	  {
+	  band = pyr + size;
+	  for (i=1; i<b; i++) band += pind[2*i]*pind[2*i+1];
+	  for (i=0; i<nbands; i++, band += x_cur*y_cur)
+	    if (SELECTED(bands, i))
+	      status |= internal_upconv(band, bfilts + i*bfilt_fdim*bfilt_fdim, temp,
+					bfilt_fdim, bfilt_fdim,
+					0, 1, x_cur, 0, 1, y_cur, dst, x_cur, y_cur, edges);
+	  have = 1;
+	  }
+      cur = dst;
+      }
+
+  for (i=0; i<size; i++) res[i] = 0.0;
+  status |= internal_upconv(cur, lo0filt, temp, lo0_fdim, lo0_fdim,
+			    0, 1, x_dim, 0, 1, y_dim, res, x_dim, y_dim, edges);
+  if (SELECTED(levs, 0))
+    status |= internal_upconv(pyr, hi0filt, temp, hi0_fdim, hi0_fdim,
+			      0, 1, x_dim, 0, 1, y_dim, res, x_dim, y_dim, edges);
+
+  free(scratch);
+  free(pind);
+  return(status);
+  }
+
+/*
+  Separable QMF/wavelet pyramid, as reconWpyr(PYR, INDICES, FILT,
+  EDGES, LEVS, BANDS).  LEVS has HT+1 entries (the last one is the
+  lowpass), BANDS has 3.  By linearity, the bands that are upsampled
+  along y with the same filter and phase (lowpass and vertical;
+  horizontal and diagonal) are summed first, so each 2D level takes
+  two passes over the full-size image instead of four.
+*/
+int recon_wpyr(image_type *pyr, int x_dim, int y_dim, int ht,
+	       image_type *filt, int flen, int *levs, int *bands,
+	       char *edges, image_type *res)
+  {
+  image_type *scratch, *hfilt, *temp, *ping, *pong, *lo, *hi, *cur, *dst, *band;
+  int lev, b, i, half, size, x_lo, x_hi, y_lo, y_hi, use_lo, use_hi;
+  int stag = (flen%2 IS 0) ? 2 : 1;
+  int *dims, *offset;
+  int have, status = 0;
+
+  /* image size and offset of the first band, at each level */
+  dims = (int *) malloc(3*(ht+1)*sizeof(int));
+  if (dims IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      return(-1);
+      }
+  offset = dims + 2*(ht+1);
+  dims[0] = x_dim;  dims[1] = y_dim;  offset[0] = 0;
+  for (lev=0; lev<ht; lev++)
+      {
+      x_dim = dims[2*lev];  y_dim = dims[2*lev+1];
+      x_lo = (x_dim-stag+2)/2;   x_hi = x_dim/2;
+      y_lo = (y_dim-stag+2)/2;   y_hi = y_dim/2;
+      if (x_dim IS 1)
+	{ dims[2*lev+2] = 1;     dims[2*lev+3] = y_lo;  b = y_hi; }
+      else if (y_dim IS 1)
+	{ dims[2*lev+2] = x_lo;  dims[2*lev+3] = 1;     b = x_hi; }
+      else
+	  {
+	  dims[2*lev+2] = x_lo;  dims[2*lev+3] = y_lo;
+	  b = x_hi*y_lo + x_lo*y_hi + x_hi*y_hi;
+	  }
+      offset[lev+1] = offset[lev] + b;
+      }
+  x_dim = dims[0];  y_dim = dims[1];
+
+  size = x_dim*y_dim;
+  have = SELECTED(levs, ht);
+  if (ht IS 0)
+      {
+      if (have) memcpy(res, pyr, size*sizeof(image_type));
+      else for (i=0; i<size; i++) res[i] = 0.0;
+      free(dims);
+      return(0);
+      }
+
+  half = ((x_dim+1)/2)*((y_dim+1)/2);
+  scratch = (image_type *) malloc((size + 2*half + flen + (flen+1)*2)
+				  * sizeof(image_type));
+  if (scratch IS NULL)
+      {
+      printf("PYRAMID: Failed to allocate temp array!");
+      free(dims);
+      return(-1);
+      }
+  lo = scratch;			/* lo and hi share the first SIZE values */
+  ping = lo + size;
+  pong = ping + half;
+  hfilt = pong + half;
+  temp = hfilt + flen;
+
+  for (i=0; i<flen; i++)		/* modulateFlip */
+    hfilt[i] = ((flen - i - (flen+1)/2) % 2) ? -filt[flen-1-i] : filt[flen-1-i];
+
+  cur = pyr + offset[ht];		/* lowpass (level HT) */
+  for (lev=ht-1; lev>=0; lev--)
+      {
+      x_dim = dims[2*lev];  y_dim = dims[2*lev+1];
+      x_lo = (x_dim-stag+2)/2;   x_hi = x_dim/2;
+      y_lo = (y_dim-stag+2)/2;   y_hi = y_dim/2;
+      size = x_dim*y_dim;
+      band = pyr + offset[lev];
+      dst = (lev IS 0) ? res : ((cur IS ping) ? pong : ping);
+      for (i=0; i<size; i++) dst[i] = 0.0;
+
+      if (x_dim IS 1)
+	  {
+	  if (have)
+	    status |= internal_upconv(cur, filt, temp, 1, flen,
+				      0, 1, x_dim, stag-1, 2, y_dim, dst, x_dim, y_dim, edges);
+	  if (SELECTED(levs, lev))
+	    status |= internal_upconv(band, hfilt, temp, 1, flen,
+				      0, 1, x_dim, 1, 2, y_dim, dst, x_dim, y_dim, edges);
+	  }
+      else if (y_dim IS 1)
+	  {
+	  if (have)
+	    status |= internal_upconv(cur, filt, temp, flen, 1,
+				      stag-1, 2, x_dim, 0, 1, y_dim, dst, x_dim, y_dim, edges);
+	  if (SELECTED(levs, lev))
+	    status |= internal_upconv(band, hfilt, temp, flen, 1,
+				      1, 2, x_dim, 0, 1, y_dim, dst, x_dim, y_dim, edges);
+	  }
+      else
+	  {
+	  hi = lo + x_lo*y_dim;
+	  for (i=0; i<size; i++) lo[i] = 0.0;	/* lo and hi */
+	  use_lo = have;
+	  use_hi = 0;
+	  if (have)
+	    status |= internal_upconv(cur, filt, temp, 1, flen,
+				      0, 1, x_lo, stag-1, 2, y_dim, lo, x_lo, y_dim, edges);
+	  if (SELECTED(levs, lev))
+	      {
+	      if (SELECTED(bands, 0))	/* lohi (horizontal) */
+		  {
+		  status |= internal_upconv(band, filt, temp, 1, flen,
+					    0, 1, x_hi, stag-1, 2, y_dim, hi, x_hi, y_dim, edges);
+		  use_hi = 1;
+		  }
+	      band += x_hi*y_lo;
+	      if (SELECTED(bands, 1))	/* hilo (vertical) */
+		  {
+		  status |= internal_upconv(band, hfilt, temp, 1, flen,
+					    0, 1, x_lo, 1, 2, y_dim, lo, x_lo, y_dim, edges);
+		  use_lo = 1;
+		  }
+	      band += x_lo*y_hi;
+	      if (SELECTED(bands, 2))	/* hihi (diagonal) */
+		  {
+		  status |= internal_upconv(band, hfilt, temp, 1, flen,
+					    0, 1, x_hi, 1, 2, y_dim, hi, x_hi, y_dim, edges);
+		  use_hi = 1;
+		  }
+	      }
+	  if (use_lo)
+	    status |= internal_upconv(lo, filt, temp, flen, 1,
+				      stag-1, 2, x_dim, 0, 1, y_dim, dst, x_dim, y_dim, edges);
+	  if (use_hi)
+	    status |= internal_upconv(hi, hfilt, temp, flen, 1,
+				      1, 2, x_dim, 0, 1, y_dim, dst, x_dim, y_dim, edges);
+	  }
+
+      have |= SELECTED(levs, lev);
+      cur = dst;
+      }
+
+  free(scratch);
+  free(dims);
+  return(status);
+  }
@@ -0,0 +1,121 @@
+/*
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;;;  File: pyramid.h
+;;;  Description: Header file for pyramid.c
+;;;  ----------------------------------------------------------------
+;;;    Object-Based Vision and Image Understanding System (OBVIUS),
+;;;      Copyright 1988, Vision Science Group,  Media Laboratory,
+;;;              Massachusetts Institute of Technology.
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+*/
+
+#include "convolve.h"
+
+#ifdef PYR_FLOAT		/* see convolve.h */
+#define internal_corrdn internal_corrdn_f
+#define internal_upconv internal_upconv_f
+#define max_pyr_ht      max_pyr_ht_f
+#define lpyr_bands      lpyr_bands_f
+#define spyr_bands      spyr_bands_f
+#define wpyr_bands      wpyr_bands_f
+#define build_lpyr      build_lpyr_f
+#define build_spyr      build_spyr_f
+#define build_wpyr      build_wpyr_f
+#define recon_lpyr      recon_lpyr_f
+#define recon_spyr      recon_spyr_f
+#define recon_wpyr      recon_wpyr_f
+#endif
+
+/* Pyramid types, as accepted by buildPyr */
+#define LAPLACIAN_PYR 0
+#define STEERABLE_PYR 1
+#define WAVELET_PYR   2
+
+/* Band sizes are returned in PIND as (x_dim, y_dim) pairs, i.e. the
+   rows of the matlabPyrTools INDICES matrix. */
+
+int internal_corrdn(image_type *image, int x_idim, int y_idim,
+		    image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+		    int x_start, int x_step, int x_stop,
+		    int y_start, int y_step, int y_stop,
+		    image_type *result, char *edges);
+int internal_upconv(image_type *image,
+		    image_type *filt, image_type *temp, int x_fdim, int y_fdim,
+		    int x_start, int x_step, int x_stop,
+		    int y_start, int y_step, int y_stop,
+		    image_type *result, int x_rdim, int y_rdim, char *edges);
+
+int max_pyr_ht(int x_idim, int y_idim, int fsz);
+int lpyr_bands(int x_idim, int y_idim, int ht, int *pind);
+int spyr_bands(int x_idim, int y_idim, int ht, int nbands, int *pind);
+int wpyr_bands(int x_idim, int y_idim, int ht, int flen, int *pind);
+
+int build_lpyr(image_type *image, int x_idim, int y_idim, int ht,
+	       image_type *filt1, int flen1, image_type *filt2, int flen2,
+	       char *edges, image_type *pyr, int *pind);
+/* LEVS and BANDS select the steerable bands to compute, as for
+   recon_spyr below; the others are left untouched in PYR. */
+int build_spyr(image_type *image, int x_idim, int y_idim, int ht,
+	       image_type *hi0filt, int hi0_fdim,
+	       image_type *lo0filt, int lo0_fdim,
+	       image_type *lofilt, int lo_fdim,
+	       image_type *bfilts, int bfilt_fdim, int nbands,
+	       int *levs, int *bands,
+	       char *edges, image_type *pyr, int *pind);
+int build_wpyr(image_type *image, int x_idim, int y_idim, int ht,
+	       image_type *filt, int flen,
+	       char *edges, image_type *pyr, int *pind);
+
+/* LEVS and BANDS are per-level and per-orientation flags (NULL = all),
+   see pyramid.c.  RES receives the reconstructed x_dim by y_dim image. */
+int recon_lpyr(image_type *pyr, int x_dim, int y_dim, int ht,
+	       image_type *filt2, int flen2, int *levs,
+	       char *edges, image_type *res);
+int recon_spyr(image_type *pyr, int x_dim, int y_dim, int ht,
+	       image_type *hi0filt, int hi0_fdim,
+	       image_type *lo0filt, int lo0_fdim,
+	       image_type *lofilt, int lo_fdim,
+	       image_type *bfilts, int bfilt_fdim, int nbands,
+	       int *levs, int *bands,
+	       char *edges, image_type *res);
+int recon_wpyr(image_type *pyr, int x_dim, int y_dim, int ht,
+	       image_type *filt, int flen, int *levs, int *bands,
+	       char *edges, image_type *res);
+
+/* Single-precision versions, for callers compiled in double. */
+int internal_corrdn_f(float *image, int x_idim, int y_idim,
+		      float *filt, float *temp, int x_fdim, int y_fdim,
+		      int x_start, int x_step, int x_stop,
+		      int y_start, int y_step, int y_stop,
+		      float *result, char *edges);
+int internal_upconv_f(float *image,
+		      float *filt, float *temp, int x_fdim, int y_fdim,
+		      int x_start, int x_step, int x_stop,
+		      int y_start, int y_step, int y_stop,
+		      float *result, int x_rdim, int y_rdim, char *edges);
+int build_lpyr_f(float *image, int x_idim, int y_idim, int ht,
+		 float *filt1, int flen1, float *filt2, int flen2,
+		 char *edges, float *pyr, int *pind);
+int build_spyr_f(float *image, int x_idim, int y_idim, int ht,
+		 float *hi0filt, int hi0_fdim,
+		 float *lo0filt, int lo0_fdim,
+		 float *lofilt, int lo_fdim,
+		 float *bfilts, int bfilt_fdim, int nbands,
+		 int *levs, int *bands,
+		 char *edges, float *pyr, int *pind);
+int build_wpyr_f(float *image, int x_idim, int y_idim, int ht,
+		 float *filt, int flen,
+		 char *edges, float *pyr, int *pind);
+int recon_lpyr_f(float *pyr, int x_dim, int y_dim, int ht,
+		 float *filt2, int flen2, int *levs,
+		 char *edges, float *res);
+int recon_spyr_f(float *pyr, int x_dim, int y_dim, int ht,
+		 float *hi0filt, int hi0_fdim,
+		 float *lo0filt, int lo0_fdim,
+		 float *lofilt, int lo_fdim,
+		 float *bfilts, int bfilt_fdim, int nbands,
+		 int *levs, int *bands,
+		 char *edges, float *res);
+int recon_wpyr_f(float *pyr, int x_dim, int y_dim, int ht,
+		 float *filt, int flen, int *levs, int *bands,
+		 char *edges, float *res);
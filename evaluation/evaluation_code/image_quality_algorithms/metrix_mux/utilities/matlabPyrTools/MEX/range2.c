@@ -1,7 +1,11 @@
-/* 
+/*
 [MIN, MAX] = range2(MTX)
+[MINS, MAXS] = range2(PYR, INDICES)
   >>> See range2.m for documentation <<<
   EPS, 3/97.
+  10/26: single and uint8 MTX; NaNs ignored; the second form gives
+  the range of every band of a pyramid in one call.  Compiled with
+  OpenMP (see the Makefiles), large matrices are split across threads.
 */
 
 #define V4_COMPAT
@@ -9,8 +13,96 @@
 #include <mex.h>
 
 #include <stddef.h>  /* NULL */
+#include <math.h>  /* HUGE_VAL */
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notRangeMtx(it) (!mxIsNumeric(it) || mxIsSparse(it) || mxIsComplex(it) || \
+			 !(mxIsDouble(it) || mxIsSingle(it) || mxIsUint8(it)))
+
+#define PAR_MIN_SIZE 65536  /* smaller matrices are done by one thread */
+
+/* OMP(directive) is an OpenMP pragma, dropped when not compiling with
+   OpenMP. */
+#ifdef _OPENMP
+#define OMP(x) _Pragma(#x)
+#else
+#define OMP(x)
+#endif
+
+#define LANES 8  /* independent min/max accumulators, see RANGE_FUNC */
+
+/*
+  Min and max of the SIZE values at IM.  The running min and max
+  start at +/-HUGE_VAL and are updated with compares that are false
+  for NaN, so NaNs are skipped; if every value is NaN (or SIZE is 0),
+  *MN > *MX on return.  Keeping LANES separate accumulators (combined
+  at the end) lets the compiler use vector min/max instructions,
+  which it will not do for a single floating-point reduction.
+  Matrices of PAR_MIN_SIZE or more are split into chunks of that
+  size, done in parallel with OpenMP.
+*/
+#define RANGE_FUNC(NAME, TYPE) \
+static void NAME##_lanes(TYPE *im, int size, double *mn_p, double *mx_p) \
+  { \
+  double lo[LANES], hi[LANES], v; \
+  int i, k; \
+  for (k=0; k<LANES; k++) { lo[k] = HUGE_VAL;  hi[k] = -HUGE_VAL; } \
+  for (i=0; i+LANES<=size; i+=LANES) \
+    for (k=0; k<LANES; k++) \
+	{ \
+	v = im[i+k]; \
+	lo[k] = (v < lo[k]) ? v : lo[k]; \
+	hi[k] = (v > hi[k]) ? v : hi[k]; \
+	} \
+  for (; i<size; i++) \
+      { \
+      v = im[i]; \
+      lo[0] = (v < lo[0]) ? v : lo[0]; \
+      hi[0] = (v > hi[0]) ? v : hi[0]; \
+      } \
+  for (k=1; k<LANES; k++) \
+      { \
+      lo[0] = (lo[k] < lo[0]) ? lo[k] : lo[0]; \
+      hi[0] = (hi[k] > hi[0]) ? hi[k] : hi[0]; \
+      } \
+  *mn_p = lo[0];  *mx_p = hi[0]; \
+  } \
+static void NAME(TYPE *im, int size, double *mn_p, double *mx_p) \
+  { \
+  double mn = HUGE_VAL, mx = -HUGE_VAL; \
+  int c, nchunks = (size+PAR_MIN_SIZE-1)/PAR_MIN_SIZE; \
+  OMP(omp parallel for if(nchunks > 1) reduction(min:mn) reduction(max:mx)) \
+  for (c=0; c<nchunks; c++) \
+      { \
+      double lo, hi; \
+      int n = (c < nchunks-1) ? PAR_MIN_SIZE : size-c*PAR_MIN_SIZE; \
+      NAME##_lanes(im+c*PAR_MIN_SIZE, n, &lo, &hi); \
+      mn = (lo < mn) ? lo : mn; \
+      mx = (hi > mx) ? hi : mx; \
+      } \
+  *mn_p = mn;  *mx_p = mx; \
+  }
+
+RANGE_FUNC(range_double, double)
+RANGE_FUNC(range_single, float)
+RANGE_FUNC(range_uint8, unsigned char)
+
+/* Range of the SIZE values of matrix ARG starting at element OFFSET,
+   NaN for both if there are none. */
+static void range_of(const mxArray *arg, int offset, int size, double *mn, double *mx)
+  {
+  if (mxIsUint8(arg))
+    range_uint8((unsigned char *) mxGetData(arg) + offset, size, mn, mx);
+  else if (mxIsSingle(arg))
+    range_single((float *) mxGetData(arg) + offset, size, mn, mx);
+  else
+    range_double(mxGetPr(arg) + offset, size, mn, mx);
+  if (*mn > *mx)
+    *mn = *mx = mxGetNaN();
+  }
 
 void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 mxArray *plhs[],    /* Matrices on lhs      */
@@ -18,39 +110,54 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 const mxArray *prhs[]     /* Matrices on rhs */
 		 )
   {
-  register double temp, mn, mx;
-  register double *mtx;
-  register int i, size;
-  mxArray *arg;
+  double *mn, *mx, *ind;
+  int b, nbands, size, offset;
+  const mxArray *arg;
 
-  if (nrhs != 1) mexErrMsgTxt("requires 1 argument.");
+  if ((nrhs < 1) || (nrhs > 2)) mexErrMsgTxt("requires 1 or 2 arguments.");
 
   /* ARG 1: MATRIX  */
   arg = prhs[0];
-  if notDblMtx(arg) mexErrMsgTxt("MTX arg must be a real non-sparse matrix.");
-  mtx = mxGetPr(arg);
+  if notRangeMtx(arg) mexErrMsgTxt("MTX arg must be a real non-sparse double, single or uint8 matrix.");
   size = (int) mxGetM(arg) * mxGetN(arg);
 
-  /* FIND min, max values of MTX */
-  mn = *mtx;   mx = *mtx;  
-  for (i=1; i<size; i++)
+  /* ARG 2 (optional): INDICES, one band size per row */
+  nbands = 1;
+  ind = NULL;
+  if (nrhs > 1)
       {
-      temp = mtx[i];
-      if (temp < mn)
-	mn = temp;
-      else if (temp > mx)
-	mx = temp;
+      if (notDblMtx(prhs[1]) || (mxGetN(prhs[1]) != 2))
+	mexErrMsgTxt("INDICES arg must be an Nx2 double matrix.");
+      nbands = (int) mxGetM(prhs[1]);
+      ind = mxGetPr(prhs[1]);
+      for (offset=0, b=0; b<nbands; b++)
+	offset += (int) (ind[b] * ind[nbands+b]);
+      if (offset != size)
+	mexErrMsgTxt("INDICES arg is inconsistent with the size of PYR.");
       }
 
-  plhs[0] = (mxArray *) mxCreateDoubleMatrix(1,1,mxREAL);
+  plhs[0] = (mxArray *) mxCreateDoubleMatrix(nbands,1,mxREAL);
   if (plhs[0] == NULL) mexErrMsgTxt("Error allocating result matrix");
-  plhs[1] = (mxArray *) mxCreateDoubleMatrix(1,1,mxREAL);
-  if (plhs[1] == NULL) mexErrMsgTxt("Error allocating result matrix");
-  mtx = mxGetPr(plhs[0]);
-  mtx[0] = mn;
-  mtx = mxGetPr(plhs[1]);
-  mtx[0] = mx;
+  mn = mxGetPr(plhs[0]);
+  if (nlhs > 1)
+      {
+      plhs[1] = (mxArray *) mxCreateDoubleMatrix(nbands,1,mxREAL);
+      if (plhs[1] == NULL) mexErrMsgTxt("Error allocating result matrix");
+      mx = mxGetPr(plhs[1]);
+      }
+  else
+    mx = mxCalloc(nbands, sizeof(double));
 
-  return;
-  }      
+  if (ind == NULL)
+    range_of(arg, 0, size, mn, mx);
+  else
+    for (offset=0, b=0; b<nbands; b++)
+	{
+	size = (int) (ind[b] * ind[nbands+b]);
+	range_of(arg, offset, size, mn+b, mx+b);
+	offset += size;
+	}
 
+  if (nlhs < 2) mxFree((char *) mx);
+  return;
+  }
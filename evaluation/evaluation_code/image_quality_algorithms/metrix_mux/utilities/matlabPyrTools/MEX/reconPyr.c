@@ -0,0 +1,288 @@
+/*
+RES = reconPyr(TYPE, PYR, INDICES, FILTERS..., EDGES, LEVS, BANDS);
+  >>> See reconPyr.m for documentation <<<
+  This is a matlab interface to the recon_lpyr, recon_spyr and
+  recon_wpyr functions of pyramid.c.  A single-precision PYR is
+  reconstructed with the float kernels (filters are always given in
+  double).
+*/
+
+#define V4_COMPAT
+#include <matrix.h>  /* Matlab matrices */
+#include <mex.h>
+
+#include <string.h>
+#include <math.h>
+#include "pyramid.h"
+
+#define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notFltMtx(it) (!mxIsNumeric(it) || !(mxIsDouble(it) || mxIsSingle(it)) || mxIsSparse(it) || mxIsComplex(it))
+
+/* Check that ARG is a 1D double filter, returning its length. */
+static int vector_filter(const mxArray *arg, char *name)
+  {
+  char msg[80];
+
+  if (notDblMtx(arg) || ((mxGetM(arg) > 1) && (mxGetN(arg) > 1)))
+      {
+      sprintf(msg, "%s should be a 1D double filter (i.e., a vector).", name);
+      mexErrMsgTxt(msg);
+      }
+  return((int) (mxGetM(arg) * mxGetN(arg)));
+  }
+
+/* Check that ARG is a square double filter, returning its size. */
+static int square_filter(const mxArray *arg, char *name)
+  {
+  char msg[80];
+
+  if (notDblMtx(arg) || (mxGetM(arg) != mxGetN(arg)))
+      {
+      sprintf(msg, "%s should be a square double filter.", name);
+      mexErrMsgTxt(msg);
+      }
+  return((int) mxGetM(arg));
+  }
+
+/* Single-precision copy of the double matrix ARG. */
+static float *float_copy(const mxArray *arg)
+  {
+  int i, n = (int) (mxGetM(arg) * mxGetN(arg));
+  double *src = mxGetPr(arg);
+  float *dst = mxCalloc(n > 0 ? n : 1, sizeof(float));
+
+  if (dst == NULL) mexErrMsgTxt("Cannot allocate necessary temporary space");
+  for (i=0; i<n; i++) dst[i] = (float) src[i];
+  return(dst);
+  }
+
+/* Flags for the selection ARG ('all' or a vector of numbers in
+   [FIRST, FIRST+N-1]); returns NULL for 'all'. */
+static int *selection(const mxArray *arg, int first, int n, char *name)
+  {
+  int i, k, *flags;
+  double *sel;
+  char str[8];
+  char msg[80];
+
+  if (mxIsChar(arg))
+      {
+      mxGetString(arg, str, 8);
+      if (strcmp(str, "all"))
+	  {
+	  sprintf(msg, "%s arg must be 'all' or a vector of numbers.", name);
+	  mexErrMsgTxt(msg);
+	  }
+      return(NULL);
+      }
+  if notDblMtx(arg)
+      {
+      sprintf(msg, "%s arg must be 'all' or a vector of numbers.", name);
+      mexErrMsgTxt(msg);
+      }
+  flags = mxCalloc(n > 0 ? n : 1, sizeof(int));
+  if (flags == NULL) mexErrMsgTxt("Cannot allocate necessary temporary space");
+  sel = mxGetPr(arg);
+  for (i=0; i<(int) (mxGetM(arg)*mxGetN(arg)); i++)
+      {
+      k = (int) sel[i] - first;
+      if ((k < 0) || (k >= n))
+	  {
+	  sprintf(msg, "%s numbers must be in the range [%d, %d].", name, first, first+n-1);
+	  mexErrMsgTxt(msg);
+	  }
+      flags[k] = 1;
+      }
+  return(flags);
+  }
+
+void mexFunction(int nlhs,	     /* Num return vals on lhs */
+		 mxArray *plhs[],    /* Matrices on lhs      */
+		 int nrhs,	     /* Num args on rhs    */
+		 const mxArray *prhs[]     /* Matrices on rhs */
+		 )
+  {
+  double *ind;
+  int x_dim, y_dim, ht = 0, nrows;
+  int type = WAVELET_PYR, nfilt = 1;
+  int nbands, total, b, status, single, per_lev;
+  int *pind, *levs = NULL, *bands = NULL;
+  int flen = 0, hi0_fdim = 0, lo0_fdim = 0, lo_fdim = 0, bfilt_fdim = 0, nori = 0;
+  const mxArray *arg;
+  char type_str[16];
+  char edges[15] = "reflect1";
+
+  if (nrhs<3) mexErrMsgTxt("requres at least 3 args.");
+
+  /* ARG 1: TYPE */
+  if (!mxIsChar(prhs[0])) mexErrMsgTxt("TYPE arg must be a string.");
+  mxGetString(prhs[0], type_str, 16);
+  if (!strcmp(type_str, "laplacian"))       { type = LAPLACIAN_PYR; nfilt = 1; }
+  else if (!strcmp(type_str, "steerable"))  { type = STEERABLE_PYR; nfilt = 4; }
+  else if (!strcmp(type_str, "wavelet"))    { type = WAVELET_PYR;   nfilt = 1; }
+  else mexErrMsgTxt("TYPE must be one of 'laplacian', 'steerable' or 'wavelet'.");
+
+  if (nrhs < 3+nfilt) mexErrMsgTxt("Not enough filter arguments for this pyramid TYPE.");
+
+  /* ARG 2: PYR */
+  arg = prhs[1];
+  if notFltMtx(arg) mexErrMsgTxt("PYR arg must be a non-sparse double or single float matrix.");
+  single = mxIsSingle(arg);
+
+  /* ARG 3: INDICES */
+  arg = prhs[2];
+  if (notDblMtx(arg) || (mxGetN(arg) != 2) || (mxGetM(arg) < 1))
+    mexErrMsgTxt("INDICES arg must be an Nx2 double matrix.");
+  ind = mxGetPr(arg);
+  nrows = (int) mxGetM(arg);
+
+  /* ARGS 4..: FILTERS.  The image size and height follow from INDICES. */
+  x_dim = (int) ind[0];
+  y_dim = (int) ind[nrows];
+  switch (type)
+      {
+      case LAPLACIAN_PYR:
+	flen = vector_filter(prhs[3], "FILT2");
+	ht = nrows;
+	break;
+      case STEERABLE_PYR:
+	lo0_fdim = square_filter(prhs[3], "LO0FILT");
+	hi0_fdim = square_filter(prhs[4], "HI0FILT");
+	lo_fdim = square_filter(prhs[5], "LOFILT");
+	if notDblMtx(prhs[6]) mexErrMsgTxt("BFILTS arg must be a double float matrix.");
+	bfilt_fdim = (int) (sqrt((double) mxGetM(prhs[6])) + 0.5);
+	if (bfilt_fdim*bfilt_fdim != (int) mxGetM(prhs[6]))
+	  mexErrMsgTxt("BFILTS columns must hold square filters.");
+	nori = (int) mxGetN(prhs[6]);
+	if ((nrows < 2) || ((nrows > 2) && ((nori < 1) || ((nrows-2) % nori))))
+	  mexErrMsgTxt("Number of pyramid bands is inconsistent with BFILTS.");
+	ht = (nrows > 2) ? (nrows-2)/nori : 0;
+	break;
+      default:
+	flen = vector_filter(prhs[3], "FILT");
+	per_lev = ((x_dim == 1) || (y_dim == 1)) ? 1 : 3;
+	if ((nrows-1) % per_lev)
+	  mexErrMsgTxt("INDICES arg does not describe a wavelet pyramid.");
+	ht = (nrows-1)/per_lev;
+	if (ht > 0)
+	    {
+	    if (x_dim == 1)
+	      for (y_dim=0, b=0; b<nrows; b++) y_dim += (int) ind[nrows+b];
+	    else if (y_dim == 1)
+	      for (x_dim=0, b=0; b<nrows; b++) x_dim += (int) ind[b];
+	    else
+		{
+		x_dim = (int) (ind[0] + ind[1]);
+		y_dim = (int) (ind[nrows] + ind[nrows+1]);
+		}
+	    }
+	break;
+      }
+
+  /* Check INDICES against the bands of an X_DIM by Y_DIM pyramid */
+  switch (type)
+      {
+      case LAPLACIAN_PYR: nbands = lpyr_bands(x_dim, y_dim, ht, NULL); break;
+      case STEERABLE_PYR: nbands = spyr_bands(x_dim, y_dim, ht, nori, NULL); break;
+      default: nbands = wpyr_bands(x_dim, y_dim, ht, flen, NULL); break;
+      }
+  if (nbands != nrows) mexErrMsgTxt("INDICES arg is inconsistent with the pyramid TYPE.");
+  pind = mxCalloc(2*nbands, sizeof(int));
+  if (pind == NULL) mexErrMsgTxt("Cannot allocate necessary temporary space");
+  switch (type)
+      {
+      case LAPLACIAN_PYR: lpyr_bands(x_dim, y_dim, ht, pind); break;
+      case STEERABLE_PYR: spyr_bands(x_dim, y_dim, ht, nori, pind); break;
+      default: wpyr_bands(x_dim, y_dim, ht, flen, pind); break;
+      }
+  for (total=0, b=0; b<nbands; b++)
+      {
+      if ((pind[2*b] != (int) ind[b]) || (pind[2*b+1] != (int) ind[nrows+b]))
+	mexErrMsgTxt("INDICES arg is inconsistent with the pyramid TYPE.");
+      total += pind[2*b]*pind[2*b+1];
+      }
+  mxFree((char *) pind);
+  if ((int) (mxGetM(prhs[1]) * mxGetN(prhs[1])) != total)
+    mexErrMsgTxt("PYR arg is inconsistent with INDICES.");
+
+  /* ARG 4+NFILT (optional): EDGES */
+  if (nrhs > 3+nfilt)
+      {
+      if (!mxIsChar(prhs[3+nfilt]))
+	mexErrMsgTxt("EDGES arg must be a string.");
+      mxGetString(prhs[3+nfilt], edges, 15);
+      }
+  if ((strcmp(edges,"circular") != 0) && (edge_function(edges) == NULL))
+    mexErrMsgTxt("Unknown EDGES type.");
+
+  /* ARGS 5+NFILT, 6+NFILT (optional): LEVS, BANDS */
+  if (nrhs > 4+nfilt)
+      {
+      switch (type)
+	  {
+	  case LAPLACIAN_PYR: levs = selection(prhs[4+nfilt], 1, ht, "LEVS"); break;
+	  case STEERABLE_PYR: levs = selection(prhs[4+nfilt], 0, ht+2, "LEVS"); break;
+	  default: levs = selection(prhs[4+nfilt], 1, ht+1, "LEVS"); break;
+	  }
+      }
+  if ((nrhs > 5+nfilt) && (type != LAPLACIAN_PYR))
+    bands = selection(prhs[5+nfilt], 1, (type == STEERABLE_PYR) ? nori : 3, "BANDS");
+
+  if (single)
+    plhs[0] = (mxArray *) mxCreateNumericMatrix(x_dim,y_dim,mxSINGLE_CLASS,mxREAL);
+  else
+    plhs[0] = (mxArray *) mxCreateDoubleMatrix(x_dim,y_dim,mxREAL);
+  if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+
+  if (single)
+      {
+      switch (type)
+	  {
+	  case LAPLACIAN_PYR:
+	    status = recon_lpyr_f((float *) mxGetData(prhs[1]), x_dim, y_dim, ht,
+				  float_copy(prhs[3]), flen, levs,
+				  edges, (float *) mxGetData(plhs[0]));
+	    break;
+	  case STEERABLE_PYR:
+	    status = recon_spyr_f((float *) mxGetData(prhs[1]), x_dim, y_dim, ht,
+				  float_copy(prhs[4]), hi0_fdim, float_copy(prhs[3]), lo0_fdim,
+				  float_copy(prhs[5]), lo_fdim,
+				  float_copy(prhs[6]), bfilt_fdim, nori, levs, bands,
+				  edges, (float *) mxGetData(plhs[0]));
+	    break;
+	  default:
+	    status = recon_wpyr_f((float *) mxGetData(prhs[1]), x_dim, y_dim, ht,
+				  float_copy(prhs[3]), flen, levs, bands,
+				  edges, (float *) mxGetData(plhs[0]));
+	    break;
+	  }
+      }
+  else
+      {
+      switch (type)
+	  {
+	  case LAPLACIAN_PYR:
+	    status = recon_lpyr(mxGetPr(prhs[1]), x_dim, y_dim, ht,
+				mxGetPr(prhs[3]), flen, levs,
+				edges, mxGetPr(plhs[0]));
+	    break;
+	  case STEERABLE_PYR:
+	    status = recon_spyr(mxGetPr(prhs[1]), x_dim, y_dim, ht,
+				mxGetPr(prhs[4]), hi0_fdim, mxGetPr(prhs[3]), lo0_fdim,
+				mxGetPr(prhs[5]), lo_fdim,
+				mxGetPr(prhs[6]), bfilt_fdim, nori, levs, bands,
+				edges, mxGetPr(plhs[0]));
+	    break;
+	  default:
+	    status = recon_wpyr(mxGetPr(prhs[1]), x_dim, y_dim, ht,
+				mxGetPr(prhs[3]), flen, levs, bands,
+				edges, mxGetPr(plhs[0]));
+	    break;
+	  }
+      }
+  if (status != 0) mexErrMsgTxt("Pyramid reconstruction failed.");
+
+  if (levs) mxFree((char *) levs);
+  if (bands) mxFree((char *) bands);
+  return;
+  }
@@ -1,17 +1,21 @@
 /* 
 RES = upConv(IM, FILT, EDGES, STEP, START, STOP, RES);
   >>> See upConv.m for documentation <<<
-  This is a matlab interface to the internal_expand function. 
+  This is a matlab interface to the internal_expand function
+  (through internal_upconv, see pyramid.c). 
   EPS, 7/96.
+  Single-precision IM runs the float kernels (-DPYR_FLOAT build), 10/26.
 */
 
 #define V4_COMPAT
 #include <matrix.h>  /* Matlab matrices */
 #include <mex.h>
 
-#include "convolve.h"
+#include <string.h>
+#include "pyramid.h"
 
 #define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notFltMtx(it) (!mxIsNumeric(it) || !(mxIsDouble(it) || mxIsSingle(it)) || mxIsSparse(it) || mxIsComplex(it))
 
 void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 mxArray *plhs[],    /* Matrices on lhs      */
@@ -19,16 +23,18 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
 		 const mxArray *prhs[]     /* Matrices on rhs */
 		 )
   {
-  double *image,*filt, *temp, *result, *orig_filt;
+  double *image,*filt, *temp, *result;
+  float *ffilt, *ftemp, *fresult = NULL;
+  int single, i, status;
   int x_fdim, y_fdim, x_idim, y_idim;
-  int orig_x = 0, orig_y, x, y;
+  int x_edim, y_edim;
   int x_rdim, y_rdim;
   int x_start = 1;
   int x_step = 1;
   int y_start = 1;
   int y_step = 1;
   int x_stop, y_stop;
-  mxArray *arg;
+  const mxArray *arg;
   double *mxMat;
   char edges[15] = "reflect1";
 
@@ -36,16 +42,28 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
 
   /* ARG 1: IMAGE  */
   arg = prhs[0];
-  if notDblMtx(arg) mexErrMsgTxt("IMAGE arg must be a non-sparse double float matrix.");
+  if notFltMtx(arg) mexErrMsgTxt("IMAGE arg must be a non-sparse double or single float matrix.");
+  single = mxIsSingle(arg);
   image = mxGetPr(arg);
   x_idim = (int) mxGetM(arg); /* X is inner index! */
   y_idim = (int) mxGetN(arg);
 
   /* ARG 2: FILTER */
   arg = prhs[1];
-  if notDblMtx(arg) mexErrMsgTxt("FILTER arg must be non-sparse double float matrix.");  filt = mxGetPr(arg);
+  if (single && notFltMtx(arg))
+    mexErrMsgTxt("FILTER arg must be non-sparse double or single float matrix.");
+  if (!single && notDblMtx(arg))
+    mexErrMsgTxt("FILTER arg must be non-sparse double float matrix.");
+  filt = mxGetPr(arg);
   x_fdim = (int) mxGetM(arg); 
   y_fdim = (int) mxGetN(arg);
+  if (mxIsSingle(arg))
+      { /* single FILTER: widen here, narrowed again below */
+      filt = mxCalloc(x_fdim*y_fdim, sizeof(double));
+      if (filt == NULL)
+	mexErrMsgTxt("Cannot allocate necessary temporary space");
+      for (i=0; i<x_fdim*y_fdim; i++) filt[i] = ((float *) mxGetData(arg))[i];
+      }
 
   /* ARG 3 (optional): EDGES */
   if (nrhs>2) 
@@ -107,12 +125,23 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
   if (nrhs>6)
       {
       arg = prhs[6];
-      if notDblMtx(arg) mexErrMsgTxt("RES arg must be double float matrix.");
+      if (single ? !mxIsSingle(arg) : notDblMtx(arg))
+	mexErrMsgTxt("RES arg must be a float matrix of the same class as IMAGE.");
 
       /* 7/10/97: Returning one of the args causes problems with Matlab's memory 
 	 manager, so we don't return anything if the result image is passed */
       /*  plhs[0] = arg;  */
+      /* 10/26: ... unless an output is requested, in which case the sum
+	 is accumulated into (and returned as) a copy, leaving RES and
+	 any variables sharing its data untouched. */
+      if (nlhs > 0)
+	  {
+	  plhs[0] = mxDuplicateArray(arg);
+	  if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+	  arg = plhs[0];
+	  }
       result = mxGetPr(arg);
+      fresult = (float *) mxGetData(arg);
       x_rdim =  (int) mxGetM(arg); /* X is inner index! */
       y_rdim = (int) mxGetN(arg);
       if  ((x_stop>x_rdim) || (y_stop>y_rdim))
@@ -125,9 +154,13 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
       /*  x_rdim = x_step * ((x_stop+x_step-1)/x_step);
           y_rdim = y_step * ((y_stop+y_step-1)/y_step);  */
 
-      plhs[0] = (mxArray *) mxCreateDoubleMatrix(x_rdim,y_rdim,mxREAL);
+      if (single)
+	plhs[0] = (mxArray *) mxCreateNumericMatrix(x_rdim,y_rdim,mxSINGLE_CLASS,mxREAL);
+      else
+	plhs[0] = (mxArray *) mxCreateDoubleMatrix(x_rdim,y_rdim,mxREAL);
       if (plhs[0] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
       result = mxGetPr(plhs[0]);
+      fresult = (float *) mxGetData(plhs[0]);
       }
 	  
   if ( (((x_stop-x_start+x_step-1) / x_step) != x_idim) ||
@@ -142,51 +175,56 @@ void mexFunction(int nlhs,	     /* Num return vals on lhs */
     }
 
   /* upConv has a bug for even-length kernels when using the 
-     reflect1, extend, or repeat edge-handlers */
+     reflect1, extend, or repeat edge-handlers: internal_upconv
+     embeds FILT in a filter with odd dimensions */
+  x_edim = x_fdim;
+  y_edim = y_fdim;
   if ((!strcmp(edges,"reflect1") || !strcmp(edges,"extend") || !strcmp(edges,"repeat"))
       &&
       ((x_fdim%2 == 0) || (y_fdim%2 == 0)))
       {
-      orig_filt = filt;
-      orig_x = x_fdim; 
-      orig_y = y_fdim;
-      x_fdim = 2*(orig_x/2)+1;
-      y_fdim = 2*(orig_y/2)+1;
-      filt = mxCalloc(x_fdim*y_fdim, sizeof(double));
-      if (filt == NULL)
-	mexErrMsgTxt("Cannot allocate necessary temporary space");
-      for (y=0; y<orig_y; y++)
-	for (x=0; x<orig_x; x++)
-	    filt[y*x_fdim + x] = orig_filt[y*orig_x + x];
+      x_edim = 2*(x_fdim/2)+1;
+      y_edim = 2*(y_fdim/2)+1;
       }
 
-  if ((x_fdim > x_rdim) || (y_fdim > y_rdim))
+  if ((x_edim > x_rdim) || (y_edim > y_rdim))
     {
-    mexPrintf("Filter: [%d %d], ",x_fdim,y_fdim);
+    mexPrintf("Filter: [%d %d], ",x_edim,y_edim);
     mexPrintf("Result: [%d %d]\n",x_rdim,y_rdim);
     mexErrMsgTxt("FILTER dimensions larger than RESULT dimensions.");
     }
  
-  temp = mxCalloc(x_fdim*y_fdim, sizeof(double));
-  if (temp == NULL)
-    mexErrMsgTxt("Cannot allocate necessary temporary space");
-
   /*
   printf("(%d, %d), (%d, %d), (%d, %d), (%d, %d), (%d, %d), %s\n",
 	 x_idim,y_idim,x_fdim,y_fdim,x_rdim,y_rdim,
 	 x_start,x_step,y_start,y_step,edges);
 	 */
 
-  if (strcmp(edges,"circular") == 0)
-	internal_wrap_expand(image, filt, x_fdim, y_fdim,
-			     x_start, x_step, x_stop, y_start, y_step, y_stop,
-			     result, x_rdim, y_rdim);
-  else internal_expand(image, filt, temp, x_fdim, y_fdim,
-		       x_start, x_step, x_stop, y_start, y_step, y_stop,
-		       result, x_rdim, y_rdim, edges);
+  if (single)
+      {
+      ftemp = mxCalloc((x_fdim+1)*(y_fdim+1) + x_fdim*y_fdim, sizeof(float));
+      if (ftemp == NULL)
+	mexErrMsgTxt("Cannot allocate necessary temporary space");
+      ffilt = ftemp + (x_fdim+1)*(y_fdim+1);
+      for (i=0; i<x_fdim*y_fdim; i++) ffilt[i] = (float) filt[i];
+      status = internal_upconv_f((float *) mxGetData(prhs[0]), ffilt, ftemp, x_fdim, y_fdim,
+				 x_start, x_step, x_stop, y_start, y_step, y_stop,
+				 fresult, x_rdim, y_rdim, edges);
+      mxFree((char *) ftemp);
+      }
+  else
+      {
+      temp = mxCalloc((x_fdim+1)*(y_fdim+1), sizeof(double));
+      if (temp == NULL)
+	mexErrMsgTxt("Cannot allocate necessary temporary space");
+      status = internal_upconv(image, filt, temp, x_fdim, y_fdim,
+			       x_start, x_step, x_stop, y_start, y_step, y_stop,
+			       result, x_rdim, y_rdim, edges);
+      mxFree((char *) temp);
+      }
 
-  if (orig_x) mxFree((char *) filt);
-  mxFree((char *) temp);
+  if (mxIsSingle(prhs[1])) mxFree((char *) filt);
+  if (status != 0) mexErrMsgTxt("upConv failed.");
 
   return;
   }      
@@ -0,0 +1,174 @@
+/*
+[MEAN_X, MEAN_Y, COV_XY, SS_X, SS_Y] = winMoments(X, Y, WIN, EDGES, STEP, START, STOP);
+  >>> See winMoments.m for documentation <<<
+  This is a matlab interface to the internal_moments function.
+  Single-precision X and Y run the float kernel (-DPYR_FLOAT build).
+*/
+
+#define V4_COMPAT
+#include <matrix.h>  /* Matlab matrices */
+#include <mex.h>
+
+#include <string.h>
+#include "convolve.h"
+
+#define notDblMtx(it) (!mxIsNumeric(it) || !mxIsDouble(it) || mxIsSparse(it) || mxIsComplex(it))
+#define notFltMtx(it) (!mxIsNumeric(it) || !(mxIsDouble(it) || mxIsSingle(it)) || mxIsSparse(it) || mxIsComplex(it))
+
+void mexFunction(int nlhs,	     /* Num return vals on lhs */
+		 mxArray *plhs[],    /* Matrices on lhs      */
+		 int nrhs,	     /* Num args on rhs    */
+		 const mxArray *prhs[]     /* Matrices on rhs */
+		 )
+  {
+  double *filt, *temp;
+  float *ftemp, *ffilt;
+  int single, i, status;
+  int x_fdim, y_fdim, x_idim, y_idim;
+  int x_rdim, y_rdim;
+  int x_start = 1;
+  int x_step = 1;
+  int y_start = 1;
+  int y_step = 1;
+  int x_stop, y_stop;
+  const mxArray *arg;
+  double *mxMat;
+  mxArray *out[5];
+  void *res[5];
+  char edges[15] = "reflect1";
+
+  if (nrhs<3) mexErrMsgTxt("requres at least 3 args.");
+
+  /* ARGS 1,2: X, Y */
+  arg = prhs[0];
+  if notFltMtx(arg) mexErrMsgTxt("X arg must be a non-sparse double or single float matrix.");
+  single = mxIsSingle(arg);
+  x_idim = (int) mxGetM(arg); /* X is inner index! */
+  y_idim = (int) mxGetN(arg);
+  arg = prhs[1];
+  if (notFltMtx(arg) || (mxIsSingle(arg) != single))
+    mexErrMsgTxt("Y arg must be a non-sparse matrix of the same class as X.");
+  if (((int) mxGetM(arg) != x_idim) || ((int) mxGetN(arg) != y_idim))
+    mexErrMsgTxt("X and Y must have the same dimensions.");
+
+  /* ARG 3: WIN */
+  arg = prhs[2];
+  if notDblMtx(arg) mexErrMsgTxt("WIN arg must be non-sparse double float matrix.");
+  filt = mxGetPr(arg);
+  x_fdim = (int) mxGetM(arg);
+  y_fdim = (int) mxGetN(arg);
+
+  if ((x_fdim > x_idim) || (y_fdim > y_idim))
+    {
+    mexPrintf("Filter: [%d %d], Image: [%d %d]\n",x_fdim,y_fdim,x_idim,y_idim);
+    mexErrMsgTxt("WIN dimensions larger than image dimensions.");
+    }
+
+  /* ARG 4 (optional): EDGES */
+  if (nrhs>3)
+      {
+      if (!mxIsChar(prhs[3]))
+	mexErrMsgTxt("EDGES arg must be a string.");
+      mxGetString(prhs[3],edges,15);
+      }
+  if (strcmp(edges,"circular") == 0)
+    mexErrMsgTxt("EDGES 'circular' is not supported by winMoments.");
+
+  /* ARG 5 (optional): STEP */
+  if (nrhs>4)
+      {
+      arg = prhs[4];
+      if notDblMtx(arg) mexErrMsgTxt("STEP arg must be a double float matrix.");
+      if (mxGetM(arg) * mxGetN(arg) != 2)
+    	 mexErrMsgTxt("STEP arg must contain two elements.");
+      mxMat = mxGetPr(arg);
+      x_step = (int) mxMat[0];
+      y_step = (int) mxMat[1];
+      if ((x_step<1) || (y_step<1))
+         mexErrMsgTxt("STEP values must be greater than zero.");
+      }
+
+  /* ARG 6 (optional): START */
+  if (nrhs>5)
+      {
+      arg = prhs[5];
+      if notDblMtx(arg) mexErrMsgTxt("START arg must be a double float matrix.");
+      if (mxGetM(arg) * mxGetN(arg) != 2)
+	mexErrMsgTxt("START arg must contain two elements.");
+      mxMat = mxGetPr(arg);
+      x_start = (int) mxMat[0];
+      y_start = (int) mxMat[1];
+      if ((x_start<1) || (x_start>x_idim) ||
+          (y_start<1) || (y_start>y_idim))
+         mexErrMsgTxt("START values must lie between 1 and the image dimensions.");
+      }
+  x_start--;  /* convert from Matlab to standard C indexes */
+  y_start--;
+
+  /* ARG 7 (optional): STOP */
+  if (nrhs>6)
+      {
+      if notDblMtx(prhs[6]) mexErrMsgTxt("STOP arg must be double float matrix.");
+      if (mxGetM(prhs[6]) * mxGetN(prhs[6]) != 2)
+    	 mexErrMsgTxt("STOP arg must contain two elements.");
+      mxMat = mxGetPr(prhs[6]);
+      x_stop = (int) mxMat[0];
+      y_stop = (int) mxMat[1];
+      if ((x_stop<x_start) || (x_stop>x_idim) ||
+          (y_stop<y_start) || (y_stop>y_idim))
+         mexErrMsgTxt("STOP values must lie between START and the image dimensions.");
+      }
+  else
+      {
+      x_stop = x_idim;
+      y_stop = y_idim;
+      }
+
+  x_rdim = (x_stop-x_start+x_step-1) / x_step;
+  y_rdim = (y_stop-y_start+y_step-1) / y_step;
+
+  /* all five results are computed, even if fewer are returned */
+  for (i=0; i<5; i++)
+      {
+      if (single)
+	out[i] = mxCreateNumericMatrix(x_rdim,y_rdim,mxSINGLE_CLASS,mxREAL);
+      else
+	out[i] = mxCreateDoubleMatrix(x_rdim,y_rdim,mxREAL);
+      if (out[i] == NULL) mexErrMsgTxt("Cannot allocate result matrix");
+      res[i] = mxGetData(out[i]);
+      }
+
+  if (single)
+      {
+      ftemp = mxCalloc(2*x_fdim*y_fdim, sizeof(float));
+      if (ftemp == NULL)
+	mexErrMsgTxt("Cannot allocate necessary temporary space");
+      ffilt = ftemp + x_fdim*y_fdim;
+      for (i=0; i<x_fdim*y_fdim; i++) ffilt[i] = (float) filt[i];
+      status = internal_moments_f((float *) mxGetData(prhs[0]), (float *) mxGetData(prhs[1]),
+				  x_idim, y_idim, ffilt, ftemp, x_fdim, y_fdim,
+				  x_start, x_step, x_stop, y_start, y_step, y_stop,
+				  (float *) res[0], (float *) res[1], (float *) res[2],
+				  (float *) res[3], (float *) res[4], edges);
+      mxFree((char *) ftemp);
+      }
+  else
+      {
+      temp = mxCalloc(x_fdim*y_fdim, sizeof(double));
+      if (temp == NULL)
+	mexErrMsgTxt("Cannot allocate necessary temporary space");
+      status = internal_moments(mxGetPr(prhs[0]), mxGetPr(prhs[1]),
+				x_idim, y_idim, filt, temp, x_fdim, y_fdim,
+				x_start, x_step, x_stop, y_start, y_step, y_stop,
+				(double *) res[0], (double *) res[1], (double *) res[2],
+				(double *) res[3], (double *) res[4], edges);
+      mxFree((char *) temp);
+      }
+  if (status != 0)
+    mexErrMsgTxt("Unknown EDGES type, or WIN sums to zero.");
+
+  for (i=0; i<5; i++)
+    if (i < ((nlhs>1) ? nlhs : 1)) plhs[i] = out[i];
+    else mxDestroyArray(out[i]);
+  return;
+  }
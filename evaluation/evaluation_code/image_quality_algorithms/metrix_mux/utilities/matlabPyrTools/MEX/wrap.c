@@ -7,6 +7,8 @@
 ;;;  MODIFICATIONS:
 ;;;      6/96: Switched array types to double float.
 ;;;      2/97: made more robust and readable.  Added STOP arguments.
+;;;     10/26: internal_wrap_reduce and internal_wrap_expand are timed
+;;;            when compiled with -DMETRIX_TRACE (native/trace.h).
 ;;;  ----------------------------------------------------------------
 ;;;    Object-Based Vision and Image Understanding System (OBVIUS),
 ;;;      Copyright 1988, Vision Science Group,  Media Laboratory,  
@@ -17,6 +19,9 @@
 #include <stdlib.h>
 
 #include "convolve.h"
+#ifdef METRIX_TRACE
+#include "trace.h"   /* native/, hot-path instrumentation */
+#endif
 
 /*
  --------------------------------------------------------------------
@@ -51,7 +56,7 @@ int internal_wrap_reduce(image, x_dim, y_dim, filt, x_fdim, y_fdim,
   image_type *image;
   int x_start, x_step, x_stop, y_start, y_step, y_stop;
   {
-  register double sum;
+  register image_type sum;
   register int filt_size = x_fdim*y_fdim;
   image_type **imval;
   register int filt_pos, x_im, y_im, x_filt_stop;
@@ -77,6 +82,9 @@ int internal_wrap_reduce(image, x_dim, y_dim, filt, x_fdim, y_fdim,
       printf("INTERNAL_WRAP: Failed to allocate temp array!");
       return(-1);
       }
+#ifdef METRIX_TRACE
+  long long const trace_start = metrix_trace_begin();
+#endif
   for (y_pos=y_im=0;y_pos<y_dim;y_pos++,y_im+=x_dim)
     imval[y_pos] = (image+y_im);
   
@@ -142,6 +150,9 @@ int internal_wrap_reduce(image, x_dim, y_dim, filt, x_fdim, y_fdim,
 
   free ((image_type **) imval);
 
+#ifdef METRIX_TRACE
+  metrix_trace_end("conv/" METRIX_TRACE_NAME(internal_wrap_reduce), trace_start);
+#endif
   return(0);
   }	/* end of internal_wrap_reduce */
 
@@ -181,7 +192,7 @@ int internal_wrap_expand(image, filt, x_fdim, y_fdim,
   image_type *image; 
   int x_start, x_step, x_stop, y_start, y_step, y_stop;
   {
-  register double val;
+  register image_type val;
   register int filt_size = x_fdim*y_fdim;
   image_type **imval;
   register int filt_pos, x_res, y_res, x_filt_stop;
@@ -207,6 +218,9 @@ int internal_wrap_expand(image, filt, x_fdim, y_fdim,
       printf("INTERNAL_WRAP: Failed to allocate temp array!");
       return(-1);
       }
+#ifdef METRIX_TRACE
+  long long const trace_start = metrix_trace_begin();
+#endif
   for (y_pos=y_res=0;y_pos<y_dim;y_pos++,y_res+=x_dim)
     imval[y_pos] = (result+y_res);
   
@@ -271,6 +285,9 @@ int internal_wrap_expand(image, filt, x_fdim, y_fdim,
     } /* end BOTTOM ROWS */
 
   free ((image_type **) imval);
+#ifdef METRIX_TRACE
+  metrix_trace_end("conv/" METRIX_TRACE_NAME(internal_wrap_expand), trace_start);
+#endif
   return(0);
   } /* end of internal_wrap_expand */
 
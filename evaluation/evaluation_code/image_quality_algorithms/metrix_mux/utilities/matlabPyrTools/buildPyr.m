@@ -0,0 +1,51 @@
+% [PYR, INDICES] = buildPyr(TYPE, IM, HEIGHT, FILTERS..., EDGES)
+%
+% Build a complete pyramid in one call.  The result is identical to
+% that of the corresponding M-file builder, but the MEX version
+% computes all levels in C, writing each subband directly into the
+% (pre-sized) output vector.
+%
+% TYPE selects the pyramid and the FILTERS that follow HEIGHT:
+%   'laplacian', FILT1, FILT2    - as buildLpyr(IM, HEIGHT, FILT1, FILT2, EDGES)
+%   'wavelet',   FILT            - as buildWpyr(IM, HEIGHT, FILT, EDGES)
+%   'steerable', LO0FILT, HI0FILT, LOFILT, BFILTS
+%                                - as buildSpyr(IM, HEIGHT, FILTFILE, EDGES),
+%                                  with the filters returned by FILTFILE
+%                                  (e.g. [lo0filt,hi0filt,lofilt,bfilts] = sp1Filters)
+%
+% All filters must be given as matrices (use namedFilter for names),
+% and HEIGHT must be a number (use maxPyrHt for 'auto', adding one for
+% a Laplacian pyramid).  EDGES (optional, default='reflect1') is as in
+% corrDn.
+%
+% PYR is a vector containing the N pyramid subbands, ordered as by the
+% M-file builders.  INDICES is an Nx2 matrix containing the sizes of
+% each subband.
+%
+% If IM is single, the single-precision kernels are used and PYR is
+% single.  Filters are always double.
+
+function [pyr,pind] = buildPyr(type, im, ht, varargin)
+
+%% NOTE: THIS CODE IS NOT ACTUALLY USED! (MEX FILE IS CALLED INSTEAD)
+
+switch type
+  case 'laplacian'
+    [pyr,pind] = buildLpyr(im, ht, varargin{:});
+  case 'wavelet'
+    [pyr,pind] = buildWpyr(im, ht, varargin{:});
+  case 'steerable'
+    [lo0filt,hi0filt,lofilt,bfilts] = deal(varargin{1:4});
+    if (length(varargin) > 4)
+      edges = varargin{5};
+    else
+      edges = 'reflect1';
+    end
+    hi0 = corrDn(im, hi0filt, edges);
+    lo0 = corrDn(im, lo0filt, edges);
+    [pyr,pind] = buildSpyrLevs(lo0, ht, lofilt, bfilts, edges);
+    pyr = [hi0(:) ; pyr];
+    pind = [size(hi0); pind];
+  otherwise
+    error('TYPE must be one of ''laplacian'', ''steerable'' or ''wavelet''.');
+end
@@ -24,6 +24,13 @@
 % vector by a matrix whose rows contain copies of the FILT shifted by
 % multiples of STEP.  See upConv.m for the operation corresponding to
 % the transpose of this matrix.
+%
+% NOTE: the MEX version switches to an FFT-based computation when FILT
+% has more than about 140 taps per output sample (see MEX/fftconv.c).
+% Results are the same, up to floating-point roundoff.
+%
+% NOTE: if IM is single, the MEX version uses single-precision kernels
+% and returns a single result (FILT may be double or single).
 
 % Eero Simoncelli, 6/96, revised 2/97.
 
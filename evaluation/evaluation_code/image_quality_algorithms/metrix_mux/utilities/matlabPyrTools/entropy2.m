@@ -6,11 +6,32 @@
 %
 % NOTE: This is a heavily  biased estimate of entropy when you
 % don't have much data.
+%
+% If MTX is a cell array of matrices, RES is an array of the same size
+% holding the entropy of each (with the default binning, all of them
+% are histogrammed in one call to histo).
 
 % Eero Simoncelli, 6/96.
 
 function res = entropy2(mtx,binsize)
 
+if iscell(mtx)
+  res = zeros(size(mtx));
+  if (exist('binsize') == 1)
+    for k = 1:numel(mtx)
+      res(k) = entropy2(mtx{k}, binsize);
+    end
+  else
+    bincounts = histo(mtx, 256);
+    for k = 1:numel(mtx)
+      H = bincounts{k}(find(bincounts{k}));
+      H = H/sum(H);
+      res(k) = -sum(H .* log2(H));
+    end
+  end
+  return
+end
+
 %% Ensure it's a vector, not a matrix.
 vec = mtx(:);
 [mn,mx] = range2(vec);
@@ -15,20 +15,41 @@
 %   + is much faster (approximately a factor of 80 on my machine).
 %   + allows specification of number of bins OR binsize.  Default=101 bins.
 %   + allows (optional) specification of binCenter.
+%
+% MTX may be double, single, uint8 or uint16; the MEX version bins
+% single and integer matrices without converting them to double.  If
+% MTX is a cell array of matrices, N and X are cell arrays of the same
+% size, holding the histogram of each matrix (computed with the same
+% nbinsOrBinsize and binCenter arguments).
 
 % Eero Simoncelli, 3/97.
 
-function [N, X] = histo(mtx, nbins, binCtr)
+function [N, X] = histo(mtx, varargin)
 
 %% NOTE: THIS CODE IS NOT ACTUALLY USED! (MEX FILE IS CALLED INSTEAD)
 
 fprintf(1,'WARNING: You should compile the MEX version of "histo.c",\n         found in the MEX subdirectory of matlabPyrTools, and put it in your matlab path.  It is MUCH faster.\n');
 
-mtx = mtx(:);
+if iscell(mtx)
+  N = cell(size(mtx));  X = cell(size(mtx));
+  for k = 1:numel(mtx)
+    [N{k}, X{k}] = histo(mtx{k}, varargin{:});
+  end
+  return
+end
+
+mtx = double(mtx(:));
 
 %------------------------------------------------------------
 %% OPTIONAL ARGS:
 
+if (length(varargin) > 0)
+  nbins = varargin{1};
+end
+if (length(varargin) > 1)
+  binCtr = varargin{2};
+end
+
 [mn,mx] = range2(mtx);
 
 if (exist('binCtr') ~= 1) 
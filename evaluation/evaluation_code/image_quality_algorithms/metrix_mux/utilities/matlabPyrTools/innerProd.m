@@ -1,6 +1,11 @@
 % RES = innerProd(MTX)
 %
 % Compute (MTX' * MTX) efficiently (i.e., without copying the matrix)
+%
+% The MEX version works through MTX in blocks of rows, using only the
+% symmetry of the result (the upper triangle is computed once), and is
+% intended for tall, narrow matrices (many rows, tens of columns).  A
+% single MTX gives a single RES, though sums are accumulated in double.
 
 function res = innerProd(mtx)
 
@@ -8,6 +8,10 @@
 % linear interpolation.  If WARNINGS is non-zero, the function prints
 % a warning whenever the lookup table is extrapolated.
 %
+% IM may be double or single (RES has the same class), or a cell
+% array of images, in which case RES is a cell array of the results,
+% all computed in one call through the same LUT.
+%
 % This function is much faster than MatLab's interp1, and allows
 % extrapolation beyond the lookup table domain.  The drawbacks are
 % that the lookup table must be equi-spaced, and the interpolation is
@@ -24,5 +28,12 @@ fprintf(1,'WARNING: You should compile the MEX version of "pointOp.c",\n
 X = origin + increment*[0:size(lut(:),1)-1];
 Y = lut(:);
 
-res = reshape(interp1(X, Y, im(:), 'linear', 'extrap'),size(im));
+if iscell(im)
+  res = cell(size(im));
+  for n = 1:numel(im)
+    res{n} = reshape(interp1(X, Y, im{n}(:), 'linear', 'extrap'),size(im{n}));
+  end
+else
+  res = reshape(interp1(X, Y, im(:), 'linear', 'extrap'),size(im));
+end
 
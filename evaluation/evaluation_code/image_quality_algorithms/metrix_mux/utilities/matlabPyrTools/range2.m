@@ -1,10 +1,19 @@
 % [MIN, MAX] = range2(MTX)
+% [MINS, MAXS] = range2(PYR, INDICES)
 %
 % Compute minimum and maximum values of MTX, returning them as a 2-vector.
+%
+% NaNs are ignored (both results are NaN if MTX has no other values).
+% MTX may be double, single or uint8.
+%
+% With a second argument, PYR is a pyramid vector and INDICES its Nx2
+% matrix of band sizes (as returned by the build*pyr functions); MINS
+% and MAXS are Nx1 vectors holding the range of each band, computed in
+% one call.
 
 % Eero Simoncelli, 3/97.
 
-function [mn, mx] = range2(mtx)
+function [mn, mx] = range2(mtx, pind)
 
 %% NOTE: THIS CODE IS NOT ACTUALLY USED! (MEX FILE IS CALLED INSTEAD)
 
@@ -14,5 +23,15 @@ if (~isreal(mtx))
   error('MTX must be real-valued');  
 end
 
-mn = min(min(mtx));
-mx = max(max(mtx));
+if (exist('pind') == 1)
+  nbands = size(pind,1);
+  mn = zeros(nbands,1);  mx = zeros(nbands,1);
+  for b = 1:nbands
+    band = double(pyrBand(mtx,pind,b));
+    mn(b) = min(band(:));  mx(b) = max(band(:));
+  end
+  return
+end
+
+mn = double(min(min(mtx)));
+mx = double(max(max(mtx)));
@@ -0,0 +1,64 @@
+% RES = reconPyr(TYPE, PYR, INDICES, FILTERS..., EDGES, LEVS, BANDS)
+%
+% Reconstruct an image from a pyramid in one call.  The result is the
+% same as that of the corresponding M-file (up to floating-point
+% roundoff), but the MEX version works entirely in C, upsampling each
+% subband and adding it directly into the image of its level, instead
+% of making one full-size temporary image per subband.
+%
+% TYPE selects the pyramid and the FILTERS that follow INDICES:
+%   'laplacian', FILT2           - as reconLpyr(PYR, INDICES, LEVS, FILT2, EDGES)
+%   'wavelet',   FILT            - as reconWpyr(PYR, INDICES, FILT, EDGES, LEVS, BANDS)
+%   'steerable', LO0FILT, HI0FILT, LOFILT, BFILTS
+%                                - as reconSpyr(PYR, INDICES, FILTFILE, EDGES, LEVS, BANDS),
+%                                  with the filters returned by FILTFILE
+%
+% All filters must be given as matrices (use namedFilter for names).
+% EDGES (optional, default='reflect1') is as in corrDn.  LEVS and
+% BANDS (optional, default='all') select levels and orientations as
+% in the M-files (BANDS is ignored for a Laplacian pyramid).
+%
+% The image size is taken from INDICES, so, as with reconWpyr, a
+% wavelet pyramid of an odd-sized image built with an even-length
+% filter cannot be reconstructed.
+%
+% If PYR is single, the single-precision kernels are used and RES is
+% single.  Filters are always double.
+
+function res = reconPyr(type, pyr, pind, varargin)
+
+%% NOTE: THIS CODE IS NOT ACTUALLY USED! (MEX FILE IS CALLED INSTEAD)
+
+switch type
+  case 'laplacian'
+    filt2 = varargin{1};
+    if (length(varargin) > 1) edges = varargin{2}; else edges = 'reflect1'; end
+    if (length(varargin) > 2) levs = varargin{3}; else levs = 'all'; end
+    res = reconLpyr(pyr, pind, levs, filt2, edges);
+  case 'wavelet'
+    res = reconWpyr(pyr, pind, varargin{:});
+  case 'steerable'
+    [lo0filt,hi0filt,lofilt,bfilts] = deal(varargin{1:4});
+    if (length(varargin) > 4) edges = varargin{5}; else edges = 'reflect1'; end
+    if (length(varargin) > 5) levs = varargin{6}; else levs = 'all'; end
+    if (length(varargin) > 6) bands = varargin{7}; else bands = 'all'; end
+    maxLev = 1 + spyrHt(pind);
+    if strcmp(levs,'all') levs = [0:maxLev]'; end
+    if strcmp(bands,'all') bands = [1:size(bfilts,2)]'; end
+    if (spyrHt(pind) == 0)
+      if (any(levs==1))
+        res1 = pyrBand(pyr,pind,2);
+      else
+        res1 = zeros(pind(2,:));
+      end
+    else
+      res1 = reconSpyrLevs(pyr(1+prod(pind(1,:)):size(pyr,1)), ...
+          pind(2:size(pind,1),:), lofilt, bfilts, edges, levs, bands);
+    end
+    res = upConv(res1, lo0filt, edges);
+    if any(levs == 0)
+      res = upConv(pyrBand(pyr,pind,1), hi0filt, edges, [1 1], [1 1], size(res), res);
+    end
+  otherwise
+    error('TYPE must be one of ''laplacian'', ''steerable'' or ''wavelet''.');
+end
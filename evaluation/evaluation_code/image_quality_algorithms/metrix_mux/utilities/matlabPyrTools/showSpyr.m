@@ -68,12 +68,8 @@ if strcmp(range,'auto1')
   range(nind,:) = [mn, mx];
 
 elseif strcmp(range,'indep1')
-  range = zeros(nind,2);
-  for bnum = 1:nind
-    band = pyrBand(pyr,pind,bnum);
-    [mn,mx] = range2(band);
-    range(bnum,:) =  [mn mx];
-  end
+  [mn,mx] = range2(pyr,pind);		% all bands in one call
+  range =  [mn mx];
 
 elseif strcmp(range,'auto2')
   range = ones(nind,1);
@@ -89,16 +89,12 @@ if strcmp(range,'auto1')
   range(nind,:) = [mn, mx];
 
 elseif strcmp(range,'indep1')
-  range = zeros(nind,2);
-  for bnum = 1:nind
-    band = pyrBand(pyr,pind,bnum);
-    [mn,mx] = range2(band);
-    if (nbands == 1)
-      pad = (mx-mn)/12; 		% *** MAGIC NUMBER!!
-      mn = mn-pad;  mx = mx+pad;
-    end
-    range(bnum,:) =  [mn mx];
+  [mn,mx] = range2(pyr,pind);		% all bands in one call
+  if (nbands == 1)
+    pad = (mx-mn)/12; 			% *** MAGIC NUMBER!!
+    mn = mn-pad;  mx = mx+pad;
   end
+  range =  [mn mx];
 
 elseif strcmp(range,'auto2')
   range = zeros(nind,1);
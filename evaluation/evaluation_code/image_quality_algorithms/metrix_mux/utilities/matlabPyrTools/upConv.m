@@ -25,11 +25,21 @@
 % destructively added into this matrix.  If this argument is passed, the 
 % result matrix will not be returned. DO NOT USE THIS ARGUMENT IF 
 % YOU DO NOT UNDERSTAND WHAT THIS MEANS!!
+% (MEX version: if an output IS requested, as in RES2 = upConv(..., RES),
+% the sum RES + upConv(...) is returned and RES itself is left unchanged.
+% To add many upsampled bands together, use reconPyr.)
 % 
 % NOTE: this operation corresponds to multiplication of a signal
 % vector by a matrix whose columns contain copies of the time-reversed
 % (or space-reversed) FILT shifted by multiples of STEP.  See corrDn.m
 % for the operation corresponding to the transpose of this matrix.
+%
+% NOTE: the MEX version switches to an FFT-based computation when FILT
+% has more than about 140 taps per input sample (see MEX/fftconv.c).
+% Results are the same, up to floating-point roundoff.
+%
+% NOTE: if IM is single, the MEX version uses single-precision kernels
+% and returns a single result; RES, if given, must then be single too.
 
 % Eero Simoncelli, 6/96.  revised 2/97.
 
@@ -0,0 +1,42 @@
+% [MEAN_X, MEAN_Y, COV_XY, SS_X, SS_Y] = winMoments(X, Y, WIN, EDGES, STEP, START, STOP)
+%
+% Windowed first and second moments of two images of the same size,
+% computed in one pass.  With W = sum(WIN(:)), the results are those
+% of
+%
+%   MEAN_X = corrDn(X, WIN/W, EDGES, STEP, START, STOP)
+%   MEAN_Y = corrDn(Y, WIN/W, EDGES, STEP, START, STOP)
+%   COV_XY = corrDn(X.*Y, WIN, EDGES, STEP, START, STOP) - W.*MEAN_X.*MEAN_Y
+%   SS_X   = corrDn(X.^2, WIN, EDGES, STEP, START, STOP) - W.*MEAN_X.^2
+%   SS_Y   = corrDn(Y.^2, WIN, EDGES, STEP, START, STOP) - W.*MEAN_Y.^2
+%
+% up to floating-point roundoff, but the MEX version reads X and Y
+% once and makes none of the product images.  EDGES, STEP, START and
+% STOP are as in corrDn, except that 'circular' is not supported.
+%
+% If X and Y are single, the results are single (the sums are still
+% accumulated in double).  WIN must be double, with a non-zero sum.
+
+function [mean_x, mean_y, cov_xy, ss_x, ss_y] = winMoments(x, y, win, edges, step, start, stop)
+
+%% NOTE: THIS CODE IS NOT ACTUALLY USED! (MEX FILE IS CALLED INSTEAD)
+
+if (exist('edges') ~= 1)
+  edges = 'reflect1';
+end
+if (exist('step') ~= 1)
+  step = [1,1];
+end
+if (exist('start') ~= 1)
+  start = [1,1];
+end
+if (exist('stop') ~= 1)
+  stop = size(x);
+end
+
+w = sum(win(:));
+mean_x = corrDn(x, win/w, edges, step, start, stop);
+mean_y = corrDn(y, win/w, edges, step, start, stop);
+cov_xy = corrDn(x.*y, win, edges, step, start, stop) - w.*mean_x.*mean_y;
+ss_x = corrDn(x.^2, win, edges, step, start, stop) - w.*mean_x.^2;
+ss_y = corrDn(y.^2, win, edges, step, start, stop) - w.*mean_y.^2;
@@ -1,13 +1,23 @@
-function xs = imshift(x, t, bbox)
+function xs = imshift(x, t, bbox, use_native)
 % IMSHIFT x by d using subpixel interpolation.
 %
 % Input:    x      image to be shifted
 %           t      2D vector, real
 %           bbox   'crop' (default) or 'same' or 'full'
+%           use_native  false to shift by shiftmatrix even if
+%                  imshift_native is built (default true)
 %
 % Michael Hirsch, Stefan Harmeling * 16 August 2010
 
 if ~exist('bbox', 'var')||isempty(bbox), bbox = 'crop'; end
+if ~exist('use_native', 'var')||isempty(use_native), use_native = true; end
+
+% the native shift (metrix_mux/native) copies or blends rows and columns
+% instead of multiplying by shiftmatrix, all channels in one call
+if use_native && exist('imshift_native', 'file') == 3
+  xs = imshift_native(x, t, bbox);
+  return;
+end
 
 if size(x,3) > 2
   for i = 1:size(x,3)
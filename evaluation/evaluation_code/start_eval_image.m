@@ -9,9 +9,19 @@ IMGEXT = 'png';
 
 % -----------------------------------------------------------------
 % DEFINE METRIC: available metrics: 'MSE','MSSIM','VIF','IFC','PSNR','MAD'
+% (all of them are scored in one pass over the ground truth images)
 % -----------------------------------------------------------------
 metric = {'PSNR'};
 
+% -----------------------------------------------------------------
+% CANDIDATE PRUNING: score 'MSSIM','VIF','IFC' and 'MAD' against the
+% topK ground truth images closest by a cheap proxy only ([]: all of
+% them).  With verify the exhaustive scores are computed as well, to
+% count the images whose best score the pruning changes.
+% -----------------------------------------------------------------
+topK = [];
+verify = false;
+
 % =================================================================
 % DEFINE image Number (1 to 4) and Kernel Number (1 to 12) of
 % deblurred images, which shall be assigned a score
@@ -28,42 +38,38 @@ exclude = [];
 % -----------------------------------------------------------------
 cd(MYPATH)
 
-for iM = 1 : length(metric)
-  for iImg = imgNo
-    for iKern = kernNo
-      if ~isempty(intersect([iImg iKern],exclude,'rows'))
-        continue
-      end
-      
+nChecked = 0;
+nDiffer = 0;
+
+for iImg = imgNo
+  for iKern = kernNo
+    if ~isempty(intersect([iImg iKern],exclude,'rows'))
+      continue
+    end
+
+    % all metrics in one pass: every ground truth image is aligned once
+    deblurred = imread(sprintf('%s/%s%d_%d.%s',DEBLPATH,DEBLNAME,iImg,iKern,IMGEXT));
+    scores = eval_image(deblurred,iImg,iKern,metric,topK,verify);
+
+    for iM = 1 : length(metric)
       metricNow = metric{iM};
-      deblurred = imread(sprintf('%s/%s%d_%d.%s',DEBLPATH,DEBLNAME,iImg,iKern,IMGEXT));
-      scores = eval_image(deblurred,iImg,iKern,metricNow);
-     
-      switch metricNow
-        case 'MSE'
-          DeblurScore.MSE(iImg,iKern) = ...
-              get_best_metric_value2(scores.MSE,'MSE',iImg,iKern);
-        case 'MSSIM'
-           DeblurScore.MSSIM(iImg,iKern) = ...
-              get_best_metric_value2(scores.MSSIM,'MSSIM',iImg,iKern);
-        case 'VIF'
-          DeblurScore.VIF(iImg,iKern) = ...
-              get_best_metric_value2(scores.VIF,'VIF',iImg,iKern);
-        case 'IFC'
-           DeblurScore.IFC(iImg,iKern) = ...
-              get_best_metric_value2(scores.IFC,'IFC',iImg,iKern);
-        case 'PSNR'
-          DeblurScore.PSNR(iImg,iKern) = ...
-              get_best_metric_value2(scores.PSNR,'PSNR',iImg,iKern);
-        case 'MAD'
-           DeblurScore.MAD(iImg,iKern) = ...
-              get_best_metric_value2(scores.MAD,'MAD',iImg,iKern);
-      end
-               
+      DeblurScore.(metricNow)(iImg,iKern) = ...
+          get_best_metric_value2(scores.(metricNow),metricNow,iImg,iKern);
+    end
+
+    if isfield(scores, 'pruned_differs')
+      nChecked = nChecked + 1;
+      nDiffer = nDiffer + scores.pruned_differs;
     end
+
   end
 end
 
+if nChecked > 0
+  fprintf('Pruned result differs from exhaustive in %d of %d images\n', ...
+          nDiffer, nChecked);
+end
+
 
 
 % =================================================================